@@ -28,6 +28,13 @@
 #define _CRT_SECURE_NO_DEPRECATE
 #endif
 
+/* Strict ANSI builds hide POSIX, ask for it to get posix_madvise for BC_JSON_ParseFile. This only
+ * works in front of the first system header, a file that includes BC_JSON.c after other headers
+ * has to ask for it itself (map_file_text then does without the advice). */
+#if !defined(CJSON_NO_MMAP) && defined(__STRICT_ANSI__) && !defined(_POSIX_C_SOURCE) && !defined(_XOPEN_SOURCE) && (defined(__unix__) || defined(__APPLE__))
+#define _POSIX_C_SOURCE 200112L
+#endif
+
 #ifdef __GNUC__
 #pragma GCC visibility push(default)
 #endif
@@ -44,11 +51,55 @@
 #include <limits.h>
 #include <ctype.h>
 #include <float.h>
+#include <assert.h>
 
 #ifdef ENABLE_LOCALES
 #include <locale.h>
 #endif
 
+/* Strings are scanned for characters that need escaping 16 or 32 at a time with SSE2/AVX2 or
+ * NEON where GCC or clang provides them, define CJSON_NO_SIMD to scan one at a time. */
+#if !defined(CJSON_NO_SIMD) && defined(__GNUC__) && (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+#define CJSON_SIMD_SSE2
+#if defined(__clang__) || (__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9))
+/* AVX2 is compiled in for every target and used if the processor has it */
+#define CJSON_SIMD_AVX2
+#endif
+#include <immintrin.h>
+#elif !defined(CJSON_NO_SIMD) && defined(__GNUC__) && defined(__aarch64__)
+#define CJSON_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+/* BC_JSON_PrintParallel prints on POSIX threads or Windows threads, define CJSON_NO_THREADS to
+ * print on the calling thread only. */
+#if !defined(CJSON_NO_THREADS) && defined(_WIN32)
+#define CJSON_THREADS_WIN32
+#include <windows.h>
+#elif !defined(CJSON_NO_THREADS) && (defined(__unix__) || defined(__APPLE__))
+#include <unistd.h>
+#if defined(_POSIX_THREADS) && (_POSIX_THREADS > 0)
+#define CJSON_THREADS_POSIX
+#include <pthread.h>
+#endif
+#endif
+
+/* BC_JSON_ParseFile maps files with mmap or MapViewOfFile, define CJSON_NO_MMAP to read them into
+ * memory instead. */
+#if !defined(CJSON_NO_MMAP) && defined(_WIN32)
+#define CJSON_MMAP_WIN32
+#include <windows.h>
+#elif !defined(CJSON_NO_MMAP) && (defined(__unix__) || defined(__APPLE__))
+#include <unistd.h>
+#if defined(_POSIX_MAPPED_FILES) && (_POSIX_MAPPED_FILES > 0)
+#define CJSON_MMAP_POSIX
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#endif
+#endif
+
 #if defined(_MSC_VER)
 #pragma warning (pop)
 #endif
@@ -237,6 +288,229 @@ CJSON_PUBLIC(void) BC_JSON_InitHooks(BC_JSON_Hooks* hooks)
     }
 }
 
+/* What a BC_JSON_PrintCache keeps about an array/object: the text it was printed as, right after
+ * it in the same allocation. */
+typedef struct
+{
+    size_t length; /* of the text */
+    size_t depth; /* of the array/object when it was printed, it is indented by it */
+    BC_JSON_bool format;
+} print_fragment;
+
+typedef struct
+{
+    const BC_JSON *item; /* NULL for a free slot */
+    print_fragment *fragment;
+} fragment_entry;
+
+/* The text BC_JSON_PrintCached cached for the arrays/objects of a document, in an open addressing
+ * table keyed by their address. Only items with BC_JSON_IsPrinted use their entry: every change
+ * drops it and new items don't have it, so the entry an item left behind at its address when it was
+ * freed is replaced before any item there uses it. */
+struct BC_JSON_PrintCache
+{
+    fragment_entry *slots;
+    size_t slot_mask;
+    size_t count;
+};
+
+#define fragment_slot(cache, item) ((((size_t)(item) / sizeof(BC_JSON)) * 2654435761u) & (cache)->slot_mask)
+
+static fragment_entry *find_fragment_entry(const BC_JSON_PrintCache * const cache, const BC_JSON * const item)
+{
+    size_t slot = 0;
+
+    if (cache->count == 0)
+    {
+        return NULL;
+    }
+
+    for (slot = fragment_slot(cache, item); cache->slots[slot].item != NULL; slot = (slot + 1) & cache->slot_mask)
+    {
+        if (cache->slots[slot].item == item)
+        {
+            return cache->slots + slot;
+        }
+    }
+
+    return NULL;
+}
+
+static print_fragment *find_fragment(const BC_JSON_PrintCache * const cache, const BC_JSON * const item)
+{
+    fragment_entry *entry = find_fragment_entry(cache, item);
+
+    return (entry != NULL) ? entry->fragment : NULL;
+}
+
+/* Add the fragment of an item that has none yet. Fails without taking it if the table can't grow. */
+static BC_JSON_bool add_fragment(BC_JSON_PrintCache * const cache, const BC_JSON * const item, print_fragment * const fragment)
+{
+    size_t slot = 0;
+
+    /* keep the table at most half full */
+    if ((2 * (cache->count + 1)) > (cache->slot_mask + 1))
+    {
+        fragment_entry *old_slots = cache->slots;
+        size_t old_count = (old_slots != NULL) ? (cache->slot_mask + 1) : 0;
+        size_t new_count = (old_slots != NULL) ? (2 * old_count) : 64;
+        size_t index = 0;
+        if (old_count > ((size_t)-1 / 2 / sizeof(fragment_entry)))
+        {
+            return false; /* overflow */
+        }
+
+        cache->slots = (fragment_entry*)global_hooks.allocate(new_count * sizeof(fragment_entry));
+        if (cache->slots == NULL)
+        {
+            cache->slots = old_slots;
+            return false; /* allocation failure */
+        }
+        memset(cache->slots, '\0', new_count * sizeof(fragment_entry));
+        cache->slot_mask = new_count - 1;
+
+        for (index = 0; index < old_count; index++)
+        {
+            if (old_slots[index].item != NULL)
+            {
+                for (slot = fragment_slot(cache, old_slots[index].item); cache->slots[slot].item != NULL; slot = (slot + 1) & cache->slot_mask)
+                {
+                }
+                cache->slots[slot] = old_slots[index];
+            }
+        }
+        if (old_slots != NULL)
+        {
+            global_hooks.deallocate(old_slots);
+        }
+    }
+
+    for (slot = fragment_slot(cache, item); cache->slots[slot].item != NULL; slot = (slot + 1) & cache->slot_mask)
+    {
+    }
+    cache->slots[slot].item = item;
+    cache->slots[slot].fragment = fragment;
+    cache->count++;
+
+    return true;
+}
+
+/* Free all the text in a cache. */
+static void clear_print_cache(BC_JSON_PrintCache * const cache)
+{
+    size_t index = 0;
+
+    if (cache->slots == NULL)
+    {
+        return;
+    }
+
+    for (index = 0; index <= cache->slot_mask; index++)
+    {
+        if (cache->slots[index].item != NULL)
+        {
+            global_hooks.deallocate(cache->slots[index].fragment);
+        }
+    }
+    global_hooks.deallocate(cache->slots);
+    cache->slots = NULL;
+    cache->slot_mask = 0;
+    cache->count = 0;
+}
+
+/* The text a cache has for an item is out of date. Frozen items never have BC_JSON_IsPrinted, so
+ * they aren't written to. */
+static void mark_changed(BC_JSON * const item)
+{
+    if ((item != NULL) && (item->type & BC_JSON_IsPrinted))
+    {
+        item->type &= ~BC_JSON_IsPrinted;
+    }
+}
+
+/* The index of an array/object, in its index field: count elements in order, and for objects a
+ * table of slot_mask + 1 slots after them that maps the lower case hash of a key to 1 + the index of
+ * the member (0 for a free slot). BC_JSON_Freeze indexes every array/object. Objects parsed with a
+ * shape cache get an index without a table, their keys are looked up in the table of their shape.
+ * Changing the elements drops the index, and it is never shared with references or copies. Only
+ * the index of a frozen array/object is taken as it is, one that can still change is checked
+ * against the members before it is used. */
+typedef struct BC_JSON_Index
+{
+    size_t count;
+    size_t slot_mask; /* 0 if there is no table: for arrays, shaped objects and objects with members without key */
+} container_index;
+
+#define has_container_index(item) ((item)->index != NULL)
+#define is_frozen_container(item) (((item)->type & BC_JSON_IsFrozen) && has_container_index(item))
+#define container_index_of(item) ((item)->index)
+#define indexed_elements(index) ((BC_JSON**)(void*)((index) + 1))
+#define indexed_slots(index) ((size_t*)(void*)(indexed_elements(index) + (index)->count))
+
+/* Drop the index of an array/object whose elements changed, frozen ones can't change. */
+static void drop_container_index(BC_JSON * const item)
+{
+    if ((item != NULL) && has_container_index(item) && !(item->type & BC_JSON_IsFrozen))
+    {
+        global_hooks.deallocate(item->index);
+        item->index = NULL;
+    }
+}
+
+/* Changing a frozen document is a bug of the caller: it fails an assert in debug builds and is refused otherwise. */
+static BC_JSON_bool reject_frozen(const BC_JSON * const item)
+{
+    if ((item != NULL) && (item->type & BC_JSON_IsFrozen))
+    {
+        assert(!"a frozen BC_JSON document can't be changed");
+        return true;
+    }
+
+    return false;
+}
+
+/* The text of a BC_JSON_ParseFile parse: a mapping of the file, or the file read into memory. */
+typedef struct
+{
+    unsigned char *content;
+    size_t length;
+    BC_JSON_bool mapped; /* content is a mapping of the file, it was allocated with the hooks otherwise */
+} file_text;
+
+/* The root of a zero_copy BC_JSON_ParseFile document, with the text its strings point into. The node
+ * comes first, so the root is allocated, linked and deleted like any other node. */
+typedef struct
+{
+    BC_JSON item;
+    file_text text;
+} file_document;
+
+static void release_file_text(file_text * const text)
+{
+    if (text->content == NULL)
+    {
+        return;
+    }
+
+    if (!text->mapped)
+    {
+        global_hooks.deallocate(text->content);
+    }
+#if defined(CJSON_MMAP_POSIX)
+    else
+    {
+        munmap(text->content, text->length);
+    }
+#elif defined(CJSON_MMAP_WIN32)
+    else
+    {
+        UnmapViewOfFile(text->content);
+    }
+#endif
+    text->content = NULL;
+    text->length = 0;
+}
+
 /* Internal constructor. */
 static BC_JSON *BC_JSON_New_Item(const internal_hooks * const hooks)
 {
@@ -253,28 +527,95 @@ static BC_JSON *BC_JSON_New_Item(const internal_hooks * const hooks)
 CJSON_PUBLIC(void) BC_JSON_Delete(BC_JSON *item)
 {
     BC_JSON *next = NULL;
+    BC_JSON *child = NULL;
+
+    /* only the whole of a frozen document can be deleted */
+    if ((item != NULL) && (item->prev != NULL) && reject_frozen(item))
+    {
+        return;
+    }
+
     while (item != NULL)
     {
-        next = item->next;
         if (!(item->type & BC_JSON_IsReference) && (item->child != NULL))
         {
-            BC_JSON_Delete(item->child);
+            /* Rotate the first element in front of its array/object, the item becomes the successor
+             * of its first element and keeps the remaining ones. This flattens the tree as it is
+             * deleted, so neither recursion nor a stack is needed however deep it is nested. */
+            child = item->child;
+            item->child = child->next;
+            child->next = item;
+            item = child;
+            continue;
         }
+
+        next = item->next;
         if (!(item->type & BC_JSON_IsReference) && (item->value_string != NULL))
         {
             global_hooks.deallocate(item->value_string);
             item->value_string = NULL;
         }
+        if (has_container_index(item))
+        {
+            global_hooks.deallocate(item->index);
+            item->index = NULL;
+        }
         if (!(item->type & BC_JSON_StringIsConst) && (item->string != NULL))
         {
             global_hooks.deallocate(item->string);
             item->string = NULL;
         }
+        if (item->type & BC_JSON_OwnsFile)
+        {
+            release_file_text(&((file_document*)item)->text);
+        }
         global_hooks.deallocate(item);
         item = next;
     }
 }
 
+/* how many frames the walks over a tree keep on the call stack before they move to the heap */
+#define WALK_STACK_INLINE_FRAMES 32
+
+/* Double the capacity of the explicit stack of a walk over a tree. The first frames live in
+ * an array on the call stack (inline_frames), they are copied over when the stack first moves
+ * to the heap. Returns the new frames or NULL if the allocation failed, the old ones are
+ * still valid then. */
+static void *grow_walk_stack(void *frames, size_t *capacity, size_t frame_size, const void *inline_frames)
+{
+    void *grown = NULL;
+    size_t new_capacity = 0;
+
+    if (*capacity > ((size_t)-1 / 2 / frame_size))
+    {
+        return NULL;
+    }
+    new_capacity = *capacity * 2;
+
+    if ((frames != inline_frames) && (global_hooks.reallocate != NULL))
+    {
+        grown = global_hooks.reallocate(frames, new_capacity * frame_size);
+    }
+    else
+    {
+        grown = global_hooks.allocate(new_capacity * frame_size);
+        if (grown != NULL)
+        {
+            memcpy(grown, frames, *capacity * frame_size);
+            if (frames != inline_frames)
+            {
+                global_hooks.deallocate(frames);
+            }
+        }
+    }
+    if (grown != NULL)
+    {
+        *capacity = new_capacity;
+    }
+
+    return grown;
+}
+
 /* get the decimal point character of the current locale */
 static unsigned char get_decimal_point(void)
 {
@@ -286,6 +627,43 @@ static unsigned char get_decimal_point(void)
 #endif
 }
 
+/* A caller provided block that a parse carves all of its memory from.
+ * Nodes are taken from the front of the block, strings from the back. */
+typedef struct
+{
+    unsigned char *nodes; /* first free byte for nodes */
+    unsigned char *strings; /* one past the last free byte for strings */
+} parse_arena;
+
+/* how many string buffers of recycled nodes are kept around until a string needs them */
+#define PARSE_SPARE_STRINGS 8
+
+/* Nodes and string buffers of a previous document that a parse reuses before allocating. */
+typedef struct
+{
+    BC_JSON *items; /* free nodes, linked through next, in the order they were in the document */
+    unsigned char *spare_strings[PARSE_SPARE_STRINGS]; /* buffers of the last recycled nodes, oldest first */
+    size_t spare_sizes[PARSE_SPARE_STRINGS];
+    size_t spare_count;
+} parse_pool;
+
+/* Where a value starts and ends in the text of a parse, as offsets. */
+typedef struct
+{
+    const BC_JSON *item;
+    size_t start;
+    size_t end; /* while an array/object is still open: 1 + index of the one around it that is open, 0 for none */
+} recorded_span;
+
+/* The spans of the values of a parse, in the order they start in. */
+typedef struct
+{
+    recorded_span *spans;
+    size_t count;
+    size_t capacity;
+    size_t open; /* 1 + index of the innermost array/object that isn't closed yet, 0 for none */
+} span_list;
+
 typedef struct
 {
     const unsigned char *content;
@@ -293,6 +671,17 @@ typedef struct
     size_t offset;
     size_t depth; /* How deeply nested (in arrays/objects) is the input at the current offset. */
     internal_hooks hooks;
+    parse_arena *arena; /* if not NULL, all memory comes from this arena instead of the hooks */
+    parse_pool *pool; /* if not NULL, memory is taken from this pool before using the hooks */
+    BC_JSON_ShapeCache *shape_cache; /* if not NULL, object keys are matched against and interned in this cache */
+    size_t depth_limit; /* how deeply arrays/objects may be nested, 0 for CJSON_NESTING_LIMIT */
+    size_t raw_depth; /* arrays/objects nested this deeply are kept as raw text, 0 to parse them all */
+    BC_JSON_bool check_utf8; /* reject strings that aren't valid UTF-8 */
+    BC_JSON_bool strict; /* accept nothing beyond RFC 8259, only walk_value and what it calls take this into account */
+    unsigned char *in_situ; /* if not NULL, a writable alias of content: strings are unescaped in place and referenced */
+    BC_JSON_bool comments; /* skip // and block comments like whitespace */
+    BC_JSON_bool trailing_commas; /* accept a comma after the last element/member */
+    span_list *spans; /* if not NULL, the span of every value is recorded in it */
 } parse_buffer;
 
 /* check if the given size is left to read in a given parse buffer (starting with 1) */
@@ -302,101 +691,424 @@ typedef struct
 #define cannot_access_at_index(buffer, index) (!can_access_at_index(buffer, index))
 /* get a pointer to the buffer at the position */
 #define buffer_at_offset(buffer) ((buffer)->content + (buffer)->offset)
+/* the nesting depth a parse allows */
+#define nesting_limit(buffer) (((buffer)->depth_limit == 0) ? (size_t)CJSON_NESTING_LIMIT : (buffer)->depth_limit)
 
-/* Parse the input text to generate a number, and populate the result into item. */
-static BC_JSON_bool parse_number(BC_JSON * const item, parse_buffer * const input_buffer)
+/* allocate memory for strings and temporary buffers of a parse */
+static unsigned char *parse_allocate(parse_buffer * const input_buffer, size_t size)
 {
-    double number = 0;
-    unsigned char *after_end = NULL;
-    unsigned char *number_c_string;
-    unsigned char decimal_point = get_decimal_point();
-    size_t i = 0;
-    size_t number_string_length = 0;
-    BC_JSON_bool has_decimal_point = false;
+    parse_arena *arena = input_buffer->arena;
 
-    if ((input_buffer == NULL) || (input_buffer->content == NULL))
+    if ((arena == NULL) && (input_buffer->pool != NULL))
     {
-        return false;
+        parse_pool *pool = input_buffer->pool;
+        size_t index = 0;
+        for (index = 0; index < pool->spare_count; index++)
+        {
+            if (pool->spare_sizes[index] >= size)
+            {
+                unsigned char *spare = pool->spare_strings[index];
+                pool->spare_count--;
+                memmove(pool->spare_strings + index, pool->spare_strings + index + 1, (pool->spare_count - index) * sizeof(pool->spare_strings[0]));
+                memmove(pool->spare_sizes + index, pool->spare_sizes + index + 1, (pool->spare_count - index) * sizeof(pool->spare_sizes[0]));
+
+                return spare;
+            }
+        }
     }
 
-    /* copy the number into a temporary buffer and replace '.' with the decimal point
-     * of the current locale (for strtod)
-     * This also takes care of '\0' not necessarily being available for marking the end of the input */
-    for (i = 0; can_access_at_index(input_buffer, i); i++)
+    if (arena == NULL)
     {
-        switch (buffer_at_offset(input_buffer)[i])
-        {
-            case '0':
-            case '1':
-            case '2':
-            case '3':
-            case '4':
-            case '5':
-            case '6':
-            case '7':
-            case '8':
-            case '9':
-            case '+':
-            case '-':
-            case 'e':
-            case 'E':
-                number_string_length++;
-                break;
+        return (unsigned char*)input_buffer->hooks.allocate(size);
+    }
 
-            case '.':
-                number_string_length++;
-                has_decimal_point = true;
-                break;
+    if ((size_t)(arena->strings - arena->nodes) < size)
+    {
+        return NULL; /* the block is too small */
+    }
+    arena->strings -= size;
 
-            default:
-                goto loop_end;
-        }
+    return arena->strings;
+}
+
+/* release memory from parse_allocate, arena memory lives as long as the block */
+static void parse_deallocate(parse_buffer * const input_buffer, void *pointer)
+{
+    if (input_buffer->arena == NULL)
+    {
+        input_buffer->hooks.deallocate(pointer);
     }
-loop_end:
-    /* malloc for temporary buffer, add 1 for '\0' */
-    number_c_string = (unsigned char *) input_buffer->hooks.allocate(number_string_length + 1);
-    if (number_c_string == NULL)
+}
+
+/* remember the string buffer of a recycled node, making room by freeing the oldest one */
+static void pool_keep_string(parse_buffer * const input_buffer, unsigned char *string)
+{
+    parse_pool *pool = input_buffer->pool;
+
+    if (pool->spare_count == PARSE_SPARE_STRINGS)
     {
-        return false; /* allocation failure */
+        input_buffer->hooks.deallocate(pool->spare_strings[0]);
+        pool->spare_count--;
+        memmove(pool->spare_strings, pool->spare_strings + 1, pool->spare_count * sizeof(pool->spare_strings[0]));
+        memmove(pool->spare_sizes, pool->spare_sizes + 1, pool->spare_count * sizeof(pool->spare_sizes[0]));
     }
 
-    memcpy(number_c_string, buffer_at_offset(input_buffer), number_string_length);
-    number_c_string[number_string_length] = '\0';
+    pool->spare_strings[pool->spare_count] = string;
+    pool->spare_sizes[pool->spare_count] = strlen((const char*)string) + sizeof("");
+    pool->spare_count++;
+}
 
-    if (has_decimal_point)
+/* Record the span of a value, or the start of an array/object with end set to the one it is in. */
+static BC_JSON_bool record_span(parse_buffer * const input_buffer, const BC_JSON * const item, const size_t start, const size_t end)
+{
+    span_list *list = input_buffer->spans;
+
+    if (list->count == list->capacity)
     {
-        for (i = 0; i < number_string_length; i++)
+        recorded_span *grown = NULL;
+        size_t new_capacity = (list->capacity == 0) ? 64 : (list->capacity * 2);
+        if (new_capacity > ((size_t)-1 / sizeof(recorded_span)))
         {
-            if (number_c_string[i] == '.')
+            return false; /* overflow */
+        }
+
+        if ((list->spans != NULL) && (input_buffer->hooks.reallocate != NULL))
+        {
+            grown = (recorded_span*)input_buffer->hooks.reallocate(list->spans, new_capacity * sizeof(recorded_span));
+        }
+        else
+        {
+            grown = (recorded_span*)input_buffer->hooks.allocate(new_capacity * sizeof(recorded_span));
+            if ((grown != NULL) && (list->spans != NULL))
             {
-                /* replace '.' with the decimal point of the current locale (for strtod) */
-                number_c_string[i] = decimal_point;
+                memcpy(grown, list->spans, list->count * sizeof(recorded_span));
+                input_buffer->hooks.deallocate(list->spans);
             }
         }
+        if (grown == NULL)
+        {
+            return false; /* allocation failure */
+        }
+        list->spans = grown;
+        list->capacity = new_capacity;
     }
 
-    number = strtod((const char*)number_c_string, (char**)&after_end);
-    if (number_c_string == after_end)
-    {
-        /* free the temporary buffer */
-        input_buffer->hooks.deallocate(number_c_string);
-        return false; /* parse_error */
-    }
+    list->spans[list->count].item = item;
+    list->spans[list->count].start = start;
+    list->spans[list->count].end = end;
+    list->count++;
 
-    item->value_number = number;
+    return true;
+}
 
-    item->type = JSON_TYPE.NUMBER;
+/* the array/object at the offset is opened, its end is recorded by close_span */
+static BC_JSON_bool open_span(parse_buffer * const input_buffer, const BC_JSON * const item)
+{
+    if (!record_span(input_buffer, item, input_buffer->offset, input_buffer->spans->open))
+    {
+        return false;
+    }
+    input_buffer->spans->open = input_buffer->spans->count;
 
-    input_buffer->offset += (size_t)(after_end - number_c_string);
-    /* free the temporary buffer */
-    input_buffer->hooks.deallocate(number_c_string);
     return true;
 }
 
-/* don't ask me, but the original BC_JSON_SetNumberValue returns an integer or double */
-CJSON_PUBLIC(double) BC_JSON_SetNumberHelper(BC_JSON *object, double number)
+/* the innermost open array/object ends at the offset */
+static void close_span(parse_buffer * const input_buffer)
 {
-    return object->value_number = number;
+    recorded_span *span = input_buffer->spans->spans + (input_buffer->spans->open - 1);
+
+    input_buffer->spans->open = span->end;
+    span->end = input_buffer->offset;
+}
+
+/* allocate a node of the tree that is being parsed */
+static BC_JSON *parse_new_item(parse_buffer * const input_buffer)
+{
+    parse_arena *arena = input_buffer->arena;
+    BC_JSON *node = NULL;
+
+    if ((arena == NULL) && (input_buffer->pool != NULL) && (input_buffer->pool->items != NULL))
+    {
+        parse_pool *pool = input_buffer->pool;
+        node = pool->items;
+        pool->items = node->next;
+
+        /* the strings of a recycled node are most likely needed by the very next string of the parse */
+        if (node->string != NULL)
+        {
+            pool_keep_string(input_buffer, (unsigned char*)node->string);
+        }
+        if (node->value_string != NULL)
+        {
+            pool_keep_string(input_buffer, (unsigned char*)node->value_string);
+        }
+        memset(node, '\0', sizeof(BC_JSON));
+
+        return node;
+    }
+
+    if (arena == NULL)
+    {
+        return BC_JSON_New_Item(&(input_buffer->hooks));
+    }
+
+    if ((size_t)(arena->strings - arena->nodes) < sizeof(BC_JSON))
+    {
+        return NULL; /* the block is too small */
+    }
+    node = (BC_JSON*)(void*)arena->nodes;
+    arena->nodes += sizeof(BC_JSON);
+    memset(node, '\0', sizeof(BC_JSON));
+
+    return node;
+}
+
+/* free a partially parsed list of items after a parse failure */
+static void parse_delete(parse_buffer * const input_buffer, BC_JSON *item)
+{
+    if (input_buffer->arena == NULL)
+    {
+        BC_JSON_Delete(item);
+    }
+}
+
+/* numbers up to this length are converted without allocating a temporary buffer */
+#define NUMBER_STACK_BUFFER_LENGTH 64
+
+/* Convert the number at the current offset with strtod and advance past it.
+ * scratch_length is set to the size of the temporary buffer that had to be allocated, if any. */
+static BC_JSON_bool parse_number_value(parse_buffer * const input_buffer, double * const number, size_t * const scratch_length)
+{
+    unsigned char *after_end = NULL;
+    unsigned char number_stack_buffer[NUMBER_STACK_BUFFER_LENGTH];
+    unsigned char *number_c_string = number_stack_buffer;
+    unsigned char decimal_point = get_decimal_point();
+    size_t i = 0;
+    size_t number_string_length = 0;
+    BC_JSON_bool has_decimal_point = false;
+
+    *scratch_length = 0;
+    if ((input_buffer == NULL) || (input_buffer->content == NULL))
+    {
+        return false;
+    }
+
+    /* copy the number into a temporary buffer and replace '.' with the decimal point
+     * of the current locale (for strtod)
+     * This also takes care of '\0' not necessarily being available for marking the end of the input */
+    for (i = 0; can_access_at_index(input_buffer, i); i++)
+    {
+        switch (buffer_at_offset(input_buffer)[i])
+        {
+            case '0':
+            case '1':
+            case '2':
+            case '3':
+            case '4':
+            case '5':
+            case '6':
+            case '7':
+            case '8':
+            case '9':
+            case '+':
+            case '-':
+            case 'e':
+            case 'E':
+                number_string_length++;
+                break;
+
+            case '.':
+                number_string_length++;
+                has_decimal_point = true;
+                break;
+
+            default:
+                goto loop_end;
+        }
+    }
+loop_end:
+    if (number_string_length >= sizeof(number_stack_buffer))
+    {
+        /* malloc for temporary buffer, add 1 for '\0' */
+        *scratch_length = number_string_length + 1;
+        number_c_string = parse_allocate(input_buffer, *scratch_length);
+        if (number_c_string == NULL)
+        {
+            return false; /* allocation failure */
+        }
+    }
+
+    memcpy(number_c_string, buffer_at_offset(input_buffer), number_string_length);
+    number_c_string[number_string_length] = '\0';
+
+    if (has_decimal_point)
+    {
+        for (i = 0; i < number_string_length; i++)
+        {
+            if (number_c_string[i] == '.')
+            {
+                /* replace '.' with the decimal point of the current locale (for strtod) */
+                number_c_string[i] = decimal_point;
+            }
+        }
+    }
+
+    *number = strtod((const char*)number_c_string, (char**)&after_end);
+    input_buffer->offset += (size_t)(after_end - number_c_string);
+
+    if (number_c_string != number_stack_buffer)
+    {
+        /* free the temporary buffer */
+        parse_deallocate(input_buffer, number_c_string);
+    }
+
+    return (after_end != number_c_string);
+}
+
+/* Move past the number at the offset without converting it. It takes the same text that
+ * parse_number_value takes, the longest prefix of the number characters that strtod accepts, or
+ * in a strict parse exactly what the number grammar of RFC 8259 allows. */
+static BC_JSON_bool skip_number(parse_buffer * const input_buffer)
+{
+    size_t i = 0;
+    size_t exponent = 0;
+    size_t digits = 0;
+
+#define number_digit_at(index) (can_access_at_index(input_buffer, (index)) && (buffer_at_offset(input_buffer)[(index)] >= '0') && (buffer_at_offset(input_buffer)[(index)] <= '9'))
+#define number_character_at(index, character) (can_access_at_index(input_buffer, (index)) && (buffer_at_offset(input_buffer)[(index)] == (character)))
+
+    if (input_buffer->strict)
+    {
+        if (number_character_at(i, '-'))
+        {
+            i++;
+        }
+        /* no leading zeros */
+        if (number_character_at(i, '0'))
+        {
+            i++;
+        }
+        else if (number_digit_at(i))
+        {
+            while (number_digit_at(i))
+            {
+                i++;
+            }
+        }
+        else
+        {
+            return false;
+        }
+        /* fraction and exponent need digits */
+        if (number_character_at(i, '.'))
+        {
+            if (!number_digit_at(i + 1))
+            {
+                return false;
+            }
+            i++;
+            while (number_digit_at(i))
+            {
+                i++;
+            }
+        }
+        if (number_character_at(i, 'e') || number_character_at(i, 'E'))
+        {
+            i++;
+            if (number_character_at(i, '-') || number_character_at(i, '+'))
+            {
+                i++;
+            }
+            if (!number_digit_at(i))
+            {
+                return false;
+            }
+            while (number_digit_at(i))
+            {
+                i++;
+            }
+        }
+        input_buffer->offset += i;
+
+        return true;
+    }
+
+    if (number_character_at(i, '-') || number_character_at(i, '+'))
+    {
+        i++;
+    }
+    for (; number_digit_at(i); i++)
+    {
+        digits++;
+    }
+    if (number_character_at(i, '.'))
+    {
+        for (i++; number_digit_at(i); i++)
+        {
+            digits++;
+        }
+    }
+    if (digits == 0)
+    {
+        return false;
+    }
+
+    /* the exponent only counts if it has digits */
+    if (number_character_at(i, 'e') || number_character_at(i, 'E'))
+    {
+        exponent = i + 1;
+        if (number_character_at(exponent, '-') || number_character_at(exponent, '+'))
+        {
+            exponent++;
+        }
+        if (number_digit_at(exponent))
+        {
+            i = exponent;
+            while (number_digit_at(i))
+            {
+                i++;
+            }
+        }
+    }
+    input_buffer->offset += i;
+
+    return true;
+
+#undef number_character_at
+#undef number_digit_at
+}
+
+/* Parse the input text to generate a number, and populate the result into item. */
+static BC_JSON_bool parse_number(BC_JSON * const item, parse_buffer * const input_buffer)
+{
+    double number = 0;
+    size_t scratch_length = 0;
+
+    if (!parse_number_value(input_buffer, &number, &scratch_length))
+    {
+        return false; /* parse_error */
+    }
+
+    item->value_number = number;
+
+    item->type = JSON_TYPE.NUMBER;
+
+    return true;
+}
+
+/* don't ask me, but the original BC_JSON_SetNumberValue returns an integer or double */
+CJSON_PUBLIC(double) BC_JSON_SetNumberHelper(BC_JSON *object, double number)
+{
+    if (reject_frozen(object))
+    {
+        return object->value_number;
+    }
+
+    /* the number may need double precision now */
+    object->type &= ~BC_JSON_NumberIsFloat;
+    mark_changed(object);
+    return object->value_number = number;
 }
 
 /* Note: when passing a NULL value_string, BC_JSON_SetValuestring treats this as an error and return NULL */
@@ -410,6 +1122,10 @@ CJSON_PUBLIC(char*) BC_JSON_SetValuestring(BC_JSON *object, const char *value_st
     {
         return NULL;
     }
+    if (reject_frozen(object))
+    {
+        return NULL;
+    }
     /* return NULL if the object is corrupted or value_string is NULL */
     if (object->value_string == NULL || value_string == NULL)
     {
@@ -427,6 +1143,7 @@ CJSON_PUBLIC(char*) BC_JSON_SetValuestring(BC_JSON *object, const char *value_st
             return NULL;
         }
         strcpy(object->value_string, value_string);
+        mark_changed(object);
         return object->value_string;
     }
     copy = (char*) BC_JSON_strdup((const unsigned char*)value_string, &global_hooks);
@@ -439,10 +1156,23 @@ CJSON_PUBLIC(char*) BC_JSON_SetValuestring(BC_JSON *object, const char *value_st
         BC_JSON_free(object->value_string);
     }
     object->value_string = copy;
+    mark_changed(object);
 
     return copy;
 }
 
+/* The segments BC_JSON_PrintIoVec collects. A segment with iov_base NULL stands for the next
+ * iov_len bytes of the printbuffer, the others reference long strings of the item in place. */
+typedef struct
+{
+    BC_JSON_IoVec *segments;
+    size_t count;
+    size_t capacity;
+    const BC_JSON_IoVec *inline_segments;
+    size_t threshold; /* strings at least this long are referenced instead of copied */
+    size_t cut; /* the printbuffer text before this offset is covered by segments */
+} segment_list;
+
 typedef struct
 {
     unsigned char *buffer;
@@ -452,9 +1182,44 @@ typedef struct
     BC_JSON_bool noalloc;
     BC_JSON_bool format; /* is this print a formatted print */
     internal_hooks hooks;
+    BC_JSON_WriteFunction write; /* if not NULL, the printed text is handed to it whenever the buffer is full */
+    void *write_context;
+    segment_list *segments; /* if not NULL, long strings are referenced in a segment instead of printed */
 } printbuffer;
 
-/* realloc printbuffer if necessary to have at least "needed" bytes more */
+/* hand length bytes to the writer of a printbuffer, as many times as it takes */
+static BC_JSON_bool write_all(const printbuffer * const p, const unsigned char *data, size_t length)
+{
+    size_t written = 0;
+
+    while (length > 0)
+    {
+        written = p->write(p->write_context, (const char*)data, length);
+        if ((written == 0) || (written > length))
+        {
+            return false;
+        }
+        data += written;
+        length -= written;
+    }
+
+    return true;
+}
+
+/* hand the text printed so far to the writer and start over at the beginning of the buffer */
+static BC_JSON_bool flush_printbuffer(printbuffer * const p)
+{
+    if (!write_all(p, p->buffer, p->offset))
+    {
+        return false;
+    }
+    p->offset = 0;
+    p->buffer[0] = '\0';
+
+    return true;
+}
+
+/* realloc printbuffer if necessary to have room for "needed" more characters and a terminating zero */
 static unsigned char* ensure(printbuffer * const p, size_t needed)
 {
     unsigned char *newbuffer = NULL;
@@ -477,6 +1242,11 @@ static unsigned char* ensure(printbuffer * const p, size_t needed)
         return NULL;
     }
 
+    if ((p->write != NULL) && ((needed + p->offset + 1) > p->length) && !flush_printbuffer(p))
+    {
+        return NULL;
+    }
+
     needed += p->offset + 1;
     if (needed <= p->length)
     {
@@ -540,19 +1310,6 @@ static unsigned char* ensure(printbuffer * const p, size_t needed)
     return newbuffer + p->offset;
 }
 
-/* calculate the new length of the string in a printbuffer and update the offset */
-static void update_offset(printbuffer * const buffer)
-{
-    const unsigned char *buffer_pointer = NULL;
-    if ((buffer == NULL) || (buffer->buffer == NULL))
-    {
-        return;
-    }
-    buffer_pointer = buffer->buffer + buffer->offset;
-
-    buffer->offset += strlen((const char*)buffer_pointer);
-}
-
 /* securely comparison of floating-point variables */
 static BC_JSON_bool compare_double(double a, double b)
 {
@@ -560,26 +1317,1145 @@ static BC_JSON_bool compare_double(double a, double b)
     return (fabs(a - b) <= maxVal * DBL_EPSILON);
 }
 
-/* Render the number nicely from the given item into a string. */
-static BC_JSON_bool print_number(const BC_JSON * const item, printbuffer * const output_buffer)
+/* the longest number print_double writes: "-1.7976931348623157e+308" */
+#define NUMBER_MAX_LENGTH 24
+
+/* Shortest round trip printing needs an integer type with at least 64 bits,
+ * without one numbers are printed with sprintf. */
+#if (ULONG_MAX >> 31 >> 31) >= 3
+typedef unsigned long number_uint64;
+#define CJSON_SHORTEST_NUMBERS
+#elif defined(_MSC_VER)
+typedef unsigned __int64 number_uint64;
+#define CJSON_SHORTEST_NUMBERS
+#elif defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L)
+typedef unsigned long long number_uint64;
+#define CJSON_SHORTEST_NUMBERS
+#endif
+
+#ifdef CJSON_SHORTEST_NUMBERS
+/* The shortest digits that read back as the same number are found with the Ryu algorithm from
+ * "Ryu: Fast Float-to-String Conversion" by Ulf Adams. The interval of decimals that round to
+ * the number is scaled by a power of five from the tables below, then digits are removed while
+ * the interval still holds a shorter decimal. */
+
+#define POW5_INVERSE_BITCOUNT 125
+#define POW5_BITCOUNT 125
+
+/* floor(2^(pow5_bits(i) - 1 + POW5_INVERSE_BITCOUNT) / 5^i) + 1 as 32 bit words, most significant first */
+static const unsigned long pow5_inverse_split[342][4] =
 {
-    unsigned char *output_pointer = NULL;
-    double d = item->value_number;
-    int length = 0;
-    size_t i = 0;
-    unsigned char number_buffer[26] = {0}; /* temporary buffer to print the number into */
-    unsigned char decimal_point = get_decimal_point();
-    double test = 0.0;
+    { 0x20000000, 0x00000000, 0x00000000, 0x00000001 },
+    { 0x19999999, 0x99999999, 0x99999999, 0x9999999A },
+    { 0x147AE147, 0xAE147AE1, 0x47AE147A, 0xE147AE15 },
+    { 0x10624DD2, 0xF1A9FBE7, 0x6C8B4395, 0x810624DE },
+    { 0x1A36E2EB, 0x1C432CA5, 0x7A786C22, 0x6809D496 },
+    { 0x14F8B588, 0xE368F084, 0x61F9F01B, 0x866E43AB },
+    { 0x10C6F7A0, 0xB5ED8D36, 0xB4C7F349, 0x38583622 },
+    { 0x1AD7F29A, 0xBCAF4857, 0x87A6520E, 0xC08D236A },
+    { 0x15798EE2, 0x308C39DF, 0x9FB841A5, 0x66D74F88 },
+    { 0x112E0BE8, 0x26D694B2, 0xE62D0151, 0x1F12A607 },
+    { 0x1B7CDFD9, 0xD7BDBAB7, 0xD6AE6881, 0xCB5109A4 },
+    { 0x15FD7FE1, 0x7964955F, 0xDEF1ED34, 0xA2A73AEA },
+    { 0x11979981, 0x2DEA1119, 0x7F27F0F6, 0xE885C8BB },
+    { 0x1C25C268, 0x497681C2, 0x650CB4BE, 0x40D60DF8 },
+    { 0x16849B86, 0xA12B9B01, 0xEA709098, 0x33DE7193 },
+    { 0x1203AF9E, 0xE756159B, 0x21F3A6E0, 0x297EC143 },
+    { 0x1CD2B297, 0xD889BC2B, 0x6985D7CD, 0x0F313537 },
+    { 0x170EF546, 0x46D49689, 0x2137DFD7, 0x3F5A90F9 },
+    { 0x12725DD1, 0xD243ABA0, 0xE75FE645, 0xCC4873FA },
+    { 0x1D83C94F, 0xB6D2AC34, 0xA5663D3C, 0x7A0D865D },
+    { 0x179CA10C, 0x9242235D, 0x511E9763, 0x94D79EB1 },
+    { 0x12E3B40A, 0x0E9B4F7D, 0xDA7EDF82, 0xDD794BC1 },
+    { 0x1E392010, 0x175EE596, 0x2A6498D1, 0x625BAC68 },
+    { 0x182DB340, 0x12B25144, 0xEEB6E0A7, 0x81E2F053 },
+    { 0x1357C299, 0xA88EA76A, 0x58924D52, 0xCE4F26A9 },
+    { 0x1EF2D0F5, 0xDA7DD8AA, 0x27507BB7, 0xB07EA441 },
+    { 0x18C240C4, 0xAECB13BB, 0x52A6C95F, 0xC0655034 },
+    { 0x13CE9A36, 0xF23C0FC9, 0x0EEBD44C, 0x99EAA690 },
+    { 0x1FB0F6BE, 0x50601941, 0xB17953AD, 0xC3110A80 },
+    { 0x195A5EFE, 0xA6B34767, 0xC12DDC8B, 0x02740867 },
+    { 0x14484BFE, 0xEBC29F86, 0x3424B06F, 0x3529A052 },
+    { 0x1039D665, 0x89687F9E, 0x901D59F2, 0x90EE19DB },
+    { 0x19F623D5, 0xA8A73297, 0x4CFBC31D, 0xB4B0295F },
+    { 0x14C4E977, 0xBA1F5BAC, 0x3D9635B1, 0x5D59BAB2 },
+    { 0x109D8792, 0xFB4C4956, 0x97AB5E27, 0x7DE16228 },
+    { 0x1A95A5B7, 0xF87A0EF0, 0xF2ABC9D8, 0xC9689D0D },
+    { 0x15448493, 0x2D2E725A, 0x5BBCA17A, 0x3ABA173E },
+    { 0x11039D42, 0x8A8B8EAE, 0xAFCA1AC8, 0x2EFB45CB },
+    { 0x1B38FB9D, 0xAA78E44A, 0xB2DCF7A6, 0xB1920945 },
+    { 0x15C72FB1, 0x552D836E, 0xF57D92EB, 0xC141A104 },
+    { 0x116C2627, 0x77579C58, 0xC4647589, 0x6767B403 },
+    { 0x1BE03D0B, 0xF225C6F4, 0x6D6D88DB, 0xD8A5ECD2 },
+    { 0x164CFDA3, 0x281E38C3, 0x8ABE0716, 0x46EB23DB },
+    { 0x11D7314F, 0x534B609C, 0x6EFE6C11, 0xD255B649 },
+    { 0x1C8B8218, 0x85456760, 0xB197134F, 0xB6EF8A0E },
+    { 0x16D601AD, 0x376AB91A, 0x27AC0F72, 0xF8BFA1A5 },
+    { 0x1244CE24, 0x2C5560E1, 0xB95672C2, 0x60994E1E },
+    { 0x1D3AE36D, 0x13BBCE35, 0xF5571E03, 0xCDC21695 },
+    { 0x17624F8A, 0x762FD82B, 0x2AAC1803, 0x0B01ABAB },
+    { 0x12B50C6E, 0xC4F31355, 0xBBBCE002, 0x6F348956 },
+    { 0x1DEE7A4A, 0xD4B81EEF, 0x92C7CCD0, 0xB1EDA889 },
+    { 0x17F1FB6F, 0x10934BF2, 0xDBD30A40, 0x8E57BA07 },
+    { 0x1327FC58, 0xDA0F6FF5, 0x7CA8D500, 0x71DFC806 },
+    { 0x1EA6608E, 0x29B24CBB, 0xFAA7BB33, 0xE9660CD6 },
+    { 0x18851A0B, 0x548EA3C9, 0x9552FC29, 0x8784D711 },
+    { 0x139DAE6F, 0x76D88307, 0xAAA8C9BA, 0xD2D0AC0E },
+    { 0x1F62B0B2, 0x57C0D1A5, 0xDDDADC5E, 0x1E1AACE3 },
+    { 0x191BC08E, 0xAC9A4151, 0x7E48B04B, 0x4B488A4F },
+    { 0x141633A5, 0x56E1CDDA, 0xCB6D59D5, 0xD5D3A1D9 },
+    { 0x1011C2EA, 0xABE7D7E2, 0x3C577B11, 0x77DC817B },
+    { 0x19B604AA, 0xACA62636, 0xC6F25E82, 0x5960CF2A },
+    { 0x14919D55, 0x56EB51C5, 0x6BF51868, 0x4780A5BB },
+    { 0x10747DDD, 0xDF22A7D1, 0x232A79ED, 0x06008496 },
+    { 0x1A53FC96, 0x31D10C81, 0xD1DD8FE1, 0xA3340756 },
+    { 0x150FFD44, 0xF4A73D34, 0xA7E4731A, 0xE8F66C45 },
+    { 0x10D9976A, 0x5D52975D, 0x531D28E2, 0x53F8569E },
+    { 0x1AF5BF10, 0x9550F22E, 0xEB61DB03, 0xB98D5762 },
+    { 0x159165A6, 0xDDDA5B58, 0xBC4E48CF, 0xC7A445E8 },
+    { 0x11411E1F, 0x17E1E2AD, 0x6371D3D9, 0x6C836B20 },
+    { 0x1B9B6364, 0xF3030448, 0x9F1C8628, 0xAD9F11CD },
+    { 0x1615E91D, 0x8F359D06, 0xE5B06B53, 0xBE18DB0B },
+    { 0x11AB20E4, 0x72914A6B, 0xEAF3890F, 0xCB4715A2 },
+    { 0x1C45016D, 0x841BAA46, 0x44B8DB4C, 0x7871BC37 },
+    { 0x169D9ABE, 0x03495505, 0x03C715D6, 0xC6C1635F },
+    { 0x1217AEFE, 0x69077737, 0x3638DE45, 0x6BCDE919 },
+    { 0x1CF2B197, 0x0E725858, 0x56C163A2, 0x461641C1 },
+    { 0x17288E12, 0x71F51379, 0xDF011C81, 0xD1AB67CE },
+    { 0x1286D80E, 0xC190DC61, 0x7F3416CE, 0x4155ECA5 },
+    { 0x1DA48CE4, 0x68E7C702, 0x6520247D, 0x3556476E },
+    { 0x17B6D71D, 0x20B96C01, 0xEA801D30, 0xF7783925 },
+    { 0x12F8AC17, 0x4D612334, 0xBB99B0F3, 0xF92CFA84 },
+    { 0x1E5AACF2, 0x15683854, 0x5F5C4E53, 0x2847F739 },
+    { 0x18488A5B, 0x44536043, 0x7F7D0B75, 0xB9D32C2E },
+    { 0x136D3B7C, 0x36A919CF, 0x9930D5F7, 0xC7DC2358 },
+    { 0x1F152BF9, 0xF10E8FB2, 0x8EB4898C, 0x72F9D226 },
+    { 0x18DDBCC7, 0xF40BA628, 0x722A07A3, 0x8F2E41B8 },
+    { 0x13E49706, 0x5CD61E86, 0xC1BB394F, 0xA5BE9AFA },
+    { 0x1FD424D6, 0xFAF030D7, 0x9C5EC219, 0x0930F7F6 },
+    { 0x197683DF, 0x2F268D79, 0x49E56814, 0x075A5FF8 },
+    { 0x145ECFE5, 0xBF520AC7, 0x6E512010, 0x05E1E660 },
+    { 0x104BD984, 0x990E6F05, 0xF1DA800C, 0xD181851A },
+    { 0x1A12F5A0, 0xF4E3E4D6, 0x4FC40014, 0x8268D4F5 },
+    { 0x14DBF7B3, 0xF71CB711, 0xD96999AA, 0x01ED772B },
+    { 0x10AFF95C, 0xC5B09274, 0xADEE1488, 0x018AC5BC },
+    { 0x1AB32894, 0x6F80EA54, 0x497CEDA6, 0x68DE092C },
+    { 0x155C2076, 0xBF9A5510, 0x3ACA57B8, 0x53E4D424 },
+    { 0x1116805E, 0xFFAEAA73, 0x623B7960, 0x431D7683 },
+    { 0x1B5733CB, 0x32B110B8, 0x9D2BF566, 0xD1C8BD9E },
+    { 0x15DF5CA2, 0x8EF40D60, 0x7DBCC452, 0x416D647F },
+    { 0x117F7D4E, 0xD8C33DE6, 0xCAFD69DB, 0x678AB6CC },
+    { 0x1BFF2EE4, 0x8E052FD7, 0xAB2F0FC5, 0x72778ADF },
+    { 0x1665BF1D, 0x3E6A8CAC, 0x88F27304, 0x5B92D580 },
+    { 0x11EAFF4A, 0x98553D56, 0xD3F528D0, 0x49424466 },
+    { 0x1CAB3210, 0xF3BB9557, 0xB988414D, 0x4203A0A3 },
+    { 0x16EF5B40, 0xC2FC7779, 0x6139CDD7, 0x6802E6E9 },
+    { 0x125915CD, 0x68C9F92D, 0xE7617179, 0x20025254 },
+    { 0x1D5B5615, 0x74765B7C, 0xA568B58E, 0x999D5086 },
+    { 0x177C44DD, 0xF6C515FD, 0x5120913E, 0xE14AA6D2 },
+    { 0x12C9D0B1, 0x923744CA, 0xA74D40FF, 0x1AA21F0E },
+    { 0x1E0FB44F, 0x50586E11, 0x0BAECE64, 0xF769CB4A },
+    { 0x180C903F, 0x7379F1A7, 0x3C8BD850, 0xC5EE3C3B },
+    { 0x133D4032, 0xC2C7F485, 0xCA0979DA, 0x37F1C9C9 },
+    { 0x1EC866B7, 0x9E0CBA6F, 0xA9A8C2F6, 0xBFE942DB },
+    { 0x18A0522C, 0x7E709526, 0x2153CF2B, 0xCCBA9BE3 },
+    { 0x13B374F0, 0x6526DDB8, 0x1AA97289, 0x70954982 },
+    { 0x1F8587E7, 0x083E2F8C, 0xF775840F, 0x1A88759D },
+    { 0x19379FEC, 0x0698260A, 0x5F913672, 0x7BA05E17 },
+    { 0x142C7FF0, 0x054684D5, 0x1940F85B, 0x9619E4DF },
+    { 0x1023998C, 0xD1053710, 0xE100C6AF, 0xAB47EA4C },
+    { 0x19D28F47, 0xB4D524E7, 0xCE67A44C, 0x453FDD47 },
+    { 0x14A8729F, 0xC3DDB71F, 0xD852E9D6, 0x9DCCB106 },
+    { 0x1086C219, 0x697E2C19, 0x79DBEE45, 0x4B0A2738 },
+    { 0x1A71368F, 0x0F30468F, 0x295FE3A2, 0x11A9D859 },
+    { 0x15275ED8, 0xD8F36BA5, 0xBAB31C81, 0xA7BB137A },
+    { 0x10EC4BE0, 0xAD8F8951, 0x6228E39A, 0xEC95A92F },
+    { 0x1B13AC9A, 0xAF4C0EE8, 0x9D0E38F7, 0xE0EF7517 },
+    { 0x15A956E2, 0x25D67253, 0xB0D82D93, 0x1A592A79 },
+    { 0x11544581, 0xB7DEC1DC, 0x8D79BE0F, 0x4847552E },
+    { 0x1BBA08CF, 0x8C979C94, 0x158F967E, 0xDA0BBB7C },
+    { 0x162E6D72, 0xD6DFB076, 0x77A611FF, 0x14D62F97 },
+    { 0x11BEBDF5, 0x78B2F391, 0xF951A7FF, 0x43DE8C79 },
+    { 0x1C646322, 0x5AB7EC1C, 0xC21C3FFE, 0xD2FDAD8E },
+    { 0x16B6B5B5, 0x155FF017, 0x01B03332, 0x42648AD8 },
+    { 0x122BC490, 0xDDE659AC, 0x0159C28E, 0x9B83A246 },
+    { 0x1D12D41A, 0xFCA3C2AC, 0xCEF60417, 0x5F3903A3 },
+    { 0x17424348, 0xCA1C9BBD, 0x725E69AC, 0x4C2D9C83 },
+    { 0x129B6907, 0x0816E2FD, 0xF5185489, 0xD68AE39C },
+    { 0x1DC574D8, 0x0CF16B2F, 0xEE8D540F, 0xBDAB05C6 },
+    { 0x17D12A46, 0x70C1228C, 0xBED77672, 0xFE226B05 },
+    { 0x130DBB6B, 0x8D674ED6, 0xFF12C528, 0xCB4EBC04 },
+    { 0x1E7C5F12, 0x7BD87E24, 0xCB513B74, 0x787DF9A0 },
+    { 0x18637F41, 0xFCAD31B7, 0x090DC929, 0xF9FE614D },
+    { 0x1382CC34, 0xCA2427C5, 0xA0D7D421, 0x94CB810A },
+    { 0x1F37AD21, 0x436D0C6F, 0x67BFB9CF, 0x5478CE77 },
+    { 0x18F9574D, 0xCF8A7059, 0x1FCC94A5, 0xDD2D71F9 },
+    { 0x13FAAC3E, 0x3FA1F37A, 0x7FD6DD51, 0x7DBDF4C7 },
+    { 0x1FF779FD, 0x329CB8C3, 0xFFBE2EE8, 0xC92FEE0B },
+    { 0x1992C7FD, 0xC216FA36, 0x6631BF20, 0xA0F324D6 },
+    { 0x14756CCB, 0x01ABFB5E, 0xB827CC1A, 0x1A5C1D78 },
+    { 0x105DF0A2, 0x67BCC918, 0x935309AE, 0x7B7CE460 },
+    { 0x1A2FE76A, 0x3F9474F4, 0x1EEB42B0, 0xC594A099 },
+    { 0x14F31F88, 0x32DD2A5C, 0xE5890227, 0x0476E6E1 },
+    { 0x10C27FA0, 0x28B0EEB0, 0xB7A0CE85, 0x9D2BEBE7 },
+    { 0x1AD0CC33, 0x744E4AB4, 0x59014A6F, 0x61DFDFD8 },
+    { 0x1573D68F, 0x903EA229, 0xE0CDD525, 0xE7E64CAD },
+    { 0x11297872, 0xD9CBB4EE, 0x4D717751, 0x8651D6F1 },
+    { 0x1B758D84, 0x8FAC54B0, 0x7BE8BEE8, 0xD6E957E8 },
+    { 0x15F7A46A, 0x0C89DD59, 0xFCBA3253, 0xDF211320 },
+    { 0x1192E9EE, 0x706E4AAE, 0x63C82843, 0x18E74280 },
+    { 0x1C1E4317, 0x1A4A1117, 0x060D0D38, 0x27D86A66 },
+    { 0x167E9C12, 0x7B6E7412, 0x6B3DA42C, 0xECAD21EB },
+    { 0x11FEE341, 0xFC585CDB, 0x88FE1CF0, 0xBD574E56 },
+    { 0x1CCB0536, 0x608D615F, 0x419694B4, 0x62254A23 },
+    { 0x1708D0F8, 0x4D3DE77F, 0x67ABAA29, 0xE81DD4E9 },
+    { 0x126D73F9, 0xD764B932, 0xB95621BB, 0x2017DD87 },
+    { 0x1D7BECC2, 0xF23AC1EA, 0xC223692B, 0x668C95A5 },
+    { 0x17965702, 0x5B6234BB, 0xCE82BA89, 0x1ED6DE1D },
+    { 0x12DEAC01, 0xE2B4F6FC, 0xA5356207, 0x4BDF1818 },
+    { 0x1E311336, 0x3787F194, 0x3B889CD8, 0x7964F359 },
+    { 0x18274291, 0xC6065ADC, 0xFC6D4A46, 0xC783F5E1 },
+    { 0x13529BA7, 0xD19EAF17, 0x30576E9F, 0x06032B1A },
+    { 0x1EEA92A6, 0x1C311825, 0x1A257DCB, 0x3CD1DE90 },
+    { 0x18BBA884, 0xE35A79B7, 0x481DFE3C, 0x30A7E540 },
+    { 0x13C9539D, 0x82AEC7C5, 0xD34B31C9, 0xC0865100 },
+    { 0x1FA885C8, 0xD117A609, 0x5211E942, 0xCDA3B4CD },
+    { 0x19539E3A, 0x40DFB807, 0x74DB2102, 0x3E1C90A4 },
+    { 0x1442E4FB, 0x67196005, 0xF715B401, 0xCB4A0D50 },
+    { 0x103583FC, 0x527AB337, 0xF8DE299B, 0x09080AA7 },
+    { 0x19EF3993, 0xB72AB859, 0x8E304291, 0xA80CDDD7 },
+    { 0x14BF6142, 0xF8EEF9E1, 0x3E8D020E, 0x200A4B13 },
+    { 0x10991A9B, 0xFA58C7E7, 0x653D9B3E, 0x80083C0F },
+    { 0x1A8E90F9, 0x908E0CA5, 0x6EC8F864, 0x000D2CE4 },
+    { 0x153EDA61, 0x4071A3B7, 0x8BD3F9E9, 0x99A423EA },
+    { 0x10FF151A, 0x99F482F9, 0x3CA994BA, 0xE1501CBB },
+    { 0x1B31BB5D, 0xC320D18E, 0xC775BAC4, 0x9BB3612B },
+    { 0x15C162B1, 0x68E70E0B, 0xD2C4956A, 0x16291A89 },
+    { 0x11678227, 0x871F3E6F, 0xDBD07788, 0x11BA7BA1 },
+    { 0x1BD8D03F, 0x3E9863E6, 0x2C80BF40, 0x1C5D929B },
+    { 0x16470CFF, 0x6546B651, 0xBD33CC33, 0x49E47549 },
+    { 0x11D270CC, 0x51055EA7, 0xCA8FD68F, 0x6E505DD4 },
+    { 0x1C83E7AD, 0x4E6EFDD9, 0x4419574B, 0xE3B3C953 },
+    { 0x16CFEC8A, 0xA52597E1, 0x03477909, 0x82F63AA9 },
+    { 0x123FF06E, 0xEA847980, 0xCF6C60D4, 0x68C4FBBA },
+    { 0x1D331A4B, 0x10D3F59A, 0xE57A3487, 0x0E07F92A },
+    { 0x175C1508, 0xDA432AE2, 0x512E906C, 0x0B399422 },
+    { 0x12B010D3, 0xE1CF5581, 0xDA8BA6BC, 0xD5C7A9B5 },
+    { 0x1DE68153, 0x02E5559C, 0x90DF712E, 0x22D90F87 },
+    { 0x17EB9AA8, 0xCF1DDE16, 0xDA4C5A8B, 0x4F140C6C },
+    { 0x1322E220, 0xA5B17E78, 0xAEA37BA2, 0xA5A9A38A },
+    { 0x1E9E369A, 0xA2B59727, 0x7DD25F6A, 0xA2A905A9 },
+    { 0x187E9215, 0x4EF7AC1F, 0x97DB7F88, 0x8220D154 },
+    { 0x139874DD, 0xD8C6234C, 0x797C6606, 0xCE80A777 },
+    { 0x1F5A5496, 0x27A36BAD, 0x8F2D700A, 0xE4010BF1 },
+    { 0x19151078, 0x1FB5EFBE, 0x0C2459A2, 0x5000D65A },
+    { 0x1410D9F9, 0xB2F7F2FE, 0x701D1481, 0xD99A4515 },
+    { 0x100D7B2E, 0x28C65BFE, 0xC017439B, 0x147B6A77 },
+    { 0x19AF2B7D, 0x0E0A2CCA, 0xCCF205C4, 0xED9243F2 },
+    { 0x148C22CA, 0x71A1BD6F, 0x0A5B37D0, 0xBE0E9CC2 },
+    { 0x10701BD5, 0x27B4978C, 0x0848F973, 0xCB3EE3CE },
+    { 0x1A4CF955, 0x0C5425AC, 0xDA0E5BEC, 0x78649FB0 },
+    { 0x150A6110, 0xD6A9B7BD, 0x7B3EAFF0, 0x60507FC0 },
+    { 0x10D51A73, 0xDEEE2C97, 0x95CBBFF3, 0x80406633 },
+    { 0x1AEE90B9, 0x64B04758, 0xEFAC6652, 0x66CD7052 },
+    { 0x158BA6FA, 0xB6F36C47, 0x2623850E, 0xB8A459DB },
+    { 0x113C8595, 0x5F29236C, 0x1E82D0D8, 0x93B6AE49 },
+    { 0x1B9408EE, 0xFEA838AC, 0xFD9E1AF4, 0x1F8AB075 },
+    { 0x16100725, 0x988693BD, 0x97B1AF29, 0xB2D559F7 },
+    { 0x11A66C1E, 0x139EDC97, 0xAC8E25BA, 0xF5777B2C },
+    { 0x1C3D79C9, 0xB8FE2DBF, 0x7A7D092B, 0x2258C513 },
+    { 0x169794A1, 0x60CB57CC, 0x61FDA0EF, 0x4EAD6A76 },
+    { 0x1212DD4D, 0xE7091309, 0xE7FE1A59, 0x0BBDEEC5 },
+    { 0x1CEAFBAF, 0xD80E84DC, 0xA6635D5B, 0x45FCB13A },
+    { 0x172262F3, 0x133ED0B0, 0x851C4AAF, 0x6B308DC8 },
+    { 0x1281E8C2, 0x75CBDA26, 0xD0E36EF2, 0xBC26D7D4 },
+    { 0x1D9CA79D, 0x894629D7, 0xB49F17EA, 0xC6A48C86 },
+    { 0x17B08617, 0xA104EE46, 0x2A18DFEF, 0x0550706B },
+    { 0x12F39E79, 0x4D9D8B6B, 0x54E0B325, 0x9DD9F389 },
+    { 0x1E529728, 0x7C2F4578, 0x87CDEB6F, 0x62F65274 },
+    { 0x18421286, 0xC9BF6AC6, 0xD30B22BF, 0x825EA85D },
+    { 0x13680ED2, 0x3AFF889F, 0x0F3C1BCC, 0x684BB9E4 },
+    { 0x1F0CE483, 0x9198DA98, 0x18602C7A, 0x4079296D },
+    { 0x18D71D36, 0x0E13E213, 0x46B356C8, 0x33942124 },
+    { 0x13DF4A91, 0xA4DCB4DC, 0x388F78A0, 0x29434DB6 },
+    { 0x1FCBAA82, 0xA1612160, 0x5A7F2766, 0xA86BAF8A },
+    { 0x196FBB9B, 0xB44DB44D, 0x153285EB, 0xB9EFBFA2 },
+    { 0x145962E2, 0xF6A4903D, 0xAA8ED189, 0x618C994E },
+    { 0x1047824F, 0x2BB6D9CA, 0xEED8A7A1, 0x1AD6E10C },
+    { 0x1A0C03B1, 0xDF8AF611, 0x7E27729B, 0x5E249B45 },
+    { 0x14D6695B, 0x193BF80D, 0xFE85F549, 0x181D4904 },
+    { 0x10AB877C, 0x142FF9A4, 0xCB9E5DD4, 0x134AA0D0 },
+    { 0x1AAC0BF9, 0xB9E65C3A, 0xDF63C953, 0x5211014D },
+    { 0x15566FFA, 0xFB1EB02F, 0x191CA10F, 0x74DA6771 },
+    { 0x1111F32F, 0x2F4BC025, 0xADB080D9, 0x2A4852C1 },
+    { 0x1B4FEB7E, 0xB212CD09, 0x15E7348E, 0xAA0D5134 },
+    { 0x15D98932, 0x280F0A6D, 0xAB1F5D3E, 0xEE710DC4 },
+    { 0x117AD428, 0x200C0857, 0xBC191765, 0x8B8DA49D },
+    { 0x1BF7B9D9, 0xCCE00D59, 0x2CF4F23C, 0x127C3A94 },
+    { 0x165FC7E1, 0x70B33DE0, 0xF0C3F4FC, 0xDB969543 },
+    { 0x11E63981, 0x26F5CB1A, 0x5A365D97, 0x16121103 },
+    { 0x1CA38F35, 0x0B22DE90, 0x9056FC24, 0xF01CE804 },
+    { 0x16E93F5D, 0xA2824BA6, 0xD9DF301D, 0x8CE3ECD0 },
+    { 0x125432B1, 0x4ECEA2EB, 0xE17F59B1, 0x3D8323DA },
+    { 0x1D53844E, 0xE47DD179, 0x68CBC2B5, 0x2F38395C },
+    { 0x17760372, 0x5064A794, 0x53D6355D, 0xBF602DE3 },
+    { 0x12C4CF8E, 0xA6B6EC76, 0xA9782AB1, 0x65E68B1C },
+    { 0x1E07B27D, 0xD78B13F1, 0x0F26AAB5, 0x6FD744FA },
+    { 0x18062864, 0xAC6F4327, 0x3F52222A, 0xBFDF6A62 },
+    { 0x13382050, 0x89F29C1F, 0x65DB4E88, 0x997F884E },
+    { 0x1EC033B4, 0x0FEA9365, 0x6FC54A74, 0x28CC0D4A },
+    { 0x1899C2F6, 0x73220F84, 0x596AA1F6, 0x8709A43B },
+    { 0x13AE3591, 0xF5B4D936, 0xADEEE7F8, 0x6C07B696 },
+    { 0x1F7D2283, 0x22BAF524, 0x497E3FF3, 0xE00C5756 },
+    { 0x1930E868, 0xE89590E9, 0xD464FFF6, 0x4CD6AC45 },
+    { 0x14272053, 0xED4473EE, 0x4383FFF8, 0x3D7889D1 },
+    { 0x101F4D0F, 0xF1038FF1, 0xCF9CCCC6, 0x9793A174 },
+    { 0x19CBAE7F, 0xE805B31C, 0x7F6147A4, 0x25B90252 },
+    { 0x14A2F1FF, 0xECD15C16, 0xCC4DD2E9, 0xB7C7350F },
+    { 0x10825B33, 0x23DAB012, 0x3D0B0F21, 0x5FD290D9 },
+    { 0x1A6A2B85, 0x062AB350, 0x61AB4B68, 0x9950E7C1 },
+    { 0x1521BC6A, 0x6B555C40, 0x4E22A2BA, 0x1440B967 },
+    { 0x10E7C9EE, 0xBC4449CD, 0x0B4EE894, 0xDD009453 },
+    { 0x1B0C764A, 0xC6D3A948, 0x1217DA87, 0xC800ED51 },
+    { 0x15A391D5, 0x6BDC876C, 0xDB46486C, 0xA000BDDA },
+    { 0x114FA7DD, 0xEFE39F8A, 0x490506BD, 0x4CCD64AF },
+    { 0x1BB2A62F, 0xE638FF43, 0xA8080AC8, 0x7AE23AB1 },
+    { 0x162884F3, 0x1E93FF69, 0x5339A239, 0xFBE82EF4 },
+    { 0x11BA03F5, 0xB20FFF87, 0x75C7B4FB, 0x2FECF25D },
+    { 0x1C5CD322, 0xB67FFF3F, 0x22D92191, 0xE647EA2E },
+    { 0x16B0A8E8, 0x91FFFF65, 0xB57A8141, 0x850654F2 },
+    { 0x1226ED86, 0xDB3332B7, 0xC4620101, 0x373843F5 },
+    { 0x1D0B15A4, 0x91EB8459, 0x3A366801, 0xF1F39FEE },
+    { 0x173C1150, 0x74BC69E0, 0xFB5EB99B, 0x27F6198B },
+    { 0x12967440, 0x5D6387E7, 0x2F7EFAE2, 0x865E7AD6 },
+    { 0x1DBD86CD, 0x6238D971, 0xE597F7D0, 0xD6FD9156 },
+    { 0x17CAD23D, 0xE82D7AC1, 0x8479930D, 0x78CADAAB },
+    { 0x1308A831, 0x868AC89A, 0xD0614271, 0x2D6F1556 },
+    { 0x1E74404F, 0x3DAADA91, 0x4D686A4E, 0xAF182222 },
+    { 0x185D003F, 0x6488AEDA, 0xA453883E, 0xF279B4E8 },
+    { 0x137D99CC, 0x506D58AE, 0xE9DC6CFF, 0x28615D87 },
+    { 0x1F2F5C7A, 0x1A488DE4, 0xA960AE65, 0x0D6895A4 },
+    { 0x18F2B061, 0xAEA07183, 0xBAB3BEB7, 0x3DED4483 },
+    { 0x13F559E7, 0xBEE6C136, 0x2EF6322C, 0x318A9D36 },
+    { 0x1FEEF63F, 0x97D79B89, 0xE4BD1D13, 0x827761F0 },
+    { 0x198BF832, 0xDFDFAFA1, 0x83CA7DA9, 0x352C4E5A },
+    { 0x146FF9C2, 0x4CB2F2E7, 0x9CA1FE20, 0xF756A515 },
+    { 0x1059949B, 0x708F28B9, 0x4A1B31B3, 0xF9121DAA },
+    { 0x1A28EDC5, 0x80E50DF5, 0x435EB5EC, 0xC1B695DD },
+    { 0x14ED8B04, 0x671DA4C4, 0x35E55E57, 0x015EDE4A },
+    { 0x10BE08D0, 0x527E1D69, 0xC4B77EAC, 0x0118B1D5 },
+    { 0x1AC9A7B3, 0xB7302F0F, 0xA1259779, 0x9B5AB622 },
+    { 0x156E1FC2, 0xF8F358D9, 0x4DB7AC61, 0x49155E81 },
+    { 0x1124E635, 0x93F5E0AD, 0xD7C62381, 0x07444B9B },
+    { 0x1B6E3D22, 0x86563449, 0x593D059B, 0x3ED3AC2B },
+    { 0x15F1CA82, 0x0511C36D, 0xE0FD9E15, 0xCBDC89BC },
+    { 0x118E3B9B, 0x37416924, 0xB3FE1811, 0x6FE3A163 },
+    { 0x1C16C5C5, 0x25357507, 0x866359B5, 0x7FD29BD1 },
+    { 0x16789E37, 0x50F790D2, 0xD1E91491, 0x330EE30E },
+    { 0x11FA182C, 0x40C60D75, 0x74BA76DA, 0x8F3F1C0B },
+    { 0x1CC359E0, 0x67A348BB, 0xEDF72490, 0xE531C678 },
+    { 0x1702AE4D, 0x1FB5D3C9, 0x8B2C1D40, 0xB75B052D },
+    { 0x12688B70, 0xE62B0FD4, 0x6F567DCD, 0x5F7C0424 },
+    { 0x1D74124E, 0x3D11B2ED, 0x7EF0C948, 0x98C66D06 },
+    { 0x17900EA4, 0xFDA7C257, 0x98C0A106, 0xE09EBD9F },
+    { 0x12D9A550, 0xCAEC9B79, 0x470080D2, 0x4D4BCAE6 },
+    { 0x1E290881, 0x44ADC58E, 0xD800CE1D, 0x487944A2 },
+    { 0x1820D39A, 0x9D57D13F, 0x1333D817, 0x6D2DD082 },
+    { 0x134D7615, 0x4AACA765, 0xA8F64679, 0x2424A6CE },
+    { 0x1EE25688, 0x777AA56F, 0x74BD3D8E, 0xA03AA47D },
+    { 0x18B51206, 0xC5FBB78C, 0x5D64313E, 0xE6955064 },
+    { 0x13C40E6B, 0xD1962C70, 0x4AB68DCB, 0xEBAAA6B7 },
+    { 0x1FA01712, 0xE8F0471A, 0x11241613, 0x12AAA457 },
+    { 0x194CDF42, 0x53F36C14, 0xDA8344DC, 0x0EEEE9DF },
+    { 0x143D7F68, 0x43292343, 0xE2029D7C, 0xD8BF2180 },
+    { 0x103132B9, 0xCF541C36, 0x4E687DFD, 0x7A328133 },
+    { 0x19E85129, 0x4BB9C6BD, 0x4A40C995, 0x9050CEB8 },
+    { 0x14B9DA87, 0x6FC7D231, 0x0833D477, 0xA6A70BC6 },
+    { 0x1094AED2, 0xBFD30E8D, 0xA02976C6, 0x1EEC096B },
+    { 0x1A877E1D, 0xFFB81749, 0x004257A3, 0x64ACDBDF },
+    { 0x153931B1, 0x996012A0, 0xCD01DFB5, 0xEA23E319 },
+    { 0x10FA8E27, 0xADE6754D, 0x70CE4C91, 0x881CB5AE },
+    { 0x1B2A7D0C, 0x4970BBAF, 0x1AE3ADB5, 0xA69455E2 },
+    { 0x15BB973D, 0x078D62F2, 0x7BE957C4, 0x854377E8 },
+    { 0x1162DF64, 0x060AB58E, 0xC987796A, 0x0435F987 },
+    { 0x1BD1656C, 0xD67788E4, 0x75A58F10, 0x06BCC271 },
+    { 0x16411DF0, 0xAB92D3E9, 0xF7B7A5A6, 0x6BCA3527 },
+    { 0x11CDB18D, 0x560F0FEE, 0x5FC61E1E, 0xBCA1C41F },
+    { 0x1C7C4F48, 0x89B1B316, 0xFFA36364, 0x6102D365 },
+    { 0x16C9D906, 0xD48E28DF, 0x32E91C50, 0x4D9BDC51 },
+    { 0x123B1405, 0x76D820B2, 0x8F20E373, 0x71497D0E },
+    { 0x1D2B533B, 0xF159CDEA, 0x7E9B0585, 0x820F2E7C },
+    { 0x1755DC2F, 0xF447D7EE, 0xCBAF379E, 0x01A5BECA },
+    { 0x12AB168C, 0xC36CACBF, 0x0958F94B, 0x348498A1 }
+};
+
+/* 5^i scaled to POW5_BITCOUNT bits as 32 bit words, most significant first */
+static const unsigned long pow5_split[326][4] =
+{
+    { 0x10000000, 0x00000000, 0x00000000, 0x00000000 },
+    { 0x14000000, 0x00000000, 0x00000000, 0x00000000 },
+    { 0x19000000, 0x00000000, 0x00000000, 0x00000000 },
+    { 0x1F400000, 0x00000000, 0x00000000, 0x00000000 },
+    { 0x13880000, 0x00000000, 0x00000000, 0x00000000 },
+    { 0x186A0000, 0x00000000, 0x00000000, 0x00000000 },
+    { 0x1E848000, 0x00000000, 0x00000000, 0x00000000 },
+    { 0x1312D000, 0x00000000, 0x00000000, 0x00000000 },
+    { 0x17D78400, 0x00000000, 0x00000000, 0x00000000 },
+    { 0x1DCD6500, 0x00000000, 0x00000000, 0x00000000 },
+    { 0x12A05F20, 0x00000000, 0x00000000, 0x00000000 },
+    { 0x174876E8, 0x00000000, 0x00000000, 0x00000000 },
+    { 0x1D1A94A2, 0x00000000, 0x00000000, 0x00000000 },
+    { 0x12309CE5, 0x40000000, 0x00000000, 0x00000000 },
+    { 0x16BCC41E, 0x90000000, 0x00000000, 0x00000000 },
+    { 0x1C6BF526, 0x34000000, 0x00000000, 0x00000000 },
+    { 0x11C37937, 0xE0800000, 0x00000000, 0x00000000 },
+    { 0x16345785, 0xD8A00000, 0x00000000, 0x00000000 },
+    { 0x1BC16D67, 0x4EC80000, 0x00000000, 0x00000000 },
+    { 0x1158E460, 0x913D0000, 0x00000000, 0x00000000 },
+    { 0x15AF1D78, 0xB58C4000, 0x00000000, 0x00000000 },
+    { 0x1B1AE4D6, 0xE2EF5000, 0x00000000, 0x00000000 },
+    { 0x10F0CF06, 0x4DD59200, 0x00000000, 0x00000000 },
+    { 0x152D02C7, 0xE14AF680, 0x00000000, 0x00000000 },
+    { 0x1A784379, 0xD99DB420, 0x00000000, 0x00000000 },
+    { 0x108B2A2C, 0x28029094, 0x00000000, 0x00000000 },
+    { 0x14ADF4B7, 0x320334B9, 0x00000000, 0x00000000 },
+    { 0x19D971E4, 0xFE8401E7, 0x40000000, 0x00000000 },
+    { 0x1027E72F, 0x1F128130, 0x88000000, 0x00000000 },
+    { 0x1431E0FA, 0xE6D7217C, 0xAA000000, 0x00000000 },
+    { 0x193E5939, 0xA08CE9DB, 0xD4800000, 0x00000000 },
+    { 0x1F8DEF88, 0x08B02452, 0xC9A00000, 0x00000000 },
+    { 0x13B8B5B5, 0x056E16B3, 0xBE040000, 0x00000000 },
+    { 0x18A6E322, 0x46C99C60, 0xAD850000, 0x00000000 },
+    { 0x1ED09BEA, 0xD87C0378, 0xD8E64000, 0x00000000 },
+    { 0x13426172, 0xC74D822B, 0x878FE800, 0x00000000 },
+    { 0x1812F9CF, 0x7920E2B6, 0x6973E200, 0x00000000 },
+    { 0x1E17B843, 0x57691B64, 0x03D0DA80, 0x00000000 },
+    { 0x12CED32A, 0x16A1B11E, 0x82628890, 0x00000000 },
+    { 0x178287F4, 0x9C4A1D66, 0x22FB2AB4, 0x00000000 },
+    { 0x1D6329F1, 0xC35CA4BF, 0xABB9F561, 0x00000000 },
+    { 0x125DFA37, 0x1A19E6F7, 0xCB54395C, 0xA0000000 },
+    { 0x16F578C4, 0xE0A060B5, 0xBE2947B3, 0xC8000000 },
+    { 0x1CB2D6F6, 0x18C878E3, 0x2DB399A0, 0xBA000000 },
+    { 0x11EFC659, 0xCF7D4B8D, 0xFC904004, 0x74400000 },
+    { 0x166BB7F0, 0x435C9E71, 0x7BB45005, 0x91500000 },
+    { 0x1C06A5EC, 0x5433C60D, 0xDAA16406, 0xF5A40000 },
+    { 0x118427B3, 0xB4A05BC8, 0xA8A4DE84, 0x59868000 },
+    { 0x15E531A0, 0xA1C872BA, 0xD2CE1625, 0x6FE82000 },
+    { 0x1B5E7E08, 0xCA3A8F69, 0x87819BAE, 0xCBE22800 },
+    { 0x111B0EC5, 0x7E6499A1, 0xF4B1014D, 0x3F6D5900 },
+    { 0x1561D276, 0xDDFDC00A, 0x71DD41A0, 0x8F48AF40 },
+    { 0x1ABA4714, 0x957D300D, 0x0E549208, 0xB31ADB10 },
+    { 0x10B46C6C, 0xDD6E3E08, 0x28F4DB45, 0x6FF0C8EA },
+    { 0x14E18788, 0x14C9CD8A, 0x33321216, 0xCBECFB24 },
+    { 0x1A19E96A, 0x19FC40EC, 0xBFFE969C, 0x7EE839ED },
+    { 0x105031E2, 0x503DA893, 0xF7FF1E21, 0xCF512434 },
+    { 0x14643E5A, 0xE44D12B8, 0xF5FEE5AA, 0x43256D41 },
+    { 0x197D4DF1, 0x9D605767, 0x337E9F14, 0xD3EEC892 },
+    { 0x1FDCA16E, 0x04B86D41, 0x005E46DA, 0x08EA7AB6 },
+    { 0x13E9E4E4, 0xC2F34448, 0xA03AEC48, 0x45928CB2 },
+    { 0x18E45E1D, 0xF3B0155A, 0xC849A75A, 0x56F72FDE },
+    { 0x1F1D75A5, 0x709C1AB1, 0x7A5C1130, 0xECB4FBD6 },
+    { 0x13726987, 0x666190AE, 0xEC798ABE, 0x93F11D65 },
+    { 0x184F03E9, 0x3FF9F4DA, 0xA797ED6E, 0x38ED64BF },
+    { 0x1E62C4E3, 0x8FF87211, 0x517DE8C9, 0xC728BDEF },
+    { 0x12FDBB0E, 0x39FB474A, 0xD2EEB17E, 0x1C7976B5 },
+    { 0x17BD29D1, 0xC87A191D, 0x87AA5DDD, 0xA397D462 },
+    { 0x1DAC7446, 0x3A989F64, 0xE994F555, 0x0C7DC97B },
+    { 0x128BC8AB, 0xE49F639F, 0x11FD1955, 0x27CE9DED },
+    { 0x172EBAD6, 0xDDC73C86, 0xD67C5FAA, 0x71C24568 },
+    { 0x1CFA698C, 0x95390BA8, 0x8C1B7795, 0x0E32D6C2 },
+    { 0x121C81F7, 0xDD43A749, 0x57912ABD, 0x28DFC639 },
+    { 0x16A3A275, 0xD494911B, 0xAD75756C, 0x7317B7C8 },
+    { 0x1C4C8B13, 0x49B9B562, 0x98D2D2C7, 0x8FDDA5BA },
+    { 0x11AFD6EC, 0x0E14115D, 0x9F83C3BC, 0xB9EA8794 },
+    { 0x161BCCA7, 0x119915B5, 0x0764B4AB, 0xE8652979 },
+    { 0x1BA2BFD0, 0xD5FF5B22, 0x493DE1D6, 0xE27E73D7 },
+    { 0x1145B7E2, 0x85BF98F5, 0x6DC6AD26, 0x4D8F0866 },
+    { 0x159725DB, 0x272F7F32, 0xC938586F, 0xE0F2CA80 },
+    { 0x1AFCEF51, 0xF0FB5EFF, 0x7B866E8B, 0xD92F7D20 },
+    { 0x10DE1593, 0x369D1B5F, 0xAD340517, 0x67BDAE34 },
+    { 0x15159AF8, 0x04446237, 0x9881065D, 0x41AD19C1 },
+    { 0x1A5B01B6, 0x05557AC5, 0x7EA147F4, 0x92186032 },
+    { 0x1078E111, 0xC3556CBB, 0x6F24CCF8, 0xDB4F3C1F },
+    { 0x14971956, 0x342AC7EA, 0x4AEE0037, 0x12230B27 },
+    { 0x19BCDFAB, 0xC13579E4, 0xDDA98044, 0xD6ABCDF0 },
+    { 0x10160BCB, 0x58C16C2F, 0x0A89F02B, 0x062B60B6 },
+    { 0x141B8EBE, 0x2EF1C73A, 0xCD2C6C35, 0xC7B638E4 },
+    { 0x1922726D, 0xBAAE3909, 0x80778743, 0x39A3C71D },
+    { 0x1F6B0F09, 0x2959C74B, 0xE0956914, 0x080CB8E4 },
+    { 0x13A2E965, 0xB9D81C8F, 0x6C5D61AC, 0x8507F38E },
+    { 0x188BA3BF, 0x284E23B3, 0x4774BA17, 0xA649F072 },
+    { 0x1EAE8CAE, 0xF261ACA0, 0x1951E89D, 0x8FDC6C8F },
+    { 0x132D17ED, 0x577D0BE4, 0x0FD33162, 0x79E9C3D9 },
+    { 0x17F85DE8, 0xAD5C4EDD, 0x13C7FDBB, 0x186434CF },
+    { 0x1DF67562, 0xD8B36294, 0x58B9FD29, 0xDE7D4203 },
+    { 0x12BA095D, 0xC7701D9C, 0xB7743E3A, 0x2B0E4942 },
+    { 0x17688BB5, 0x394C2503, 0xE5514DC8, 0xB5D1DB92 },
+    { 0x1D42AEA2, 0x879F2E44, 0xDEA5A13A, 0xE3465277 },
+    { 0x1249AD25, 0x94C37CEB, 0x0B2784C4, 0xCE0BF38A },
+    { 0x16DC186E, 0xF9F45C25, 0xCDF165F6, 0x018EF06D },
+    { 0x1C931E8A, 0xB871732F, 0x416DBF73, 0x81F2AC88 },
+    { 0x11DBF316, 0xB346E7FD, 0x88E497A8, 0x3137ABD5 },
+    { 0x1652EFDC, 0x6018A1FC, 0xEB1DBD92, 0x3D8596CA },
+    { 0x1BE7ABD3, 0x781ECA7C, 0x25E52CF6, 0xCCE6FC7D },
+    { 0x1170CB64, 0x2B133E8D, 0x97AF3C1A, 0x40105DCE },
+    { 0x15CCFE3D, 0x35D80E30, 0xFD9B0B20, 0xD0147542 },
+    { 0x1B403DCC, 0x834E11BD, 0x3D01CDE9, 0x04199292 },
+    { 0x1108269F, 0xD210CB16, 0x462120B1, 0xA28FFB9B },
+    { 0x154A3047, 0xC694FDDB, 0xD7A968DE, 0x0B33FA82 },
+    { 0x1A9CBC59, 0xB83A3D52, 0xCD93C315, 0x8E00F923 },
+    { 0x10A1F5B8, 0x13246653, 0xC07C59ED, 0x78C09BB6 },
+    { 0x14CA7326, 0x17ED7FE8, 0xB09B7068, 0xD6F0C2A3 },
+    { 0x19FD0FEF, 0x9DE8DFE2, 0xDCC24C83, 0x0CACF34C },
+    { 0x103E29F5, 0xC2B18BED, 0xC9F96FD1, 0xE7EC180F },
+    { 0x144DB473, 0x335DEEE9, 0x3C77CBC6, 0x61E71E13 },
+    { 0x19612190, 0x00356AA3, 0x8B95BEB7, 0xFA60E598 },
+    { 0x1FB969F4, 0x0042C54C, 0x6E7B2E65, 0xF8F91EFE },
+    { 0x13D3E238, 0x8029BB4F, 0xC50CFCFF, 0xBB9BB35F },
+    { 0x18C8DAC6, 0xA0342A23, 0xB6503C3F, 0xAA82A037 },
+    { 0x1EFB1178, 0x484134AC, 0xA3E44B4F, 0x95234844 },
+    { 0x135CEAEB, 0x2D28C0EB, 0xE66EAF11, 0xBD360D2B },
+    { 0x183425A5, 0xF872F126, 0xE00A5AD6, 0x2C839075 },
+    { 0x1E412F0F, 0x768FAD70, 0x980CF18B, 0xB7A47493 },
+    { 0x12E8BD69, 0xAA19CC66, 0x5F0816F7, 0x52C6C8DC },
+    { 0x17A2ECC4, 0x14A03F7F, 0xF6CA1CB5, 0x27787B13 },
+    { 0x1D8BA7F5, 0x19C84F5F, 0xF47CA3E2, 0x715699D7 },
+    { 0x127748F9, 0x301D319B, 0xF8CDE66D, 0x86D62026 },
+    { 0x17151B37, 0x7C247E02, 0xF7016008, 0xE88BA830 },
+    { 0x1CDA6205, 0x5B2D9D83, 0xB4C1B80B, 0x22AE923C },
+    { 0x12087D43, 0x58FC8272, 0x50F91306, 0xF5AD1B65 },
+    { 0x168A9C94, 0x2F3BA30E, 0xE53757C8, 0xB318623F },
+    { 0x1C2D43B9, 0x3B0A8BD2, 0x9E852DBA, 0xDFDE7ACF },
+    { 0x119C4A53, 0xC4E69763, 0xA3133C94, 0xCBEB0CC1 },
+    { 0x16035CE8, 0xB6203D3C, 0x8BD80BB9, 0xFEE5CFF1 },
+    { 0x1B843422, 0xE3A84C8B, 0xAECE0EA8, 0x7E9F43EE },
+    { 0x1132A095, 0xCE492FD7, 0x4D40C929, 0x4F238A75 },
+    { 0x157F48BB, 0x41DB7BCD, 0x2090FB73, 0xA2EC6D12 },
+    { 0x1ADF1AEA, 0x12525AC0, 0x68B53A50, 0x8BA78856 },
+    { 0x10CB70D2, 0x4B7378B8, 0x41714472, 0x5748B536 },
+    { 0x14FE4D06, 0xDE5056E6, 0x51CD958E, 0xED1AE283 },
+    { 0x1A3DE048, 0x95E46C9F, 0xE640FAF2, 0xA8619B24 },
+    { 0x1066AC2D, 0x5DAEC3E3, 0xEFE89CD7, 0xA93D00F7 },
+    { 0x14805738, 0xB51A74DC, 0xEBE2C40D, 0x938C4134 },
+    { 0x19A06D06, 0xE2611214, 0x26DB7510, 0xF86F5181 },
+    { 0x10044424, 0x4D7CAB4C, 0x9849292A, 0x9B4592F1 },
+    { 0x1405552D, 0x60DBD61F, 0xBE5B7375, 0x4216F7AD },
+    { 0x1906AA78, 0xB912CBA7, 0xADF25052, 0x929CB598 },
+    { 0x1F485516, 0xE7577E91, 0x996EE467, 0x3743E2FF },
+    { 0x138D352E, 0x5096AF1A, 0xFFE54EC0, 0x828A6DDF },
+    { 0x18708279, 0xE4BC5AE1, 0xBFDEA270, 0xA32D0957 },
+    { 0x1E8CA318, 0x5DEB719A, 0x2FD64B0C, 0xCBF84BAD },
+    { 0x1317E5EF, 0x3AB32700, 0x5DE5EEE7, 0xFF7B2F4C },
+    { 0x17DDDF6B, 0x095FF0C0, 0x755F6AA1, 0xFF59FB1F },
+    { 0x1DD55745, 0xCBB7ECF0, 0x92B7454A, 0x7F3079E7 },
+    { 0x12A5568B, 0x9F52F416, 0x5BB28B4E, 0x8F7E4C30 },
+    { 0x174EAC2E, 0x8727B11B, 0xF29F2E22, 0x335DDF3C },
+    { 0x1D22573A, 0x28F19D62, 0xEF46F9AA, 0xC035570B },
+    { 0x12357684, 0x5997025D, 0xD58C5C0A, 0xB8215667 },
+    { 0x16C2D425, 0x6FFCC2F5, 0x4AEF730D, 0x6629AC01 },
+    { 0x1C73892E, 0xCBFBF3B2, 0x9DAB4FD0, 0xBFB41701 },
+    { 0x11C835BD, 0x3F7D784F, 0xA28B11E2, 0x77D08E60 },
+    { 0x163A432C, 0x8F5CD663, 0x8B2DD65B, 0x15C4B1F9 },
+    { 0x1BC8D3F7, 0xB3340BFC, 0x6DF94BF1, 0xDB35DE77 },
+    { 0x115D847A, 0xD000877D, 0xC4BBCF77, 0x2901AB0A },
+    { 0x15B4E599, 0x8400A95D, 0x35EAC354, 0xF34215CD },
+    { 0x1B221EFF, 0xE500D3B4, 0x8365742A, 0x30129B40 },
+    { 0x10F5535F, 0xEF208450, 0xD21F689A, 0x5E0BA108 },
+    { 0x1532A837, 0xEAE8A565, 0x06A742C0, 0xF58E894A },
+    { 0x1A7F5245, 0xE5A2CEBE, 0x48511371, 0x32F22B9D },
+    { 0x108F936B, 0xAF85C136, 0xED32AC26, 0xBFD75B42 },
+    { 0x14B37846, 0x9B673184, 0xA87F5730, 0x6FCD3212 },
+    { 0x19E05658, 0x4240FDE5, 0xD29F2CFC, 0x8BC07E97 },
+    { 0x102C35F7, 0x29689EAF, 0xA3A37C1D, 0xD7584F1E },
+    { 0x14374374, 0xF3C2C65B, 0x8C8C5B25, 0x4D2E62E6 },
+    { 0x19451452, 0x30B377F2, 0x6FAF71EE, 0xA079FB9F },
+    { 0x1F965966, 0xBCE055EF, 0x0B9B4E6A, 0x48987A87 },
+    { 0x13BDF7E0, 0x360C35B5, 0x67411102, 0x6D5F4C94 },
+    { 0x18AD75D8, 0x438F4322, 0xC1115543, 0x08B71FBA },
+    { 0x1ED8D34E, 0x547313EB, 0x7155AA93, 0xCAE4E7A8 },
+    { 0x13478410, 0xF4C7EC73, 0x26D58A9C, 0x5ECF10C9 },
+    { 0x18196515, 0x31F9E78F, 0xF08AED43, 0x7682D4FB },
+    { 0x1E1FBE5A, 0x7E786173, 0xECADA894, 0x54238A3A },
+    { 0x12D3D6F8, 0x8F0B3CE8, 0x73EC895C, 0xB4963664 },
+    { 0x1788CCB6, 0xB2CE0C22, 0x90E7ABB3, 0xE1BBC3FD },
+    { 0x1D6AFFE4, 0x5F818F2B, 0x352196A0, 0xDA2AB4FD },
+    { 0x1262DFEE, 0xBBB0F97B, 0x0134FE24, 0x885AB11E },
+    { 0x16FB97EA, 0x6A9D37D9, 0xC1823DAD, 0xAA715D65 },
+    { 0x1CBA7DE5, 0x054485D0, 0x31E2CD19, 0x150DB4BF },
+    { 0x11F48EAF, 0x234AD3A2, 0x1F2DC02F, 0xAD2890F7 },
+    { 0x1671B25A, 0xEC1D888A, 0xA6F9303B, 0x9872B535 },
+    { 0x1C0E1EF1, 0xA724EAAD, 0x50B77C4A, 0x7E8F6282 },
+    { 0x1188D357, 0x087712AC, 0x5272ADAE, 0x8F199D91 },
+    { 0x15EB082C, 0xCA94D757, 0x670F591A, 0x32E004F6 },
+    { 0x1B65CA37, 0xFD3A0D2D, 0x40D32F60, 0xBF980633 },
+    { 0x111F9E62, 0xFE44483C, 0x4883FD9C, 0x77BF03E0 },
+    { 0x156785FB, 0xBDD55A4B, 0x5AA4FD03, 0x95AEC4D8 },
+    { 0x1AC1677A, 0xAD4AB0DE, 0x314E3C44, 0x7B1A760E },
+    { 0x10B8E0AC, 0xAC4EAE8A, 0xDED0E5AA, 0xCCF089C9 },
+    { 0x14E718D7, 0xD7625A2D, 0x96851F15, 0x802CAC3B },
+    { 0x1A20DF0D, 0xCD3AF0B8, 0xFC2666DA, 0xE037D74A },
+    { 0x10548B68, 0xA044D673, 0x9D980048, 0xCC22E68E },
+    { 0x1469AE42, 0xC8560C10, 0x84FE005A, 0xFF2BA032 },
+    { 0x198419D3, 0x7A6B8F14, 0xA63D8071, 0xBEF6883E },
+    { 0x1FE52048, 0x590672D9, 0xCFCCE08E, 0x2EB42A4E },
+    { 0x13EF342D, 0x37A407C8, 0x21E00C58, 0xDD309A70 },
+    { 0x18EB0138, 0x858D09BA, 0x2A580F6F, 0x147CC10D },
+    { 0x1F25C186, 0xA6F04C28, 0xB4EE134A, 0xD99BF150 },
+    { 0x137798F4, 0x28562F99, 0x7114CC0E, 0xC80176D2 },
+    { 0x18557F31, 0x326BBB7F, 0xCD59FF12, 0x7A01D486 },
+    { 0x1E6ADEFD, 0x7F06AA5F, 0xC0B07ED7, 0x188249A8 },
+    { 0x1302CB5E, 0x6F642A7B, 0xD86E4F46, 0x6F516E09 },
+    { 0x17C37E36, 0x0B3D351A, 0xCE89E318, 0x0B25C98B },
+    { 0x1DB45DC3, 0x8E0C8261, 0x822C5BDE, 0x0DEF3BEE },
+    { 0x1290BA9A, 0x38C7D17C, 0xF15BB96A, 0xC8B58575 },
+    { 0x1734E940, 0xC6F9C5DC, 0x2DB2A7C5, 0x7AE2E6D2 },
+    { 0x1D022390, 0xF8B83753, 0x391F51B6, 0xD99BA086 },
+    { 0x1221563A, 0x9B732294, 0x03B39312, 0x48014454 },
+    { 0x16A9ABC9, 0x424FEB39, 0x04A077D6, 0xDA019569 },
+    { 0x1C5416BB, 0x92E3E607, 0x45C895CC, 0x9081FAC3 },
+    { 0x11B48E35, 0x3BCE6FC4, 0x8B9D5D9F, 0xDA513CBA },
+    { 0x1621B1C2, 0x8AC20BB5, 0xAE84B507, 0xD0E58BE8 },
+    { 0x1BAA1E33, 0x2D728EA3, 0x1A25E249, 0xC51EEEE3 },
+    { 0x114A52DF, 0xFC679925, 0xF057AD6E, 0x1B33554D },
+    { 0x159CE797, 0xFB817F6F, 0x6C6D98C9, 0xA2002AA1 },
+    { 0x1B04217D, 0xFA61DF4B, 0x4788FEFC, 0x0A803549 },
+    { 0x10E294EE, 0xBC7D2B8F, 0x0CB59F5D, 0x8690214E },
+    { 0x151B3A2A, 0x6B9C7672, 0xCFE30734, 0xE83429A1 },
+    { 0x1A6208B5, 0x0683940F, 0x83DBC902, 0x2241340A },
+    { 0x107D4571, 0x24123C89, 0xB2695DA1, 0x5568C086 },
+    { 0x149C96CD, 0x6D16CBAC, 0x1F03B509, 0xAAC2F0A7 },
+    { 0x19C3BC80, 0xC85C7E97, 0x26C4A24C, 0x1573ACD1 },
+    { 0x101A55D0, 0x7D39CF1E, 0x783AE56F, 0x8D684C03 },
+    { 0x1420EB44, 0x9C8842E6, 0x16499ECB, 0x70C25F03 },
+    { 0x19292615, 0xC3AA539F, 0x9BDC067E, 0x4CF2F6C4 },
+    { 0x1F736F9B, 0x3494E887, 0x82D3081D, 0xE02FB476 },
+    { 0x13A825C1, 0x00DD1154, 0xB1C3E512, 0xAC1DD0C9 },
+    { 0x18922F31, 0x411455A9, 0xDE34DE57, 0x572544FC },
+    { 0x1EB6BAFD, 0x91596B14, 0x55C215ED, 0x2CEE963B },
+    { 0x133234DE, 0x7AD7E2EC, 0xB5994DB4, 0x3C151DE5 },
+    { 0x17FEC216, 0x198DDBA7, 0xE2FFA121, 0x4B1A655E },
+    { 0x1DFE729B, 0x9FF15291, 0xDBBF8969, 0x9DE0FEB6 },
+    { 0x12BF07A1, 0x43F6D39B, 0x2957B5E2, 0x02AC9F31 },
+    { 0x176EC989, 0x94F48881, 0xF3ADA35A, 0x8357C6FE },
+    { 0x1D4A7BEB, 0xFA31AAA2, 0x70990C31, 0x242DB8BD },
+    { 0x124E8D73, 0x7C5F0AA5, 0x865FA79E, 0xB69C9376 },
+    { 0x16E230D0, 0x5B76CD4E, 0xE7F79186, 0x6443B854 },
+    { 0x1C9ABD04, 0x725480A2, 0xA1F575E7, 0xFD54A669 },
+    { 0x11E0B622, 0xC774D065, 0xA53969B0, 0xFE54E801 },
+    { 0x1658E3AB, 0x7952047F, 0x0E87C41D, 0x3DEA2202 },
+    { 0x1BEF1C96, 0x57A6859E, 0xD229B524, 0x8D64AA82 },
+    { 0x117571DD, 0xF6C81383, 0x435A1136, 0xD85EEA91 },
+    { 0x15D2CE55, 0x747A1864, 0x14309584, 0x8E76A536 },
+    { 0x1B4781EA, 0xD1989E7D, 0x193CBAE5, 0xB2144E83 },
+    { 0x110CB132, 0xC2FF630E, 0x2FC5F4CF, 0x8F4CB112 },
+    { 0x154FDD7F, 0x73BF3BD1, 0xBBB77203, 0x731FDD56 },
+    { 0x1AA3D4DF, 0x50AF0AC6, 0x2AA54E84, 0x4FE7D4AC },
+    { 0x10A6650B, 0x926D66BB, 0xDAA75112, 0xB1F0E4EB },
+    { 0x14CFFE4E, 0x7708C06A, 0xD1512557, 0x5E6D1E26 },
+    { 0x1A03FDE2, 0x14CAF085, 0x85A56EAD, 0x360865B0 },
+    { 0x10427EAD, 0x4CFED653, 0x7387652C, 0x41C53F8E },
+    { 0x14531E58, 0xA03E8BE8, 0x50693E77, 0x52368F71 },
+    { 0x1967E5EE, 0xC84E2EE2, 0x64838E15, 0x26C4334E },
+    { 0x1FC1DF6A, 0x7A61BA9A, 0xFDA4719A, 0x70754022 },
+    { 0x13D92BA2, 0x8C7D14A0, 0xDE86C700, 0x86494815 },
+    { 0x18CF768B, 0x2F9C59C9, 0x162878C0, 0xA7DB9A1A },
+    { 0x1F03542D, 0xFB83703B, 0x5BB296F0, 0xD1D280A1 },
+    { 0x1362149C, 0xBD322625, 0x194F9E56, 0x83239064 },
+    { 0x183A99C3, 0xEC7EAFAE, 0x5FA385EC, 0x23EC747E },
+    { 0x1E494034, 0xE79E5B99, 0xF78C6767, 0x2CE7919D },
+    { 0x12EDC821, 0x10C2F940, 0x3AB7C0A0, 0x7C10BB02 },
+    { 0x17A93A29, 0x54F3B790, 0x4965B0C8, 0x9B14E9C3 },
+    { 0x1D9388B3, 0xAA30A574, 0x5BBF1CFA, 0xC1DA2433 },
+    { 0x127C3570, 0x4A5E6768, 0xB957721C, 0xB92856A0 },
+    { 0x171B42CC, 0x5CF60142, 0xE7AD4EA3, 0xE7726C48 },
+    { 0x1CE2137F, 0x74338193, 0xA198A24C, 0xE14F075A },
+    { 0x120D4C2F, 0xA8A030FC, 0x44FF6570, 0x0CD16498 },
+    { 0x16909F3B, 0x92C83D3B, 0x563F3ECC, 0x1005BDBE },
+    { 0x1C34C70A, 0x777A4C8A, 0x2BCF0E7F, 0x14072D2E },
+    { 0x11A0FC66, 0x8AAC6FD6, 0x5B61690F, 0x6C847C3D },
+    { 0x16093B80, 0x2D578BCB, 0xF239C353, 0x47A59B4C },
+    { 0x1B8B8A60, 0x38AD6EBE, 0xEEC83428, 0x198F021F },
+    { 0x1137367C, 0x236C6537, 0x553D2099, 0x0FF96153 },
+    { 0x1585041B, 0x2C477E85, 0x2A8C68BF, 0x53F7B9A8 },
+    { 0x1AE64521, 0xF7595E26, 0x752F82EF, 0x28F5A812 },
+    { 0x10CFEB35, 0x3A97DAD8, 0x093DB1D5, 0x7999890B },
+    { 0x1503E602, 0x893DD18E, 0x0B8D1E4A, 0xD7FFEB4E },
+    { 0x1A44DF83, 0x2B8D45F1, 0x8E7065DD, 0x8DFFE622 },
+    { 0x106B0BB1, 0xFB384BB6, 0xF9063FAA, 0x78BFEFD5 },
+    { 0x1485CE9E, 0x7A065EA4, 0xB747CF95, 0x16EFEBCA },
+    { 0x19A74246, 0x1887F64D, 0xE519C37A, 0x5CABE6BD },
+    { 0x1008896B, 0xCF54F9F0, 0xAF301A2C, 0x79EB7036 },
+    { 0x140AABC6, 0xC32A386C, 0xDAFC20B7, 0x98664C43 },
+    { 0x190D56B8, 0x73F4C688, 0x11BB28E5, 0x7E7FDF54 },
+    { 0x1F50AC66, 0x90F1F82A, 0x1629F31E, 0xDE1FD72A },
+    { 0x13926BC0, 0x1A973B1A, 0x4DDA37F3, 0x4AD3E67A },
+    { 0x187706B0, 0x213D09E0, 0xE150C5F0, 0x1D88E019 },
+    { 0x1E94C85C, 0x298C4C59, 0x19A4F76C, 0x24EB181F },
+    { 0x131CFD39, 0x99F7AFB7, 0xB0071AA3, 0x9712EF13 },
+    { 0x17E43C88, 0x00759BA5, 0x9C08E14C, 0x7CD7AAD8 },
+    { 0x1DDD4BAA, 0x0093028F, 0x030B199F, 0x9C0D958E },
+    { 0x12AA4F4A, 0x405BE199, 0x61E6F003, 0xC1887D79 },
+    { 0x1754E31C, 0xD072D9FF, 0xBA60AC04, 0xB1EA9CD7 },
+    { 0x1D2A1BE4, 0x048F907F, 0xA8F8D705, 0xDE65440D },
+    { 0x123A516E, 0x82D9BA4F, 0xC99B8663, 0xAAFF4A88 },
+    { 0x16C8E5CA, 0x239028E3, 0xBC0267FC, 0x95BF1D2A },
+    { 0x1C7B1F3C, 0xAC74331C, 0xAB0301FB, 0xBB2EE474 },
+    { 0x11CCF385, 0xEBC89FF1, 0xEAE1E13D, 0x54FD4EC9 },
+    { 0x16403067, 0x66BAC7EE, 0x659A598C, 0xAA3CA27B },
+    { 0x1BD03C81, 0x406979E9, 0xFF00EFEF, 0xD4CBCB1A },
+    { 0x116225D0, 0xC841EC32, 0x3F6095F5, 0xE4FF5EF0 },
+    { 0x15BAAF44, 0xFA52673E, 0xCF38BB73, 0x5E3F36AC },
+    { 0x1B295B16, 0x38E7010E, 0x8306EA50, 0x35CF0457 },
+    { 0x10F9D8ED, 0xE39060A9, 0x11E45272, 0x21A162B6 },
+    { 0x15384F29, 0x5C7478D3, 0x565D670E, 0xAA09BB64 },
+    { 0x1A8662F3, 0xB3919708, 0x2BF4C0D2, 0x548C2A3D },
+    { 0x1093FDD8, 0x503AFE65, 0x1B78F883, 0x74D79A66 },
+    { 0x14B8FD4E, 0x6449BDFE, 0x625736A4, 0x520D8100 },
+    { 0x19E73CA1, 0xFD5C2D7D, 0xFAED044D, 0x6690E140 },
+    { 0x103085E5, 0x3E599C6E, 0xBCD422B0, 0x601A8CC8 },
+    { 0x143CA75E, 0x8DF0038A, 0x6C092B5C, 0x78212FFA },
+    { 0x194BD136, 0x316C046D, 0x070B7633, 0x96297BF8 },
+    { 0x1F9EC583, 0xBDC70588, 0x48CE53C0, 0x7BB3DAF6 },
+    { 0x13C33B72, 0x569C6375, 0x2D80F458, 0x4D5068DA },
+    { 0x18B40A4E, 0xEC437C52, 0x78E1316E, 0x60A48310 }
+};
+
+/* the number of bits of 5^e, for 0 <= e <= 3528 */
+#define pow5_bits(e) ((int)(((unsigned long)(e) * 1217359UL) >> 19) + 1)
+/* floor(log10(2^e)), for 0 <= e <= 1650 */
+#define log10_pow2(e) ((int)(((unsigned long)(e) * 78913UL) >> 18))
+/* floor(log10(5^e)), for 0 <= e <= 2620 */
+#define log10_pow5(e) ((int)(((unsigned long)(e) * 732923UL) >> 20))
+
+#if defined(__SIZEOF_INT128__)
+__extension__ typedef unsigned __int128 number_uint128;
+
+/* (m * multiplier) >> shift for a 128 bit multiplier from the tables, 64 < shift < 128 */
+static number_uint64 multiply_shift(const number_uint64 m, const unsigned long * const multiplier, const int shift)
+{
+    const number_uint128 multiplier_high = ((number_uint128)(multiplier[0] & 0xFFFFFFFFUL) << 32) | (multiplier[1] & 0xFFFFFFFFUL);
+    const number_uint128 multiplier_low = ((number_uint64)(multiplier[2] & 0xFFFFFFFFUL) << 32) | (multiplier[3] & 0xFFFFFFFFUL);
+    const number_uint128 low = (number_uint128)m * multiplier_low;
+    const number_uint128 high = ((number_uint128)m * multiplier_high) + (low >> 64);
 
-    if (output_buffer == NULL)
+    return (number_uint64)(high >> (shift - 64));
+}
+#else
+#define LOWER_32_BITS ((number_uint64)0xFFFFFFFFUL)
+
+/* the full 128 bit product of a and b, returns the lower 64 bits */
+static number_uint64 multiply_128(const number_uint64 a, const number_uint64 b, number_uint64 * const product_high)
+{
+    const number_uint64 a_low = a & LOWER_32_BITS;
+    const number_uint64 a_high = a >> 32;
+    const number_uint64 b_low = b & LOWER_32_BITS;
+    const number_uint64 b_high = b >> 32;
+    const number_uint64 low_low = a_low * b_low;
+    const number_uint64 middle1 = (a_high * b_low) + (low_low >> 32);
+    const number_uint64 middle2 = (a_low * b_high) + (middle1 & LOWER_32_BITS);
+
+    *product_high = (a_high * b_high) + (middle1 >> 32) + (middle2 >> 32);
+    return ((middle2 & LOWER_32_BITS) << 32) | (low_low & LOWER_32_BITS);
+}
+
+/* (m * multiplier) >> shift for a 128 bit multiplier from the tables, 64 < shift < 128 */
+static number_uint64 multiply_shift(const number_uint64 m, const unsigned long * const multiplier, const int shift)
+{
+    const number_uint64 multiplier_high = ((number_uint64)(multiplier[0] & 0xFFFFFFFFUL) << 32) | (multiplier[1] & 0xFFFFFFFFUL);
+    const number_uint64 multiplier_low = ((number_uint64)(multiplier[2] & 0xFFFFFFFFUL) << 32) | (multiplier[3] & 0xFFFFFFFFUL);
+    number_uint64 high1 = 0;
+    number_uint64 high0 = 0;
+    number_uint64 low1 = multiply_128(m, multiplier_high, &high1);
+    number_uint64 sum = 0;
+
+    multiply_128(m, multiplier_low, &high0);
+    sum = high0 + low1;
+    if (sum < high0)
     {
-        return false;
+        high1++;
     }
 
-    /* This checks for NaN and Infinity */
-    if (isnan(d) || isinf(d))
+    return (high1 << (128 - shift)) | (sum >> (shift - 64));
+}
+#endif
+
+/* is value divisible by 5^p */
+static BC_JSON_bool is_multiple_of_pow5(number_uint64 value, int p)
+{
+    while ((p > 0) && ((value % 5) == 0))
     {
-        length = sprintf((char*)number_buffer, "null");
+        value /= 5;
+        p--;
+    }
+
+    return p == 0;
+}
+
+/* Find the shortest decimal (closest to the number if there are several) that rounds to the
+ * number m2 * 2^e2, returns the decimal as output * 10^decimal_exponent. lower_is_half_way
+ * tells whether the next smaller number is as far away as the next larger one, which is not
+ * the case for a power of two whose predecessor is in the binade below. */
+static number_uint64 shortest_decimal(const number_uint64 m2, const int e2_unshifted, const BC_JSON_bool lower_is_half_way, int * const decimal_exponent)
+{
+    /* the interval is computed with 2 more bits, so its bounds are integers too */
+    const int e2 = e2_unshifted - 2;
+    const BC_JSON_bool accept_bounds = ((m2 & 1) == 0); /* ties round to even */
+    const number_uint64 mv = m2 << 2;
+    const number_uint64 mm_offset = lower_is_half_way ? 2 : 1;
+    number_uint64 vr = 0;
+    number_uint64 vp = 0;
+    number_uint64 vm = 0;
+    number_uint64 output = 0;
+    BC_JSON_bool vm_is_trailing_zeros = false;
+    BC_JSON_bool vr_is_trailing_zeros = false;
+    BC_JSON_bool round_up = false;
+    int last_removed_digit = 0;
+    int removed = 0;
+    int e10 = 0;
+    int q = 0;
+    int i = 0;
+
+    /* compute the decimal interval [vm, vp] of the number vr scaled by 10^-e10 */
+    if (e2 >= 0)
+    {
+        q = log10_pow2(e2) - ((e2 > 3) ? 1 : 0);
+        e10 = q;
+        i = -e2 + q + POW5_INVERSE_BITCOUNT + pow5_bits(q) - 1;
+        vr = multiply_shift(mv, pow5_inverse_split[q], i);
+        vp = multiply_shift(mv + 2, pow5_inverse_split[q], i);
+        vm = multiply_shift(mv - mm_offset, pow5_inverse_split[q], i);
+        if (q <= 21)
+        {
+            /* find out whether the removed digits are all zero, only one of mv, mv + 2 and
+             * mv - mm_offset can be a multiple of 5 */
+            if ((mv % 5) == 0)
+            {
+                vr_is_trailing_zeros = is_multiple_of_pow5(mv, q);
+            }
+            else if (accept_bounds)
+            {
+                vm_is_trailing_zeros = is_multiple_of_pow5(mv - mm_offset, q);
+            }
+            else if (is_multiple_of_pow5(mv + 2, q))
+            {
+                vp--;
+            }
+        }
+    }
+    else
+    {
+        q = log10_pow5(-e2) - ((-e2 > 1) ? 1 : 0);
+        e10 = q + e2;
+        i = -e2 - q;
+        vr = multiply_shift(mv, pow5_split[i], q - (pow5_bits(i) - POW5_BITCOUNT));
+        vp = multiply_shift(mv + 2, pow5_split[i], q - (pow5_bits(i) - POW5_BITCOUNT));
+        vm = multiply_shift(mv - mm_offset, pow5_split[i], q - (pow5_bits(i) - POW5_BITCOUNT));
+        if (q <= 1)
+        {
+            /* mv has at least 2 trailing zero bits, and so do mv + 2 and mv - mm_offset if it is even */
+            vr_is_trailing_zeros = true;
+            if (accept_bounds)
+            {
+                vm_is_trailing_zeros = lower_is_half_way;
+            }
+            else
+            {
+                vp--;
+            }
+        }
+        else if (q < 63)
+        {
+            vr_is_trailing_zeros = ((mv & (((number_uint64)1 << q) - 1)) == 0);
+        }
+    }
+
+    /* remove digits while the interval still holds a shorter decimal */
+    if (vm_is_trailing_zeros || vr_is_trailing_zeros)
+    {
+        /* rare: the bounds or the exact number may be exact decimals */
+        while ((vp / 10) > (vm / 10))
+        {
+            vm_is_trailing_zeros = vm_is_trailing_zeros && ((vm % 10) == 0);
+            vr_is_trailing_zeros = vr_is_trailing_zeros && (last_removed_digit == 0);
+            last_removed_digit = (int)(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        if (vm_is_trailing_zeros)
+        {
+            while ((vm % 10) == 0)
+            {
+                vr_is_trailing_zeros = vr_is_trailing_zeros && (last_removed_digit == 0);
+                last_removed_digit = (int)(vr % 10);
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                removed++;
+            }
+        }
+        if (vr_is_trailing_zeros && (last_removed_digit == 5) && ((vr % 2) == 0))
+        {
+            /* exactly half way, round to even */
+            last_removed_digit = 4;
+        }
+        output = vr + ((((vr == vm) && (!accept_bounds || !vm_is_trailing_zeros)) || (last_removed_digit >= 5)) ? 1 : 0);
+    }
+    else
+    {
+        if ((vp / 100) > (vm / 100))
+        {
+            round_up = ((vr % 100) >= 50);
+            vr /= 100;
+            vp /= 100;
+            vm /= 100;
+            removed += 2;
+        }
+        while ((vp / 10) > (vm / 10))
+        {
+            round_up = ((vr % 10) >= 5);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        output = vr + (((vr == vm) || round_up) ? 1 : 0);
+    }
+
+    *decimal_exponent = e10 + removed;
+    return output;
+}
+
+/* The shortest decimal of a positive finite number, the number is decimal * 10^decimal_exponent.
+ * With single_precision the decimal reads back as the same float instead, the number has to be
+ * a float then. */
+static number_uint64 shortest_decimal_of(const double number, const BC_JSON_bool single_precision, int * const decimal_exponent)
+{
+    const int precision = single_precision ? FLT_MANT_DIG : DBL_MANT_DIG;
+    const int min_exponent = single_precision ? (FLT_MIN_EXP - FLT_MANT_DIG) : (DBL_MIN_EXP - DBL_MANT_DIG);
+    int exponent = 0;
+    const double mantissa = frexp(number, &exponent);
+    number_uint64 m2 = 0;
+
+    /* number = m2 * 2^exponent with an integer m2 of precision bits at most */
+    if ((exponent - precision) < min_exponent)
+    {
+        /* subnormal */
+        m2 = (number_uint64)ldexp(number, -min_exponent);
+        exponent = min_exponent;
+    }
+    else
+    {
+        m2 = (number_uint64)ldexp(mantissa, precision);
+        exponent -= precision;
+    }
+
+    return shortest_decimal(m2, exponent, (m2 != ((number_uint64)1 << (precision - 1))) || (exponent == min_exponent), decimal_exponent);
+}
+
+/* the number of decimal digits of value */
+static int decimal_length(number_uint64 value)
+{
+    int length = 1;
+
+    while (value >= 10000)
+    {
+        value /= 10000;
+        length += 4;
+    }
+    if (value >= 100)
+    {
+        value /= 100;
+        length += 2;
+    }
+
+    return length + ((value >= 10) ? 1 : 0);
+}
+
+/* Write the decimal digits of value so that the last one is right before end. */
+static void write_digits(unsigned char *end, number_uint64 value)
+{
+    static const char digit_pairs[] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+    size_t pair = 0;
+
+    while (value >= 100)
+    {
+        pair = (size_t)(value % 100) * 2;
+        value /= 100;
+        *--end = (unsigned char)digit_pairs[pair + 1];
+        *--end = (unsigned char)digit_pairs[pair];
+    }
+    if (value >= 10)
+    {
+        pair = (size_t)value * 2;
+        *--end = (unsigned char)digit_pairs[pair + 1];
+        *--end = (unsigned char)digit_pairs[pair];
+    }
+    else
+    {
+        *--end = (unsigned char)('0' + value);
+    }
+}
+
+/* Print a finite number with the shortest digits that read back as the same number
+ * (as the same float if single_precision is set), laid out the way printf's %g does it.
+ * Returns the length of the output, with output NULL only the length is computed. */
+static size_t print_double(double d, const BC_JSON_bool single_precision, unsigned char * const output)
+{
+    static const double negative_zero = -0.0;
+    unsigned char *output_pointer = output;
+    number_uint64 decimal = 0;
+    size_t sign = 0;
+    int decimal_exponent = 0;
+    int exponent = 0;
+    int length = 0;
+    int i = 0;
+
+    if ((d < 0) || ((d == 0) && (memcmp(&d, &negative_zero, sizeof(d)) == 0)))
+    {
+        sign = 1;
+        d = -d;
+    }
+
+    if ((d == floor(d)) && (d < 1e15))
+    {
+        /* integers are exact with 15 digits */
+        decimal = (number_uint64)d;
+        length = decimal_length(decimal);
+        if (output != NULL)
+        {
+            if (sign != 0)
+            {
+                *output_pointer++ = '-';
+            }
+            write_digits(output_pointer + length, decimal);
+        }
+
+        return sign + (size_t)length;
+    }
+
+    decimal = shortest_decimal_of(d, single_precision, &decimal_exponent);
+    length = decimal_length(decimal);
+
+    /* d = 0.digits * 10^exponent */
+    exponent = length + decimal_exponent;
+    /* printf would need 15 or 17 digits of precision to print the digits */
+    if ((exponent < -3) || (exponent > ((length > 15) ? 17 : 15)))
+    {
+        /* d.igitse+xx */
+        exponent--;
+        if (output == NULL)
+        {
+            return sign + (size_t)length + ((length > 1) ? 1 : 0) + static_strlen("e+") + ((abs(exponent) >= 100) ? 3 : 2);
+        }
+        if (sign != 0)
+        {
+            *output_pointer++ = '-';
+        }
+        /* the digits go after the first one, which is moved in front of the decimal point */
+        write_digits(output_pointer + 1 + length, decimal);
+        output_pointer[0] = output_pointer[1];
+        output_pointer += 1;
+        if (length > 1)
+        {
+            output_pointer[0] = '.';
+            output_pointer += length;
+        }
+        *output_pointer++ = 'e';
+        *output_pointer++ = (exponent < 0) ? '-' : '+';
+        if (exponent < 0)
+        {
+            exponent = -exponent;
+        }
+        if (exponent >= 100)
+        {
+            *output_pointer++ = (unsigned char)('0' + (exponent / 100));
+            exponent %= 100;
+        }
+        *output_pointer++ = (unsigned char)('0' + (exponent / 10));
+        *output_pointer++ = (unsigned char)('0' + (exponent % 10));
+    }
+    else if (exponent <= 0)
+    {
+        /* 0.000digits */
+        if (output == NULL)
+        {
+            return sign + static_strlen("0.") + (size_t)(length - exponent);
+        }
+        if (sign != 0)
+        {
+            *output_pointer++ = '-';
+        }
+        *output_pointer++ = '0';
+        *output_pointer++ = '.';
+        for (i = exponent; i < 0; i++)
+        {
+            *output_pointer++ = '0';
+        }
+        output_pointer += length;
+        write_digits(output_pointer, decimal);
+    }
+    else if (exponent >= length)
+    {
+        /* digits000 */
+        if (output == NULL)
+        {
+            return sign + (size_t)exponent;
+        }
+        if (sign != 0)
+        {
+            *output_pointer++ = '-';
+        }
+        write_digits(output_pointer + length, decimal);
+        output_pointer += length;
+        for (i = length; i < exponent; i++)
+        {
+            *output_pointer++ = '0';
+        }
+    }
+    else
+    {
+        /* dig.its */
+        if (output == NULL)
+        {
+            return sign + (size_t)length + static_strlen(".");
+        }
+        if (sign != 0)
+        {
+            *output_pointer++ = '-';
+        }
+        /* the integer digits are moved in front of the decimal point */
+        write_digits(output_pointer + 1 + length, decimal);
+        memmove(output_pointer, output_pointer + 1, (size_t)exponent);
+        output_pointer[exponent] = '.';
+        output_pointer += length + 1;
+    }
+
+    return (size_t)(output_pointer - output);
+}
+#else
+/* Print a finite number with sprintf, using as few digits as read back as the same number
+ * (as the same float if single_precision is set). Returns the length of the output, 0 on failure. */
+static size_t print_double(const double d, const BC_JSON_bool single_precision, unsigned char * const output)
+{
+    unsigned char number_buffer[26] = {0}; /* temporary buffer to print the number into */
+    unsigned char decimal_point = get_decimal_point();
+    double test = 0.0;
+    int length = 0;
+    int i = 0;
+
+    if (single_precision)
+    {
+        /* 6 decimal places are always significant for floats, 9 recover every float */
+        length = sprintf((char*)number_buffer, "%1.6g", d);
+        if ((sscanf((char*)number_buffer, "%lg", &test) != 1) || ((float)test != (float)d))
+        {
+            length = sprintf((char*)number_buffer, "%1.9g", d);
+        }
     }
     else
     {
@@ -595,33 +2471,82 @@ static BC_JSON_bool print_number(const BC_JSON * const item, printbuffer * const
     }
 
     /* sprintf failed or buffer overrun occurred */
-    if ((length < 0) || (length > (int)(sizeof(number_buffer) - 1)))
+    if ((length < 0) || (length > NUMBER_MAX_LENGTH))
     {
-        return false;
+        return 0;
     }
 
-    /* reserve appropriate space in the output */
-    output_pointer = ensure(output_buffer, (size_t)length + sizeof(""));
-    if (output_pointer == NULL)
+    if (output == NULL)
     {
-        return false;
+        return (size_t)length;
     }
 
     /* copy the printed number to the output and replace locale
      * dependent decimal point with '.' */
-    for (i = 0; i < ((size_t)length); i++)
+    for (i = 0; i < length; i++)
+    {
+        output[i] = (number_buffer[i] == decimal_point) ? '.' : number_buffer[i];
+    }
+
+    return (size_t)length;
+}
+#endif
+
+/* Write the text of the number in item to output, which needs room for NUMBER_MAX_LENGTH
+ * characters. Returns the length of the text, 0 on failure. With output NULL only the length
+ * is computed. */
+static size_t format_number(const BC_JSON * const item, unsigned char * const output)
+{
+    double d = item->value_number;
+    BC_JSON_bool single_precision = false;
+
+    /* This checks for NaN and Infinity */
+    if (isnan(d) || isinf(d))
     {
-        if (number_buffer[i] == decimal_point)
+        if (output != NULL)
         {
-            output_pointer[i] = '.';
-            continue;
+            memcpy(output, "null", static_strlen("null"));
         }
+        return static_strlen("null");
+    }
 
-        output_pointer[i] = number_buffer[i];
+    /* numbers that came from floats are printed as floats, unless they were changed since */
+    if ((item->type & BC_JSON_NumberIsFloat) && (fabs(d) <= (double)FLT_MAX) && ((double)(float)d == d))
+    {
+        single_precision = true;
+    }
+
+    return print_double(d, single_precision, output);
+}
+
+/* Render the number nicely from the given item into a string. */
+static BC_JSON_bool print_number(const BC_JSON * const item, printbuffer * const output_buffer)
+{
+    unsigned char number_buffer[NUMBER_MAX_LENGTH];
+    unsigned char *output_pointer = NULL;
+    size_t length = 0;
+
+    if (output_buffer == NULL)
+    {
+        return false;
+    }
+
+    /* format first, so no more than the actual length has to be reserved */
+    length = format_number(item, number_buffer);
+    if (length == 0)
+    {
+        return false;
+    }
+
+    output_pointer = ensure(output_buffer, length);
+    if (output_pointer == NULL)
+    {
+        return false;
     }
-    output_pointer[i] = '\0';
+    memcpy(output_pointer, number_buffer, length);
+    output_pointer[length] = '\0';
 
-    output_buffer->offset += (size_t)length;
+    output_buffer->offset += length;
 
     return true;
 }
@@ -784,66 +2709,343 @@ fail:
     return 0;
 }
 
-/* Parse the input text into an unescaped cinput, and populate item. */
-static BC_JSON_bool parse_string(BC_JSON * const item, parse_buffer * const input_buffer)
+/* Calculate the exact length of the unescaped form of [*input, input_end), fails on invalid escape
+ * sequences just like parse_string does and leaves *input at the invalid one then. */
+static BC_JSON_bool unescaped_string_length(const unsigned char ** const input, const unsigned char * const input_end, size_t * const length)
 {
-    const unsigned char *input_pointer = buffer_at_offset(input_buffer) + 1;
-    const unsigned char *input_end = buffer_at_offset(input_buffer) + 1;
-    unsigned char *output_pointer = NULL;
-    unsigned char *output = NULL;
+    const unsigned char *input_pointer = *input;
+    unsigned char utf8_scratch[4];
+    unsigned char *scratch_pointer = NULL;
+    unsigned char sequence_length = 0;
 
-    /* not a string */
-    if (buffer_at_offset(input_buffer)[0] != '\"')
+    *length = 0;
+    while (input_pointer < input_end)
     {
-        goto fail;
-    }
+        if (*input_pointer != '\\')
+        {
+            (*length)++;
+            input_pointer++;
+            continue;
+        }
 
-    {
-        /* calculate approximate size of the output (overestimate) */
-        size_t allocation_length = 0;
-        size_t skipped_bytes = 0;
-        while (((size_t)(input_end - input_buffer->content) < input_buffer->length) && (*input_end != '\"'))
+        switch (input_pointer[1])
         {
-            /* is escape sequence */
-            if (input_end[0] == '\\')
-            {
-                if ((size_t)(input_end + 1 - input_buffer->content) >= input_buffer->length)
+            case 'b':
+            case 'f':
+            case 'n':
+            case 'r':
+            case 't':
+            case '\"':
+            case '\\':
+            case '/':
+                (*length)++;
+                sequence_length = 2;
+                break;
+
+            /* UTF-16 literal */
+            case 'u':
+                scratch_pointer = utf8_scratch;
+                sequence_length = utf16_literal_to_utf8(input_pointer, input_end, &scratch_pointer);
+                if (sequence_length == 0)
                 {
-                    /* prevent buffer overflow when last input character is a backslash */
                     goto fail;
                 }
-                skipped_bytes++;
-                input_end++;
-            }
-            input_end++;
+                *length += (size_t)(scratch_pointer - utf8_scratch);
+                break;
+
+            default:
+                goto fail;
         }
-        if (((size_t)(input_end - input_buffer->content) >= input_buffer->length) || (*input_end != '\"'))
+        input_pointer += sequence_length;
+    }
+
+    return true;
+
+fail:
+    *input = input_pointer;
+
+    return false;
+}
+
+/* the offset of the first byte of input that isn't printable ASCII, length if there is none */
+static size_t find_non_ascii_bytewise(const unsigned char * const input, const size_t length)
+{
+    size_t offset = 0;
+
+    while ((offset < length) && (input[offset] >= 0x20) && (input[offset] < 0x80))
+    {
+        offset++;
+    }
+
+    return offset;
+}
+
+#ifdef CJSON_SIMD_SSE2
+/* find_non_ascii_bytewise 16 bytes at a time */
+static size_t find_non_ascii_sse2(const unsigned char * const input, const size_t length)
+{
+    const __m128i space = _mm_set1_epi8(' ');
+    size_t offset = 0;
+
+    for (offset = 0; (offset + 16) <= length; offset += 16)
+    {
+        const __m128i bytes = _mm_loadu_si128((const __m128i*)(const void*)(input + offset));
+        /* as signed bytes, both control characters and bytes from 0x80 on are less than a space */
+        const int mask = _mm_movemask_epi8(_mm_cmplt_epi8(bytes, space));
+        if (mask != 0)
         {
-            goto fail; /* string ended unexpectedly */
+            return offset + (size_t)__builtin_ctz((unsigned int)mask);
         }
+    }
 
-        /* This is at most how much we need for the output */
-        allocation_length = (size_t) (input_end - buffer_at_offset(input_buffer)) - skipped_bytes;
-        output = (unsigned char*)input_buffer->hooks.allocate(allocation_length + sizeof(""));
-        if (output == NULL)
+    return offset + find_non_ascii_bytewise(input + offset, length - offset);
+}
+#endif
+
+#ifdef CJSON_SIMD_AVX2
+/* find_non_ascii_bytewise 32 bytes at a time */
+__attribute__((target("avx2")))
+static size_t find_non_ascii_avx2(const unsigned char * const input, const size_t length)
+{
+    const __m256i space = _mm256_set1_epi8(' ');
+    size_t offset = 0;
+
+    for (offset = 0; (offset + 32) <= length; offset += 32)
+    {
+        const __m256i bytes = _mm256_loadu_si256((const __m256i*)(const void*)(input + offset));
+        const unsigned int mask = (unsigned int)_mm256_movemask_epi8(_mm256_cmpgt_epi8(space, bytes));
+        if (mask != 0)
         {
-            goto fail; /* allocation failure */
+            return offset + (size_t)__builtin_ctz(mask);
         }
     }
 
-    output_pointer = output;
-    /* loop through the string literal */
-    while (input_pointer < input_end)
+    return offset + find_non_ascii_bytewise(input + offset, length - offset);
+}
+#endif
+
+#ifdef CJSON_SIMD_NEON
+/* find_non_ascii_bytewise 16 bytes at a time */
+static size_t find_non_ascii_neon(const unsigned char * const input, const size_t length)
+{
+    const int8x16_t space = vdupq_n_s8(' ');
+    size_t offset = 0;
+
+    for (offset = 0; (offset + 16) <= length; offset += 16)
     {
-        if (*input_pointer != '\\')
+        const int8x16_t bytes = vreinterpretq_s8_u8(vld1q_u8(input + offset));
+        if (vmaxvq_u8(vcltq_s8(bytes, space)) != 0)
         {
-            *output_pointer++ = *input_pointer++;
+            /* the byte is somewhere in these 16 */
+            return offset + find_non_ascii_bytewise(input + offset, 16);
         }
-        /* escape sequence */
-        else
-        {
-            unsigned char sequence_length = 2;
-            if ((input_end - input_pointer) < 1)
+    }
+
+    return offset + find_non_ascii_bytewise(input + offset, length - offset);
+}
+#endif
+
+#if defined(CJSON_SIMD_AVX2)
+/* __builtin_cpu_supports only reads what was found out about the processor at startup, which is
+ * cheap next to a scan of 16 bytes or more, and unlike a function pointer picked on the first call
+ * it leaves nothing for threads to race on */
+#define find_non_ascii_wide(input, length) (__builtin_cpu_supports("avx2") ? find_non_ascii_avx2((input), (length)) : find_non_ascii_sse2((input), (length)))
+#elif defined(CJSON_SIMD_SSE2)
+#define find_non_ascii_wide find_non_ascii_sse2
+#elif defined(CJSON_SIMD_NEON)
+#define find_non_ascii_wide find_non_ascii_neon
+#else
+#define find_non_ascii_wide find_non_ascii_bytewise
+#endif
+
+#define find_non_ascii(input, length) (((length) < 16) ? find_non_ascii_bytewise((input), (length)) : find_non_ascii_wide((input), (length)))
+
+/* The offset of the first byte of input that isn't part of valid UTF-8, length if there is none.
+ * Overlong forms, surrogates and code points beyond U+10FFFF are invalid, and so are control
+ * characters unless allow_control is set. Runs of ASCII are skipped with the vector scan, the
+ * other sequences are checked against the ranges of valid bytes in RFC 3629. */
+static size_t find_invalid_utf8(const unsigned char * const input, const size_t length, const BC_JSON_bool allow_control)
+{
+    size_t offset = 0;
+
+    while (offset < length)
+    {
+        unsigned char lowest = 0x80; /* range of the second byte */
+        unsigned char highest = 0xBF;
+        size_t sequence_length = 0;
+        size_t i = 0;
+
+        offset += find_non_ascii(input + offset, length - offset);
+        if (offset == length)
+        {
+            break;
+        }
+
+        if (input[offset] < 0x80)
+        {
+            /* control character */
+            if (!allow_control)
+            {
+                return offset;
+            }
+            offset++;
+            continue;
+        }
+
+        if ((input[offset] >= 0xC2) && (input[offset] <= 0xDF))
+        {
+            sequence_length = 2;
+        }
+        else if ((input[offset] >= 0xE0) && (input[offset] <= 0xEF))
+        {
+            sequence_length = 3;
+            if (input[offset] == 0xE0)
+            {
+                lowest = 0xA0; /* no overlong forms */
+            }
+            else if (input[offset] == 0xED)
+            {
+                highest = 0x9F; /* no surrogates */
+            }
+        }
+        else if ((input[offset] >= 0xF0) && (input[offset] <= 0xF4))
+        {
+            sequence_length = 4;
+            if (input[offset] == 0xF0)
+            {
+                lowest = 0x90; /* no overlong forms */
+            }
+            else if (input[offset] == 0xF4)
+            {
+                highest = 0x8F; /* nothing beyond U+10FFFF */
+            }
+        }
+        else
+        {
+            return offset; /* continuation byte or invalid lead byte */
+        }
+
+        if ((length - offset) < sequence_length)
+        {
+            return offset; /* incomplete sequence */
+        }
+        if ((input[offset + 1] < lowest) || (input[offset + 1] > highest))
+        {
+            return offset;
+        }
+        for (i = 2; i < sequence_length; i++)
+        {
+            if ((input[offset + i] & 0xC0) != 0x80)
+            {
+                return offset;
+            }
+        }
+        offset += sequence_length;
+    }
+
+    return length;
+}
+
+/* whether the input has four hex digits at input */
+static BC_JSON_bool is_hex4(const parse_buffer * const input_buffer, const unsigned char *input)
+{
+    size_t i = 0;
+
+    for (i = 0; i < 4; i++)
+    {
+        if (((size_t)(input + i - input_buffer->content) >= input_buffer->length) || !isxdigit(input[i]))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* Find the closing quote of the string literal at the current offset and calculate how many bytes
+ * its unescaped form needs (without the '\0'). Escape sequences are only checked if validate is set
+ * or if the length can't be known without decoding them, *literal_end is left at the first invalid
+ * one if that fails. The bytes are checked to be UTF-8 if the input buffer asks for it, and to have
+ * no control characters in a strict parse. */
+static BC_JSON_bool string_literal_length(const parse_buffer * const input_buffer, const unsigned char ** const literal_end, size_t * const length, const BC_JSON_bool validate)
+{
+    const unsigned char *input_pointer = buffer_at_offset(input_buffer) + 1;
+    const unsigned char *input_end = input_pointer;
+    size_t skipped_bytes = 0;
+    BC_JSON_bool has_utf16_literals = false;
+
+    while (((size_t)(input_end - input_buffer->content) < input_buffer->length) && (*input_end != '\"'))
+    {
+        /* is escape sequence */
+        if (input_end[0] == '\\')
+        {
+            if ((size_t)(input_end + 1 - input_buffer->content) >= input_buffer->length)
+            {
+                /* prevent buffer overflow when last input character is a backslash */
+                return false;
+            }
+            if (input_end[1] == 'u')
+            {
+                has_utf16_literals = true;
+                /* parse_hex4 takes anything that isn't a hex digit as 0, RFC 8259 wants four of them */
+                if (input_buffer->strict && !is_hex4(input_buffer, input_end + 2))
+                {
+                    return false;
+                }
+            }
+            skipped_bytes++;
+            input_end++;
+        }
+        input_end++;
+    }
+    if (((size_t)(input_end - input_buffer->content) >= input_buffer->length) || (*input_end != '\"'))
+    {
+        return false; /* string ended unexpectedly */
+    }
+
+    if ((input_buffer->check_utf8 || input_buffer->strict) && (find_invalid_utf8(input_pointer, (size_t)(input_end - input_pointer), !input_buffer->strict) != (size_t)(input_end - input_pointer)))
+    {
+        return false; /* invalid UTF-8 or control character */
+    }
+
+    *literal_end = input_end;
+    if ((skipped_bytes > 0) && (validate || has_utf16_literals))
+    {
+        *literal_end = input_pointer;
+        if (!unescaped_string_length(literal_end, input_end, length))
+        {
+            return false;
+        }
+        *literal_end = input_end;
+
+        return true;
+    }
+
+    /* every escape sequence other than \uXXXX unescapes to exactly one byte */
+    *length = (size_t)(input_end - input_pointer) - skipped_bytes;
+
+    return true;
+}
+
+/* Unescape a string literal from *input up to input_end (the closing quote) into output, which has
+ * room for its unescaped length. Returns the end of the output, or NULL if there is an invalid
+ * escape sequence, *input is left at it then. */
+static unsigned char *unescape_string(const unsigned char ** const input, const unsigned char * const input_end, unsigned char *output_pointer)
+{
+    const unsigned char *input_pointer = *input;
+
+    /* loop through the string literal */
+    while (input_pointer < input_end)
+    {
+        if (*input_pointer != '\\')
+        {
+            *output_pointer++ = *input_pointer++;
+        }
+        /* escape sequence */
+        else
+        {
+            unsigned char sequence_length = 2;
+            if ((input_end - input_pointer) < 1)
             {
                 goto fail;
             }
@@ -887,11 +3089,90 @@ static BC_JSON_bool parse_string(BC_JSON * const item, parse_buffer * const inpu
             input_pointer += sequence_length;
         }
     }
+    *input = input_pointer;
+
+    return output_pointer;
+
+fail:
+    *input = input_pointer;
+
+    return NULL;
+}
+
+/* The offset parse_string leaves behind when it fails on the string literal at the current offset,
+ * so that the parsers that only check strings report errors at the same place: at the first invalid
+ * escape sequence, otherwise behind the opening quote. */
+static size_t string_error_offset(const parse_buffer * const input_buffer)
+{
+    const unsigned char *error_pointer = buffer_at_offset(input_buffer) + 1;
+    size_t length = 0;
+
+    if (input_buffer->strict)
+    {
+        return input_buffer->offset; /* BC_JSON_Validate points at the invalid string itself */
+    }
+
+    if (buffer_at_offset(input_buffer)[0] == '\"')
+    {
+        /* fails, leaving error_pointer at the invalid escape sequence if there is one */
+        string_literal_length(input_buffer, &error_pointer, &length, true);
+    }
+
+    return (size_t)(error_pointer - input_buffer->content);
+}
+
+/* Parse the input text into an unescaped cinput, and populate item. */
+static BC_JSON_bool parse_string(BC_JSON * const item, parse_buffer * const input_buffer)
+{
+    const unsigned char *input_pointer = buffer_at_offset(input_buffer) + 1;
+    const unsigned char *input_end = buffer_at_offset(input_buffer) + 1;
+    unsigned char *output_pointer = NULL;
+    unsigned char *output = NULL;
+
+    /* not a string */
+    if (buffer_at_offset(input_buffer)[0] != '\"')
+    {
+        goto fail;
+    }
+
+    {
+        /* calculate the size of the output */
+        size_t allocation_length = 0;
+        if (!string_literal_length(input_buffer, &input_end, &allocation_length, false))
+        {
+            input_pointer = input_end; /* at the invalid escape sequence, if that is what failed */
+            goto fail;
+        }
+
+        if (input_buffer->in_situ != NULL)
+        {
+            /* unescaping never makes a string longer, so it fits where it is, closing quote included */
+            output = input_buffer->in_situ + (input_pointer - input_buffer->content);
+        }
+        else
+        {
+            output = parse_allocate(input_buffer, allocation_length + sizeof(""));
+            if (output == NULL)
+            {
+                goto fail; /* allocation failure */
+            }
+        }
+    }
+
+    output_pointer = unescape_string(&input_pointer, input_end, output);
+    if (output_pointer == NULL)
+    {
+        goto fail;
+    }
 
     /* zero terminate the output */
     *output_pointer = '\0';
 
     item->type = BC_JSON_String;
+    if (input_buffer->in_situ != NULL)
+    {
+        item->type |= BC_JSON_IsReference;
+    }
     item->value_string = (char*)output;
 
     input_buffer->offset = (size_t) (input_end - input_buffer->content);
@@ -900,9 +3181,9 @@ static BC_JSON_bool parse_string(BC_JSON * const item, parse_buffer * const inpu
     return true;
 
 fail:
-    if (output != NULL)
+    if ((output != NULL) && (input_buffer->in_situ == NULL))
     {
-        input_buffer->hooks.deallocate(output);
+        parse_deallocate(input_buffer, output);
         output = NULL;
     }
 
@@ -914,940 +3195,6266 @@ fail:
     return false;
 }
 
-/* Render the cstring provided to an escaped version that can be printed. */
-static BC_JSON_bool print_string_ptr(const unsigned char * const input, printbuffer * const output_buffer)
+/* Shape cache: a shape is a sequence of keys that objects start with. Every shape is one key
+ * added to the shape of the keys in front of it, so the shapes of a cache form a tree that the
+ * parser walks while it reads the keys of an object. The key strings are owned by the cache and
+ * shared by all objects with that shape. Each of them is preceded by an interned_key header. */
+typedef struct interned_key
 {
-    const unsigned char *input_pointer = NULL;
-    unsigned char *output = NULL;
-    unsigned char *output_pointer = NULL;
-    size_t output_length = 0;
-    /* numbers of additional characters needed for escaping */
-    size_t escape_characters = 0;
+    struct object_shape *shape; /* the shape that ends with this key, NULL for symbols */
+    size_t length; /* strlen of the key */
+    BC_JSON_Symbol symbol; /* the symbol with the same name, 0 if there wasn't one when the key was interned */
+} interned_key;
 
-    if (output_buffer == NULL)
+typedef struct object_shape
+{
+    struct object_shape *parent; /* the shape without the last key, NULL for shapes of a single key */
+    struct object_shape *next_shapes; /* shapes with one more key than this one, most recently used first */
+    struct object_shape *sibling; /* the next shape with the same parent */
+    struct object_shape *allocated; /* the next shape in the list of all shapes of the cache */
+    size_t key_count; /* number of keys in the shape */
+    char **keys; /* the keys of the shape in order, built when the first object with the shape is parsed */
+    size_t *slots; /* open addressing table of key indices + 1, built with keys */
+    size_t slot_mask;
+    /* followed by the interned_key header and the characters of the last key */
+} object_shape;
+
+struct BC_JSON_ShapeCache
+{
+    object_shape *first_keys; /* shapes of a single key, most recently used first */
+    object_shape *shapes; /* all shapes of the cache */
+    size_t shape_count;
+};
+
+#define shape_key_header(shape) ((interned_key*)(void*)((shape) + 1))
+#define shape_key(shape) ((char*)(void*)(shape_key_header(shape) + 1))
+#define interned_key_header(string) (((const interned_key*)(const void*)(string)) - 1)
+
+#define KEY_HASH_SEED 5381
+#define key_hash_step(hash, character) (((hash) * 33) ^ (character))
+
+static size_t hash_key(const unsigned char *key, size_t length)
+{
+    size_t hash = KEY_HASH_SEED;
+    size_t index = 0;
+    for (index = 0; index < length; index++)
     {
-        return false;
+        hash = key_hash_step(hash, key[index]);
     }
 
-    /* empty string */
-    if (input == NULL)
+    return hash;
+}
+
+/* hash_key of a key in lower case, keys that only differ in case get the same hash */
+static size_t hash_folded_key(const unsigned char *key)
+{
+    size_t hash = KEY_HASH_SEED;
+    for (; *key != '\0'; key++)
     {
-        output = ensure(output_buffer, sizeof("\"\""));
-        if (output == NULL)
-        {
-            return false;
-        }
-        strcpy((char*)output, "\"\"");
+        hash = key_hash_step(hash, (size_t)tolower(*key));
+    }
 
-        return true;
+    return hash;
+}
+
+/* Symbols: keys registered with BC_JSON_Intern. The names are interned keys without a shape, and
+ * live as long as the program. */
+typedef struct
+{
+    char **names; /* the name of symbol n is names[n - 1] */
+    size_t count;
+    size_t capacity;
+    BC_JSON_Symbol *slots; /* open addressing table of symbols, 0 for free slots */
+    size_t slot_mask;
+} symbol_table;
+
+static symbol_table global_symbols = { NULL, 0, 0, NULL, 0 };
+
+static BC_JSON_Symbol find_symbol(const unsigned char * const name, const size_t length, const size_t hash)
+{
+    size_t slot = 0;
+
+    if (global_symbols.count == 0)
+    {
+        return 0;
     }
 
-    /* set "flag" to 1 if something needs to be escaped */
-    for (input_pointer = input; *input_pointer; input_pointer++)
+    for (slot = hash & global_symbols.slot_mask; global_symbols.slots[slot] != 0; slot = (slot + 1) & global_symbols.slot_mask)
     {
-        switch (*input_pointer)
+        const char *candidate = global_symbols.names[global_symbols.slots[slot] - 1];
+        if ((interned_key_header(candidate)->length == length) && (memcmp(candidate, name, length) == 0))
         {
-            case '\"':
-            case '\\':
-            case '\b':
-            case '\f':
-            case '\n':
-            case '\r':
-            case '\t':
-                /* one character escape sequence */
-                escape_characters++;
-                break;
-            default:
-                if (*input_pointer < 32)
-                {
-                    /* UTF-16 escape sequence uXXXX */
-                    escape_characters += 5;
-                }
-                break;
+            return global_symbols.slots[slot];
         }
     }
-    output_length = (size_t)(input_pointer - input) + escape_characters;
 
-    output = ensure(output_buffer, output_length + sizeof("\"\""));
-    if (output == NULL)
+    return 0;
+}
+
+/* make room for one more symbol, keeping the table at most half full */
+static BC_JSON_bool grow_symbol_table(void)
+{
+    char **names = NULL;
+    BC_JSON_Symbol *slots = NULL;
+    size_t capacity = 0;
+    size_t index = 0;
+
+    if (global_symbols.count < global_symbols.capacity)
     {
-        return false;
+        return true;
     }
 
-    /* no characters have to be escaped */
-    if (escape_characters == 0)
+    capacity = (global_symbols.capacity == 0) ? 64 : (global_symbols.capacity * 2);
+    if ((capacity > (size_t)INT_MAX) || (capacity > ((size_t)-1 / (2 * sizeof(char*)))))
     {
-        output[0] = '\"';
-        memcpy(output + 1, input, output_length);
-        output[output_length + 1] = '\"';
-        output[output_length + 2] = '\0';
-
-        return true;
+        return false;
     }
 
-    output[0] = '\"';
-    output_pointer = output + 1;
-    /* copy the string */
-    for (input_pointer = input; *input_pointer != '\0'; (void)input_pointer++, output_pointer++)
+    names = (char**)global_hooks.allocate(capacity * sizeof(char*));
+    slots = (BC_JSON_Symbol*)global_hooks.allocate(2 * capacity * sizeof(BC_JSON_Symbol));
+    if ((names == NULL) || (slots == NULL))
     {
-        if ((*input_pointer > 31) && (*input_pointer != '\"') && (*input_pointer != '\\'))
+        if (names != NULL)
         {
-            /* normal character, copy */
-            *output_pointer = *input_pointer;
+            global_hooks.deallocate(names);
         }
-        else
+        if (slots != NULL)
         {
-            /* character needs to be escaped */
-            *output_pointer++ = '\\';
-            switch (*input_pointer)
-            {
-                case '\\':
-                    *output_pointer = '\\';
-                    break;
-                case '\"':
-                    *output_pointer = '\"';
-                    break;
-                case '\b':
-                    *output_pointer = 'b';
-                    break;
-                case '\f':
-                    *output_pointer = 'f';
-                    break;
-                case '\n':
-                    *output_pointer = 'n';
-                    break;
-                case '\r':
-                    *output_pointer = 'r';
-                    break;
-                case '\t':
-                    *output_pointer = 't';
-                    break;
-                default:
-                    /* escape and print as unicode codepoint */
-                    sprintf((char*)output_pointer, "u%04x", *input_pointer);
-                    output_pointer += 4;
-                    break;
-            }
+            global_hooks.deallocate(slots);
         }
+        return false;
     }
-    output[output_length + 1] = '\"';
-    output[output_length + 2] = '\0';
 
-    return true;
-}
+    if (global_symbols.names != NULL)
+    {
+        memcpy(names, global_symbols.names, global_symbols.count * sizeof(char*));
+        global_hooks.deallocate(global_symbols.names);
+        global_hooks.deallocate(global_symbols.slots);
+    }
+    global_symbols.names = names;
+    global_symbols.capacity = capacity;
+    global_symbols.slots = slots;
+    global_symbols.slot_mask = (2 * capacity) - 1;
 
-/* Invoke print_string_ptr (which is useful) on an item. */
-static BC_JSON_bool print_string(const BC_JSON * const item, printbuffer * const p)
-{
-    return print_string_ptr((unsigned char*)item->value_string, p);
-}
+    /* rehash */
+    memset(slots, '\0', 2 * capacity * sizeof(BC_JSON_Symbol));
+    for (index = 0; index < global_symbols.count; index++)
+    {
+        size_t slot = hash_key((const unsigned char*)names[index], interned_key_header(names[index])->length) & global_symbols.slot_mask;
+        while (slots[slot] != 0)
+        {
+            slot = (slot + 1) & global_symbols.slot_mask;
+        }
+        slots[slot] = (BC_JSON_Symbol)(index + 1);
+    }
 
-/* Predeclare these prototypes. */
-static BC_JSON_bool parse_value(BC_JSON * const item, parse_buffer * const input_buffer);
-static BC_JSON_bool print_value(const BC_JSON * const item, printbuffer * const output_buffer);
-static BC_JSON_bool parse_array(BC_JSON * const item, parse_buffer * const input_buffer);
-static BC_JSON_bool print_array(const BC_JSON * const item, printbuffer * const output_buffer);
-static BC_JSON_bool parse_object(BC_JSON * const item, parse_buffer * const input_buffer);
-static BC_JSON_bool print_object(const BC_JSON * const item, printbuffer * const output_buffer);
+    return true;
+}
 
-/* Utility to jump whitespace and cr/lf */
-static parse_buffer *buffer_skip_whitespace(parse_buffer * const buffer)
+CJSON_PUBLIC(BC_JSON_Symbol) BC_JSON_Intern(const char *name)
 {
-    if ((buffer == NULL) || (buffer->content == NULL))
-    {
-        return NULL;
-    }
+    interned_key *header = NULL;
+    BC_JSON_Symbol symbol = 0;
+    size_t length = 0;
+    size_t hash = 0;
+    size_t slot = 0;
 
-    if (cannot_access_at_index(buffer, 0))
+    if (name == NULL)
     {
-        return buffer;
+        return 0;
     }
 
-    while (can_access_at_index(buffer, 0) && (buffer_at_offset(buffer)[0] <= 32))
+    length = strlen(name);
+    hash = hash_key((const unsigned char*)name, length);
+    symbol = find_symbol((const unsigned char*)name, length, hash);
+    if (symbol != 0)
     {
-       buffer->offset++;
+        return symbol;
     }
 
-    if (buffer->offset == buffer->length)
+    if (!grow_symbol_table())
     {
-        buffer->offset--;
+        return 0;
     }
 
-    return buffer;
-}
-
-/* skip the UTF-8 BOM (byte order mark) if it is at the beginning of a buffer */
-static parse_buffer *skip_utf8_bom(parse_buffer * const buffer)
-{
-    if ((buffer == NULL) || (buffer->content == NULL) || (buffer->offset != 0))
+    header = (interned_key*)global_hooks.allocate(sizeof(interned_key) + length + sizeof(""));
+    if (header == NULL)
     {
-        return NULL;
+        return 0;
     }
+    symbol = (BC_JSON_Symbol)(global_symbols.count + 1);
+    header->shape = NULL;
+    header->length = length;
+    header->symbol = symbol;
+    memcpy(header + 1, name, length + sizeof(""));
 
-    if (can_access_at_index(buffer, 4) && (strncmp((const char*)buffer_at_offset(buffer), "\xEF\xBB\xBF", 3) == 0))
+    global_symbols.names[global_symbols.count] = (char*)(void*)(header + 1);
+    global_symbols.count++;
+
+    slot = hash & global_symbols.slot_mask;
+    while (global_symbols.slots[slot] != 0)
     {
-        buffer->offset += 3;
+        slot = (slot + 1) & global_symbols.slot_mask;
     }
+    global_symbols.slots[slot] = symbol;
 
-    return buffer;
+    return symbol;
 }
 
-CJSON_PUBLIC(BC_JSON *) BC_JSON_ParseWithOpts(const char *value, const char **return_parse_end, BC_JSON_bool require_null_terminated)
+CJSON_PUBLIC(const char *) BC_JSON_SymbolName(BC_JSON_Symbol symbol)
 {
-    size_t buffer_length;
-
-    if (NULL == value)
+    if ((symbol <= 0) || ((size_t)symbol > global_symbols.count))
     {
         return NULL;
     }
 
-    /* Adding null character size due to require_null_terminated. */
-    buffer_length = strlen(value) + sizeof("");
-
-    return BC_JSON_ParseWithLengthOpts(value, buffer_length, return_parse_end, require_null_terminated);
+    return global_symbols.names[symbol - 1];
 }
 
-/* Parse an object - create a new root, and populate. */
-CJSON_PUBLIC(BC_JSON *) BC_JSON_ParseWithLengthOpts(const char *value, size_t buffer_length, const char **return_parse_end, BC_JSON_bool require_null_terminated)
+/* check if a string is the name of a symbol itself, not just a string with the same characters */
+static BC_JSON_bool is_symbol_name(const char * const string)
 {
-    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 } };
-    BC_JSON *item = NULL;
-
-    /* reset error position */
-    global_error.json = NULL;
-    global_error.position = 0;
+    size_t length = 0;
+    BC_JSON_Symbol symbol = 0;
 
-    if (value == NULL || 0 == buffer_length)
+    if ((global_symbols.count == 0) || (string == NULL))
     {
-        goto fail;
+        return false;
     }
 
-    buffer.content = (const unsigned char*)value;
-    buffer.length = buffer_length;
-    buffer.offset = 0;
-    buffer.hooks = global_hooks;
+    length = strlen(string);
+    symbol = find_symbol((const unsigned char*)string, length, hash_key((const unsigned char*)string, length));
 
-    item = BC_JSON_New_Item(&global_hooks);
-    if (item == NULL) /* memory fail */
+    return (symbol != 0) && (global_symbols.names[symbol - 1] == string);
+}
+
+/* Use the name of a symbol as the key of an object member, if the key at the current offset is one.
+ * Returns false and leaves the offset alone if it isn't. */
+static BC_JSON_bool parse_symbol_key(BC_JSON * const item, parse_buffer * const input_buffer)
+{
+    const unsigned char *literal = NULL;
+    size_t length = 0;
+    size_t hash = KEY_HASH_SEED;
+    BC_JSON_Symbol symbol = 0;
+
+    /* the keys of a tree in a caller provided block don't point out of it */
+    if ((global_symbols.count == 0) || (input_buffer->arena != NULL))
     {
-        goto fail;
+        return false;
     }
 
-    if (!parse_value(item, buffer_skip_whitespace(skip_utf8_bom(&buffer))))
+    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != '\"'))
     {
-        /* parse failure. ep is set. */
-        goto fail;
+        return false;
     }
 
-    /* if we require null-terminated JSON without appended garbage, skip and then check for a null terminator */
-    if (require_null_terminated)
+    literal = buffer_at_offset(input_buffer) + 1;
+    while (can_access_at_index(input_buffer, length + 1) && (literal[length] != '\"'))
     {
-        buffer_skip_whitespace(&buffer);
-        if ((buffer.offset >= buffer.length) || buffer_at_offset(&buffer)[0] != '\0')
+        if (literal[length] == '\\')
         {
-            goto fail;
+            return false; /* leave escape sequences to parse_string */
         }
+        hash = key_hash_step(hash, literal[length]);
+        length++;
     }
-    if (return_parse_end)
+    if (cannot_access_at_index(input_buffer, length + 1))
+    {
+        return false; /* string ended unexpectedly */
+    }
+    if (input_buffer->check_utf8 && (find_invalid_utf8(literal, length, true) != length))
     {
-        *return_parse_end = (const char*)buffer_at_offset(&buffer);
+        return false; /* leave the error to parse_string */
     }
 
-    return item;
+    symbol = find_symbol(literal, length, hash);
+    if (symbol == 0)
+    {
+        return false;
+    }
 
-fail:
-    if (item != NULL)
+    item->string = global_symbols.names[symbol - 1];
+    item->type |= BC_JSON_StringIsConst | BC_JSON_StringIsInterned;
+    input_buffer->offset += length + static_strlen("\"\"");
+
+    return true;
+}
+
+CJSON_PUBLIC(BC_JSON_ShapeCache *) BC_JSON_CreateShapeCache(void)
+{
+    BC_JSON_ShapeCache *cache = (BC_JSON_ShapeCache*)global_hooks.allocate(sizeof(BC_JSON_ShapeCache));
+    if (cache != NULL)
     {
-        BC_JSON_Delete(item);
+        memset(cache, '\0', sizeof(BC_JSON_ShapeCache));
     }
 
-    if (value != NULL)
+    return cache;
+}
+
+CJSON_PUBLIC(void) BC_JSON_DeleteShapeCache(BC_JSON_ShapeCache *cache)
+{
+    object_shape *shape = NULL;
+    object_shape *next = NULL;
+
+    if (cache == NULL)
     {
-        error local_error;
-        local_error.json = (const unsigned char*)value;
-        local_error.position = 0;
+        return;
+    }
 
-        if (buffer.offset < buffer.length)
+    for (shape = cache->shapes; shape != NULL; shape = next)
+    {
+        next = shape->allocated;
+        if (shape->keys != NULL)
         {
-            local_error.position = buffer.offset;
+            global_hooks.deallocate(shape->keys);
         }
-        else if (buffer.length > 0)
+        if (shape->slots != NULL)
         {
-            local_error.position = buffer.length - 1;
+            global_hooks.deallocate(shape->slots);
         }
+        global_hooks.deallocate(shape);
+    }
+
+    global_hooks.deallocate(cache);
+}
+
+/* Parse the key of an object member. previous_shape is the shape of the keys in front of it, or
+ * NULL for the first key, and is replaced by the shape that ends with this key. If the key can't
+ * be interned, the shape is set to NULL and the key is parsed into a string of its own. */
+static BC_JSON_bool parse_shaped_key(BC_JSON * const item, parse_buffer * const input_buffer, object_shape ** const previous_shape)
+{
+    BC_JSON_ShapeCache *cache = input_buffer->shape_cache;
+    object_shape *previous = *previous_shape;
+    object_shape **first = (previous == NULL) ? &(cache->first_keys) : &(previous->next_shapes);
+    object_shape **link = NULL;
+    object_shape *shape = NULL;
+    size_t literal_start = input_buffer->offset;
+    size_t length = 0;
 
-        if (return_parse_end != NULL)
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '\"'))
+    {
+        const unsigned char *literal = buffer_at_offset(input_buffer) + 1;
+        size_t available = input_buffer->length - input_buffer->offset - 1;
+
+        /* usually the first candidate is the key, so this is a single memcmp */
+        for (link = first; *link != NULL; link = &((*link)->sibling))
         {
-            *return_parse_end = (const char*)local_error.json + local_error.position;
+            shape = *link;
+            length = shape_key_header(shape)->length;
+            if ((length < available) && (literal[length] == '\"') && (memcmp(literal, shape_key(shape), length) == 0)
+                && (!input_buffer->check_utf8 || (find_invalid_utf8(literal, length, true) == length)))
+            {
+                /* move it to the front, so it is tried first the next time */
+                *link = shape->sibling;
+                shape->sibling = *first;
+                *first = shape;
+
+                item->string = shape_key(shape);
+                item->type |= BC_JSON_StringIsConst | BC_JSON_StringIsInterned;
+                input_buffer->offset += length + static_strlen("\"\"");
+                *previous_shape = shape;
+
+                return true;
+            }
         }
+    }
 
-        global_error = local_error;
+    if (!parse_string(item, input_buffer))
+    {
+        return false;
     }
+    item->string = item->value_string;
+    item->value_string = NULL;
+    *previous_shape = NULL;
 
-    return NULL;
-}
+    /* Escape sequences always make a key shorter, so a key that is as long as its literal has none
+     * and can be matched against the input as it is. */
+    length = strlen(item->string);
+    if (((input_buffer->offset - literal_start - static_strlen("\"\"")) != length) || (cache->shape_count >= CJSON_SHAPE_CACHE_LIMIT))
+    {
+        return true;
+    }
 
-/* Default options for BC_JSON_Parse */
-CJSON_PUBLIC(BC_JSON *) BC_JSON_Parse(const char *value)
-{
-    return BC_JSON_ParseWithOpts(value, 0, 0);
-}
+    shape = (object_shape*)global_hooks.allocate(sizeof(object_shape) + sizeof(interned_key) + length + sizeof(""));
+    if (shape == NULL)
+    {
+        return true; /* the key just isn't interned */
+    }
+    memset(shape, '\0', sizeof(object_shape));
+    shape->parent = previous;
+    shape->key_count = (previous == NULL) ? 1 : (previous->key_count + 1);
+    shape_key_header(shape)->shape = shape;
+    shape_key_header(shape)->length = length;
+    shape_key_header(shape)->symbol = find_symbol((const unsigned char*)item->string, length, hash_key((const unsigned char*)item->string, length));
+    memcpy(shape_key(shape), item->string, length + sizeof(""));
 
-CJSON_PUBLIC(BC_JSON *) BC_JSON_ParseWithLength(const char *value, size_t buffer_length)
-{
-    return BC_JSON_ParseWithLengthOpts(value, buffer_length, 0, 0);
-}
+    shape->sibling = *first;
+    *first = shape;
+    shape->allocated = cache->shapes;
+    cache->shapes = shape;
+    cache->shape_count++;
 
-#define cjson_min(a, b) (((a) < (b)) ? (a) : (b))
+    parse_deallocate(input_buffer, item->string);
+    item->string = shape_key(shape);
+    item->type |= BC_JSON_StringIsConst | BC_JSON_StringIsInterned;
+    *previous_shape = shape;
 
-static unsigned char *print(const BC_JSON * const item, BC_JSON_bool format, const internal_hooks * const hooks)
-{
-    static const size_t default_buffer_size = 256;
-    printbuffer buffer[1];
-    unsigned char *printed = NULL;
+    return true;
+}
 
-    memset(buffer, 0, sizeof(buffer));
+/* build the table that maps the keys of a shape to their index, the first occurrence of a key wins */
+static BC_JSON_bool build_shape_slots(object_shape * const shape)
+{
+    object_shape *current = NULL;
+    size_t table_size = 4;
+    size_t index = 0;
 
-    /* create buffer */
-    buffer->buffer = (unsigned char*) hooks->allocate(default_buffer_size);
-    buffer->length = default_buffer_size;
-    buffer->format = format;
-    buffer->hooks = *hooks;
-    if (buffer->buffer == NULL)
+    while (table_size < (2 * shape->key_count))
     {
-        goto fail;
+        table_size *= 2;
     }
 
-    /* print the value */
-    if (!print_value(item, buffer))
+    shape->keys = (char**)global_hooks.allocate(shape->key_count * sizeof(char*));
+    shape->slots = (size_t*)global_hooks.allocate(table_size * sizeof(size_t));
+    if ((shape->keys == NULL) || (shape->slots == NULL))
     {
-        goto fail;
+        if (shape->keys != NULL)
+        {
+            global_hooks.deallocate(shape->keys);
+            shape->keys = NULL;
+        }
+        if (shape->slots != NULL)
+        {
+            global_hooks.deallocate(shape->slots);
+            shape->slots = NULL;
+        }
+
+        return false;
     }
-    update_offset(buffer);
+    memset(shape->slots, '\0', table_size * sizeof(size_t));
+    shape->slot_mask = table_size - 1;
 
-    /* check if reallocate is available */
-    if (hooks->reallocate != NULL)
+    index = shape->key_count;
+    for (current = shape; current != NULL; current = current->parent)
     {
-        printed = (unsigned char*) hooks->reallocate(buffer->buffer, buffer->offset + 1);
-        if (printed == NULL) {
-            goto fail;
-        }
-        buffer->buffer = NULL;
+        index--;
+        shape->keys[index] = shape_key(current);
     }
-    else /* otherwise copy the JSON over to a new buffer */
+
+    for (index = 0; index < shape->key_count; index++)
     {
-        printed = (unsigned char*) hooks->allocate(buffer->offset + 1);
-        if (printed == NULL)
+        size_t slot = hash_key((const unsigned char*)shape->keys[index], strlen(shape->keys[index])) & shape->slot_mask;
+        while ((shape->slots[slot] != 0) && (strcmp(shape->keys[shape->slots[slot] - 1], shape->keys[index]) != 0))
         {
-            goto fail;
+            slot = (slot + 1) & shape->slot_mask;
+        }
+        if (shape->slots[slot] == 0)
+        {
+            shape->slots[slot] = index + 1;
         }
-        memcpy(printed, buffer->buffer, cjson_min(buffer->length, buffer->offset + 1));
-        printed[buffer->offset] = '\0'; /* just to be sure */
-
-        /* free the buffer */
-        hooks->deallocate(buffer->buffer);
-        buffer->buffer = NULL;
     }
 
-    return printed;
+    return true;
+}
+
+/* Give an object parsed with a shape cache an index of its members once it is complete, and build
+ * the slot table of its shape if it doesn't have one yet. Looking up keys in it then neither walks
+ * the members nor writes to the cache, so documents parsed with the same cache can be read on
+ * several threads. Objects without a shape, or if memory runs out, are searched the normal way. */
+static void index_shaped_object(BC_JSON * const object, parse_buffer * const input_buffer)
+{
+    const BC_JSON *last = NULL;
+    object_shape *shape = NULL;
+    container_index *index = NULL;
+    BC_JSON *child = NULL;
+    size_t position = 0;
 
-fail:
-    if (buffer->buffer != NULL)
+    /* the index of an object in an arena would outlive the block */
+    if ((input_buffer->arena != NULL) || (object->child == NULL) || has_container_index(object))
+    {
+        return;
+    }
+
+    /* the last member knows the shape of the whole object */
+    last = object->child->prev;
+    if (!(last->type & BC_JSON_StringIsInterned) || (last->string == NULL))
     {
-        hooks->deallocate(buffer->buffer);
-        buffer->buffer = NULL;
+        return;
+    }
+    shape = interned_key_header(last->string)->shape;
+    if ((shape == NULL) || ((shape->slots == NULL) && !build_shape_slots(shape)))
+    {
+        return;
     }
 
-    if (printed != NULL)
+    index = (container_index*)global_hooks.allocate(sizeof(container_index) + (shape->key_count * sizeof(BC_JSON*)));
+    if (index == NULL)
+    {
+        return;
+    }
+    index->count = shape->key_count;
+    index->slot_mask = 0;
+    for (child = object->child; (child != NULL) && (position < index->count); child = child->next)
+    {
+        indexed_elements(index)[position] = child;
+        position++;
+    }
+    if ((child != NULL) || (position != index->count))
     {
-        hooks->deallocate(printed);
-        printed = NULL;
+        global_hooks.deallocate(index);
+        return;
     }
 
-    return NULL;
+    object->index = index;
 }
 
-/* Render a BC_JSON item/entity/structure to text. */
-CJSON_PUBLIC(char *) BC_JSON_Print(const BC_JSON *item)
+/* The letter of the escape sequence of every character that needs to be escaped, 'u' for
+ * \\uXXXX, 0 for characters that are printed as they are. */
+static const unsigned char escape_letters[256] =
 {
-    return (char*)print(item, true, &global_hooks);
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    0, 0, '\"', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, '\\', 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+/* the offset of the first character of input that needs to be escaped, length if there is none */
+static size_t find_escape_bytewise(const unsigned char * const input, const size_t length)
+{
+    size_t offset = 0;
+
+    while ((offset < length) && (escape_letters[input[offset]] == 0))
+    {
+        offset++;
+    }
+
+    return offset;
 }
 
-CJSON_PUBLIC(char *) BC_JSON_PrintUnformatted(const BC_JSON *item)
+#ifdef CJSON_SIMD_SSE2
+/* find_escape_bytewise 16 characters at a time */
+static size_t find_escape_sse2(const unsigned char * const input, const size_t length)
 {
-    return (char*)print(item, false, &global_hooks);
+    const __m128i quote = _mm_set1_epi8('\"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i last_control = _mm_set1_epi8(31);
+    size_t offset = 0;
+
+    for (offset = 0; (offset + 16) <= length; offset += 16)
+    {
+        const __m128i characters = _mm_loadu_si128((const __m128i*)(const void*)(input + offset));
+        /* control characters are the ones that are unchanged by an unsigned minimum with 31 */
+        const __m128i escaped = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(characters, quote), _mm_cmpeq_epi8(characters, backslash)),
+                _mm_cmpeq_epi8(_mm_min_epu8(characters, last_control), characters));
+        const int mask = _mm_movemask_epi8(escaped);
+        if (mask != 0)
+        {
+            return offset + (size_t)__builtin_ctz((unsigned int)mask);
+        }
+    }
+
+    return offset + find_escape_bytewise(input + offset, length - offset);
 }
+#endif
 
-CJSON_PUBLIC(char *) BC_JSON_PrintBuffered(const BC_JSON *item, int prebuffer, BC_JSON_bool fmt)
+#ifdef CJSON_SIMD_AVX2
+/* find_escape_bytewise 32 characters at a time */
+__attribute__((target("avx2")))
+static size_t find_escape_avx2(const unsigned char * const input, const size_t length)
 {
-    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 } };
-
-    if (prebuffer < 0)
-    {
-        return NULL;
+    const __m256i quote = _mm256_set1_epi8('\"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i last_control = _mm256_set1_epi8(31);
+    size_t offset = 0;
+
+    for (offset = 0; (offset + 32) <= length; offset += 32)
+    {
+        const __m256i characters = _mm256_loadu_si256((const __m256i*)(const void*)(input + offset));
+        const __m256i escaped = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(characters, quote), _mm256_cmpeq_epi8(characters, backslash)),
+                _mm256_cmpeq_epi8(_mm256_min_epu8(characters, last_control), characters));
+        const unsigned int mask = (unsigned int)_mm256_movemask_epi8(escaped);
+        if (mask != 0)
+        {
+            return offset + (size_t)__builtin_ctz(mask);
+        }
     }
 
-    p.buffer = (unsigned char*)global_hooks.allocate((size_t)prebuffer);
-    if (!p.buffer)
-    {
-        return NULL;
+    return offset + find_escape_bytewise(input + offset, length - offset);
+}
+#endif
+
+#ifdef CJSON_SIMD_NEON
+/* find_escape_bytewise 16 characters at a time */
+static size_t find_escape_neon(const unsigned char * const input, const size_t length)
+{
+    const uint8x16_t quote = vdupq_n_u8('\"');
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+    const uint8x16_t space = vdupq_n_u8(' ');
+    size_t offset = 0;
+
+    for (offset = 0; (offset + 16) <= length; offset += 16)
+    {
+        const uint8x16_t characters = vld1q_u8(input + offset);
+        const uint8x16_t escaped = vorrq_u8(
+                vorrq_u8(vceqq_u8(characters, quote), vceqq_u8(characters, backslash)),
+                vcltq_u8(characters, space));
+        if (vmaxvq_u8(escaped) != 0)
+        {
+            /* the character is somewhere in these 16 */
+            return offset + find_escape_bytewise(input + offset, 16);
+        }
     }
 
-    p.length = (size_t)prebuffer;
-    p.offset = 0;
-    p.noalloc = false;
-    p.format = fmt;
-    p.hooks = global_hooks;
+    return offset + find_escape_bytewise(input + offset, length - offset);
+}
+#endif
 
-    if (!print_value(item, &p))
+#if defined(CJSON_SIMD_AVX2)
+/* asks the processor on every call for the same reason as find_non_ascii_wide */
+#define find_escape_wide(input, length) (__builtin_cpu_supports("avx2") ? find_escape_avx2((input), (length)) : find_escape_sse2((input), (length)))
+#elif defined(CJSON_SIMD_SSE2)
+#define find_escape_wide find_escape_sse2
+#elif defined(CJSON_SIMD_NEON)
+#define find_escape_wide find_escape_neon
+#else
+#define find_escape_wide find_escape_bytewise
+#endif
+
+/* the offset of the first character of input that needs to be escaped, length if there is none.
+ * Short strings aren't worth the vector scan. */
+#define find_escape(input, length) (((length) < 16) ? find_escape_bytewise((input), (length)) : find_escape_wide((input), (length)))
+
+/* The length of the cstring provided once it is escaped, without the quotes. */
+static size_t escaped_length(const unsigned char * const input, size_t * const escape_characters)
+{
+    const size_t length = strlen((const char*)input);
+    /* numbers of additional characters needed for escaping */
+    size_t escapes = 0;
+    size_t offset = find_escape(input, length);
+
+    while (offset < length)
     {
-        global_hooks.deallocate(p.buffer);
-        p.buffer = NULL;
-        return NULL;
+        /* \\uXXXX adds 5 characters, the other escape sequences 1 */
+        escapes += (escape_letters[input[offset]] == 'u') ? 5 : 1;
+        offset++;
+        offset += find_escape(input + offset, length - offset);
     }
+    *escape_characters = escapes;
 
-    return (char*)p.buffer;
+    return length + escapes;
 }
 
-CJSON_PUBLIC(BC_JSON_bool) BC_JSON_PrintPreallocated(BC_JSON *item, char *buffer, const int length, const BC_JSON_bool format)
+/* Render the escape sequence of a character that needs to be escaped, returns its length. */
+static size_t print_escape(const unsigned char character, unsigned char * const output)
 {
-    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 } };
+    static const char hex_digits[] = "0123456789abcdef";
 
-    if ((length < 0) || (buffer == NULL))
+    output[0] = '\\';
+    output[1] = escape_letters[character];
+    if (output[1] != 'u')
     {
-        return false;
+        return static_strlen("\\n");
     }
 
-    p.buffer = (unsigned char*)buffer;
-    p.length = (size_t)length;
-    p.offset = 0;
-    p.noalloc = true;
-    p.format = format;
-    p.hooks = global_hooks;
+    /* print control characters as unicode codepoint */
+    output[2] = '0';
+    output[3] = '0';
+    output[4] = (unsigned char)hex_digits[character >> 4];
+    output[5] = (unsigned char)hex_digits[character & 0xF];
 
-    return print_value(item, &p);
+    return static_strlen("\\u0000");
 }
 
-/* Parser core - when encountering text, process appropriately. */
-static BC_JSON_bool parse_value(BC_JSON * const item, parse_buffer * const input_buffer)
+/* Append text to the buffer of a writer, text that doesn't fit is handed to the writer directly
+ * instead of being copied. */
+static BC_JSON_bool print_through(const unsigned char * const text, const size_t length, printbuffer * const output_buffer)
 {
-    if ((input_buffer == NULL) || (input_buffer->content == NULL))
-    {
-        return false; /* no input */
-    }
+    unsigned char *output = NULL;
 
-    /* parse the different types of values */
+    if ((length + output_buffer->offset + 1) > output_buffer->length)
+    {
+        if (!flush_printbuffer(output_buffer))
+        {
+            return false;
+        }
+        if ((length + 1) > output_buffer->length)
+        {
+            return write_all(output_buffer, text, length);
+        }
+    }
+
+    output = output_buffer->buffer + output_buffer->offset;
+    memcpy(output, text, length);
+    output[length] = '\0';
+    output_buffer->offset += length;
+
+    return true;
+}
+
+/* Render a string that doesn't fit into the buffer of a writer. The parts between escaped
+ * characters are handed to the writer straight from the input. */
+static BC_JSON_bool print_long_string(const unsigned char * const input, const size_t length, printbuffer * const output_buffer)
+{
+    unsigned char *output = NULL;
+    size_t offset = 0;
+    size_t unescaped = 0;
+
+    if (!print_through((const unsigned char*)"\"", static_strlen("\""), output_buffer))
+    {
+        return false;
+    }
+
+    for (;;)
+    {
+        unescaped = find_escape(input + offset, length - offset);
+        if ((unescaped > 0) && !print_through(input + offset, unescaped, output_buffer))
+        {
+            return false;
+        }
+        offset += unescaped;
+        if (offset == length)
+        {
+            break;
+        }
+
+        output = ensure(output_buffer, static_strlen("\\u0000"));
+        if (output == NULL)
+        {
+            return false;
+        }
+        output_buffer->offset += print_escape(input[offset], output);
+        offset++;
+    }
+
+    output = ensure(output_buffer, static_strlen("\""));
+    if (output == NULL)
+    {
+        return false;
+    }
+    output[0] = '\"';
+    output[1] = '\0';
+    output_buffer->offset++;
+
+    return true;
+}
+
+static void* cast_away_const(const void* string);
+
+/* add a segment to the segments of a printbuffer */
+static BC_JSON_bool add_segment(segment_list * const list, const unsigned char * const text, const size_t length)
+{
+    BC_JSON_IoVec *grown = NULL;
+
+    if (list->count == list->capacity)
+    {
+        grown = (BC_JSON_IoVec*)grow_walk_stack((void*)list->segments, &list->capacity, sizeof(BC_JSON_IoVec), (const void*)list->inline_segments);
+        if (grown == NULL)
+        {
+            return false;
+        }
+        list->segments = grown;
+    }
+    list->segments[list->count].iov_base = cast_away_const(text);
+    list->segments[list->count].iov_len = length;
+    list->count++;
+
+    return true;
+}
+
+/* end the segment of printed text at the current offset */
+static BC_JSON_bool cut_segment(printbuffer * const output_buffer)
+{
+    segment_list * const list = output_buffer->segments;
+
+    if (output_buffer->offset > list->cut)
+    {
+        if (!add_segment(list, NULL, output_buffer->offset - list->cut))
+        {
+            return false;
+        }
+        list->cut = output_buffer->offset;
+    }
+
+    return true;
+}
+
+/* Reference text in a segment of its own instead of printing it. */
+static BC_JSON_bool print_reference(const unsigned char * const text, const size_t length, printbuffer * const output_buffer)
+{
+    return cut_segment(output_buffer) && add_segment(output_buffer->segments, text, length);
+}
+
+/* Render a string without escapes whose characters are referenced in place. */
+static BC_JSON_bool print_string_reference(const unsigned char * const input, const size_t length, printbuffer * const output_buffer)
+{
+    unsigned char *output = NULL;
+
+    output = ensure(output_buffer, static_strlen("\""));
+    if (output == NULL)
+    {
+        return false;
+    }
+    output[0] = '\"';
+    output_buffer->offset++;
+
+    if (!print_reference(input, length, output_buffer))
+    {
+        return false;
+    }
+
+    output = ensure(output_buffer, static_strlen("\""));
+    if (output == NULL)
+    {
+        return false;
+    }
+    output[0] = '\"';
+    output[1] = '\0';
+    output_buffer->offset++;
+
+    return true;
+}
+
+/* Render the cstring provided to an escaped version that can be printed. */
+static BC_JSON_bool print_string_ptr(const unsigned char * const input, printbuffer * const output_buffer)
+{
+    const unsigned char *input_pointer = input;
+    size_t input_length = 0;
+    size_t unescaped = 0;
+    unsigned char *output = NULL;
+    unsigned char *output_pointer = NULL;
+    size_t output_length = 0;
+    /* numbers of additional characters needed for escaping */
+    size_t escape_characters = 0;
+
+    if (output_buffer == NULL)
+    {
+        return false;
+    }
+
+    /* empty string */
+    if (input == NULL)
+    {
+        output = ensure(output_buffer, static_strlen("\"\""));
+        if (output == NULL)
+        {
+            return false;
+        }
+        strcpy((char*)output, "\"\"");
+        output_buffer->offset += static_strlen("\"\"");
+
+        return true;
+    }
+
+    output_length = escaped_length(input, &escape_characters);
+
+    if ((output_buffer->write != NULL) && ((output_length + sizeof("\"\"")) > output_buffer->length))
+    {
+        return print_long_string(input, output_length - escape_characters, output_buffer);
+    }
+
+    if ((output_buffer->segments != NULL) && (escape_characters == 0) && (output_length >= output_buffer->segments->threshold))
+    {
+        return print_string_reference(input, output_length, output_buffer);
+    }
+
+    output = ensure(output_buffer, output_length + static_strlen("\"\""));
+    if (output == NULL)
+    {
+        return false;
+    }
+
+    /* no characters have to be escaped */
+    if (escape_characters == 0)
+    {
+        output[0] = '\"';
+        memcpy(output + 1, input, output_length);
+        output[output_length + 1] = '\"';
+        output[output_length + 2] = '\0';
+        output_buffer->offset += output_length + static_strlen("\"\"");
+
+        return true;
+    }
+
+    output[0] = '\"';
+    output_pointer = output + 1;
+    /* copy the runs of normal characters, escape the characters between them */
+    input_length = output_length - escape_characters;
+    for (;;)
+    {
+        unescaped = find_escape(input_pointer, input_length - (size_t)(input_pointer - input));
+        memcpy(output_pointer, input_pointer, unescaped);
+        output_pointer += unescaped;
+        input_pointer += unescaped;
+        if (*input_pointer == '\0')
+        {
+            break;
+        }
+        output_pointer += print_escape(*input_pointer, output_pointer);
+        input_pointer++;
+    }
+    output[output_length + 1] = '\"';
+    output[output_length + 2] = '\0';
+    output_buffer->offset += output_length + static_strlen("\"\"");
+
+    return true;
+}
+
+/* Invoke print_string_ptr (which is useful) on an item. */
+static BC_JSON_bool print_string(const BC_JSON * const item, printbuffer * const p)
+{
+    return print_string_ptr((unsigned char*)item->value_string, p);
+}
+
+/* Predeclare these prototypes. */
+static BC_JSON_bool parse_value(BC_JSON * const item, parse_buffer * const input_buffer);
+static BC_JSON_bool print_value(const BC_JSON * const item, printbuffer * const output_buffer);
+static BC_JSON_bool parse_array(BC_JSON * const item, parse_buffer * const input_buffer);
+static BC_JSON_bool print_array(const BC_JSON * const item, printbuffer * const output_buffer);
+static BC_JSON_bool parse_object(BC_JSON * const item, parse_buffer * const input_buffer);
+static BC_JSON_bool print_object(const BC_JSON * const item, printbuffer * const output_buffer);
+
+/* Skip the comment at the offset, if there is one. A block comment without its end isn't skipped,
+ * so parsing fails at it. Like the input, comments end at a terminating zero. */
+static BC_JSON_bool skip_comment(parse_buffer * const buffer)
+{
+    const unsigned char *content = buffer->content;
+    size_t offset = buffer->offset;
+
+    if (cannot_access_at_index(buffer, 1) || (content[offset] != '/'))
+    {
+        return false;
+    }
+
+    if (content[offset + 1] == '/')
+    {
+        /* up to the end of the line, the line break is whitespace */
+        offset += static_strlen("//");
+        while ((offset < buffer->length) && (content[offset] != '\n') && (content[offset] != '\0'))
+        {
+            offset++;
+        }
+        buffer->offset = offset;
+
+        return true;
+    }
+
+    if (content[offset + 1] == '*')
+    {
+        for (offset += static_strlen("/*"); ((offset + 1) < buffer->length) && (content[offset] != '\0'); offset++)
+        {
+            if ((content[offset] == '*') && (content[offset + 1] == '/'))
+            {
+                buffer->offset = offset + static_strlen("*/");
+
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/* Utility to jump whitespace and cr/lf */
+static parse_buffer *buffer_skip_whitespace(parse_buffer * const buffer)
+{
+    if ((buffer == NULL) || (buffer->content == NULL))
+    {
+        return NULL;
+    }
+
+    if (cannot_access_at_index(buffer, 0))
+    {
+        return buffer;
+    }
+
+    for (;;)
+    {
+        while (can_access_at_index(buffer, 0) && (buffer_at_offset(buffer)[0] <= 32))
+        {
+            if (buffer->strict && (buffer_at_offset(buffer)[0] != ' ') && (buffer_at_offset(buffer)[0] != '\t') && (buffer_at_offset(buffer)[0] != '\n') && (buffer_at_offset(buffer)[0] != '\r'))
+            {
+                break; /* RFC 8259 only knows these four */
+            }
+           buffer->offset++;
+        }
+
+        if (!buffer->comments || !skip_comment(buffer))
+        {
+            break;
+        }
+        if (buffer->offset == buffer->length)
+        {
+            /* don't step back into a comment that ends the input */
+            return buffer;
+        }
+    }
+
+    if (buffer->offset == buffer->length)
+    {
+        buffer->offset--;
+    }
+
+    return buffer;
+}
+
+/* Check if the comma at the offset is a trailing one (if they are allowed), one with only whitespace
+ * (and comments) between it and the closing bracket of its array/object. The offset moves to the bracket then. */
+static BC_JSON_bool skip_trailing_comma(parse_buffer * const buffer, const unsigned char closing)
+{
+    const size_t comma = buffer->offset;
+
+    if (!buffer->trailing_commas)
+    {
+        return false;
+    }
+
+    buffer->offset++;
+    buffer_skip_whitespace(buffer);
+    if (can_access_at_index(buffer, 0) && (buffer_at_offset(buffer)[0] == closing))
+    {
+        return true;
+    }
+    buffer->offset = comma;
+
+    return false;
+}
+
+/* skip the UTF-8 BOM (byte order mark) if it is at the beginning of a buffer */
+static parse_buffer *skip_utf8_bom(parse_buffer * const buffer)
+{
+    if ((buffer == NULL) || (buffer->content == NULL) || (buffer->offset != 0))
+    {
+        return NULL;
+    }
+
+    if (can_access_at_index(buffer, 4) && (strncmp((const char*)buffer_at_offset(buffer), "\xEF\xBB\xBF", 3) == 0))
+    {
+        buffer->offset += 3;
+    }
+
+    return buffer;
+}
+
+CJSON_PUBLIC(BC_JSON *) BC_JSON_ParseWithOpts(const char *value, const char **return_parse_end, BC_JSON_bool require_null_terminated)
+{
+    size_t buffer_length;
+
+    if (NULL == value)
+    {
+        return NULL;
+    }
+
+    /* Adding null character size due to require_null_terminated. */
+    buffer_length = strlen(value) + sizeof("");
+
+    return BC_JSON_ParseWithLengthOpts(value, buffer_length, return_parse_end, require_null_terminated);
+}
+
+/* remember where parsing the buffer failed, for BC_JSON_GetErrorPtr */
+static void record_parse_error(const parse_buffer * const buffer, const char ** const return_parse_end)
+{
+    error local_error;
+    local_error.json = buffer->content;
+    local_error.position = 0;
+
+    if (buffer->offset < buffer->length)
+    {
+        local_error.position = buffer->offset;
+    }
+    else if (buffer->length > 0)
+    {
+        local_error.position = buffer->length - 1;
+    }
+
+    if (return_parse_end != NULL)
+    {
+        *return_parse_end = (const char*)local_error.json + local_error.position;
+    }
+
+    global_error = local_error;
+}
+
+/* Parse the content of a prepared parse buffer - create a new root, and populate. */
+static BC_JSON *parse_root(parse_buffer * const buffer, const char ** const return_parse_end, const BC_JSON_bool require_null_terminated)
+{
+    BC_JSON *item = NULL;
+
+    /* reset error position */
+    global_error.json = NULL;
+    global_error.position = 0;
+
+    if ((buffer->content == NULL) || (0 == buffer->length))
+    {
+        goto fail;
+    }
+
+    item = parse_new_item(buffer);
+    if (item == NULL) /* memory fail */
+    {
+        goto fail;
+    }
+
+    if (!parse_value(item, buffer_skip_whitespace(skip_utf8_bom(buffer))))
+    {
+        /* parse failure. ep is set. */
+        goto fail;
+    }
+
+    /* if we require null-terminated JSON without appended garbage, skip and then check for a null terminator */
+    if (require_null_terminated)
+    {
+        buffer_skip_whitespace(buffer);
+        if ((buffer->offset >= buffer->length) || buffer_at_offset(buffer)[0] != '\0')
+        {
+            goto fail;
+        }
+    }
+    if (return_parse_end)
+    {
+        *return_parse_end = (const char*)buffer_at_offset(buffer);
+    }
+
+    return item;
+
+fail:
+    if (item != NULL)
+    {
+        parse_delete(buffer, item);
+    }
+
+    if (buffer->content != NULL)
+    {
+        record_parse_error(buffer, return_parse_end);
+    }
+
+    return NULL;
+}
+
+/* Parse an object - create a new root, and populate. */
+CJSON_PUBLIC(BC_JSON *) BC_JSON_ParseWithLengthOpts(const char *value, size_t buffer_length, const char **return_parse_end, BC_JSON_bool require_null_terminated)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+
+    buffer.content = (const unsigned char*)value;
+    buffer.length = buffer_length;
+    buffer.offset = 0;
+    buffer.hooks = global_hooks;
+
+    return parse_root(&buffer, return_parse_end, require_null_terminated);
+}
+
+/* take over what the options ask of the parse itself */
+static void set_parse_options(parse_buffer * const buffer, const BC_JSON_ParseOptions * const options)
+{
+    buffer->shape_cache = options->shape_cache;
+    buffer->depth_limit = options->max_depth;
+    buffer->raw_depth = options->raw_depth;
+    buffer->check_utf8 = options->strict_utf8;
+    buffer->comments = options->allow_comments;
+    buffer->trailing_commas = options->allow_trailing_commas;
+}
+
+CJSON_PUBLIC(BC_JSON *) BC_JSON_ParseWithOptions(const char *value, size_t buffer_length, const BC_JSON_ParseOptions *options, const char **return_parse_end)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+    BC_JSON_bool require_null_terminated = false;
+
+    buffer.content = (const unsigned char*)value;
+    buffer.length = buffer_length;
+    buffer.offset = 0;
+    buffer.hooks = global_hooks;
+
+    if (options != NULL)
+    {
+        set_parse_options(&buffer, options);
+        require_null_terminated = options->require_null_terminated;
+    }
+
+    return parse_root(&buffer, return_parse_end, require_null_terminated);
+}
+
+/* Map a whole file, privately so that writing to it (writable) doesn't change the file. It is read
+ * front to back once (sequential), or here and there. Fails for files that can't be mapped, like
+ * empty files, pipes and devices. */
+static BC_JSON_bool map_file_text(const char * const path, const BC_JSON_bool writable, const BC_JSON_bool sequential, file_text * const text)
+{
+#if defined(CJSON_MMAP_POSIX)
+    struct stat status;
+    void *mapping = NULL;
+    int file = open(path, O_RDONLY);
+    if (file < 0)
+    {
+        return false;
+    }
+
+    if ((fstat(file, &status) != 0) || !S_ISREG(status.st_mode) || (status.st_size <= 0) || ((off_t)(size_t)status.st_size != status.st_size))
+    {
+        close(file);
+        return false;
+    }
+
+    mapping = mmap(NULL, (size_t)status.st_size, writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (mapping == MAP_FAILED)
+    {
+        return false;
+    }
+#if defined(POSIX_MADV_SEQUENTIAL)
+    posix_madvise(mapping, (size_t)status.st_size, sequential ? POSIX_MADV_SEQUENTIAL : POSIX_MADV_RANDOM);
+#elif defined(MADV_SEQUENTIAL)
+    madvise(mapping, (size_t)status.st_size, sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+#else
+    (void)sequential;
+#endif
+
+    text->content = (unsigned char*)mapping;
+    text->length = (size_t)status.st_size;
+    text->mapped = true;
+
+    return true;
+#elif defined(CJSON_MMAP_WIN32)
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS, NULL);
+    HANDLE mapping = NULL;
+    LARGE_INTEGER size;
+    void *view = NULL;
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    if (!GetFileSizeEx(file, &size) || (size.QuadPart <= 0) || ((ULONGLONG)size.QuadPart > (ULONGLONG)(size_t)-1))
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    /* the view keeps the mapping and the file open */
+    mapping = CreateFileMappingA(file, NULL, writable ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (mapping == NULL)
+    {
+        return false;
+    }
+    view = MapViewOfFile(mapping, writable ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (view == NULL)
+    {
+        return false;
+    }
+
+    text->content = (unsigned char*)view;
+    text->length = (size_t)size.QuadPart;
+    text->mapped = true;
+
+    return true;
+#else
+    (void)path;
+    (void)writable;
+    (void)sequential;
+    (void)text;
+
+    return false;
+#endif
+}
+
+/* Read a whole file into memory from the hooks, for files that can't be mapped. */
+static BC_JSON_bool read_file_text(const char * const path, file_text * const text)
+{
+    FILE *file = fopen(path, "rb");
+    unsigned char *content = NULL;
+    size_t capacity = 0;
+    size_t length = 0;
+    size_t read = 0;
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    do
+    {
+        if (length == capacity)
+        {
+            unsigned char *grown = NULL;
+            size_t new_capacity = (capacity == 0) ? 4096 : (capacity * 2);
+            if (new_capacity < capacity)
+            {
+                goto fail; /* overflow */
+            }
+
+            if ((content != NULL) && (global_hooks.reallocate != NULL))
+            {
+                grown = (unsigned char*)global_hooks.reallocate(content, new_capacity);
+            }
+            else
+            {
+                grown = (unsigned char*)global_hooks.allocate(new_capacity);
+                if ((grown != NULL) && (content != NULL))
+                {
+                    memcpy(grown, content, length);
+                    global_hooks.deallocate(content);
+                }
+            }
+            if (grown == NULL)
+            {
+                goto fail; /* allocation failure */
+            }
+            content = grown;
+            capacity = new_capacity;
+        }
+
+        read = fread(content + length, 1, capacity - length, file);
+        length += read;
+    } while (read > 0);
+
+    if (ferror(file))
+    {
+        goto fail;
+    }
+    fclose(file);
+
+    text->content = content;
+    text->length = length;
+    text->mapped = false;
+
+    return true;
+
+fail:
+    if (content != NULL)
+    {
+        global_hooks.deallocate(content);
+    }
+    fclose(file);
+
+    return false;
+}
+
+CJSON_PUBLIC(BC_JSON *) BC_JSON_ParseFile(const char *path, const BC_JSON_ParseOptions *options)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+    file_text text = { NULL, 0, false };
+    file_document *document = NULL;
+    BC_JSON *item = NULL;
+    const BC_JSON_bool zero_copy = (options != NULL) && options->zero_copy;
+
+    /* reset error position */
+    global_error.json = NULL;
+    global_error.position = 0;
+
+    if ((path == NULL) || (!map_file_text(path, zero_copy, true, &text) && !read_file_text(path, &text)))
+    {
+        return NULL;
+    }
+
+    buffer.content = text.content;
+    buffer.length = text.length;
+    buffer.offset = 0;
+    buffer.hooks = global_hooks;
+    if (zero_copy)
+    {
+        buffer.in_situ = text.content;
+    }
+
+    if (options != NULL)
+    {
+        set_parse_options(&buffer, options);
+    }
+
+    item = parse_root(&buffer, NULL, false);
+    if ((item != NULL) && (options != NULL) && options->require_null_terminated)
+    {
+        /* a file has no terminator, it has to end after the JSON */
+        buffer_skip_whitespace(&buffer);
+        if ((buffer.offset < buffer.length) && (buffer_at_offset(&buffer)[0] > 32))
+        {
+            BC_JSON_Delete(item);
+            item = NULL;
+        }
+    }
+
+    /* an error position would point into the text, which goes away */
+    global_error.json = NULL;
+    global_error.position = 0;
+
+    if ((item != NULL) && zero_copy)
+    {
+        document = (file_document*)global_hooks.allocate(sizeof(file_document));
+        if (document != NULL)
+        {
+            /* move the root into the document, nothing points to it yet */
+            memcpy(&document->item, item, sizeof(BC_JSON));
+            global_hooks.deallocate(item);
+            document->item.type |= BC_JSON_OwnsFile;
+            document->text = text;
+
+            return &document->item;
+        }
+
+        BC_JSON_Delete(item);
+        item = NULL;
+    }
+
+    release_file_text(&text);
+
+    return item;
+}
+
+/* alignment that is good enough for a BC_JSON node */
+typedef union
+{
+    double number;
+    void *pointer;
+    size_t size;
+} node_alignment;
+
+/* Point *string at the unescaped text of the string literal that starts at the current offset and
+ * ends at literal_end. Without escape sequences that is the literal itself, otherwise it's unescaped
+ * into the scratch buffer, which grows as needed and is reused for the following strings. */
+static BC_JSON_bool sax_string(const parse_buffer * const input_buffer, const unsigned char * const literal_end, const size_t length, const unsigned char ** const string, unsigned char ** const scratch, size_t * const scratch_size)
+{
+    const unsigned char *input_pointer = buffer_at_offset(input_buffer) + 1;
+
+    if (length == (size_t)(literal_end - input_pointer))
+    {
+        /* no escape sequences */
+        *string = input_pointer;
+        return true;
+    }
+
+    if (length > *scratch_size)
+    {
+        size_t new_size = (*scratch_size > 0) ? *scratch_size : 64;
+        while (new_size < length)
+        {
+            new_size *= 2;
+        }
+        if (*scratch != NULL)
+        {
+            input_buffer->hooks.deallocate(*scratch);
+        }
+        *scratch = (unsigned char*)input_buffer->hooks.allocate(new_size);
+        if (*scratch == NULL)
+        {
+            *scratch_size = 0;
+            return false;
+        }
+        *scratch_size = new_size;
+    }
+
+    /* the escape sequences were validated while measuring the literal */
+    if (unescape_string(&input_pointer, literal_end, *scratch) == NULL)
+    {
+        return false;
+    }
+    *string = *scratch;
+
+    return true;
+}
+
+static const BC_JSON_SaxHandlers no_sax_handlers = { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
+
+/* Walk a value the same way parse_value does without building nodes, report what's in it to the
+ * handlers on the way and, if there is a measurement, count the nodes and the string bytes that
+ * parsing it would allocate. Nothing is reported for the contents of skipped arrays/objects or for
+ * the values of skipped members, but they are still checked. Nesting is tracked in a bit set
+ * instead of on the call stack, so the stack usage doesn't depend on the input, and it continues
+ * the depth of the buffer, so a value inside arrays/objects has the same nesting limit as there. */
+static BC_JSON_bool walk_value(parse_buffer * const input_buffer, const BC_JSON_SaxHandlers * const handlers, void * const context, BC_JSON_Measurement * const measurement)
+{
+    /* one bit per nesting level below the one the walk starts at, set for objects and cleared for
+     * arrays, moved to the heap for parses that allow more than CJSON_NESTING_LIMIT levels */
+    unsigned char inline_levels[(CJSON_NESTING_LIMIT + CHAR_BIT - 1) / CHAR_BIT];
+    unsigned char *object_levels = inline_levels;
+    unsigned char *grown = NULL;
+    size_t capacity = sizeof(inline_levels);
+    size_t base_depth = 0;
+    const unsigned char *literal_end = NULL;
+    const unsigned char *string = NULL;
+    unsigned char *scratch = NULL;
+    size_t scratch_size = 0;
+    size_t length = 0;
+    double number = 0;
+    /* depth of the array/object whose contents are skipped, 0 if nothing is skipped */
+    size_t skip_depth = 0;
+    /* the value that comes next is skipped as a whole */
+    BC_JSON_bool skip_next = false;
+    /* the skipped array/object is a member value whose start wasn't reported, so its end isn't */
+    BC_JSON_bool skipping_member = false;
+    int action = BC_JSON_SaxContinue;
+    BC_JSON_bool success = false;
+
+#define in_object(depth) ((object_levels[((depth) - base_depth - 1) / CHAR_BIT] >> (((depth) - base_depth - 1) % CHAR_BIT)) & 1)
+/* call a handler unless it's missing or the event is skipped, a handler that stops ends the walk */
+#define sax_event(handler, arguments) \
+    action = BC_JSON_SaxContinue; \
+    if ((skip_depth == 0) && !skip_next && (handlers->handler != NULL)) \
+    { \
+        action = handlers->handler arguments; \
+        if (action == BC_JSON_SaxStop) \
+        { \
+            success = true; \
+            goto end; \
+        } \
+    }
+
+    if ((input_buffer == NULL) || (input_buffer->content == NULL))
+    {
+        return false; /* no input */
+    }
+    base_depth = input_buffer->depth;
+
+    for (;;)
+    {
+        if (measurement != NULL)
+        {
+            /* every value becomes one node */
+            measurement->node_count++;
+        }
+
+        if (can_read(input_buffer, 4) && (strncmp((const char*)buffer_at_offset(input_buffer), "null", 4) == 0))
+        {
+            sax_event(null, (context));
+            input_buffer->offset += 4;
+        }
+        else if (can_read(input_buffer, 5) && (strncmp((const char*)buffer_at_offset(input_buffer), "false", 5) == 0))
+        {
+            sax_event(boolean, (context, false));
+            input_buffer->offset += 5;
+        }
+        else if (can_read(input_buffer, 4) && (strncmp((const char*)buffer_at_offset(input_buffer), "true", 4) == 0))
+        {
+            sax_event(boolean, (context, true));
+            input_buffer->offset += 4;
+        }
+        else if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '\"'))
+        {
+            if (!string_literal_length(input_buffer, &literal_end, &length, true))
+            {
+                input_buffer->offset = string_error_offset(input_buffer);
+                goto end;
+            }
+            if (measurement != NULL)
+            {
+                measurement->string_bytes += length + sizeof("");
+            }
+            if ((skip_depth == 0) && !skip_next && (handlers->string != NULL))
+            {
+                if (!sax_string(input_buffer, literal_end, length, &string, &scratch, &scratch_size))
+                {
+                    goto end;
+                }
+                sax_event(string, (context, (const char*)string, length));
+            }
+            input_buffer->offset = (size_t)(literal_end - input_buffer->content) + 1;
+        }
+        else if (can_access_at_index(input_buffer, 0) && ((buffer_at_offset(input_buffer)[0] == '-') || ((buffer_at_offset(input_buffer)[0] >= '0') && (buffer_at_offset(input_buffer)[0] <= '9'))))
+        {
+            if ((measurement != NULL) || ((skip_depth == 0) && !skip_next && (handlers->number != NULL)))
+            {
+                if (!parse_number_value(input_buffer, &number, &length))
+                {
+                    goto end;
+                }
+                if (measurement != NULL)
+                {
+                    measurement->string_bytes += length;
+                }
+                sax_event(number, (context, number));
+            }
+            else if (!skip_number(input_buffer))
+            {
+                goto end;
+            }
+        }
+        else if (can_access_at_index(input_buffer, 0) && ((buffer_at_offset(input_buffer)[0] == '[') || (buffer_at_offset(input_buffer)[0] == '{')))
+        {
+            const size_t level = (input_buffer->depth - base_depth) / CHAR_BIT;
+            const unsigned char bit = (unsigned char)(1 << ((input_buffer->depth - base_depth) % CHAR_BIT));
+            const unsigned char closing = (buffer_at_offset(input_buffer)[0] == '[') ? ']' : '}';
+
+            if (input_buffer->depth >= nesting_limit(input_buffer))
+            {
+                goto end; /* to deeply nested */
+            }
+            if (level == capacity)
+            {
+                grown = (unsigned char*)grow_walk_stack((void*)object_levels, &capacity, sizeof(unsigned char), (const void*)inline_levels);
+                if (grown == NULL)
+                {
+                    goto end;
+                }
+                object_levels = grown;
+            }
+            if (closing == '}')
+            {
+                sax_event(start_object, (context));
+                object_levels[level] = (unsigned char)(object_levels[level] | bit);
+            }
+            else
+            {
+                sax_event(start_array, (context));
+                object_levels[level] = (unsigned char)(object_levels[level] & ~bit);
+            }
+            input_buffer->depth++;
+            if ((skip_depth == 0) && (skip_next || (action == BC_JSON_SaxSkip)))
+            {
+                skip_depth = input_buffer->depth;
+                skipping_member = skip_next;
+            }
+            skip_next = false;
+
+            input_buffer->offset++;
+            buffer_skip_whitespace(input_buffer);
+            if (cannot_access_at_index(input_buffer, 0))
+            {
+                input_buffer->offset--;
+                goto end;
+            }
+            if (buffer_at_offset(input_buffer)[0] != closing)
+            {
+                if (closing == ']')
+                {
+                    continue; /* first element */
+                }
+                /* the first key is handled like the ones following a comma */
+                input_buffer->offset--;
+                goto object_member;
+            }
+            /* empty array or object, closed below */
+        }
+        else
+        {
+            goto end;
+        }
+        /* a skipped member value is over once the value is */
+        skip_next = false;
+
+        /* close the finished arrays/objects until there is a next element */
+        while (input_buffer->depth > base_depth)
+        {
+            buffer_skip_whitespace(input_buffer);
+            if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ',') && !skip_trailing_comma(input_buffer, in_object(input_buffer->depth) ? '}' : ']'))
+            {
+                if (in_object(input_buffer->depth))
+                {
+                    goto object_member;
+                }
+                input_buffer->offset++;
+                buffer_skip_whitespace(input_buffer);
+                break;
+            }
+
+            if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != (in_object(input_buffer->depth) ? '}' : ']')))
+            {
+                goto end; /* expected end of array/object */
+            }
+            if (skip_depth == input_buffer->depth)
+            {
+                /* the skipped array/object ends here, and so does skipping */
+                skip_depth = 0;
+                skip_next = skipping_member;
+            }
+            if (in_object(input_buffer->depth))
+            {
+                sax_event(end_object, (context));
+            }
+            else
+            {
+                sax_event(end_array, (context));
+            }
+            skip_next = false;
+            input_buffer->offset++;
+            input_buffer->depth--;
+        }
+
+        if (input_buffer->depth == base_depth)
+        {
+            success = true;
+            goto end;
+        }
+        continue;
+
+object_member:
+        /* the offset is at the character in front of the key */
+        if (cannot_access_at_index(input_buffer, 1))
+        {
+            goto end; /* nothing comes after the comma */
+        }
+        input_buffer->offset++;
+        buffer_skip_whitespace(input_buffer);
+        if ((buffer_at_offset(input_buffer)[0] != '\"') || !string_literal_length(input_buffer, &literal_end, &length, true))
+        {
+            input_buffer->offset = string_error_offset(input_buffer);
+            goto end; /* failed to parse name */
+        }
+        if (measurement != NULL)
+        {
+            measurement->string_bytes += length + sizeof("");
+        }
+        if ((skip_depth == 0) && (handlers->key != NULL))
+        {
+            if (!sax_string(input_buffer, literal_end, length, &string, &scratch, &scratch_size))
+            {
+                goto end;
+            }
+            sax_event(key, (context, (const char*)string, length));
+            skip_next = (action == BC_JSON_SaxSkip);
+        }
+        input_buffer->offset = (size_t)(literal_end - input_buffer->content) + 1;
+        buffer_skip_whitespace(input_buffer);
+
+        if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != ':'))
+        {
+            goto end; /* invalid object */
+        }
+        input_buffer->offset++;
+        buffer_skip_whitespace(input_buffer);
+    }
+
+end:
+    if (scratch != NULL)
+    {
+        input_buffer->hooks.deallocate(scratch);
+    }
+    if (object_levels != inline_levels)
+    {
+        global_hooks.deallocate(object_levels);
+    }
+
+    return success;
+
+#undef sax_event
+#undef in_object
+}
+
+/* Walk a value without reporting anything, only counting the nodes and the string bytes that parsing it would allocate. */
+static BC_JSON_bool measure_value(parse_buffer * const input_buffer, BC_JSON_Measurement * const measurement)
+{
+    return walk_value(input_buffer, &no_sax_handlers, NULL, measurement);
+}
+
+CJSON_PUBLIC(BC_JSON_bool) BC_JSON_ParseMeasure(const char *value, size_t buffer_length, BC_JSON_Measurement *measurement)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+
+    /* reset error position */
+    global_error.json = NULL;
+    global_error.position = 0;
+
+    if (measurement == NULL)
+    {
+        return false;
+    }
+    measurement->node_count = 0;
+    measurement->string_bytes = 0;
+    measurement->buffer_size = 0;
+
+    if ((value == NULL) || (0 == buffer_length))
+    {
+        return false;
+    }
+
+    buffer.content = (const unsigned char*)value;
+    buffer.length = buffer_length;
+    buffer.offset = 0;
+    buffer.hooks = global_hooks;
+
+    if (!measure_value(buffer_skip_whitespace(skip_utf8_bom(&buffer)), measurement))
+    {
+        record_parse_error(&buffer, NULL);
+        return false;
+    }
+
+    /* BC_JSON_ParseIntoBuffer aligns the nodes inside the block, which can take up to all but one
+     * byte of a node_alignment if the block isn't aligned */
+    measurement->buffer_size = (sizeof(node_alignment) - 1) + (measurement->node_count * sizeof(BC_JSON)) + measurement->string_bytes;
+
+    return true;
+}
+
+CJSON_PUBLIC(BC_JSON_bool) BC_JSON_SaxParse(const char *value, size_t buffer_length, const BC_JSON_SaxHandlers *handlers, void *context)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+
+    /* reset error position */
+    global_error.json = NULL;
+    global_error.position = 0;
+
+    if ((value == NULL) || (handlers == NULL))
+    {
+        return false;
+    }
+
+    buffer.content = (const unsigned char*)value;
+    buffer.length = buffer_length;
+    buffer.offset = 0;
+    buffer.hooks = global_hooks;
+
+    /* like BC_JSON_ParseWithLength, empty input is an error at its start */
+    if ((0 == buffer_length) || !walk_value(buffer_skip_whitespace(skip_utf8_bom(&buffer)), handlers, context, NULL))
+    {
+        record_parse_error(&buffer, NULL);
+        return false;
+    }
+
+    return true;
+}
+
+/* Move past the value at the offset, checking it like parse_value does, without building nodes,
+ * unescaping strings or converting numbers. */
+static BC_JSON_bool skip_value(parse_buffer * const input_buffer)
+{
+    return walk_value(input_buffer, &no_sax_handlers, NULL, NULL);
+}
+
+CJSON_PUBLIC(BC_JSON_bool) BC_JSON_Validate(const char *value, size_t buffer_length, const char **error_position)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+
+    /* reset error position */
+    global_error.json = NULL;
+    global_error.position = 0;
+
+    if (error_position != NULL)
+    {
+        *error_position = NULL;
+    }
+
+    if ((value == NULL) || (0 == buffer_length))
+    {
+        if (error_position != NULL)
+        {
+            *error_position = value;
+        }
+        return false;
+    }
+
+    buffer.content = (const unsigned char*)value;
+    buffer.length = buffer_length;
+    buffer.offset = 0;
+    buffer.hooks = global_hooks;
+    buffer.check_utf8 = true;
+    buffer.strict = true;
+
+    if (!skip_value(buffer_skip_whitespace(skip_utf8_bom(&buffer))))
+    {
+        goto fail;
+    }
+
+    /* only whitespace may follow, up to the end of the buffer or a terminating zero */
+    while ((buffer.offset < buffer.length) && (buffer_at_offset(&buffer)[0] != '\0'))
+    {
+        if ((buffer_at_offset(&buffer)[0] != ' ') && (buffer_at_offset(&buffer)[0] != '\t') && (buffer_at_offset(&buffer)[0] != '\n') && (buffer_at_offset(&buffer)[0] != '\r'))
+        {
+            goto fail;
+        }
+        buffer.offset++;
+    }
+
+    return true;
+
+fail:
+    record_parse_error(&buffer, error_position);
+
+    return false;
+}
+
+/* A token of a path of BC_JSON_ParseProjected, with ~0 and ~1 decoded. */
+typedef struct
+{
+    const char *name;
+    size_t length;
+    size_t index; /* the array index the token stands for, or (size_t)-1 if it isn't one */
+    BC_JSON_bool wildcard;
+} path_token;
+
+typedef struct
+{
+    path_token *tokens; /* the tokens of all paths, one path after the other */
+    size_t *path_start; /* where the tokens of each path start, and where the last one ends */
+    size_t *matched; /* how many tokens of each path the value that is being parsed matches */
+    size_t count;
+    char *names; /* the decoded names of the tokens */
+    unsigned char *scratch; /* for keys with escape sequences */
+    size_t scratch_size;
+} path_projection;
+
+/* the number of tokens in path number i of a projection */
+#define path_length(projection, i) ((projection)->path_start[(i) + 1] - (projection)->path_start[(i)])
+
+static void delete_projection(path_projection * const projection)
+{
+    if (projection->tokens != NULL)
+    {
+        global_hooks.deallocate(projection->tokens);
+    }
+    if (projection->path_start != NULL)
+    {
+        global_hooks.deallocate(projection->path_start);
+    }
+    if (projection->matched != NULL)
+    {
+        global_hooks.deallocate(projection->matched);
+    }
+    if (projection->names != NULL)
+    {
+        global_hooks.deallocate(projection->names);
+    }
+    if (projection->scratch != NULL)
+    {
+        global_hooks.deallocate(projection->scratch);
+    }
+}
+
+/* Split the paths into tokens. A path is empty or a JSON pointer, anything else is an error. */
+static BC_JSON_bool create_projection(path_projection * const projection, const char * const * const paths, const size_t count)
+{
+    size_t token_count = 0;
+    size_t name_size = 0;
+    size_t token = 0;
+    char *name = NULL;
+    size_t i = 0;
+
+    for (i = 0; i < count; i++)
+    {
+        const char *path = paths[i];
+        if ((path == NULL) || ((path[0] != '\0') && (path[0] != '/')))
+        {
+            return false;
+        }
+        for (; *path != '\0'; path++)
+        {
+            if (*path == '/')
+            {
+                token_count++;
+            }
+        }
+        name_size += (size_t)(path - paths[i]);
+    }
+
+    projection->count = count;
+    projection->tokens = (path_token*)global_hooks.allocate((token_count + 1) * sizeof(path_token));
+    projection->path_start = (size_t*)global_hooks.allocate((count + 1) * sizeof(size_t));
+    projection->matched = (size_t*)global_hooks.allocate((count + 1) * sizeof(size_t));
+    projection->names = (char*)global_hooks.allocate(name_size + 1);
+    if ((projection->tokens == NULL) || (projection->path_start == NULL) || (projection->matched == NULL) || (projection->names == NULL))
+    {
+        return false;
+    }
+
+    name = projection->names;
+    for (i = 0; i < count; i++)
+    {
+        const char *path = paths[i];
+
+        projection->path_start[i] = token;
+        projection->matched[i] = 0;
+        while (*path == '/')
+        {
+            path_token *current = &projection->tokens[token++];
+            const char *digits = NULL;
+
+            current->name = name;
+            for (path++; (*path != '\0') && (*path != '/'); path++)
+            {
+                if (*path != '~')
+                {
+                    *name++ = *path;
+                }
+                else if ((path[1] == '0') || (path[1] == '1'))
+                {
+                    *name++ = (path[1] == '0') ? '~' : '/';
+                    path++;
+                }
+                else
+                {
+                    return false; /* invalid escape sequence */
+                }
+            }
+            current->length = (size_t)(name - current->name);
+            current->wildcard = (current->length == 1) && (current->name[0] == '*');
+
+            /* array indices are decimal, without leading zeros */
+            current->index = (size_t)-1;
+            if ((current->length > 0) && ((current->name[0] != '0') || (current->length == 1)))
+            {
+                size_t index = 0;
+                for (digits = current->name; digits < name; digits++)
+                {
+                    if ((*digits < '0') || (*digits > '9') || (index > (((size_t)-1 - 9) / 10)))
+                    {
+                        break;
+                    }
+                    index = (index * 10) + (size_t)(*digits - '0');
+                }
+                if (digits == name)
+                {
+                    current->index = index;
+                }
+            }
+        }
+    }
+    projection->path_start[count] = token;
+
+    return true;
+}
+
+/* Build what the paths that match up to depth select from the value at the offset: all of it if
+ * one of them ends there, otherwise the array/object with only the selected elements in it. A value
+ * that isn't an array or object selects nothing then, it is skipped and *result is NULL. */
+static BC_JSON_bool project_value(parse_buffer * const input_buffer, path_projection * const projection, const size_t depth, BC_JSON ** const result)
+{
+    BC_JSON *item = NULL;
+    BC_JSON *child = NULL;
+    const unsigned char *key = NULL;
+    const unsigned char *literal_end = NULL;
+    size_t key_length = 0;
+    size_t index = 0;
+    size_t i = 0;
+    BC_JSON_bool object = false;
+    BC_JSON_bool complete = false;
+    BC_JSON_bool selected = false;
+
+    *result = NULL;
+
+    if (cannot_access_at_index(input_buffer, 0))
+    {
+        return false;
+    }
+    object = (buffer_at_offset(input_buffer)[0] == '{');
+
+    for (i = 0; i < projection->count; i++)
+    {
+        if ((projection->matched[i] == depth) && (path_length(projection, i) == depth))
+        {
+            complete = true;
+        }
+    }
+
+    if (!object && (buffer_at_offset(input_buffer)[0] != '['))
+    {
+        if (!complete && (depth > 0))
+        {
+            return skip_value(input_buffer);
+        }
+        /* the root is always part of the result */
+        complete = true;
+    }
+
+    item = parse_new_item(input_buffer);
+    if (item == NULL)
+    {
+        return false; /* allocation failure */
+    }
+
+    if (complete)
+    {
+        if (!parse_value(item, input_buffer))
+        {
+            goto fail;
+        }
+        *result = item;
+        return true;
+    }
+
+    if (input_buffer->depth >= CJSON_NESTING_LIMIT)
+    {
+        goto fail; /* to deeply nested */
+    }
+    input_buffer->depth++;
+    item->type = object ? BC_JSON_Object : BC_JSON_Array;
+
+    input_buffer->offset++;
+    buffer_skip_whitespace(input_buffer);
+    if (cannot_access_at_index(input_buffer, 0))
+    {
+        input_buffer->offset--;
+        goto fail;
+    }
+    if (buffer_at_offset(input_buffer)[0] != (object ? '}' : ']'))
+    {
+        /* the offset is at the character in front of the next element */
+        input_buffer->offset--;
+        for (index = 0; ; index++)
+        {
+            if (cannot_access_at_index(input_buffer, 1))
+            {
+                goto fail; /* nothing comes after the comma */
+            }
+            input_buffer->offset++;
+            buffer_skip_whitespace(input_buffer);
+
+            if (object)
+            {
+                if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != '\"')
+                    || !string_literal_length(input_buffer, &literal_end, &key_length, true)
+                    || !sax_string(input_buffer, literal_end, key_length, &key, &projection->scratch, &projection->scratch_size))
+                {
+                    goto fail; /* failed to parse name */
+                }
+                input_buffer->offset = (size_t)(literal_end - input_buffer->content) + 1;
+                buffer_skip_whitespace(input_buffer);
+                if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != ':'))
+                {
+                    goto fail; /* invalid object */
+                }
+                input_buffer->offset++;
+                buffer_skip_whitespace(input_buffer);
+            }
+
+            /* the paths that continue with this element */
+            selected = false;
+            for (i = 0; i < projection->count; i++)
+            {
+                const path_token *token = &projection->tokens[projection->path_start[i] + depth];
+                if ((projection->matched[i] != depth) || (path_length(projection, i) == depth))
+                {
+                    continue;
+                }
+                if (token->wildcard || (object ? ((token->length == key_length) && (memcmp(token->name, key, key_length) == 0)) : (token->index == index)))
+                {
+                    projection->matched[i] = depth + 1;
+                    selected = true;
+                }
+            }
+
+            if (!selected)
+            {
+                if (!skip_value(input_buffer))
+                {
+                    goto fail;
+                }
+            }
+            else
+            {
+                char *name = NULL;
+                BC_JSON_bool success = false;
+
+                if (object)
+                {
+                    /* the key may be in the scratch buffer, which the element needs itself */
+                    name = (char*)parse_allocate(input_buffer, key_length + sizeof(""));
+                    if (name == NULL)
+                    {
+                        goto fail; /* allocation failure */
+                    }
+                    memcpy(name, key, key_length);
+                    name[key_length] = '\0';
+                }
+
+                success = project_value(input_buffer, projection, depth + 1, &child);
+                for (i = 0; i < projection->count; i++)
+                {
+                    if (projection->matched[i] == (depth + 1))
+                    {
+                        projection->matched[i] = depth;
+                    }
+                }
+
+                if (!success || (child == NULL))
+                {
+                    if (name != NULL)
+                    {
+                        parse_deallocate(input_buffer, name);
+                    }
+                    if (!success)
+                    {
+                        goto fail;
+                    }
+                }
+                else
+                {
+                    /* append to the elements, the last one is child->prev of the first */
+                    child->string = name;
+                    if (item->child == NULL)
+                    {
+                        item->child = child;
+                    }
+                    else
+                    {
+                        item->child->prev->next = child;
+                        child->prev = item->child->prev;
+                    }
+                    item->child->prev = child;
+                }
+            }
+
+            buffer_skip_whitespace(input_buffer);
+            if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ','))
+            {
+                continue;
+            }
+            if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != (object ? '}' : ']')))
+            {
+                goto fail; /* expected end of array/object */
+            }
+            break;
+        }
+    }
+
+    input_buffer->offset++;
+    input_buffer->depth--;
+    *result = item;
+
+    return true;
+
+fail:
+    parse_delete(input_buffer, item);
+
+    return false;
+}
+
+#undef path_length
+
+CJSON_PUBLIC(BC_JSON *) BC_JSON_ParseProjected(const char *value, size_t buffer_length, const char * const *paths, size_t path_count)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+    path_projection projection;
+    BC_JSON *item = NULL;
+
+    /* reset error position */
+    global_error.json = NULL;
+    global_error.position = 0;
+
+    if ((value == NULL) || (0 == buffer_length) || ((paths == NULL) && (path_count > 0)))
+    {
+        return NULL;
+    }
+
+    memset(&projection, '\0', sizeof(projection));
+    if (!create_projection(&projection, paths, path_count))
+    {
+        delete_projection(&projection);
+        return NULL;
+    }
+
+    buffer.content = (const unsigned char*)value;
+    buffer.length = buffer_length;
+    buffer.offset = 0;
+    buffer.hooks = global_hooks;
+
+    if (!project_value(buffer_skip_whitespace(skip_utf8_bom(&buffer)), &projection, 0, &item))
+    {
+        record_parse_error(&buffer, NULL);
+        item = NULL;
+    }
+    delete_projection(&projection);
+
+    return item;
+}
+
+CJSON_PUBLIC(BC_JSON *) BC_JSON_ParseIntoBuffer(const char *value, size_t buffer_length, void *block, size_t block_size)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+    parse_arena arena;
+    size_t misalignment = 0;
+
+    if ((block == NULL) || (value == NULL))
+    {
+        /* reset error position */
+        global_error.json = NULL;
+        global_error.position = 0;
+        return NULL;
+    }
+
+    /* nodes are carved from the front of the block, so it has to be aligned for them */
+    misalignment = (size_t)block % sizeof(node_alignment);
+    if (misalignment != 0)
+    {
+        misalignment = sizeof(node_alignment) - misalignment;
+        if (misalignment > block_size)
+        {
+            misalignment = block_size;
+        }
+    }
+
+    arena.nodes = (unsigned char*)block + misalignment;
+    arena.strings = (unsigned char*)block + block_size;
+
+    buffer.content = (const unsigned char*)value;
+    buffer.length = buffer_length;
+    buffer.offset = 0;
+    buffer.hooks = global_hooks;
+    buffer.arena = &arena;
+
+    return parse_root(&buffer, NULL, false);
+}
+
+/* Flatten a document into a list of its nodes linked through next, without recursion.
+ * The children of every node are spliced in right after it, so the list is in document order.
+ * Memory the document doesn't own (references and constant keys) is dropped from the nodes. */
+static BC_JSON *recycle_items(BC_JSON *item)
+{
+    BC_JSON *current = NULL;
+
+    for (current = item; current != NULL; current = current->next)
+    {
+        if (current->type & BC_JSON_IsReference)
+        {
+            current->child = NULL;
+            current->value_string = NULL;
+        }
+        if (current->type & BC_JSON_StringIsConst)
+        {
+            current->string = NULL;
+        }
+        /* the index of an array/object isn't a string buffer that can be reused */
+        if (has_container_index(current))
+        {
+            global_hooks.deallocate(current->index);
+            current->index = NULL;
+        }
+        current->type &= ~BC_JSON_IsFrozen;
+        if (current->type & BC_JSON_OwnsFile)
+        {
+            /* the strings pointing into the text were dropped above, the node is reused like any other */
+            release_file_text(&((file_document*)current)->text);
+            current->type &= ~BC_JSON_OwnsFile;
+        }
+
+        if (current->child != NULL)
+        {
+            BC_JSON *last = current->child;
+            while (last->next != NULL)
+            {
+                last = last->next;
+            }
+
+            last->next = current->next;
+            current->next = current->child;
+            current->child = NULL;
+        }
+    }
+
+    return item;
+}
+
+CJSON_PUBLIC(BC_JSON *) BC_JSON_ParseReuse(BC_JSON **doc, const char *value, size_t buffer_length)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+    parse_pool pool;
+    BC_JSON *item = NULL;
+    size_t index = 0;
+
+    if (doc == NULL)
+    {
+        return BC_JSON_ParseWithLength(value, buffer_length);
+    }
+
+    memset(&pool, '\0', sizeof(pool));
+    pool.items = recycle_items(*doc);
+    *doc = NULL;
+
+    buffer.content = (const unsigned char*)value;
+    buffer.length = buffer_length;
+    buffer.offset = 0;
+    buffer.hooks = global_hooks;
+    buffer.pool = &pool;
+
+    item = parse_root(&buffer, NULL, false);
+
+    /* release whatever this document didn't need */
+    BC_JSON_Delete(pool.items);
+    for (index = 0; index < pool.spare_count; index++)
+    {
+        global_hooks.deallocate(pool.spare_strings[index]);
+    }
+
+    *doc = item;
+
+    return item;
+}
+
+/* A top level array that is parsed one element at a time, the elements are built from the nodes and
+ * strings of the ones handed back. */
+struct BC_JSON_ArrayStream
+{
+    parse_buffer buffer; /* at the opening bracket or behind the last element that was read */
+    parse_pool pool;
+    BC_JSON_bool started; /* an element was read */
+    BC_JSON_bool finished; /* the end of the array or an error was reached */
+};
+
+/* Follow the tokens of the path from the value at the offset down to the array they lead to,
+ * the offset is at its opening bracket then. Values on the way are skipped, but checked. */
+static BC_JSON_bool find_stream_array(parse_buffer * const input_buffer, path_projection * const path)
+{
+    const unsigned char *key = NULL;
+    const unsigned char *literal_end = NULL;
+    size_t key_length = 0;
+    size_t token = 0;
+    size_t index = 0;
+    BC_JSON_bool object = false;
+
+    for (token = 0; token < path->path_start[1]; token++)
+    {
+        const path_token *current = &path->tokens[token];
+
+        if (cannot_access_at_index(input_buffer, 0) || ((buffer_at_offset(input_buffer)[0] != '{') && (buffer_at_offset(input_buffer)[0] != '[')))
+        {
+            return false; /* the path goes on, but the value isn't an array/object */
+        }
+        object = (buffer_at_offset(input_buffer)[0] == '{');
+
+        input_buffer->offset++;
+        if (cannot_access_at_index(input_buffer, 0))
+        {
+            return false;
+        }
+        buffer_skip_whitespace(input_buffer);
+        for (index = 0; ; index++)
+        {
+            if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] == (object ? '}' : ']')))
+            {
+                return false; /* there is no such member/element */
+            }
+
+            key_length = 0;
+            if (object)
+            {
+                if ((buffer_at_offset(input_buffer)[0] != '\"')
+                    || !string_literal_length(input_buffer, &literal_end, &key_length, true)
+                    || !sax_string(input_buffer, literal_end, key_length, &key, &path->scratch, &path->scratch_size))
+                {
+                    return false; /* failed to parse name */
+                }
+                input_buffer->offset = (size_t)(literal_end - input_buffer->content) + 1;
+                buffer_skip_whitespace(input_buffer);
+                if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != ':'))
+                {
+                    return false; /* invalid object */
+                }
+                input_buffer->offset++;
+                buffer_skip_whitespace(input_buffer);
+            }
+
+            if (object ? ((current->length == key_length) && (memcmp(current->name, key, key_length) == 0)) : (current->index == index))
+            {
+                break;
+            }
+
+            if (!skip_value(input_buffer))
+            {
+                return false;
+            }
+            buffer_skip_whitespace(input_buffer);
+            if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != ','))
+            {
+                return false; /* the end of the array/object, or it is invalid */
+            }
+            input_buffer->offset++;
+            buffer_skip_whitespace(input_buffer);
+        }
+    }
+
+    return can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '[');
+}
+
+CJSON_PUBLIC(BC_JSON_ArrayStream *) BC_JSON_ArrayStream_Open(const char *value, size_t buffer_length, const char *pointer)
+{
+    path_projection path;
+    BC_JSON_ArrayStream *stream = NULL;
+
+    /* reset error position */
+    global_error.json = NULL;
+    global_error.position = 0;
+
+    if ((value == NULL) || (0 == buffer_length))
+    {
+        return NULL;
+    }
+
+    memset(&path, '\0', sizeof(path));
+    if (pointer == NULL)
+    {
+        pointer = ""; /* the root */
+    }
+    if (!create_projection(&path, &pointer, 1))
+    {
+        delete_projection(&path);
+        return NULL;
+    }
+
+    stream = (BC_JSON_ArrayStream*)global_hooks.allocate(sizeof(BC_JSON_ArrayStream));
+    if (stream == NULL)
+    {
+        delete_projection(&path);
+        return NULL;
+    }
+    memset(stream, '\0', sizeof(BC_JSON_ArrayStream));
+
+    stream->buffer.content = (const unsigned char*)value;
+    stream->buffer.length = buffer_length;
+    stream->buffer.offset = 0;
+    stream->buffer.hooks = global_hooks;
+    stream->buffer.pool = &stream->pool;
+
+    if (!find_stream_array(buffer_skip_whitespace(skip_utf8_bom(&stream->buffer)), &path))
+    {
+        record_parse_error(&stream->buffer, NULL);
+        delete_projection(&path);
+        global_hooks.deallocate(stream);
+        return NULL;
+    }
+    /* the elements are nested as deeply as they are in the document */
+    stream->buffer.depth = path.path_start[1] + 1;
+    stream->buffer.offset++;
+    delete_projection(&path);
+
+    return stream;
+}
+
+CJSON_PUBLIC(BC_JSON *) BC_JSON_ArrayStream_Next(BC_JSON_ArrayStream *stream, BC_JSON *recycled)
+{
+    parse_buffer *buffer = NULL;
+    BC_JSON *item = NULL;
+
+    /* reset error position */
+    global_error.json = NULL;
+    global_error.position = 0;
+
+    if (stream == NULL)
+    {
+        BC_JSON_Delete(recycled);
+        return NULL;
+    }
+    if (recycled != NULL)
+    {
+        BC_JSON *last = recycle_items(recycled);
+        while (last->next != NULL)
+        {
+            last = last->next;
+        }
+        last->next = stream->pool.items;
+        stream->pool.items = recycled;
+    }
+    if (stream->finished)
+    {
+        return NULL;
+    }
+
+    buffer = buffer_skip_whitespace(&stream->buffer);
+    if (cannot_access_at_index(buffer, 0))
+    {
+        goto fail;
+    }
+    if (buffer_at_offset(buffer)[0] == ']')
+    {
+        /* the end, what comes after the array isn't looked at */
+        buffer->offset++;
+        stream->finished = true;
+        return NULL;
+    }
+    if (stream->started)
+    {
+        if (buffer_at_offset(buffer)[0] != ',')
+        {
+            goto fail; /* expected end of array */
+        }
+        buffer->offset++;
+        buffer_skip_whitespace(buffer);
+    }
+
+    item = parse_new_item(buffer);
+    if (item == NULL)
+    {
+        goto fail; /* allocation failure */
+    }
+    if (!parse_value(item, buffer))
+    {
+        goto fail;
+    }
+    stream->started = true;
+
+    return item;
+
+fail:
+    if (item != NULL)
+    {
+        parse_delete(buffer, item);
+    }
+    record_parse_error(buffer, NULL);
+    stream->finished = true;
+
+    return NULL;
+}
+
+CJSON_PUBLIC(void) BC_JSON_ArrayStream_Close(BC_JSON_ArrayStream *stream)
+{
+    size_t index = 0;
+
+    if (stream == NULL)
+    {
+        return;
+    }
+
+    BC_JSON_Delete(stream->pool.items);
+    for (index = 0; index < stream->pool.spare_count; index++)
+    {
+        global_hooks.deallocate(stream->pool.spare_strings[index]);
+    }
+    global_hooks.deallocate(stream);
+}
+
+/* A sidecar index of a JSON file, written by BC_JSON_WriteIndex. Numbers are little endian. It starts
+ * with INDEX_MAGIC, the version (4 bytes), the number of levels (4), the length (8) and checksum (4)
+ * of the file and the number of entries of every level (8 each). Then come the entries of level 0
+ * (the root), those of level 1 (its elements/members) and so on, INDEX_ENTRY_SIZE bytes each: where
+ * the value is (8), or its key for a member of an object, the index of its first element/member in
+ * the next level (8) and hash_key of its key (4, 0 for elements of arrays). The elements of a value
+ * are next to each other in their level, up to where those of the entry after it start. */
+#define INDEX_MAGIC "BCJSONIX"
+#define INDEX_VERSION 1
+#define INDEX_HEADER_SIZE 28
+#define INDEX_ENTRY_SIZE 20
+#define INDEX_HASH_MASK 0xFFFFFFFFUL
+
+typedef struct
+{
+    size_t offset;
+    size_t first_child;
+    size_t key_hash;
+} index_entry;
+
+typedef struct
+{
+    index_entry *entries;
+    size_t count;
+    size_t capacity;
+} index_level;
+
+/* an index while it is built */
+typedef struct
+{
+    index_level *levels;
+    size_t level_count;
+    unsigned char *scratch; /* for keys with escape sequences */
+    size_t scratch_size;
+} file_index;
+
+struct BC_JSON_IndexedFile
+{
+    file_text text;
+    file_text index;
+    size_t level_count;
+    size_t level_start[CJSON_NESTING_LIMIT + 2]; /* the entries in front of each level, and all of them at the end */
+};
+
+static void put_index_number(unsigned char * const output, size_t number, const size_t size)
+{
+    size_t index = 0;
+
+    for (index = 0; index < size; index++)
+    {
+        output[index] = (unsigned char)(number & 0xFF);
+        number >>= 8;
+    }
+}
+
+/* fails for numbers that don't fit in a size_t */
+static BC_JSON_bool get_index_number(const unsigned char * const input, const size_t size, size_t * const number)
+{
+    size_t index = size;
+
+    *number = 0;
+    while (index > 0)
+    {
+        index--;
+        if (*number > ((size_t)-1 >> 8))
+        {
+            return false;
+        }
+        *number = (*number << 8) | input[index];
+    }
+
+    return true;
+}
+
+/* FNV-1a of a file, to tell if an index was written for it */
+static size_t file_checksum(const file_text * const text)
+{
+    size_t checksum = 2166136261UL;
+    size_t index = 0;
+
+    for (index = 0; index < text->length; index++)
+    {
+        checksum = ((checksum ^ text->content[index]) * 16777619UL) & INDEX_HASH_MASK;
+    }
+
+    return checksum;
+}
+
+static BC_JSON_bool add_index_entry(file_index * const index, const size_t level, const size_t offset, const size_t key_hash)
+{
+    index_level *entries = &index->levels[level];
+    index_entry *entry = NULL;
+
+    if (entries->count == entries->capacity)
+    {
+        index_entry *grown = NULL;
+        size_t new_capacity = (entries->capacity == 0) ? 64 : (entries->capacity * 2);
+        if (new_capacity > ((size_t)-1 / sizeof(index_entry)))
+        {
+            return false; /* overflow */
+        }
+
+        if ((entries->entries != NULL) && (global_hooks.reallocate != NULL))
+        {
+            grown = (index_entry*)global_hooks.reallocate(entries->entries, new_capacity * sizeof(index_entry));
+        }
+        else
+        {
+            grown = (index_entry*)global_hooks.allocate(new_capacity * sizeof(index_entry));
+            if ((grown != NULL) && (entries->entries != NULL))
+            {
+                memcpy(grown, entries->entries, entries->count * sizeof(index_entry));
+                global_hooks.deallocate(entries->entries);
+            }
+        }
+        if (grown == NULL)
+        {
+            return false; /* allocation failure */
+        }
+        entries->entries = grown;
+        entries->capacity = new_capacity;
+    }
+
+    entry = &entries->entries[entries->count++];
+    entry->offset = offset;
+    /* its elements/members are added to the next level from here on */
+    entry->first_child = ((level + 1) < index->level_count) ? index->levels[level + 1].count : 0;
+    entry->key_hash = key_hash;
+
+    return true;
+}
+
+/* Move from the key of a member at the offset to its value, decoding the key into *key. */
+static BC_JSON_bool skip_member_key(parse_buffer * const input_buffer, const unsigned char ** const key, size_t * const key_length, unsigned char ** const scratch, size_t * const scratch_size)
+{
+    const unsigned char *literal_end = NULL;
+
+    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != '\"')
+        || !string_literal_length(input_buffer, &literal_end, key_length, true)
+        || !sax_string(input_buffer, literal_end, *key_length, key, scratch, scratch_size))
+    {
+        return false; /* failed to parse name */
+    }
+    input_buffer->offset = (size_t)(literal_end - input_buffer->content) + 1;
+    buffer_skip_whitespace(input_buffer);
+    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != ':'))
+    {
+        return false; /* invalid object */
+    }
+    input_buffer->offset++;
+    buffer_skip_whitespace(input_buffer);
+
+    return can_access_at_index(input_buffer, 0);
+}
+
+/* Index the elements/members of the value at the offset, whose entry is the last one of level 0, and
+ * theirs down to the last level. Values below that are only checked. */
+static BC_JSON_bool index_value(parse_buffer * const input_buffer, file_index * const index)
+{
+    /* whether each of the arrays/objects the offset is in is an object */
+    BC_JSON_bool inline_frames[WALK_STACK_INLINE_FRAMES];
+    BC_JSON_bool *objects = inline_frames;
+    BC_JSON_bool *grown = NULL;
+    size_t capacity = WALK_STACK_INLINE_FRAMES;
+    /* the value at the offset is in this level */
+    size_t depth = 0;
+    const unsigned char *key = NULL;
+    size_t key_length = 0;
+    size_t offset = 0;
+    BC_JSON_bool object = false;
+    BC_JSON_bool success = false;
+
+    for (;;)
+    {
+        /* the value at the offset, its entry is the last one of its level */
+        if (((depth + 1) < index->level_count) && can_access_at_index(input_buffer, 0)
+            && ((buffer_at_offset(input_buffer)[0] == '{') || (buffer_at_offset(input_buffer)[0] == '[')))
+        {
+            object = (buffer_at_offset(input_buffer)[0] == '{');
+            input_buffer->offset++;
+            buffer_skip_whitespace(input_buffer);
+            if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != (object ? '}' : ']')))
+            {
+                if (depth == capacity)
+                {
+                    grown = (BC_JSON_bool*)grow_walk_stack((void*)objects, &capacity, sizeof(BC_JSON_bool), (const void*)inline_frames);
+                    if (grown == NULL)
+                    {
+                        goto end;
+                    }
+                    objects = grown;
+                }
+                objects[depth] = object;
+                depth++;
+                goto element;
+            }
+            input_buffer->offset++; /* empty */
+        }
+        else if (!skip_value(input_buffer))
+        {
+            goto end;
+        }
+
+        /* go up out of the arrays/objects that end after the value */
+        for (;;)
+        {
+            if (depth == 0)
+            {
+                success = true;
+                goto end;
+            }
+            buffer_skip_whitespace(input_buffer);
+            if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ','))
+            {
+                break;
+            }
+            if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != (objects[depth - 1] ? '}' : ']')))
+            {
+                goto end; /* expected end of array/object */
+            }
+            input_buffer->offset++;
+            depth--;
+        }
+        input_buffer->offset++;
+        buffer_skip_whitespace(input_buffer);
+
+element:
+        /* the next element/member of the array/object the offset is in */
+        offset = input_buffer->offset;
+        if (objects[depth - 1] && !skip_member_key(input_buffer, &key, &key_length, &index->scratch, &index->scratch_size))
+        {
+            goto end;
+        }
+        if (!add_index_entry(index, depth, offset, objects[depth - 1] ? (hash_key(key, key_length) & INDEX_HASH_MASK) : 0))
+        {
+            goto end;
+        }
+    }
+
+end:
+    if (objects != inline_frames)
+    {
+        global_hooks.deallocate(objects);
+    }
+
+    return success;
+}
+
+static BC_JSON_bool write_index(FILE * const output, const file_index * const index, const file_text * const text)
+{
+    unsigned char bytes[INDEX_ENTRY_SIZE * 64];
+    size_t level = 0;
+    size_t entry = 0;
+    size_t used = 0;
+
+    memcpy(bytes, INDEX_MAGIC, 8);
+    put_index_number(bytes + 8, INDEX_VERSION, 4);
+    put_index_number(bytes + 12, index->level_count, 4);
+    put_index_number(bytes + 16, text->length, 8);
+    put_index_number(bytes + 24, file_checksum(text), 4);
+    if (fwrite(bytes, 1, INDEX_HEADER_SIZE, output) != INDEX_HEADER_SIZE)
+    {
+        return false;
+    }
+    for (level = 0; level < index->level_count; level++)
+    {
+        put_index_number(bytes, index->levels[level].count, 8);
+        if (fwrite(bytes, 1, 8, output) != 8)
+        {
+            return false;
+        }
+    }
+
+    for (level = 0; level < index->level_count; level++)
+    {
+        for (entry = 0; entry < index->levels[level].count; entry++)
+        {
+            const index_entry *current = &index->levels[level].entries[entry];
+            put_index_number(bytes + used, current->offset, 8);
+            put_index_number(bytes + used + 8, current->first_child, 8);
+            put_index_number(bytes + used + 16, current->key_hash, 4);
+            used += INDEX_ENTRY_SIZE;
+            if (used == sizeof(bytes))
+            {
+                if (fwrite(bytes, 1, used, output) != used)
+                {
+                    return false;
+                }
+                used = 0;
+            }
+        }
+    }
+
+    return fwrite(bytes, 1, used, output) == used;
+}
+
+CJSON_PUBLIC(BC_JSON_bool) BC_JSON_WriteIndex(const char *path, const char *index_path, int max_depth)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+    file_text text = { NULL, 0, false };
+    file_index index;
+    FILE *output = NULL;
+    size_t level = 0;
+    BC_JSON_bool success = false;
+
+    /* reset error position */
+    global_error.json = NULL;
+    global_error.position = 0;
+
+    if ((path == NULL) || (index_path == NULL) || (max_depth < 0))
+    {
+        return false;
+    }
+
+    memset(&index, '\0', sizeof(index));
+    index.level_count = ((size_t)max_depth < CJSON_NESTING_LIMIT) ? ((size_t)max_depth + 1) : (CJSON_NESTING_LIMIT + 1);
+    index.levels = (index_level*)global_hooks.allocate(index.level_count * sizeof(index_level));
+    if (index.levels == NULL)
+    {
+        return false;
+    }
+    memset(index.levels, '\0', index.level_count * sizeof(index_level));
+
+    if (!map_file_text(path, false, true, &text) && !read_file_text(path, &text))
+    {
+        goto end;
+    }
+
+    buffer.content = text.content;
+    buffer.length = text.length;
+    buffer.offset = 0;
+    buffer.hooks = global_hooks;
+
+    buffer_skip_whitespace(skip_utf8_bom(&buffer));
+    if (!add_index_entry(&index, 0, buffer.offset, 0) || !index_value(&buffer, &index))
+    {
+        goto end;
+    }
+    /* a file has no terminator, it has to end after the JSON */
+    buffer_skip_whitespace(&buffer);
+    if ((buffer.offset < buffer.length) && (buffer_at_offset(&buffer)[0] > 32))
+    {
+        goto end;
+    }
+
+    output = fopen(index_path, "wb");
+    if (output == NULL)
+    {
+        goto end;
+    }
+    success = write_index(output, &index, &text);
+    if ((fclose(output) != 0) || !success)
+    {
+        /* don't leave half an index behind */
+        remove(index_path);
+        success = false;
+    }
+
+end:
+    for (level = 0; level < index.level_count; level++)
+    {
+        if (index.levels[level].entries != NULL)
+        {
+            global_hooks.deallocate(index.levels[level].entries);
+        }
+    }
+    global_hooks.deallocate(index.levels);
+    if (index.scratch != NULL)
+    {
+        global_hooks.deallocate(index.scratch);
+    }
+    release_file_text(&text);
+
+    return success;
+}
+
+CJSON_PUBLIC(BC_JSON_IndexedFile *) BC_JSON_IndexedFile_Open(const char *path, const char *index_path, BC_JSON_bool verify)
+{
+    BC_JSON_IndexedFile *file = NULL;
+    const unsigned char *header = NULL;
+    size_t number = 0;
+    size_t level = 0;
+
+    if ((path == NULL) || (index_path == NULL))
+    {
+        return NULL;
+    }
+
+    file = (BC_JSON_IndexedFile*)global_hooks.allocate(sizeof(BC_JSON_IndexedFile));
+    if (file == NULL)
+    {
+        return NULL;
+    }
+    memset(file, '\0', sizeof(BC_JSON_IndexedFile));
+
+    if ((!map_file_text(path, false, false, &file->text) && !read_file_text(path, &file->text))
+        || (!map_file_text(index_path, false, false, &file->index) && !read_file_text(index_path, &file->index)))
+    {
+        goto fail;
+    }
+
+    header = file->index.content;
+    if ((file->index.length < INDEX_HEADER_SIZE) || (memcmp(header, INDEX_MAGIC, 8) != 0)
+        || !get_index_number(header + 8, 4, &number) || (number != INDEX_VERSION)
+        || !get_index_number(header + 12, 4, &file->level_count) || (file->level_count == 0) || (file->level_count > (CJSON_NESTING_LIMIT + 1))
+        || !get_index_number(header + 16, 8, &number) || (number != file->text.length)
+        || ((file->index.length - INDEX_HEADER_SIZE) / 8 < file->level_count))
+    {
+        goto fail; /* not an index, or not one for this file */
+    }
+    if (verify && (!get_index_number(header + 24, 4, &number) || (number != file_checksum(&file->text))))
+    {
+        goto fail; /* the file changed since */
+    }
+
+    for (level = 0; level < file->level_count; level++)
+    {
+        if (!get_index_number(header + INDEX_HEADER_SIZE + (level * 8), 8, &number) || ((level == 0) && (number != 1))
+            || (number > ((size_t)-1 - file->level_start[level])))
+        {
+            goto fail;
+        }
+        file->level_start[level + 1] = file->level_start[level] + number;
+    }
+    number = file->index.length - INDEX_HEADER_SIZE - (file->level_count * 8);
+    if (((number / INDEX_ENTRY_SIZE) != file->level_start[file->level_count]) || ((number % INDEX_ENTRY_SIZE) != 0))
+    {
+        goto fail; /* truncated */
+    }
+
+    return file;
+
+fail:
+    BC_JSON_IndexedFile_Close(file);
+
+    return NULL;
+}
+
+static BC_JSON_bool read_index_entry(const BC_JSON_IndexedFile * const file, const size_t level, const size_t entry, index_entry * const result)
+{
+    const unsigned char *bytes = file->index.content + INDEX_HEADER_SIZE + (file->level_count * 8) + ((file->level_start[level] + entry) * INDEX_ENTRY_SIZE);
+
+    return get_index_number(bytes, 8, &result->offset) && (result->offset < file->text.length)
+        && get_index_number(bytes + 8, 8, &result->first_child)
+        && get_index_number(bytes + 16, 4, &result->key_hash);
+}
+
+/* the number of entries of a level of an index */
+#define level_size(file, level) ((file)->level_start[(level) + 1] - (file)->level_start[(level)])
+
+CJSON_PUBLIC(BC_JSON *) BC_JSON_IndexedFile_Get(BC_JSON_IndexedFile *file, const char *pointer)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+    path_projection path;
+    index_entry current;
+    index_entry next;
+    const unsigned char *key = NULL;
+    size_t key_length = 0;
+    size_t key_hash = 0;
+    size_t level = 0;
+    size_t entry = 0;
+    size_t token = 0;
+    size_t first_child = 0;
+    size_t last_child = 0; /* one past it */
+    BC_JSON_bool member = false;
+    BC_JSON *root = NULL;
+    BC_JSON *parent = NULL;
+    BC_JSON *item = NULL;
+
+    /* reset error position */
+    global_error.json = NULL;
+    global_error.position = 0;
+
+    if (file == NULL)
+    {
+        return NULL;
+    }
+
+    memset(&path, '\0', sizeof(path));
+    if (pointer == NULL)
+    {
+        pointer = ""; /* the root */
+    }
+    if (!create_projection(&path, &pointer, 1) || !read_index_entry(file, 0, 0, &current))
+    {
+        goto end;
+    }
+
+    buffer.content = file->text.content;
+    buffer.length = file->text.length;
+    buffer.hooks = global_hooks;
+
+    /* go down the index as far as it goes */
+    for (token = 0; (token < path.path_start[1]) && ((level + 1) < file->level_count); token++)
+    {
+        const path_token *name = &path.tokens[token];
+
+        buffer.offset = current.offset;
+        if ((member && !skip_member_key(&buffer, &key, &key_length, &path.scratch, &path.scratch_size))
+            || ((buffer_at_offset(&buffer)[0] != '{') && (buffer_at_offset(&buffer)[0] != '[')))
+        {
+            goto end;
+        }
+        member = (buffer_at_offset(&buffer)[0] == '{');
+
+        first_child = current.first_child;
+        last_child = level_size(file, level + 1);
+        if ((entry + 1) < level_size(file, level))
+        {
+            if (!read_index_entry(file, level, entry + 1, &next))
+            {
+                goto end;
+            }
+            last_child = next.first_child;
+        }
+        if ((first_child > last_child) || (last_child > level_size(file, level + 1)))
+        {
+            goto end; /* a broken index */
+        }
+
+        if (!member)
+        {
+            if (name->index >= (last_child - first_child))
+            {
+                goto end; /* there is no such element */
+            }
+            entry = first_child + name->index;
+        }
+        else
+        {
+            key_hash = hash_key((const unsigned char*)name->name, name->length) & INDEX_HASH_MASK;
+            for (entry = first_child; entry < last_child; entry++)
+            {
+                if (!read_index_entry(file, level + 1, entry, &current))
+                {
+                    goto end;
+                }
+                if (current.key_hash != key_hash)
+                {
+                    continue;
+                }
+                buffer.offset = current.offset;
+                if (skip_member_key(&buffer, &key, &key_length, &path.scratch, &path.scratch_size)
+                    && (key_length == name->length) && (memcmp(key, name->name, key_length) == 0))
+                {
+                    break;
+                }
+            }
+            if (entry == last_child)
+            {
+                goto end; /* there is no such member */
+            }
+        }
+        level++;
+        if (!read_index_entry(file, level, entry, &current))
+        {
+            goto end;
+        }
+    }
+
+    /* parse only that value */
+    buffer.offset = current.offset;
+    if (member && !skip_member_key(&buffer, &key, &key_length, &path.scratch, &path.scratch_size))
+    {
+        goto end;
+    }
+    root = parse_new_item(&buffer);
+    if (root == NULL)
+    {
+        goto end; /* allocation failure */
+    }
+    if (!parse_value(root, &buffer))
+    {
+        record_parse_error(&buffer, NULL);
+        goto end;
+    }
+
+    /* the rest of the pointer is below what the index covers */
+    item = root;
+    for (; token < path.path_start[1]; token++)
+    {
+        const path_token *name = &path.tokens[token];
+        size_t index = 0;
+
+        parent = item;
+        for (item = parent->child; item != NULL; item = item->next, index++)
+        {
+            if (BC_JSON_IsArray(parent) ? (index == name->index)
+                : (BC_JSON_IsObject(parent) && (strlen(item->string) == name->length) && (memcmp(item->string, name->name, name->length) == 0)))
+            {
+                break;
+            }
+        }
+        if (item == NULL)
+        {
+            goto end; /* there is no such element/member */
+        }
+    }
+    if (item != root)
+    {
+        BC_JSON_DetachItemViaPointer(parent, item);
+        if (!(item->type & (BC_JSON_StringIsConst | BC_JSON_StringIsInterned)))
+        {
+            global_hooks.deallocate(item->string);
+        }
+        item->string = NULL;
+        item->type &= ~(BC_JSON_StringIsConst | BC_JSON_StringIsInterned);
+    }
+    else
+    {
+        root = NULL;
+    }
+
+end:
+    if (root != NULL)
+    {
+        BC_JSON_Delete(root);
+    }
+    delete_projection(&path);
+
+    return item;
+}
+
+#undef level_size
+
+CJSON_PUBLIC(void) BC_JSON_IndexedFile_Close(BC_JSON_IndexedFile *file)
+{
+    if (file == NULL)
+    {
+        return;
+    }
+
+    release_file_text(&file->text);
+    release_file_text(&file->index);
+    global_hooks.deallocate(file);
+}
+
+/* Spans of a document: where every value is in the text, relative to what comes before it. A value
+ * is found gap bytes after the end of the element in front of it, or after the start (the bracket)
+ * of its array/object if it is the first one, or after the start of the text for the root. An edit
+ * inside a value then only changes its own length and that of the arrays/objects around it. The
+ * spans are kept in an open addressing table keyed by the address of the item. */
+typedef struct
+{
+    const BC_JSON *item; /* NULL for a free slot */
+    size_t gap;
+    size_t length;
+} value_span;
+
+struct BC_JSON_Spans
+{
+    value_span *slots;
+    size_t slot_mask;
+    size_t count;
+};
+
+#define span_slot(spans, item) (((size_t)(item) / sizeof(BC_JSON) * 2654435761u) & (spans)->slot_mask)
+
+static value_span *find_span(const BC_JSON_Spans * const spans, const BC_JSON * const item)
+{
+    size_t slot = 0;
+
+    for (slot = span_slot(spans, item); spans->slots[slot].item != NULL; slot = (slot + 1) & spans->slot_mask)
+    {
+        if (spans->slots[slot].item == item)
+        {
+            return spans->slots + slot;
+        }
+    }
+
+    return NULL;
+}
+
+static BC_JSON_bool add_span(BC_JSON_Spans * const spans, const BC_JSON * const item, const size_t gap, const size_t length)
+{
+    size_t slot = 0;
+
+    /* keep the table at most half full */
+    if ((2 * (spans->count + 1)) > (spans->slot_mask + 1))
+    {
+        value_span *old_slots = spans->slots;
+        size_t old_count = spans->slot_mask + 1;
+        size_t index = 0;
+        if (old_count > ((size_t)-1 / 2 / sizeof(value_span)))
+        {
+            return false; /* overflow */
+        }
+
+        spans->slots = (value_span*)global_hooks.allocate(2 * old_count * sizeof(value_span));
+        if (spans->slots == NULL)
+        {
+            spans->slots = old_slots;
+            return false; /* allocation failure */
+        }
+        memset(spans->slots, '\0', 2 * old_count * sizeof(value_span));
+        spans->slot_mask = (2 * old_count) - 1;
+
+        for (index = 0; index < old_count; index++)
+        {
+            if (old_slots[index].item != NULL)
+            {
+                for (slot = span_slot(spans, old_slots[index].item); spans->slots[slot].item != NULL; slot = (slot + 1) & spans->slot_mask)
+                {
+                }
+                spans->slots[slot] = old_slots[index];
+            }
+        }
+        global_hooks.deallocate(old_slots);
+    }
+
+    for (slot = span_slot(spans, item); spans->slots[slot].item != NULL; slot = (slot + 1) & spans->slot_mask)
+    {
+        if (spans->slots[slot].item == item)
+        {
+            break; /* left behind by an item that was freed, the address is in use again */
+        }
+    }
+    if (spans->slots[slot].item == NULL)
+    {
+        spans->count++;
+    }
+    spans->slots[slot].item = item;
+    spans->slots[slot].gap = gap;
+    spans->slots[slot].length = length;
+
+    return true;
+}
+
+static void remove_span(BC_JSON_Spans * const spans, const BC_JSON * const item)
+{
+    value_span *span = find_span(spans, item);
+    size_t hole = 0;
+    size_t slot = 0;
+
+    if (span == NULL)
+    {
+        return;
+    }
+
+    /* move the spans after it in their probe sequence up, so the sequences stay unbroken */
+    hole = (size_t)(span - spans->slots);
+    for (slot = (hole + 1) & spans->slot_mask; spans->slots[slot].item != NULL; slot = (slot + 1) & spans->slot_mask)
+    {
+        size_t home = span_slot(spans, spans->slots[slot].item);
+        /* it can fill the hole if its home isn't cyclically in (hole, slot] */
+        if (((slot > hole) && ((home <= hole) || (home > slot))) || ((slot < hole) && ((home <= hole) && (home > slot))))
+        {
+            spans->slots[hole] = spans->slots[slot];
+            hole = slot;
+        }
+    }
+    spans->slots[hole].item = NULL;
+    spans->count--;
+}
+
+/* forget the spans of an item and everything in it */
+static void remove_spans(BC_JSON_Spans * const spans, const BC_JSON * const item)
+{
+    const BC_JSON *inline_frames[WALK_STACK_INLINE_FRAMES];
+    const BC_JSON **parents = inline_frames;
+    const BC_JSON **grown = NULL;
+    size_t capacity = WALK_STACK_INLINE_FRAMES;
+    size_t depth = 0;
+    const BC_JSON *current = item;
+
+    while (current != NULL)
+    {
+        remove_span(spans, current);
+
+        if (!(current->type & BC_JSON_IsReference) && (current->child != NULL))
+        {
+            if (depth == capacity)
+            {
+                grown = (const BC_JSON**)grow_walk_stack((void*)parents, &capacity, sizeof(const BC_JSON*), (const void*)inline_frames);
+                if (grown == NULL)
+                {
+                    break; /* the rest is left behind, add_span reuses their slots */
+                }
+                parents = grown;
+            }
+            parents[depth] = current;
+            depth++;
+            current = current->child;
+            continue;
+        }
+
+        /* continue with the next element, going up out of the arrays/objects that are done */
+        while ((depth > 0) && (current->next == NULL))
+        {
+            depth--;
+            current = parents[depth];
+        }
+        current = (depth > 0) ? current->next : NULL;
+    }
+
+    if (parents != inline_frames)
+    {
+        global_hooks.deallocate((void*)parents);
+    }
+}
+
+/* an array/object that is open while the recorded spans are turned into relative ones */
+typedef struct
+{
+    size_t end;
+    size_t cursor; /* end of its last element so far, its start before the first one */
+} span_frame;
+
+/* Add the spans recorded by a parse, the root's gap is root_gap plus where it starts. */
+static BC_JSON_bool add_recorded_spans(BC_JSON_Spans * const spans, const span_list * const list, const size_t root_gap)
+{
+    span_frame inline_frames[WALK_STACK_INLINE_FRAMES];
+    span_frame *frames = inline_frames;
+    span_frame *grown = NULL;
+    size_t capacity = WALK_STACK_INLINE_FRAMES;
+    size_t depth = 0;
+    size_t index = 0;
+    BC_JSON_bool success = false;
+
+    for (index = 0; index < list->count; index++)
+    {
+        const recorded_span *span = list->spans + index;
+        size_t gap = 0;
+
+        /* leave the arrays/objects that ended before it, the spans are in the order values start in */
+        while ((depth > 0) && (frames[depth - 1].end <= span->start))
+        {
+            depth--;
+        }
+        gap = (depth == 0) ? (root_gap + span->start) : (span->start - frames[depth - 1].cursor);
+        if (!add_span(spans, span->item, gap, span->end - span->start))
+        {
+            goto end;
+        }
+        if (depth > 0)
+        {
+            frames[depth - 1].cursor = span->end;
+        }
+
+        if (span->item->type & (BC_JSON_Array | BC_JSON_Object))
+        {
+            if (depth == capacity)
+            {
+                grown = (span_frame*)grow_walk_stack((void*)frames, &capacity, sizeof(span_frame), (const void*)inline_frames);
+                if (grown == NULL)
+                {
+                    goto end;
+                }
+                frames = grown;
+            }
+            frames[depth].end = span->end;
+            frames[depth].cursor = span->start;
+            depth++;
+        }
+    }
+    success = true;
+
+end:
+    if (frames != inline_frames)
+    {
+        global_hooks.deallocate((void*)frames);
+    }
+
+    return success;
+}
+
+/* Parse the value at the offset of buffer, recording the spans of it and everything in it. */
+static BC_JSON *parse_value_with_spans(parse_buffer * const buffer, span_list * const list)
+{
+    const size_t start = buffer->offset;
+    BC_JSON *item = parse_new_item(buffer);
+
+    buffer->spans = list;
+    if (item == NULL)
+    {
+        return NULL;
+    }
+
+    /* arrays/objects record their own spans */
+    if (!parse_value(item, buffer) || (!(item->type & (BC_JSON_Array | BC_JSON_Object)) && !record_span(buffer, item, start, buffer->offset)))
+    {
+        parse_delete(buffer, item);
+        return NULL;
+    }
+
+    return item;
+}
+
+/* Parse a whole text and replace the spans with its ones. */
+static BC_JSON *parse_all_with_spans(const unsigned char * const value, const size_t length, BC_JSON_Spans * const spans)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+    span_list list = { NULL, 0, 0, 0 };
+    BC_JSON *item = NULL;
+
+    buffer.content = value;
+    buffer.length = length;
+    buffer.offset = 0;
+    buffer.hooks = global_hooks;
+
+    if ((value != NULL) && (length > 0))
+    {
+        buffer_skip_whitespace(skip_utf8_bom(&buffer));
+        item = parse_value_with_spans(&buffer, &list);
+    }
+    if (item == NULL)
+    {
+        if (value != NULL)
+        {
+            record_parse_error(&buffer, NULL);
+        }
+        goto end;
+    }
+
+    memset(spans->slots, '\0', (spans->slot_mask + 1) * sizeof(value_span));
+    spans->count = 0;
+    if (!add_recorded_spans(spans, &list, 0))
+    {
+        /* no spans at all make the next edit parse everything */
+        memset(spans->slots, '\0', (spans->slot_mask + 1) * sizeof(value_span));
+        spans->count = 0;
+        BC_JSON_Delete(item);
+        item = NULL;
+    }
+
+end:
+    if (list.spans != NULL)
+    {
+        global_hooks.deallocate(list.spans);
+    }
+
+    return item;
+}
+
+CJSON_PUBLIC(BC_JSON *) BC_JSON_ParseWithSpans(const char *value, size_t buffer_length, BC_JSON_Spans **spans)
+{
+    BC_JSON_Spans *created = NULL;
+    BC_JSON *item = NULL;
+
+    global_error.json = NULL;
+    global_error.position = 0;
+
+    if (spans == NULL)
+    {
+        return NULL;
+    }
+    *spans = NULL;
+
+    created = (BC_JSON_Spans*)global_hooks.allocate(sizeof(BC_JSON_Spans));
+    if (created == NULL)
+    {
+        return NULL;
+    }
+    created->count = 0;
+    created->slot_mask = 63;
+    created->slots = (value_span*)global_hooks.allocate((created->slot_mask + 1) * sizeof(value_span));
+    if (created->slots == NULL)
+    {
+        global_hooks.deallocate(created);
+        return NULL;
+    }
+
+    item = parse_all_with_spans((const unsigned char*)value, buffer_length, created);
+    if (item == NULL)
+    {
+        BC_JSON_DeleteSpans(created);
+        return NULL;
+    }
+    *spans = created;
+
+    return item;
+}
+
+CJSON_PUBLIC(void) BC_JSON_DeleteSpans(BC_JSON_Spans *spans)
+{
+    if (spans == NULL)
+    {
+        return;
+    }
+
+    global_hooks.deallocate(spans->slots);
+    global_hooks.deallocate(spans);
+}
+
+/* a value on the way from the root to the one an edit is in */
+typedef struct
+{
+    BC_JSON *item;
+    size_t start; /* of its text */
+} edit_frame;
+
+/* Copy the text from start to end with the edit applied to it, into memory from the hooks. */
+static unsigned char *edited_text(const unsigned char * const value, const size_t start, const size_t end, const size_t edit_offset, const size_t removed_length, const unsigned char * const inserted, const size_t inserted_length)
+{
+    const size_t length = (end - start) - removed_length + inserted_length;
+    unsigned char *text = (unsigned char*)global_hooks.allocate(length + sizeof(""));
+    if (text == NULL)
+    {
+        return NULL;
+    }
+
+    memcpy(text, value + start, edit_offset - start);
+    if (inserted_length > 0)
+    {
+        memcpy(text + (edit_offset - start), inserted, inserted_length);
+    }
+    memcpy(text + (edit_offset - start) + inserted_length, value + edit_offset + removed_length, end - (edit_offset + removed_length));
+    text[length] = '\0';
+
+    return text;
+}
+
+/* Re-parse the value of frames[level] with the edit applied and splice the result in. Fails if the
+ * edited text isn't a single value from start to end. */
+static BC_JSON_bool reparse_value(BC_JSON ** const doc, BC_JSON_Spans * const spans, const edit_frame * const frames, const size_t level, const unsigned char * const value, const size_t edit_offset, const size_t removed_length, const unsigned char * const inserted, const size_t inserted_length)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+    span_list list = { NULL, 0, 0, 0 };
+    BC_JSON *item = frames[level].item;
+    BC_JSON *replacement = NULL;
+    value_span *span = find_span(spans, item);
+    unsigned char *text = NULL;
+    size_t gap = 0;
+    size_t index = 0;
+    BC_JSON_bool success = false;
+
+    text = edited_text(value, frames[level].start, frames[level].start + span->length, edit_offset, removed_length, inserted, inserted_length);
+    if (text == NULL)
+    {
+        return false;
+    }
+    gap = span->gap;
+
+    buffer.content = text;
+    buffer.length = span->length - removed_length + inserted_length;
+    buffer.offset = 0;
+    /* the value is nested in the arrays/objects of the frames before it, they count for the nesting limit */
+    buffer.depth = level;
+    buffer.hooks = global_hooks;
+
+    replacement = parse_value_with_spans(&buffer, &list);
+    if ((replacement == NULL) || (buffer.offset != buffer.length))
+    {
+        goto end; /* the edit reaches beyond the value */
+    }
+
+    if (!add_recorded_spans(spans, &list, gap))
+    {
+        remove_spans(spans, replacement);
+        goto end;
+    }
+    remove_spans(spans, item);
+    /* the arrays/objects around it grow or shrink with it */
+    for (index = 0; index < level; index++)
+    {
+        span = find_span(spans, frames[index].item);
+        span->length = span->length - removed_length + inserted_length;
+    }
+
+    if (level == 0)
+    {
+        BC_JSON_Delete(item);
+        *doc = replacement;
+    }
+    else
+    {
+        /* the key stays with the member */
+        replacement->string = item->string;
+        replacement->type |= item->type & (BC_JSON_StringIsConst | BC_JSON_StringIsInterned);
+        item->string = NULL;
+        item->type &= ~(BC_JSON_StringIsConst | BC_JSON_StringIsInterned);
+        BC_JSON_ReplaceItemViaPointer(frames[level - 1].item, item, replacement);
+    }
+    replacement = NULL;
+    success = true;
+
+end:
+    if (replacement != NULL)
+    {
+        BC_JSON_Delete(replacement);
+    }
+    if (list.spans != NULL)
+    {
+        global_hooks.deallocate(list.spans);
+    }
+    global_hooks.deallocate(text);
+
+    return success;
+}
+
+CJSON_PUBLIC(BC_JSON_bool) BC_JSON_ParseEdit(BC_JSON **doc, BC_JSON_Spans *spans, const char *value, size_t buffer_length, size_t edit_offset, size_t removed_length, const char *inserted, size_t inserted_length)
+{
+    edit_frame inline_frames[WALK_STACK_INLINE_FRAMES];
+    edit_frame *frames = inline_frames;
+    edit_frame *grown = NULL;
+    size_t capacity = WALK_STACK_INLINE_FRAMES;
+    size_t depth = 0;
+    const value_span *span = NULL;
+    unsigned char *text = NULL;
+    BC_JSON *item = NULL;
+    BC_JSON_bool success = false;
+
+    if ((doc == NULL) || (*doc == NULL) || (spans == NULL) || (value == NULL) || ((inserted == NULL) && (inserted_length > 0))
+        || (edit_offset > buffer_length) || (removed_length > (buffer_length - edit_offset))
+        || (inserted_length > ((size_t)-1 - sizeof("") - buffer_length)))
+    {
+        return false;
+    }
+    if (reject_frozen(*doc))
+    {
+        return false;
+    }
+
+    /* find the innermost value the edit is in, from start to end, spans that don't fit the text aren't for it */
+    span = find_span(spans, *doc);
+    if ((span != NULL) && (span->length <= buffer_length) && (span->gap <= (buffer_length - span->length))
+        && (span->gap <= edit_offset) && ((edit_offset + removed_length) <= (span->gap + span->length))
+        /* an edit anywhere in the root can join it with text after it that the parse ignored, 35e45e5
+         * parses as 35e45 but becomes 3515e5 when e4 is replaced by 1 */
+        && (((span->gap + span->length) == buffer_length) || (value[span->gap + span->length] <= 32)))
+    {
+        frames[0].item = *doc;
+        frames[0].start = span->gap;
+        depth = 1;
+    }
+    while ((depth > 0) && (frames[depth - 1].item->type & (BC_JSON_Array | BC_JSON_Object)))
+    {
+        BC_JSON *child = frames[depth - 1].item->child;
+        size_t cursor = frames[depth - 1].start;
+        size_t start = 0;
+
+        for (; child != NULL; child = child->next)
+        {
+            span = find_span(spans, child);
+            if (span == NULL)
+            {
+                depth = 0; /* the tree was changed, its spans are no good */
+                break;
+            }
+            start = cursor + span->gap;
+            cursor = start + span->length;
+            if ((start > edit_offset) || ((edit_offset + removed_length) <= cursor))
+            {
+                break;
+            }
+        }
+        if ((depth == 0) || (child == NULL) || (start > edit_offset))
+        {
+            break; /* it is in the array/object, but not in one of its elements */
+        }
+
+        if (depth == capacity)
+        {
+            grown = (edit_frame*)grow_walk_stack((void*)frames, &capacity, sizeof(edit_frame), (const void*)inline_frames);
+            if (grown == NULL)
+            {
+                break; /* re-parse from where it got to */
+            }
+            frames = grown;
+        }
+        frames[depth].item = child;
+        frames[depth].start = start;
+        depth++;
+    }
+
+    /* re-parse the innermost value, if the edit changes more than that go outwards */
+    for (; depth > 0; depth--)
+    {
+        if (reparse_value(doc, spans, frames, depth - 1, (const unsigned char*)value, edit_offset, removed_length, (const unsigned char*)inserted, inserted_length))
+        {
+            success = true;
+            goto end;
+        }
+    }
+
+    /* the structure around the values changed, parse everything */
+    text = edited_text((const unsigned char*)value, 0, buffer_length, edit_offset, removed_length, (const unsigned char*)inserted, inserted_length);
+    if (text == NULL)
+    {
+        goto end;
+    }
+    item = parse_all_with_spans(text, buffer_length - removed_length + inserted_length, spans);
+    global_hooks.deallocate(text);
+    if (item != NULL)
+    {
+        BC_JSON_Delete(*doc);
+        *doc = item;
+        success = true;
+    }
+
+end:
+    /* an error position would point into a copy that is gone */
+    global_error.json = NULL;
+    global_error.position = 0;
+
+    if (frames != inline_frames)
+    {
+        global_hooks.deallocate((void*)frames);
+    }
+
+    return success;
+}
+
+/* Default options for BC_JSON_Parse */
+CJSON_PUBLIC(BC_JSON *) BC_JSON_Parse(const char *value)
+{
+    return BC_JSON_ParseWithOpts(value, 0, 0);
+}
+
+CJSON_PUBLIC(BC_JSON *) BC_JSON_ParseWithLength(const char *value, size_t buffer_length)
+{
+    return BC_JSON_ParseWithLengthOpts(value, buffer_length, 0, 0);
+}
+
+static unsigned char *print(const BC_JSON * const item, BC_JSON_bool format, const internal_hooks * const hooks)
+{
+    printbuffer buffer[1];
+    size_t length = 0;
+
+    memset(buffer, 0, sizeof(buffer));
+
+    /* measure first, so the text is printed into a single allocation of the exact size */
+    length = BC_JSON_PrintedLength(item, format);
+    if (length == 0)
+    {
+        return NULL;
+    }
+
+    /* create buffer */
+    buffer->buffer = (unsigned char*) hooks->allocate(length + 1);
+    buffer->length = length + 1;
+    buffer->format = format;
+    buffer->hooks = *hooks;
+    if (buffer->buffer == NULL)
+    {
+        return NULL;
+    }
+
+    /* print the value */
+    if (!print_value(item, buffer))
+    {
+        if (buffer->buffer != NULL)
+        {
+            hooks->deallocate(buffer->buffer);
+        }
+
+        return NULL;
+    }
+    buffer->buffer[length] = '\0'; /* just to be sure */
+
+    return buffer->buffer;
+}
+
+/* Render a BC_JSON item/entity/structure to text. */
+CJSON_PUBLIC(char *) BC_JSON_Print(const BC_JSON *item)
+{
+    return (char*)print(item, true, &global_hooks);
+}
+
+CJSON_PUBLIC(char *) BC_JSON_PrintUnformatted(const BC_JSON *item)
+{
+    return (char*)print(item, false, &global_hooks);
+}
+
+CJSON_PUBLIC(char *) BC_JSON_PrintBuffered(const BC_JSON *item, int prebuffer, BC_JSON_bool fmt)
+{
+    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0 };
+
+    if (prebuffer < 0)
+    {
+        return NULL;
+    }
+
+    p.buffer = (unsigned char*)global_hooks.allocate((size_t)prebuffer);
+    if (!p.buffer)
+    {
+        return NULL;
+    }
+
+    p.length = (size_t)prebuffer;
+    p.offset = 0;
+    p.noalloc = false;
+    p.format = fmt;
+    p.hooks = global_hooks;
+
+    if (!print_value(item, &p))
+    {
+        global_hooks.deallocate(p.buffer);
+        p.buffer = NULL;
+        return NULL;
+    }
+
+    return (char*)p.buffer;
+}
+
+CJSON_PUBLIC(BC_JSON_bool) BC_JSON_PrintPreallocated(BC_JSON *item, char *buffer, const int length, const BC_JSON_bool format)
+{
+    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0 };
+
+    if ((length < 0) || (buffer == NULL))
+    {
+        return false;
+    }
+
+    p.buffer = (unsigned char*)buffer;
+    p.length = (size_t)length;
+    p.offset = 0;
+    p.noalloc = true;
+    p.format = format;
+    p.hooks = global_hooks;
+
+    return print_value(item, &p);
+}
+
+CJSON_PUBLIC(BC_JSON_bool) BC_JSON_PrintToWriter(const BC_JSON *item, BC_JSON_bool format, BC_JSON_WriteFunction write_fn, void *context, size_t chunk_size)
+{
+    static const size_t default_chunk_size = 4096;
+    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0 };
+    BC_JSON_bool success = false;
+
+    if ((item == NULL) || (write_fn == NULL))
+    {
+        return false;
+    }
+
+    if (chunk_size == 0)
+    {
+        chunk_size = default_chunk_size;
+    }
+    else if (chunk_size < (NUMBER_MAX_LENGTH + sizeof("")))
+    {
+        /* numbers are printed as a whole */
+        chunk_size = NUMBER_MAX_LENGTH + sizeof("");
+    }
+
+    p.buffer = (unsigned char*)global_hooks.allocate(chunk_size);
+    if (p.buffer == NULL)
+    {
+        return false;
+    }
+
+    p.length = chunk_size;
+    p.offset = 0;
+    p.noalloc = false; /* only deep indentation ever needs more than chunk_size */
+    p.format = format;
+    p.hooks = global_hooks;
+    p.write = write_fn;
+    p.write_context = context;
+
+    if (print_value(item, &p))
+    {
+        success = flush_printbuffer(&p);
+    }
+
+    if (p.buffer != NULL)
+    {
+        global_hooks.deallocate(p.buffer);
+    }
+
+    return success;
+}
+
+CJSON_PUBLIC(BC_JSON_IoVec *) BC_JSON_PrintIoVec(const BC_JSON *item, BC_JSON_bool format, size_t threshold, size_t *count)
+{
+    static const size_t default_threshold = 1024;
+    static const size_t default_buffer_size = 256;
+    BC_JSON_IoVec inline_segments[WALK_STACK_INLINE_FRAMES];
+    segment_list segments;
+    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0 };
+    BC_JSON_IoVec *vectors = NULL;
+    unsigned char *text = NULL;
+    size_t i = 0;
+
+    if ((item == NULL) || (count == NULL))
+    {
+        return NULL;
+    }
+
+    segments.segments = inline_segments;
+    segments.count = 0;
+    segments.capacity = WALK_STACK_INLINE_FRAMES;
+    segments.inline_segments = inline_segments;
+    segments.threshold = (threshold == 0) ? default_threshold : threshold;
+    segments.cut = 0;
+
+    p.buffer = (unsigned char*)global_hooks.allocate(default_buffer_size);
+    if (p.buffer == NULL)
+    {
+        return NULL;
+    }
+    p.length = default_buffer_size;
+    p.offset = 0;
+    p.noalloc = false;
+    p.format = format;
+    p.hooks = global_hooks;
+    p.segments = &segments;
+
+    if (!print_value(item, &p))
+    {
+        goto end;
+    }
+    if (!cut_segment(&p))
+    {
+        goto end;
+    }
+
+    /* the vectors and the printed text they point to go into one allocation */
+    if (segments.count > (((size_t)-1 - p.offset) / sizeof(BC_JSON_IoVec)))
+    {
+        goto end;
+    }
+    vectors = (BC_JSON_IoVec*)global_hooks.allocate((segments.count * sizeof(BC_JSON_IoVec)) + p.offset);
+    if (vectors == NULL)
+    {
+        goto end;
+    }
+    text = (unsigned char*)(vectors + segments.count);
+    memcpy(text, p.buffer, p.offset);
+    for (i = 0; i < segments.count; i++)
+    {
+        vectors[i] = segments.segments[i];
+        if (vectors[i].iov_base == NULL)
+        {
+            vectors[i].iov_base = text;
+            text += vectors[i].iov_len;
+        }
+    }
+    *count = segments.count;
+
+end:
+    if (p.buffer != NULL)
+    {
+        global_hooks.deallocate(p.buffer);
+    }
+    if (segments.segments != inline_segments)
+    {
+        global_hooks.deallocate(segments.segments);
+    }
+
+    return vectors;
+}
+
+struct BC_JSON_PrintBuffer
+{
+    unsigned char *text;
+    size_t capacity;
+    size_t length; /* of the text printed last, without the terminating zero */
+};
+
+CJSON_PUBLIC(BC_JSON_PrintBuffer *) BC_JSON_CreatePrintBuffer(void)
+{
+    BC_JSON_PrintBuffer *buffer = (BC_JSON_PrintBuffer*)global_hooks.allocate(sizeof(BC_JSON_PrintBuffer));
+    if (buffer != NULL)
+    {
+        memset(buffer, '\0', sizeof(BC_JSON_PrintBuffer));
+    }
+
+    return buffer;
+}
+
+CJSON_PUBLIC(void) BC_JSON_DeletePrintBuffer(BC_JSON_PrintBuffer *buffer)
+{
+    if (buffer == NULL)
+    {
+        return;
+    }
+
+    if (buffer->text != NULL)
+    {
+        global_hooks.deallocate(buffer->text);
+    }
+    global_hooks.deallocate(buffer);
+}
+
+CJSON_PUBLIC(BC_JSON_bool) BC_JSON_PrintInto(BC_JSON_PrintBuffer *buffer, const BC_JSON *item, BC_JSON_bool format)
+{
+    static const size_t default_buffer_size = 256;
+    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0 };
+    BC_JSON_bool success = false;
+
+    if ((buffer == NULL) || (item == NULL))
+    {
+        return false;
+    }
+
+    buffer->length = 0;
+    if (buffer->text == NULL)
+    {
+        buffer->text = (unsigned char*)global_hooks.allocate(default_buffer_size);
+        if (buffer->text == NULL)
+        {
+            return false;
+        }
+        buffer->capacity = default_buffer_size;
+    }
+
+    /* print over the previous text, ensure only grows the buffer if it is too small */
+    p.buffer = buffer->text;
+    p.length = buffer->capacity;
+    p.offset = 0;
+    p.noalloc = false;
+    p.format = format;
+    p.hooks = global_hooks;
+
+    success = print_value(item, &p);
+
+    /* ensure may have moved the buffer, or freed it when it failed to grow it */
+    buffer->text = p.buffer;
+    buffer->capacity = (p.buffer == NULL) ? 0 : p.length;
+    if (!success)
+    {
+        if (buffer->text != NULL)
+        {
+            buffer->text[0] = '\0';
+        }
+
+        return false;
+    }
+    buffer->length = p.offset;
+
+    return true;
+}
+
+CJSON_PUBLIC(const char *) BC_JSON_PrintBufferText(const BC_JSON_PrintBuffer *buffer)
+{
+    if ((buffer == NULL) || (buffer->text == NULL))
+    {
+        return "";
+    }
+
+    return (const char*)buffer->text;
+}
+
+CJSON_PUBLIC(size_t) BC_JSON_PrintBufferLength(const BC_JSON_PrintBuffer *buffer)
+{
+    if (buffer == NULL)
+    {
+        return 0;
+    }
+
+    return buffer->length;
+}
+
+struct BC_JSON_Writer
+{
+    printbuffer output;
+    /* one bit per nesting level, set for objects and cleared for arrays */
+    unsigned char object_levels[(CJSON_NESTING_LIMIT + CHAR_BIT - 1) / CHAR_BIT];
+    /* one bit per nesting level, set once the array/object has an element */
+    unsigned char filled_levels[(CJSON_NESTING_LIMIT + CHAR_BIT - 1) / CHAR_BIT];
+    BC_JSON_bool key_written; /* the key of a member is written, its value isn't yet */
+    BC_JSON_bool complete; /* the top level value is written */
+    BC_JSON_bool failed; /* a call failed, the text is broken and every call fails from now on */
+};
+
+#define writer_level_is_set(levels, depth) (((levels)[((depth) - 1) / CHAR_BIT] >> (((depth) - 1) % CHAR_BIT)) & 1)
+
+static void writer_set_level(unsigned char * const levels, const size_t depth, const BC_JSON_bool set)
+{
+    const unsigned char bit = (unsigned char)(1 << ((depth - 1) % CHAR_BIT));
+
+    if (set)
+    {
+        levels[(depth - 1) / CHAR_BIT] = (unsigned char)(levels[(depth - 1) / CHAR_BIT] | bit);
+    }
+    else
+    {
+        levels[(depth - 1) / CHAR_BIT] = (unsigned char)(levels[(depth - 1) / CHAR_BIT] & ~bit);
+    }
+}
+
+static BC_JSON_Writer *create_writer(const BC_JSON_bool format, const size_t buffer_size)
+{
+    BC_JSON_Writer *writer = (BC_JSON_Writer*)global_hooks.allocate(sizeof(BC_JSON_Writer));
+    if (writer == NULL)
+    {
+        return NULL;
+    }
+    memset(writer, '\0', sizeof(BC_JSON_Writer));
+
+    writer->output.buffer = (unsigned char*)global_hooks.allocate(buffer_size);
+    if (writer->output.buffer == NULL)
+    {
+        global_hooks.deallocate(writer);
+        return NULL;
+    }
+    writer->output.buffer[0] = '\0';
+    writer->output.length = buffer_size;
+    writer->output.offset = 0;
+    writer->output.noalloc = false;
+    writer->output.format = format;
+    writer->output.hooks = global_hooks;
+
+    return writer;
+}
+
+CJSON_PUBLIC(BC_JSON_Writer *) BC_JSON_CreateWriter(BC_JSON_bool format)
+{
+    static const size_t default_buffer_size = 256;
+
+    return create_writer(format, default_buffer_size);
+}
+
+CJSON_PUBLIC(BC_JSON_Writer *) BC_JSON_CreateStreamWriter(BC_JSON_bool format, BC_JSON_WriteFunction write_fn, void *context, size_t chunk_size)
+{
+    static const size_t default_chunk_size = 4096;
+    BC_JSON_Writer *writer = NULL;
+
+    if (write_fn == NULL)
+    {
+        return NULL;
+    }
+
+    if (chunk_size == 0)
+    {
+        chunk_size = default_chunk_size;
+    }
+    else if (chunk_size < (NUMBER_MAX_LENGTH + sizeof("")))
+    {
+        /* numbers are written as a whole */
+        chunk_size = NUMBER_MAX_LENGTH + sizeof("");
+    }
+
+    writer = create_writer(format, chunk_size);
+    if (writer != NULL)
+    {
+        writer->output.write = write_fn;
+        writer->output.write_context = context;
+    }
+
+    return writer;
+}
+
+CJSON_PUBLIC(void) BC_JSON_DeleteWriter(BC_JSON_Writer *writer)
+{
+    if (writer == NULL)
+    {
+        return;
+    }
+
+    if (writer->output.buffer != NULL)
+    {
+        global_hooks.deallocate(writer->output.buffer);
+    }
+    global_hooks.deallocate(writer);
+}
+
+CJSON_PUBLIC(void) BC_JSON_ResetWriter(BC_JSON_Writer *writer)
+{
+    if (writer == NULL)
+    {
+        return;
+    }
+
+    if (writer->output.buffer != NULL)
+    {
+        writer->output.buffer[0] = '\0';
+    }
+    writer->output.offset = 0;
+    writer->output.depth = 0;
+    writer->key_written = false;
+    writer->complete = false;
+    writer->failed = (writer->output.buffer == NULL);
+}
+
+/* append length bytes of text to the output of a writer */
+static BC_JSON_bool writer_append(BC_JSON_Writer * const writer, const char * const text, const size_t length)
+{
+    unsigned char *output_pointer = ensure(&writer->output, length);
+    if (output_pointer == NULL)
+    {
+        return false;
+    }
+    memcpy(output_pointer, text, length);
+    output_pointer[length] = '\0';
+    writer->output.offset += length;
+
+    return true;
+}
+
+/* append the tabs that indent the current nesting level */
+static BC_JSON_bool writer_indent(BC_JSON_Writer * const writer, const size_t depth)
+{
+    unsigned char *output_pointer = ensure(&writer->output, depth);
+    if (output_pointer == NULL)
+    {
+        return false;
+    }
+    memset(output_pointer, '\t', depth);
+    output_pointer[depth] = '\0';
+    writer->output.offset += depth;
+
+    return true;
+}
+
+/* Check that a value can be written where the writer is and write what comes in front of it, like
+ * print_separator does after the previous element. */
+static BC_JSON_bool writer_begin_value(BC_JSON_Writer * const writer)
+{
+    const size_t depth = writer->output.depth;
+
+    if (writer->failed)
+    {
+        return false;
+    }
+
+    if (depth == 0)
+    {
+        if (writer->complete)
+        {
+            goto fail; /* there is only one value at the top level */
+        }
+        return true;
+    }
+
+    if (writer_level_is_set(writer->object_levels, depth))
+    {
+        if (!writer->key_written)
+        {
+            goto fail; /* a member needs a key first */
+        }
+        writer->key_written = false;
+        return true;
+    }
+
+    if (writer_level_is_set(writer->filled_levels, depth))
+    {
+        if (!writer_append(writer, ", ", writer->output.format ? 2 : 1))
+        {
+            goto fail;
+        }
+    }
+    writer_set_level(writer->filled_levels, depth, true);
+
+    return true;
+
+fail:
+    writer->failed = true;
+
+    return false;
+}
+
+/* a value is written, it completes the output if it is at the top level */
+static BC_JSON_bool writer_end_value(BC_JSON_Writer * const writer, const BC_JSON_bool success)
+{
+    if (!success)
+    {
+        writer->failed = true;
+        return false;
+    }
+
+    if (writer->output.depth == 0)
+    {
+        writer->complete = true;
+    }
+
+    return true;
+}
+
+static BC_JSON_bool writer_begin_container(BC_JSON_Writer * const writer, const BC_JSON_bool object)
+{
+    size_t depth = 0;
+
+    if ((writer == NULL) || !writer_begin_value(writer))
+    {
+        return false;
+    }
+    depth = writer->output.depth + 1;
+
+    if (depth > CJSON_NESTING_LIMIT)
+    {
+        writer->failed = true;
+        return false; /* to deeply nested */
+    }
+
+    if (object)
+    {
+        if (!writer_append(writer, "{\n", writer->output.format ? 2 : 1))
+        {
+            writer->failed = true;
+            return false;
+        }
+    }
+    else if (!writer_append(writer, "[", 1))
+    {
+        writer->failed = true;
+        return false;
+    }
+
+    writer_set_level(writer->object_levels, depth, object);
+    writer_set_level(writer->filled_levels, depth, false);
+    writer->output.depth = depth;
+
+    return true;
+}
+
+static BC_JSON_bool writer_end_container(BC_JSON_Writer * const writer, const BC_JSON_bool object)
+{
+    const size_t depth = (writer == NULL) ? 0 : writer->output.depth;
+    BC_JSON_bool success = false;
+
+    if ((writer == NULL) || writer->failed)
+    {
+        return false;
+    }
+
+    if ((depth == 0) || (writer_level_is_set(writer->object_levels, depth) != (object ? 1 : 0)) || writer->key_written)
+    {
+        /* nothing to close, the wrong kind of container or a key without a value */
+        writer->failed = true;
+        return false;
+    }
+
+    if (object)
+    {
+        /* the newline after the last member, like print_separator, and the indentation */
+        success = (!writer->output.format || !writer_level_is_set(writer->filled_levels, depth) || writer_append(writer, "\n", 1))
+            && (!writer->output.format || writer_indent(writer, depth - 1))
+            && writer_append(writer, "}", 1);
+    }
+    else
+    {
+        success = writer_append(writer, "]", 1);
+    }
+    writer->output.depth--;
+
+    return writer_end_value(writer, success);
+}
+
+CJSON_PUBLIC(BC_JSON_bool) BC_JSON_WriterBeginObject(BC_JSON_Writer *writer)
+{
+    return writer_begin_container(writer, true);
+}
+
+CJSON_PUBLIC(BC_JSON_bool) BC_JSON_WriterEndObject(BC_JSON_Writer *writer)
+{
+    return writer_end_container(writer, true);
+}
+
+CJSON_PUBLIC(BC_JSON_bool) BC_JSON_WriterBeginArray(BC_JSON_Writer *writer)
+{
+    return writer_begin_container(writer, false);
+}
+
+CJSON_PUBLIC(BC_JSON_bool) BC_JSON_WriterEndArray(BC_JSON_Writer *writer)
+{
+    return writer_end_container(writer, false);
+}
+
+CJSON_PUBLIC(BC_JSON_bool) BC_JSON_WriterKey(BC_JSON_Writer *writer, const char *key)
+{
+    const size_t depth = (writer == NULL) ? 0 : writer->output.depth;
+    BC_JSON_bool success = false;
+
+    if ((writer == NULL) || writer->failed)
+    {
+        return false;
+    }
+
+    if ((key == NULL) || (depth == 0) || !writer_level_is_set(writer->object_levels, depth) || writer->key_written)
+    {
+        /* keys only go into objects, one per member */
+        writer->failed = true;
+        return false;
+    }
+
+    /* the comma after the previous member, like print_separator, and the key like print_member_key */
+    success = (!writer_level_is_set(writer->filled_levels, depth) || writer_append(writer, ",\n", writer->output.format ? 2 : 1))
+        && (!writer->output.format || writer_indent(writer, depth))
+        && print_string_ptr((const unsigned char*)key, &writer->output)
+        && writer_append(writer, ":\t", writer->output.format ? 2 : 1);
+    if (!success)
+    {
+        writer->failed = true;
+        return false;
+    }
+    writer_set_level(writer->filled_levels, depth, true);
+    writer->key_written = true;
+
+    return true;
+}
+
+CJSON_PUBLIC(BC_JSON_bool) BC_JSON_WriterString(BC_JSON_Writer *writer, const char *string)
+{
+    if ((writer == NULL) || !writer_begin_value(writer))
+    {
+        return false;
+    }
+
+    return writer_end_value(writer, print_string_ptr((const unsigned char*)string, &writer->output));
+}
+
+CJSON_PUBLIC(BC_JSON_bool) BC_JSON_WriterNumber(BC_JSON_Writer *writer, double number)
+{
+    BC_JSON item;
+
+    if ((writer == NULL) || !writer_begin_value(writer))
+    {
+        return false;
+    }
+
+    /* print it like a number item, so the text is the same */
+    memset(&item, '\0', sizeof(item));
+    item.type = JSON_TYPE.NUMBER;
+    item.value_number = number;
+
+    return writer_end_value(writer, print_number(&item, &writer->output));
+}
+
+CJSON_PUBLIC(BC_JSON_bool) BC_JSON_WriterBool(BC_JSON_Writer *writer, BC_JSON_bool boolean)
+{
+    if ((writer == NULL) || !writer_begin_value(writer))
+    {
+        return false;
+    }
+
+    if (boolean)
+    {
+        return writer_end_value(writer, writer_append(writer, "true", static_strlen("true")));
+    }
+
+    return writer_end_value(writer, writer_append(writer, "false", static_strlen("false")));
+}
+
+CJSON_PUBLIC(BC_JSON_bool) BC_JSON_WriterNull(BC_JSON_Writer *writer)
+{
+    if ((writer == NULL) || !writer_begin_value(writer))
+    {
+        return false;
+    }
+
+    return writer_end_value(writer, writer_append(writer, "null", static_strlen("null")));
+}
+
+CJSON_PUBLIC(BC_JSON_bool) BC_JSON_WriterRaw(BC_JSON_Writer *writer, const char *raw)
+{
+    if ((writer == NULL) || !writer_begin_value(writer))
+    {
+        return false;
+    }
+
+    return writer_end_value(writer, (raw != NULL) && writer_append(writer, raw, strlen(raw)));
+}
+
+CJSON_PUBLIC(BC_JSON_bool) BC_JSON_WriterFinish(BC_JSON_Writer *writer)
+{
+    if ((writer == NULL) || writer->failed || !writer->complete)
+    {
+        return false;
+    }
+
+    if ((writer->output.write != NULL) && !flush_printbuffer(&writer->output))
+    {
+        writer->failed = true;
+        return false;
+    }
+
+    return true;
+}
+
+CJSON_PUBLIC(const char *) BC_JSON_WriterText(const BC_JSON_Writer *writer)
+{
+    if ((writer == NULL) || (writer->output.buffer == NULL))
+    {
+        return "";
+    }
+
+    return (const char*)writer->output.buffer;
+}
+
+CJSON_PUBLIC(size_t) BC_JSON_WriterLength(const BC_JSON_Writer *writer)
+{
+    if (writer == NULL)
+    {
+        return 0;
+    }
+
+    return writer->output.offset;
+}
+
+#undef writer_level_is_set
+
+/* Parse a value that isn't an array or object. */
+static BC_JSON_bool parse_scalar(BC_JSON * const item, parse_buffer * const input_buffer)
+{
+    /* parse the different types of values */
     /* null */
     if (can_read(input_buffer, 4) && (strncmp((const char*)buffer_at_offset(input_buffer), "null", 4) == 0))
     {
-        item->type = BC_JSON_NULL;
-        input_buffer->offset += 4;
+        item->type = BC_JSON_NULL;
+        input_buffer->offset += 4;
+        return true;
+    }
+    /* false */
+    if (can_read(input_buffer, 5) && (strncmp((const char*)buffer_at_offset(input_buffer), "false", 5) == 0))
+    {
+        item->type = BC_JSON_False;
+        input_buffer->offset += 5;
+        return true;
+    }
+    /* true */
+    if (can_read(input_buffer, 4) && (strncmp((const char*)buffer_at_offset(input_buffer), "true", 4) == 0))
+    {
+        item->type = BC_JSON_True;
+        input_buffer->offset += 4;
+        return true;
+    }
+    /* string */
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '\"'))
+    {
+        return parse_string(item, input_buffer);
+    }
+    /* number */
+    if (can_access_at_index(input_buffer, 0) && ((buffer_at_offset(input_buffer)[0] == '-') || ((buffer_at_offset(input_buffer)[0] >= '0') && (buffer_at_offset(input_buffer)[0] <= '9'))))
+    {
+        return parse_number(item, input_buffer);
+    }
+
+    return false;
+}
+
+/* Parser core - when encountering text, process appropriately. */
+static BC_JSON_bool parse_value(BC_JSON * const item, parse_buffer * const input_buffer)
+{
+    if ((input_buffer == NULL) || (input_buffer->content == NULL))
+    {
+        return false; /* no input */
+    }
+
+    /* array */
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '['))
+    {
+        return parse_array(item, input_buffer);
+    }
+    /* object */
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '{'))
+    {
+        return parse_object(item, input_buffer);
+    }
+
+    return parse_scalar(item, input_buffer);
+}
+
+/* Render a value to text. */
+static BC_JSON_bool print_value(const BC_JSON * const item, printbuffer * const output_buffer)
+{
+    unsigned char *output = NULL;
+
+    if ((item == NULL) || (output_buffer == NULL))
+    {
+        return false;
+    }
+
+    switch ((item->type) & 0xFF)
+    {
+        case BC_JSON_NULL:
+            output = ensure(output_buffer, static_strlen("null"));
+            if (output == NULL)
+            {
+                return false;
+            }
+            strcpy((char*)output, "null");
+            output_buffer->offset += static_strlen("null");
+            return true;
+
+        case BC_JSON_False:
+            output = ensure(output_buffer, static_strlen("false"));
+            if (output == NULL)
+            {
+                return false;
+            }
+            strcpy((char*)output, "false");
+            output_buffer->offset += static_strlen("false");
+            return true;
+
+        case BC_JSON_True:
+            output = ensure(output_buffer, static_strlen("true"));
+            if (output == NULL)
+            {
+                return false;
+            }
+            strcpy((char*)output, "true");
+            output_buffer->offset += static_strlen("true");
+            return true;
+
+        case JSON_TYPE.NUMBER:
+            return print_number(item, output_buffer);
+
+        case BC_JSON_Raw:
+        {
+            size_t raw_length = 0;
+            if (item->value_string == NULL)
+            {
+                return false;
+            }
+
+            raw_length = strlen(item->value_string);
+            if ((output_buffer->write != NULL) && ((raw_length + sizeof("")) > output_buffer->length))
+            {
+                return print_through((const unsigned char*)item->value_string, raw_length, output_buffer);
+            }
+            if ((output_buffer->segments != NULL) && (raw_length >= output_buffer->segments->threshold))
+            {
+                return print_reference((const unsigned char*)item->value_string, raw_length, output_buffer);
+            }
+            output = ensure(output_buffer, raw_length);
+            if (output == NULL)
+            {
+                return false;
+            }
+            memcpy(output, item->value_string, raw_length + sizeof(""));
+            output_buffer->offset += raw_length;
+            return true;
+        }
+
+        case BC_JSON_String:
+            return print_string(item, output_buffer);
+
+        case BC_JSON_Array:
+            return print_array(item, output_buffer);
+
+        case BC_JSON_Object:
+            return print_object(item, output_buffer);
+
+        default:
+            return false;
+    }
+}
+
+/* the character that closes an array/object that is being parsed */
+#define closing_bracket(container) (((container)->type & BC_JSON_Array) ? ']' : '}')
+/* flags of an item that tell how its key is stored, they survive parsing its value */
+#define KEY_FLAGS (BC_JSON_StringIsConst | BC_JSON_StringIsInterned)
+
+/* Keep the array/object at the offset as a raw item with its text as it is, after checking it. */
+static BC_JSON_bool parse_raw(BC_JSON * const item, parse_buffer * const input_buffer)
+{
+    const size_t start = input_buffer->offset;
+    unsigned char *text = NULL;
+    size_t length = 0;
+
+    if (!skip_value(input_buffer))
+    {
+        return false;
+    }
+
+    length = input_buffer->offset - start;
+    text = parse_allocate(input_buffer, length + sizeof(""));
+    if (text == NULL)
+    {
+        return false; /* allocation failure */
+    }
+    memcpy(text, input_buffer->content + start, length);
+    text[length] = '\0';
+
+    item->type = BC_JSON_Raw;
+    item->value_string = (char*)text;
+
+    return true;
+}
+
+/* Build an array or object, including everything nested in it, from the text at the offset.
+ *
+ * This doesn't recurse. The state of every array/object that is still open is kept in the tree
+ * itself: its type is already set, its child points to the elements so far with the last one in
+ * child->prev as usual, and next points to the array/object it is nested in (it is always the last
+ * element of that one). This way the parse needs neither the C stack nor an allocation for nesting,
+ * so the depth is only limited by nesting_limit. */
+static BC_JSON_bool parse_container(BC_JSON * const item, parse_buffer * const input_buffer)
+{
+    const int item_type = item->type;
+    BC_JSON *container = NULL; /* innermost array/object that is still open */
+    BC_JSON *current_item = item; /* value that is being parsed */
+    BC_JSON *parent = NULL;
+    int key_flags = 0;
+    size_t value_start = 0;
+
+    for (;;)
+    {
+        /* open the array/object at the current offset */
+        if (input_buffer->depth >= nesting_limit(input_buffer))
+        {
+            goto fail; /* to deeply nested */
+        }
+        input_buffer->depth++;
+        if ((input_buffer->spans != NULL) && !open_span(input_buffer, current_item))
+        {
+            goto fail; /* allocation failure */
+        }
+
+        current_item->type = (current_item->type & KEY_FLAGS) | ((buffer_at_offset(input_buffer)[0] == '[') ? BC_JSON_Array : BC_JSON_Object);
+        if (current_item != item)
+        {
+            current_item->next = container;
+        }
+        container = current_item;
+
+        input_buffer->offset++;
+        buffer_skip_whitespace(input_buffer);
+        if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == closing_bracket(container)))
+        {
+            goto close_containers; /* empty array/object */
+        }
+
+        /* check if we skipped to the end of the buffer */
+        if (cannot_access_at_index(input_buffer, 0))
+        {
+            input_buffer->offset--;
+            goto fail;
+        }
+
+        /* step back to character in front of the first element */
+        input_buffer->offset--;
+        /* loop through the comma separated elements, the offset is at the character in front of the next one */
+        for (;;)
+        {
+            /* allocate next item */
+            BC_JSON *new_item = parse_new_item(input_buffer);
+            BC_JSON *last = (container->child == NULL) ? NULL : container->child->prev;
+            if (new_item == NULL)
+            {
+                goto fail; /* allocation failure */
+            }
+
+            /* attach next item to the list */
+            if (last == NULL)
+            {
+                /* start the linked list */
+                container->child = new_item;
+            }
+            else
+            {
+                /* add to the end */
+                last->next = new_item;
+                new_item->prev = last;
+            }
+            container->child->prev = new_item;
+            current_item = new_item;
+
+            if (container->type & BC_JSON_Object)
+            {
+                if (cannot_access_at_index(input_buffer, 1))
+                {
+                    goto fail; /* nothing comes after the comma */
+                }
+
+                /* parse the name of the child */
+                input_buffer->offset++;
+                buffer_skip_whitespace(input_buffer);
+                if ((input_buffer->shape_cache != NULL) && ((last == NULL) || ((last->type & BC_JSON_StringIsInterned) && (interned_key_header(last->string)->shape != NULL))))
+                {
+                    /* the keys so far have a shape, it is the one of the last key */
+                    object_shape *shape = (last == NULL) ? NULL : interned_key_header(last->string)->shape;
+                    if (!parse_shaped_key(current_item, input_buffer, &shape))
+                    {
+                        goto fail; /* failed to parse name */
+                    }
+                }
+                else if (!parse_symbol_key(current_item, input_buffer))
+                {
+                    if (!parse_string(current_item, input_buffer))
+                    {
+                        goto fail; /* failed to parse name */
+                    }
+
+                    /* swap value_string and string, because we parsed the name */
+                    current_item->string = current_item->value_string;
+                    current_item->value_string = NULL;
+                    if (current_item->type & BC_JSON_IsReference)
+                    {
+                        current_item->type = BC_JSON_StringIsConst; /* the name is in the text of an in situ parse */
+                    }
+                }
+                buffer_skip_whitespace(input_buffer);
+
+                if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != ':'))
+                {
+                    goto fail; /* invalid object */
+                }
+            }
+
+            /* parse the value */
+            input_buffer->offset++;
+            buffer_skip_whitespace(input_buffer);
+            key_flags = current_item->type & KEY_FLAGS;
+            value_start = input_buffer->offset;
+            if (can_access_at_index(input_buffer, 0) && ((buffer_at_offset(input_buffer)[0] == '[') || (buffer_at_offset(input_buffer)[0] == '{')))
+            {
+                if ((input_buffer->raw_depth == 0) || (input_buffer->depth < input_buffer->raw_depth))
+                {
+                    break; /* nested array/object */
+                }
+                if (!parse_raw(current_item, input_buffer))
+                {
+                    goto fail; /* failed to parse value */
+                }
+            }
+            else if (!parse_scalar(current_item, input_buffer))
+            {
+                goto fail; /* failed to parse value */
+            }
+            /* parse_scalar/parse_raw replaced the type */
+            current_item->type |= key_flags;
+            if ((input_buffer->spans != NULL) && !record_span(input_buffer, current_item, value_start, input_buffer->offset))
+            {
+                goto fail; /* allocation failure */
+            }
+
+close_containers:
+            /* close the finished arrays/objects until there is a next element */
+            for (;;)
+            {
+                buffer_skip_whitespace(input_buffer);
+                if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ',') && !skip_trailing_comma(input_buffer, closing_bracket(container)))
+                {
+                    break;
+                }
+
+                if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != closing_bracket(container)))
+                {
+                    goto fail; /* expected end of array/object */
+                }
+
+                input_buffer->depth--;
+                input_buffer->offset++;
+                if (input_buffer->spans != NULL)
+                {
+                    close_span(input_buffer);
+                }
+                if ((input_buffer->shape_cache != NULL) && (container->type & BC_JSON_Object))
+                {
+                    index_shaped_object(container, input_buffer);
+                }
+                if (container == item)
+                {
+                    return true;
+                }
+
+                parent = container->next;
+                container->next = NULL;
+                container = parent;
+            }
+        }
+    }
+
+fail:
+    /* Unwind the open arrays/objects from the inside out. Every one of them is the last element of
+     * the one it is nested in, so it has to be detached from its parent first. */
+    while (container != NULL)
+    {
+        parent = (container == item) ? NULL : container->next;
+        if (container != item)
+        {
+            container->next = NULL;
+        }
+        if (container->child != NULL)
+        {
+            parse_delete(input_buffer, container->child);
+            container->child = NULL;
+        }
+        container = parent;
+    }
+    item->type = item_type;
+
+    return false;
+}
+
+/* Build an array from input text. */
+static BC_JSON_bool parse_array(BC_JSON * const item, parse_buffer * const input_buffer)
+{
+    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != '['))
+    {
+        return false; /* not an array */
+    }
+
+    return parse_container(item, input_buffer);
+}
+
+/* Render the opening bracket of an array/object. */
+static BC_JSON_bool print_opening(const BC_JSON * const item, printbuffer * const output_buffer)
+{
+    unsigned char *output_pointer = NULL;
+    size_t length = 0;
+
+    if ((item->type & 0xFF) == BC_JSON_Array)
+    {
+        /* opening square bracket */
+        output_pointer = ensure(output_buffer, 1);
+        if (output_pointer == NULL)
+        {
+            return false;
+        }
+
+        *output_pointer = '[';
+        output_buffer->offset++;
+        output_buffer->depth++;
+
         return true;
     }
-    /* false */
-    if (can_read(input_buffer, 5) && (strncmp((const char*)buffer_at_offset(input_buffer), "false", 5) == 0))
+
+    length = (size_t) (output_buffer->format ? 2 : 1); /* fmt: {\n */
+    output_pointer = ensure(output_buffer, length);
+    if (output_pointer == NULL)
     {
-        item->type = BC_JSON_False;
-        input_buffer->offset += 5;
+        return false;
+    }
+
+    *output_pointer++ = '{';
+    output_buffer->depth++;
+    if (output_buffer->format)
+    {
+        *output_pointer++ = '\n';
+    }
+    output_buffer->offset += length;
+
+    return true;
+}
+
+/* Render the indentation and key of a member of an object. */
+static BC_JSON_bool print_member_key(const BC_JSON * const item, printbuffer * const output_buffer)
+{
+    unsigned char *output_pointer = NULL;
+    size_t length = 0;
+
+    if (output_buffer->format)
+    {
+        size_t i;
+        output_pointer = ensure(output_buffer, output_buffer->depth);
+        if (output_pointer == NULL)
+        {
+            return false;
+        }
+        for (i = 0; i < output_buffer->depth; i++)
+        {
+            *output_pointer++ = '\t';
+        }
+        output_buffer->offset += output_buffer->depth;
+    }
+
+    /* print key */
+    if (!print_string_ptr((unsigned char*)item->string, output_buffer))
+    {
+        return false;
+    }
+
+    length = (size_t) (output_buffer->format ? 2 : 1);
+    output_pointer = ensure(output_buffer, length);
+    if (output_pointer == NULL)
+    {
+        return false;
+    }
+    *output_pointer++ = ':';
+    if (output_buffer->format)
+    {
+        *output_pointer++ = '\t';
+    }
+    output_buffer->offset += length;
+
+    return true;
+}
+
+/* Render what follows an element of an array/object: a comma if it is not the last one. */
+static BC_JSON_bool print_separator(const BC_JSON * const container, const BC_JSON * const element, printbuffer * const output_buffer)
+{
+    unsigned char *output_pointer = NULL;
+    size_t length = 0;
+
+    if ((container->type & 0xFF) == BC_JSON_Array)
+    {
+        if (element->next)
+        {
+            length = (size_t) (output_buffer->format ? 2 : 1);
+            output_pointer = ensure(output_buffer, length);
+            if (output_pointer == NULL)
+            {
+                return false;
+            }
+            *output_pointer++ = ',';
+            if(output_buffer->format)
+            {
+                *output_pointer++ = ' ';
+            }
+            *output_pointer = '\0';
+            output_buffer->offset += length;
+        }
+
         return true;
     }
-    /* true */
-    if (can_read(input_buffer, 4) && (strncmp((const char*)buffer_at_offset(input_buffer), "true", 4) == 0))
+
+    /* print comma if not last */
+    length = ((size_t)(output_buffer->format ? 1 : 0) + (size_t)(element->next ? 1 : 0));
+    output_pointer = ensure(output_buffer, length);
+    if (output_pointer == NULL)
     {
-        item->type = BC_JSON_True;
-        input_buffer->offset += 4;
+        return false;
+    }
+    if (element->next)
+    {
+        *output_pointer++ = ',';
+    }
+
+    if (output_buffer->format)
+    {
+        *output_pointer++ = '\n';
+    }
+    *output_pointer = '\0';
+    output_buffer->offset += length;
+
+    return true;
+}
+
+/* Render the closing bracket of an array/object. */
+static BC_JSON_bool print_closing(const BC_JSON * const item, printbuffer * const output_buffer)
+{
+    unsigned char *output_pointer = NULL;
+
+    if ((item->type & 0xFF) == BC_JSON_Array)
+    {
+        output_pointer = ensure(output_buffer, 1);
+        if (output_pointer == NULL)
+        {
+            return false;
+        }
+        *output_pointer++ = ']';
+        *output_pointer = '\0';
+        output_buffer->offset++;
+        output_buffer->depth--;
+
         return true;
     }
-    /* string */
-    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '\"'))
+
+    output_pointer = ensure(output_buffer, output_buffer->format ? output_buffer->depth : 1);
+    if (output_pointer == NULL)
     {
-        return parse_string(item, input_buffer);
+        return false;
     }
-    /* number */
-    if (can_access_at_index(input_buffer, 0) && ((buffer_at_offset(input_buffer)[0] == '-') || ((buffer_at_offset(input_buffer)[0] >= '0') && (buffer_at_offset(input_buffer)[0] <= '9'))))
+    if (output_buffer->format)
     {
-        return parse_number(item, input_buffer);
+        size_t i;
+        for (i = 0; i < (output_buffer->depth - 1); i++)
+        {
+            *output_pointer++ = '\t';
+        }
+        output_buffer->offset += output_buffer->depth - 1;
+    }
+    *output_pointer++ = '}';
+    *output_pointer = '\0';
+    output_buffer->offset++;
+    output_buffer->depth--;
+
+    return true;
+}
+
+/* Render the elements of an array/object from first up to, but not including, stop with
+ * everything in them, after the opening bracket is printed. The arrays/objects that are being
+ * printed are kept on an explicit stack, so deep nesting doesn't use up the call stack. */
+static BC_JSON_bool print_elements(const BC_JSON * const item, const BC_JSON * const first, const BC_JSON * const stop, printbuffer * const output_buffer)
+{
+    const BC_JSON *inline_frames[WALK_STACK_INLINE_FRAMES];
+    const BC_JSON **parents = inline_frames;
+    const BC_JSON **grown = NULL;
+    size_t capacity = WALK_STACK_INLINE_FRAMES;
+    size_t depth = 0;
+    const BC_JSON *container = item;
+    const BC_JSON *current = first;
+    BC_JSON_bool success = false;
+
+    for (;;)
+    {
+        if ((depth == 0) && (current == stop))
+        {
+            success = true;
+            goto end;
+        }
+
+        if (current == NULL)
+        {
+            /* all elements are printed, continue with the array/object it is in */
+            if (!print_closing(container, output_buffer))
+            {
+                goto end;
+            }
+            depth--;
+            current = container;
+            container = parents[depth];
+        }
+        else
+        {
+            if (((container->type & 0xFF) == BC_JSON_Object) && !print_member_key(current, output_buffer))
+            {
+                goto end;
+            }
+
+            if (((current->type & 0xFF) == BC_JSON_Array) || ((current->type & 0xFF) == BC_JSON_Object))
+            {
+                /* descend into the elements */
+                if (depth == capacity)
+                {
+                    grown = (const BC_JSON**)grow_walk_stack((void*)parents, &capacity, sizeof(const BC_JSON*), (const void*)inline_frames);
+                    if (grown == NULL)
+                    {
+                        goto end;
+                    }
+                    parents = grown;
+                }
+                parents[depth] = container;
+                depth++;
+                container = current;
+                if (!print_opening(container, output_buffer))
+                {
+                    goto end;
+                }
+                current = container->child;
+                continue;
+            }
+
+            if (!print_value(current, output_buffer))
+            {
+                goto end;
+            }
+        }
+
+        /* the element is complete */
+        if (!print_separator(container, current, output_buffer))
+        {
+            goto end;
+        }
+        current = current->next;
     }
-    /* array */
-    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '['))
+
+end:
+    if (parents != inline_frames)
     {
-        return parse_array(item, input_buffer);
+        global_hooks.deallocate((void*)parents);
     }
-    /* object */
-    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '{'))
+
+    return success;
+}
+
+/* Render an array/object with everything in it to text. */
+static BC_JSON_bool print_container(const BC_JSON * const item, printbuffer * const output_buffer)
+{
+    if ((item == NULL) || (output_buffer == NULL))
     {
-        return parse_object(item, input_buffer);
+        return false;
     }
 
-    return false;
+    return print_opening(item, output_buffer)
+        && print_elements(item, item->child, NULL, output_buffer)
+        && print_closing(item, output_buffer);
 }
 
-/* Render a value to text. */
-static BC_JSON_bool print_value(const BC_JSON * const item, printbuffer * const output_buffer)
+/* Render an array to text */
+static BC_JSON_bool print_array(const BC_JSON * const item, printbuffer * const output_buffer)
 {
-    unsigned char *output = NULL;
+    return print_container(item, output_buffer);
+}
 
-    if ((item == NULL) || (output_buffer == NULL))
+/* Build an object from the text. */
+static BC_JSON_bool parse_object(BC_JSON * const item, parse_buffer * const input_buffer)
+{
+    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != '{'))
     {
-        return false;
+        return false; /* not an object */
     }
 
+    return parse_container(item, input_buffer);
+}
+
+/* Render an object to text. */
+static BC_JSON_bool print_object(const BC_JSON * const item, printbuffer * const output_buffer)
+{
+    return print_container(item, output_buffer);
+}
+
+/* The length of the text print_value renders for a value that isn't an array or object. */
+static BC_JSON_bool printed_scalar_length(const BC_JSON * const item, size_t * const length)
+{
+    size_t escape_characters = 0;
+
     switch ((item->type) & 0xFF)
     {
         case BC_JSON_NULL:
-            output = ensure(output_buffer, 5);
-            if (output == NULL)
-            {
-                return false;
-            }
-            strcpy((char*)output, "null");
+            *length = static_strlen("null");
             return true;
 
         case BC_JSON_False:
-            output = ensure(output_buffer, 6);
-            if (output == NULL)
-            {
-                return false;
-            }
-            strcpy((char*)output, "false");
+            *length = static_strlen("false");
             return true;
 
         case BC_JSON_True:
-            output = ensure(output_buffer, 5);
-            if (output == NULL)
-            {
-                return false;
-            }
-            strcpy((char*)output, "true");
+            *length = static_strlen("true");
             return true;
 
         case JSON_TYPE.NUMBER:
-            return print_number(item, output_buffer);
+            *length = format_number(item, NULL);
+            return *length != 0;
 
         case BC_JSON_Raw:
-        {
-            size_t raw_length = 0;
             if (item->value_string == NULL)
             {
                 return false;
             }
+            *length = strlen(item->value_string);
+            return true;
 
-            raw_length = strlen(item->value_string) + sizeof("");
-            output = ensure(output_buffer, raw_length);
-            if (output == NULL)
+        case BC_JSON_String:
+            *length = static_strlen("\"\"");
+            if (item->value_string != NULL)
             {
-                return false;
+                *length += escaped_length((const unsigned char*)item->value_string, &escape_characters);
             }
-            memcpy(output, item->value_string, raw_length);
             return true;
+
+        default:
+            return false;
+    }
+}
+
+/* The length of the brackets of an array/object whose elements are at the given depth, the
+ * indentation before the closing bracket of an object included. */
+static size_t printed_brackets_length(const BC_JSON * const container, const size_t depth, const BC_JSON_bool format)
+{
+    if ((container->type & 0xFF) == BC_JSON_Array)
+    {
+        return static_strlen("[]");
+    }
+
+    /* fmt: {\n, the tabs and } */
+    return format ? (static_strlen("{\n}") + depth - 1) : static_strlen("{}");
+}
+
+/* The length of what print_container renders around an element: the indentation and key of an
+ * object member, and the separator after it. */
+static size_t printed_element_overhead(const BC_JSON * const container, const BC_JSON * const element, const size_t depth, const BC_JSON_bool format, size_t * const key_escapes)
+{
+    size_t length = 0;
+
+    if ((container->type & 0xFF) == BC_JSON_Array)
+    {
+        if (element->next != NULL)
+        {
+            length = format ? static_strlen(", ") : static_strlen(",");
         }
 
-        case BC_JSON_String:
-            return print_string(item, output_buffer);
+        return length;
+    }
 
-        case BC_JSON_Array:
-            return print_array(item, output_buffer);
+    /* indentation, key, colon and the newline after the member */
+    length = format ? (depth + static_strlen(":\t") + static_strlen("\n")) : static_strlen(":");
+    length += static_strlen("\"\"");
+    if (element->string != NULL)
+    {
+        length += escaped_length((const unsigned char*)element->string, key_escapes);
+    }
+    if (element->next != NULL)
+    {
+        length += static_strlen(",");
+    }
 
-        case BC_JSON_Object:
-            return print_object(item, output_buffer);
+    return length;
+}
 
-        default:
-            return false;
+CJSON_PUBLIC(size_t) BC_JSON_PrintedLength(const BC_JSON *item, BC_JSON_bool format)
+{
+    const BC_JSON *inline_frames[WALK_STACK_INLINE_FRAMES];
+    const BC_JSON **parents = inline_frames;
+    const BC_JSON **grown = NULL;
+    size_t capacity = WALK_STACK_INLINE_FRAMES;
+    size_t depth = 0;
+    const BC_JSON *container = item;
+    const BC_JSON *current = NULL;
+    size_t key_escapes = 0;
+    size_t element_length = 0;
+    size_t length = 0;
+
+    if (item == NULL)
+    {
+        return 0;
+    }
+
+    if (((item->type & 0xFF) != BC_JSON_Array) && ((item->type & 0xFF) != BC_JSON_Object))
+    {
+        return printed_scalar_length(item, &length) ? length : 0;
+    }
+
+    /* walk the elements the same way print_container does, depth counts the open arrays/objects */
+    depth = 1;
+    length = printed_brackets_length(container, depth, format);
+    current = container->child;
+    for (;;)
+    {
+        if (current == NULL)
+        {
+            /* all elements are measured, continue with the array/object it is in */
+            depth--;
+            if (depth == 0)
+            {
+                break;
+            }
+            current = container;
+            container = parents[depth - 1];
+        }
+        else
+        {
+            length += printed_element_overhead(container, current, depth, format, &key_escapes);
+
+            if (((current->type & 0xFF) == BC_JSON_Array) || ((current->type & 0xFF) == BC_JSON_Object))
+            {
+                /* descend into the elements */
+                if (depth > capacity)
+                {
+                    grown = (const BC_JSON**)grow_walk_stack((void*)parents, &capacity, sizeof(const BC_JSON*), (const void*)inline_frames);
+                    if (grown == NULL)
+                    {
+                        length = 0;
+                        break;
+                    }
+                    parents = grown;
+                }
+                parents[depth - 1] = container;
+                depth++;
+                container = current;
+                length += printed_brackets_length(container, depth, format);
+                current = container->child;
+                continue;
+            }
+
+            if (!printed_scalar_length(current, &element_length))
+            {
+                length = 0;
+                break;
+            }
+            length += element_length;
+        }
+
+        current = current->next;
     }
+
+    if (parents != inline_frames)
+    {
+        global_hooks.deallocate((void*)parents);
+    }
+
+    return length;
 }
 
-/* Build an array from input text. */
-static BC_JSON_bool parse_array(BC_JSON * const item, parse_buffer * const input_buffer)
+/* Fewer elements than this per thread are printed on the calling thread. */
+#define PARALLEL_MIN_ELEMENTS 256
+
+/* A run of elements of the array/object that BC_JSON_PrintParallel splits, printed into its own buffer. */
+typedef struct
 {
-    BC_JSON *head = NULL; /* head of the linked list */
-    BC_JSON *current_item = NULL;
+    const BC_JSON *container;
+    const BC_JSON *first;
+    const BC_JSON *stop;
+    printbuffer buffer;
+    BC_JSON_bool success;
+#if defined(CJSON_THREADS_POSIX)
+    pthread_t thread;
+#elif defined(CJSON_THREADS_WIN32)
+    HANDLE thread;
+#endif
+    BC_JSON_bool started;
+} print_chunk;
 
-    if (input_buffer->depth >= CJSON_NESTING_LIMIT)
+static void print_chunk_elements(print_chunk * const chunk)
+{
+    static const size_t default_buffer_size = 256;
+
+    chunk->buffer.buffer = (unsigned char*)chunk->buffer.hooks.allocate(default_buffer_size);
+    if (chunk->buffer.buffer == NULL)
     {
-        return false; /* to deeply nested */
+        chunk->success = false;
+        return;
+    }
+    chunk->buffer.length = default_buffer_size;
+
+    chunk->success = print_elements(chunk->container, chunk->first, chunk->stop, &chunk->buffer);
+}
+
+#if defined(CJSON_THREADS_POSIX)
+static void *print_chunk_thread(void *chunk)
+{
+    print_chunk_elements((print_chunk*)chunk);
+
+    return NULL;
+}
+
+static BC_JSON_bool start_chunk_thread(print_chunk * const chunk)
+{
+    return pthread_create(&chunk->thread, NULL, print_chunk_thread, (void*)chunk) == 0;
+}
+
+static void join_chunk_thread(print_chunk * const chunk)
+{
+    pthread_join(chunk->thread, NULL);
+}
+#elif defined(CJSON_THREADS_WIN32)
+static DWORD WINAPI print_chunk_thread(LPVOID chunk)
+{
+    print_chunk_elements((print_chunk*)chunk);
+
+    return 0;
+}
+
+static BC_JSON_bool start_chunk_thread(print_chunk * const chunk)
+{
+    chunk->thread = CreateThread(NULL, 0, print_chunk_thread, (LPVOID)chunk, 0, NULL);
+
+    return chunk->thread != NULL;
+}
+
+static void join_chunk_thread(print_chunk * const chunk)
+{
+    WaitForSingleObject(chunk->thread, INFINITE);
+    CloseHandle(chunk->thread);
+}
+#else
+static BC_JSON_bool start_chunk_thread(print_chunk * const chunk)
+{
+    (void)chunk;
+
+    return false;
+}
+
+static void join_chunk_thread(print_chunk * const chunk)
+{
+    (void)chunk;
+}
+#endif
+
+CJSON_PUBLIC(char *) BC_JSON_PrintParallel(const BC_JSON *item, BC_JSON_bool format, int threads)
+{
+    static const size_t default_buffer_size = 64;
+    printbuffer head = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0 };
+    printbuffer tail = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0 };
+    const BC_JSON *container = NULL;
+    const BC_JSON *level = NULL;
+    const BC_JSON *element = NULL;
+    print_chunk *chunks = NULL;
+    size_t chunk_count = 0;
+    size_t element_count = 0;
+    size_t per_chunk = 0;
+    size_t length = 0;
+    size_t i = 0;
+    unsigned char *printed = NULL;
+    unsigned char *output_pointer = NULL;
+
+    if (item == NULL)
+    {
+        return NULL;
+    }
+
+    /* split the first array/object that has more than one element, going down through
+     * arrays/objects with just one element like {"records":[...]} */
+    container = item;
+    while ((((container->type & 0xFF) == BC_JSON_Array) || ((container->type & 0xFF) == BC_JSON_Object))
+        && (container->child != NULL) && (container->child->next == NULL))
+    {
+        container = container->child;
+    }
+    if (((container->type & 0xFF) == BC_JSON_Array) || ((container->type & 0xFF) == BC_JSON_Object))
+    {
+        for (element = container->child; element != NULL; element = element->next)
+        {
+            element_count++;
+        }
+    }
+    if (threads > 1)
+    {
+        chunk_count = element_count / PARALLEL_MIN_ELEMENTS;
+        if (chunk_count > (size_t)threads)
+        {
+            chunk_count = (size_t)threads;
+        }
+    }
+    if (chunk_count < 2)
+    {
+        return (char*)print(item, format, &global_hooks);
+    }
+
+    head.buffer = (unsigned char*)global_hooks.allocate(default_buffer_size);
+    tail.buffer = (unsigned char*)global_hooks.allocate(default_buffer_size);
+    if ((head.buffer == NULL) || (tail.buffer == NULL))
+    {
+        goto fail;
+    }
+    head.length = default_buffer_size;
+    head.format = format;
+    head.hooks = global_hooks;
+    tail.length = default_buffer_size;
+    tail.format = format;
+    tail.hooks = global_hooks;
+
+    /* print everything before the elements: the opening brackets and keys on the way down */
+    for (level = item; level != container; level = level->child)
+    {
+        if (!print_opening(level, &head)
+            || (((level->type & 0xFF) == BC_JSON_Object) && !print_member_key(level->child, &head)))
+        {
+            goto fail;
+        }
+    }
+    if (!print_opening(container, &head))
+    {
+        goto fail;
+    }
+
+    chunks = (print_chunk*)global_hooks.allocate(chunk_count * sizeof(print_chunk));
+    if (chunks == NULL)
+    {
+        goto fail;
+    }
+    memset(chunks, '\0', chunk_count * sizeof(print_chunk));
+
+    /* the chunks are printed at the depth of the elements, so the indentation is the same */
+    per_chunk = element_count / chunk_count;
+    element = container->child;
+    for (i = 0; i < chunk_count; i++)
+    {
+        size_t j = 0;
+
+        chunks[i].container = container;
+        chunks[i].first = element;
+        for (j = 0; (j < per_chunk) || ((i == (chunk_count - 1)) && (element != NULL)); j++)
+        {
+            element = element->next;
+        }
+        chunks[i].stop = element;
+        chunks[i].buffer.depth = head.depth;
+        chunks[i].buffer.format = format;
+        chunks[i].buffer.hooks = global_hooks;
+    }
+
+    /* the first chunk is printed on this thread, and so is every chunk that doesn't get one */
+    for (i = 1; i < chunk_count; i++)
+    {
+        chunks[i].started = start_chunk_thread(&chunks[i]);
+    }
+    print_chunk_elements(&chunks[0]);
+    for (i = 1; i < chunk_count; i++)
+    {
+        if (chunks[i].started)
+        {
+            join_chunk_thread(&chunks[i]);
+        }
+        else
+        {
+            print_chunk_elements(&chunks[i]);
+        }
+    }
+
+    /* print everything after the elements: the closing brackets on the way up */
+    tail.depth = head.depth;
+    if (!print_closing(container, &tail))
+    {
+        goto fail;
+    }
+    while (container != item)
+    {
+        const BC_JSON *parent = item;
+        while (parent->child != container)
+        {
+            parent = parent->child;
+        }
+        if (!print_separator(parent, container, &tail) || !print_closing(parent, &tail))
+        {
+            goto fail;
+        }
+        container = parent;
     }
-    input_buffer->depth++;
 
-    if (buffer_at_offset(input_buffer)[0] != '[')
+    /* stitch the pieces together */
+    length = head.offset + tail.offset;
+    for (i = 0; i < chunk_count; i++)
     {
-        /* not an array */
-        goto fail;
+        if (!chunks[i].success)
+        {
+            goto fail;
+        }
+        length += chunks[i].buffer.offset;
     }
-
-    input_buffer->offset++;
-    buffer_skip_whitespace(input_buffer);
-    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ']'))
+    printed = (unsigned char*)global_hooks.allocate(length + 1);
+    if (printed == NULL)
     {
-        /* empty array */
-        goto success;
+        goto fail;
     }
-
-    /* check if we skipped to the end of the buffer */
-    if (cannot_access_at_index(input_buffer, 0))
+    output_pointer = printed;
+    memcpy(output_pointer, head.buffer, head.offset);
+    output_pointer += head.offset;
+    for (i = 0; i < chunk_count; i++)
     {
-        input_buffer->offset--;
-        goto fail;
+        memcpy(output_pointer, chunks[i].buffer.buffer, chunks[i].buffer.offset);
+        output_pointer += chunks[i].buffer.offset;
     }
+    memcpy(output_pointer, tail.buffer, tail.offset);
+    printed[length] = '\0';
 
-    /* step back to character in front of the first element */
-    input_buffer->offset--;
-    /* loop through the comma separated array elements */
-    do
+fail:
+    if (chunks != NULL)
     {
-        /* allocate next item */
-        BC_JSON *new_item = BC_JSON_New_Item(&(input_buffer->hooks));
-        if (new_item == NULL)
+        for (i = 0; i < chunk_count; i++)
         {
-            goto fail; /* allocation failure */
+            if (chunks[i].buffer.buffer != NULL)
+            {
+                global_hooks.deallocate(chunks[i].buffer.buffer);
+            }
         }
+        global_hooks.deallocate(chunks);
+    }
+    if (head.buffer != NULL)
+    {
+        global_hooks.deallocate(head.buffer);
+    }
+    if (tail.buffer != NULL)
+    {
+        global_hooks.deallocate(tail.buffer);
+    }
+
+    return (char*)printed;
+}
+
+/* An array/object that BC_JSON_PrintCached is printing. */
+typedef struct
+{
+    BC_JSON *container;
+    size_t start; /* where its text starts in the printbuffer */
+    BC_JSON_bool keep_dirty; /* its text can't be cached, see print_cached */
+} cached_frame;
+
+/* Whether the cached text of an array/object can be printed as it is at this depth. */
+static BC_JSON_bool fragment_is_current(const BC_JSON * const item, const print_fragment * const fragment, const size_t depth, const BC_JSON_bool format)
+{
+    return (item->type & BC_JSON_IsPrinted) && (fragment != NULL)
+        && (fragment->depth == depth) && (fragment->format == format);
+}
+
+/* Cache the text an array/object was just printed as. If that fails the old text stays out of date. */
+static BC_JSON_bool keep_fragment(BC_JSON_PrintCache * const cache, const BC_JSON * const item, const unsigned char * const text, const size_t length, const size_t depth, const BC_JSON_bool format)
+{
+    fragment_entry *entry = find_fragment_entry(cache, item);
+    print_fragment *fragment = (entry != NULL) ? entry->fragment : NULL;
 
-        /* attach next item to list */
-        if (head == NULL)
+    if ((fragment == NULL) || (fragment->length < length) || (fragment->length > (2 * length)))
+    {
+        fragment = (print_fragment*)global_hooks.allocate(sizeof(print_fragment) + length);
+        if (fragment == NULL)
         {
-            /* start the linked list */
-            current_item = head = new_item;
+            return false;
         }
-        else
+        if (entry != NULL)
         {
-            /* add to the end and advance */
-            current_item->next = new_item;
-            new_item->prev = current_item;
-            current_item = new_item;
+            global_hooks.deallocate(entry->fragment);
+            entry->fragment = fragment;
         }
-
-        /* parse next value */
-        input_buffer->offset++;
-        buffer_skip_whitespace(input_buffer);
-        if (!parse_value(current_item, input_buffer))
+        else if (!add_fragment(cache, item, fragment))
         {
-            goto fail; /* failed to parse value */
+            global_hooks.deallocate(fragment);
+            return false;
         }
-        buffer_skip_whitespace(input_buffer);
-    }
-    while (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ','));
-
-    if (cannot_access_at_index(input_buffer, 0) || buffer_at_offset(input_buffer)[0] != ']')
-    {
-        goto fail; /* expected end of array */
     }
 
-success:
-    input_buffer->depth--;
+    memcpy(fragment + 1, text, length);
+    fragment->length = length;
+    fragment->depth = depth;
+    fragment->format = format;
 
-    if (head != NULL) {
-        head->prev = current_item;
-    }
+    return true;
+}
 
-    item->type = BC_JSON_Array;
-    item->child = head;
+/* Drop BC_JSON_IsPrinted from every array/object around an item without it, so that only the
+ * arrays/objects nothing in which changed since they were printed keep it, and count the
+ * arrays/objects. References never have it, so neither does anything around them. */
+static BC_JSON_bool find_changes(BC_JSON * const item, size_t * const containers)
+{
+    BC_JSON *inline_frames[WALK_STACK_INLINE_FRAMES];
+    BC_JSON **parents = inline_frames;
+    BC_JSON **grown = NULL;
+    size_t capacity = WALK_STACK_INLINE_FRAMES;
+    size_t depth = 0;
+    BC_JSON *current = item;
+    BC_JSON_bool success = false;
+
+    *containers = 0;
+    for (;;)
+    {
+        if (current->type & (BC_JSON_Array | BC_JSON_Object))
+        {
+            (*containers)++;
+        }
 
-    input_buffer->offset++;
+        if (!(current->type & BC_JSON_IsReference) && (current->child != NULL))
+        {
+            if (depth == capacity)
+            {
+                grown = (BC_JSON**)grow_walk_stack((void*)parents, &capacity, sizeof(BC_JSON*), (const void*)inline_frames);
+                if (grown == NULL)
+                {
+                    goto end;
+                }
+                parents = grown;
+            }
+            parents[depth] = current;
+            depth++;
+            current = current->child;
+            continue;
+        }
 
-    return true;
+        /* the item is done, pass a change on to the arrays/objects that are done with it */
+        while (depth > 0)
+        {
+            if (!(current->type & BC_JSON_IsPrinted))
+            {
+                mark_changed(parents[depth - 1]);
+            }
+            if (current->next != NULL)
+            {
+                break;
+            }
+            depth--;
+            current = parents[depth];
+        }
+        if (depth == 0)
+        {
+            success = true;
+            goto end;
+        }
+        current = current->next;
+    }
 
-fail:
-    if (head != NULL)
+end:
+    if (parents != inline_frames)
     {
-        BC_JSON_Delete(head);
+        global_hooks.deallocate((void*)parents);
     }
 
-    return false;
+    return success;
 }
 
-/* Render an array to text */
-static BC_JSON_bool print_array(const BC_JSON * const item, printbuffer * const output_buffer)
+/* Render an array/object like print_container, but copy the cached text of the arrays/objects in it
+ * that haven't changed since they were printed, and cache the text of those that have. Arrays/objects
+ * that reference the elements of another one are printed every time: printing the original marks
+ * changes to those elements as printed, so neither they nor anything around them can be cached. */
+static BC_JSON_bool print_cached(BC_JSON_PrintCache * const cache, BC_JSON * const item, printbuffer * const output_buffer)
 {
+    cached_frame inline_frames[WALK_STACK_INLINE_FRAMES];
+    cached_frame *frames = inline_frames;
+    cached_frame *grown = NULL;
+    size_t capacity = WALK_STACK_INLINE_FRAMES;
+    size_t depth = 0;
+    BC_JSON *container = item;
+    BC_JSON *current = NULL;
+    print_fragment *fragment = NULL;
     unsigned char *output_pointer = NULL;
-    size_t length = 0;
-    BC_JSON *current_element = item->child;
+    BC_JSON_bool success = false;
 
-    if (output_buffer == NULL)
+    frames[0].container = item;
+    frames[0].start = output_buffer->offset;
+    frames[0].keep_dirty = false;
+    depth = 1;
+    if (!print_opening(container, output_buffer))
     {
-        return false;
+        goto end;
     }
-
-    /* Compose the output array. */
-    /* opening square bracket */
-    output_pointer = ensure(output_buffer, 1);
-    if (output_pointer == NULL)
+    current = container->child;
+    for (;;)
     {
-        return false;
-    }
-
-    *output_pointer = '[';
-    output_buffer->offset++;
-    output_buffer->depth++;
+        cached_frame *frame = &frames[depth - 1];
 
-    while (current_element != NULL)
-    {
-        if (!print_value(current_element, output_buffer))
+        if (current == NULL)
         {
-            return false;
+            BC_JSON_bool keep_dirty = frame->keep_dirty;
+
+            /* all elements are printed, cache the text and continue with the array/object it is in */
+            if (!print_closing(container, output_buffer))
+            {
+                goto end;
+            }
+            if (!keep_dirty && keep_fragment(cache, container, output_buffer->buffer + frame->start, output_buffer->offset - frame->start, output_buffer->depth, output_buffer->format))
+            {
+                container->type |= BC_JSON_IsPrinted;
+            }
+            depth--;
+            if (depth == 0)
+            {
+                success = true;
+                goto end;
+            }
+            frames[depth - 1].keep_dirty |= keep_dirty;
+            current = container;
+            container = frames[depth - 1].container;
         }
-        update_offset(output_buffer);
-        if (current_element->next)
+        else
         {
-            length = (size_t) (output_buffer->format ? 2 : 1);
-            output_pointer = ensure(output_buffer, length + 1);
-            if (output_pointer == NULL)
+            if (((container->type & 0xFF) == BC_JSON_Object) && !print_member_key(current, output_buffer))
             {
-                return false;
+                goto end;
             }
-            *output_pointer++ = ',';
-            if(output_buffer->format)
+
+            if (((current->type & 0xFF) != BC_JSON_Array) && ((current->type & 0xFF) != BC_JSON_Object))
             {
-                *output_pointer++ = ' ';
+                if (!print_value(current, output_buffer))
+                {
+                    goto end;
+                }
+                current->type |= BC_JSON_IsPrinted;
             }
-            *output_pointer = '\0';
-            output_buffer->offset += length;
+            else if (current->type & BC_JSON_IsReference)
+            {
+                if (!print_container(current, output_buffer))
+                {
+                    goto end;
+                }
+                frame->keep_dirty = true;
+            }
+            else
+            {
+                fragment = find_fragment(cache, current);
+                if (!fragment_is_current(current, fragment, output_buffer->depth, output_buffer->format))
+                {
+                    /* print the elements again */
+                    if (depth == capacity)
+                    {
+                        grown = (cached_frame*)grow_walk_stack((void*)frames, &capacity, sizeof(cached_frame), (const void*)inline_frames);
+                        if (grown == NULL)
+                        {
+                            goto end;
+                        }
+                        frames = grown;
+                    }
+                    frames[depth].container = current;
+                    frames[depth].start = output_buffer->offset;
+                    frames[depth].keep_dirty = false;
+                    depth++;
+                    container = current;
+                    if (!print_opening(container, output_buffer))
+                    {
+                        goto end;
+                    }
+                    current = container->child;
+                    continue;
+                }
+
+                output_pointer = ensure(output_buffer, fragment->length);
+                if (output_pointer == NULL)
+                {
+                    goto end;
+                }
+                memcpy(output_pointer, fragment + 1, fragment->length);
+                output_pointer[fragment->length] = '\0';
+                output_buffer->offset += fragment->length;
+            }
+        }
+
+        /* the element is complete */
+        if (!print_separator(container, current, output_buffer))
+        {
+            goto end;
         }
-        current_element = current_element->next;
+        current = current->next;
     }
 
-    output_pointer = ensure(output_buffer, 2);
-    if (output_pointer == NULL)
+end:
+    if (frames != inline_frames)
     {
-        return false;
+        global_hooks.deallocate((void*)frames);
     }
-    *output_pointer++ = ']';
-    *output_pointer = '\0';
-    output_buffer->depth--;
 
-    return true;
+    return success;
 }
 
-/* Build an object from the text. */
-static BC_JSON_bool parse_object(BC_JSON * const item, parse_buffer * const input_buffer)
+CJSON_PUBLIC(BC_JSON_PrintCache *) BC_JSON_CreatePrintCache(void)
 {
-    BC_JSON *head = NULL; /* linked list head */
-    BC_JSON *current_item = NULL;
-
-    if (input_buffer->depth >= CJSON_NESTING_LIMIT)
+    BC_JSON_PrintCache *cache = (BC_JSON_PrintCache*)global_hooks.allocate(sizeof(BC_JSON_PrintCache));
+    if (cache != NULL)
     {
-        return false; /* to deeply nested */
+        memset(cache, '\0', sizeof(BC_JSON_PrintCache));
     }
-    input_buffer->depth++;
 
-    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != '{'))
+    return cache;
+}
+
+CJSON_PUBLIC(void) BC_JSON_DeletePrintCache(BC_JSON_PrintCache *cache)
+{
+    if (cache == NULL)
     {
-        goto fail; /* not an object */
+        return;
     }
 
-    input_buffer->offset++;
-    buffer_skip_whitespace(input_buffer);
-    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '}'))
+    clear_print_cache(cache);
+    global_hooks.deallocate(cache);
+}
+
+CJSON_PUBLIC(char *) BC_JSON_PrintCached(BC_JSON_PrintCache *cache, BC_JSON *item, BC_JSON_bool format)
+{
+    static const size_t default_buffer_size = 256;
+    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0 };
+    print_fragment *fragment = NULL;
+    size_t containers = 0;
+
+    if ((cache == NULL) || (item == NULL))
     {
-        goto success; /* empty object */
+        return NULL;
     }
 
-    /* check if we skipped to the end of the buffer */
-    if (cannot_access_at_index(input_buffer, 0))
+    /* caching would write to frozen documents, which other threads may be reading */
+    if ((((item->type & 0xFF) != BC_JSON_Array) && ((item->type & 0xFF) != BC_JSON_Object)) || (item->type & BC_JSON_IsFrozen))
     {
-        input_buffer->offset--;
-        goto fail;
+        return (char*)print(item, format, &global_hooks);
     }
 
-    /* step back to character in front of the first element */
-    input_buffer->offset--;
-    /* loop through the comma separated array elements */
-    do
+    if (!find_changes(item, &containers))
     {
-        /* allocate next item */
-        BC_JSON *new_item = BC_JSON_New_Item(&(input_buffer->hooks));
-        if (new_item == NULL)
-        {
-            goto fail; /* allocation failure */
-        }
-
-        /* attach next item to list */
-        if (head == NULL)
-        {
-            /* start the linked list */
-            current_item = head = new_item;
-        }
-        else
-        {
-            /* add to the end and advance */
-            current_item->next = new_item;
-            new_item->prev = current_item;
-            current_item = new_item;
-        }
-
-        if (cannot_access_at_index(input_buffer, 1))
-        {
-            goto fail; /* nothing comes after the comma */
-        }
+        return NULL;
+    }
+    /* most of the text is left behind by arrays/objects that were deleted or replaced */
+    if (cache->count > (2 * containers))
+    {
+        clear_print_cache(cache);
+    }
 
-        /* parse the name of the child */
-        input_buffer->offset++;
-        buffer_skip_whitespace(input_buffer);
-        if (!parse_string(current_item, input_buffer))
+    /* nothing has changed */
+    fragment = find_fragment(cache, item);
+    if (fragment_is_current(item, fragment, 0, format))
+    {
+        unsigned char *printed = (unsigned char*)global_hooks.allocate(fragment->length + 1);
+        if (printed != NULL)
         {
-            goto fail; /* failed to parse name */
+            memcpy(printed, fragment + 1, fragment->length);
+            printed[fragment->length] = '\0';
         }
-        buffer_skip_whitespace(input_buffer);
 
-        /* swap value_string and string, because we parsed the name */
-        current_item->string = current_item->value_string;
-        current_item->value_string = NULL;
+        return (char*)printed;
+    }
 
-        if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != ':'))
-        {
-            goto fail; /* invalid object */
-        }
+    p.length = (fragment != NULL) ? (fragment->length + (fragment->length / 8) + 1) : default_buffer_size;
+    p.buffer = (unsigned char*)global_hooks.allocate(p.length);
+    if (p.buffer == NULL)
+    {
+        return NULL;
+    }
+    p.offset = 0;
+    p.noalloc = false;
+    p.format = format;
+    p.hooks = global_hooks;
 
-        /* parse the value */
-        input_buffer->offset++;
-        buffer_skip_whitespace(input_buffer);
-        if (!parse_value(current_item, input_buffer))
+    if (item->type & BC_JSON_IsReference)
+    {
+        if (!print_container(item, &p))
         {
-            goto fail; /* failed to parse value */
+            goto fail;
         }
-        buffer_skip_whitespace(input_buffer);
     }
-    while (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ','));
-
-    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != '}'))
+    else if (!print_cached(cache, item, &p))
     {
-        goto fail; /* expected end of object */
-    }
-
-success:
-    input_buffer->depth--;
-
-    if (head != NULL) {
-        head->prev = current_item;
+        goto fail;
     }
 
-    item->type = BC_JSON_Object;
-    item->child = head;
-
-    input_buffer->offset++;
-    return true;
+    return (char*)p.buffer;
 
 fail:
-    if (head != NULL)
+    if (p.buffer != NULL)
     {
-        BC_JSON_Delete(head);
+        global_hooks.deallocate(p.buffer);
     }
 
-    return false;
+    return NULL;
 }
 
-/* Render an object to text. */
-static BC_JSON_bool print_object(const BC_JSON * const item, printbuffer * const output_buffer)
+CJSON_PUBLIC(void) BC_JSON_MarkChanged(BC_JSON *item)
 {
-    unsigned char *output_pointer = NULL;
-    size_t length = 0;
-    BC_JSON *current_item = item->child;
+    mark_changed(item);
+    /* its elements may have changed */
+    drop_container_index(item);
+}
 
-    if (output_buffer == NULL)
+/* Build the container_index of a frozen array/object and put it in its index field. */
+static BC_JSON_bool build_frozen_index(BC_JSON * const container)
+{
+    container_index *index = NULL;
+    BC_JSON **elements = NULL;
+    size_t *slots = NULL;
+    BC_JSON *child = NULL;
+    BC_JSON_bool keyed = (container->type & BC_JSON_Object) ? true : false;
+    size_t count = 0;
+    size_t table_size = 0;
+    size_t position = 0;
+
+    for (child = container->child; child != NULL; child = child->next)
     {
-        return false;
+        /* members without key stop the normal lookup, such objects are searched the normal way */
+        if (child->string == NULL)
+        {
+            keyed = false;
+        }
+        count++;
     }
-
-    /* Compose the output: */
-    length = (size_t) (output_buffer->format ? 2 : 1); /* fmt: {\n */
-    output_pointer = ensure(output_buffer, length + 1);
-    if (output_pointer == NULL)
+    if (count > ((size_t)-1 / 8 / sizeof(size_t)))
     {
-        return false;
+        return false; /* overflow */
     }
-
-    *output_pointer++ = '{';
-    output_buffer->depth++;
-    if (output_buffer->format)
+    if (keyed)
     {
-        *output_pointer++ = '\n';
+        table_size = 4;
+        while (table_size < (2 * count))
+        {
+            table_size *= 2;
+        }
     }
-    output_buffer->offset += length;
+    index = (container_index*)global_hooks.allocate(sizeof(container_index) + (count * sizeof(BC_JSON*)) + (table_size * sizeof(size_t)));
+    if (index == NULL)
+    {
+        return false;
+    }
+    index->count = count;
+    index->slot_mask = (table_size > 0) ? (table_size - 1) : 0;
+    elements = indexed_elements(index);
+    slots = indexed_slots(index);
+    memset(slots, '\0', table_size * sizeof(size_t));
 
-    while (current_item)
+    for (child = container->child; child != NULL; child = child->next)
     {
-        if (output_buffer->format)
+        elements[position] = child;
+        position++;
+        if (table_size > 0)
         {
-            size_t i;
-            output_pointer = ensure(output_buffer, output_buffer->depth);
-            if (output_pointer == NULL)
-            {
-                return false;
-            }
-            for (i = 0; i < output_buffer->depth; i++)
+            /* the members are added in order, so the first one with a key comes first when probing for it */
+            size_t slot = hash_folded_key((const unsigned char*)child->string) & index->slot_mask;
+            while (slots[slot] != 0)
             {
-                *output_pointer++ = '\t';
+                slot = (slot + 1) & index->slot_mask;
             }
-            output_buffer->offset += output_buffer->depth;
+            slots[slot] = position;
         }
+    }
 
-        /* print key */
-        if (!print_string_ptr((unsigned char*)current_item->string, output_buffer))
-        {
-            return false;
-        }
-        update_offset(output_buffer);
+    /* an index from a parse with a shape cache is replaced */
+    drop_container_index(container);
+    container->index = index;
 
-        length = (size_t) (output_buffer->format ? 2 : 1);
-        output_pointer = ensure(output_buffer, length);
-        if (output_pointer == NULL)
-        {
-            return false;
-        }
-        *output_pointer++ = ':';
-        if (output_buffer->format)
+    return true;
+}
+
+/* Freeze every item of the document at item, or unfreeze them. Freezing fails for arrays/objects
+ * that are references and if memory runs out, the items that are frozen already stay frozen. */
+static BC_JSON_bool freeze_items(BC_JSON * const item, const BC_JSON_bool freeze)
+{
+    BC_JSON *inline_frames[WALK_STACK_INLINE_FRAMES];
+    BC_JSON **parents = inline_frames;
+    BC_JSON **grown = NULL;
+    size_t capacity = WALK_STACK_INLINE_FRAMES;
+    size_t depth = 0;
+    BC_JSON *current = item;
+    BC_JSON_bool success = false;
+
+    while (current != NULL)
+    {
+        if (!freeze)
         {
-            *output_pointer++ = '\t';
+            if (is_frozen_container(current))
+            {
+                global_hooks.deallocate(current->index);
+                current->index = NULL;
+            }
+            current->type &= ~BC_JSON_IsFrozen;
         }
-        output_buffer->offset += length;
-
-        /* print value */
-        if (!print_value(current_item, output_buffer))
+        else if (!(current->type & BC_JSON_IsFrozen))
         {
-            return false;
+            if ((current->type & BC_JSON_IsReference) && (current->type & (BC_JSON_Array | BC_JSON_Object)))
+            {
+                goto end;
+            }
+            if ((current->type & (BC_JSON_Array | BC_JSON_Object)) && !build_frozen_index(current))
+            {
+                goto end;
+            }
+            current->type = (current->type | BC_JSON_IsFrozen) & ~BC_JSON_IsPrinted;
         }
-        update_offset(output_buffer);
 
-        /* print comma if not last */
-        length = ((size_t)(output_buffer->format ? 1 : 0) + (size_t)(current_item->next ? 1 : 0));
-        output_pointer = ensure(output_buffer, length + 1);
-        if (output_pointer == NULL)
-        {
-            return false;
-        }
-        if (current_item->next)
+        if (!(current->type & BC_JSON_IsReference) && (current->child != NULL))
         {
-            *output_pointer++ = ',';
+            if (depth == capacity)
+            {
+                grown = (BC_JSON**)grow_walk_stack((void*)parents, &capacity, sizeof(BC_JSON*), (const void*)inline_frames);
+                if (grown == NULL)
+                {
+                    goto end;
+                }
+                parents = grown;
+            }
+            parents[depth] = current;
+            depth++;
+            current = current->child;
+            continue;
         }
 
-        if (output_buffer->format)
+        /* continue with the next element, going up out of the arrays/objects that are done */
+        while ((depth > 0) && (current->next == NULL))
         {
-            *output_pointer++ = '\n';
+            depth--;
+            current = parents[depth];
         }
-        *output_pointer = '\0';
-        output_buffer->offset += length;
+        current = (depth > 0) ? current->next : NULL;
+    }
+    success = true;
 
-        current_item = current_item->next;
+end:
+    if (parents != inline_frames)
+    {
+        global_hooks.deallocate((void*)parents);
     }
 
-    output_pointer = ensure(output_buffer, output_buffer->format ? (output_buffer->depth + 1) : 2);
-    if (output_pointer == NULL)
+    return success;
+}
+
+CJSON_PUBLIC(BC_JSON_bool) BC_JSON_Freeze(BC_JSON *item)
+{
+    if ((item == NULL) || (item->prev != NULL))
     {
         return false;
     }
-    if (output_buffer->format)
+    if (item->type & BC_JSON_IsFrozen)
     {
-        size_t i;
-        for (i = 0; i < (output_buffer->depth - 1); i++)
-        {
-            *output_pointer++ = '\t';
-        }
+        return true;
+    }
+
+    if (!freeze_items(item, true))
+    {
+        freeze_items(item, false);
+        return false;
     }
-    *output_pointer++ = '}';
-    *output_pointer = '\0';
-    output_buffer->depth--;
 
     return true;
 }
 
+CJSON_PUBLIC(void) BC_JSON_Unfreeze(BC_JSON *item)
+{
+    if ((item == NULL) || (item->prev != NULL) || !(item->type & BC_JSON_IsFrozen))
+    {
+        return;
+    }
+
+    freeze_items(item, false);
+}
+
 /* Get Array size/item / object item. */
 CJSON_PUBLIC(int) BC_JSON_GetArraySize(const BC_JSON *array)
 {
@@ -1859,6 +9466,11 @@ CJSON_PUBLIC(int) BC_JSON_GetArraySize(const BC_JSON *array)
         return 0;
     }
 
+    if (is_frozen_container(array))
+    {
+        return (int)container_index_of(array)->count;
+    }
+
     child = array->child;
 
     while(child != NULL)
@@ -1881,6 +9493,12 @@ static BC_JSON* get_array_item(const BC_JSON *array, size_t index)
         return NULL;
     }
 
+    if (is_frozen_container(array))
+    {
+        container_index *indexed = container_index_of(array);
+        return (index < indexed->count) ? indexed_elements(indexed)[index] : NULL;
+    }
+
     current_child = array->child;
     while ((current_child != NULL) && (index > 0))
     {
@@ -1901,6 +9519,76 @@ CJSON_PUBLIC(BC_JSON *) BC_JSON_GetArrayItem(const BC_JSON *array, int index)
     return get_array_item(array, (size_t)index);
 }
 
+/* Look up a key in an object that was indexed by index_shaped_object, using the slot table of its
+ * shape instead of comparing the key to every member. Returns false if the object doesn't have a
+ * shape (anymore) or its members no longer match the index, it has to be searched the normal way
+ * then. Nothing is written, not even to the cache. */
+static BC_JSON_bool get_shaped_object_item(const BC_JSON * const object, const char * const name, BC_JSON ** const found)
+{
+    const BC_JSON *last = NULL;
+    container_index *index = NULL;
+    object_shape *shape = NULL;
+    size_t slot = 0;
+
+    if (!has_container_index(object) || (object->child == NULL))
+    {
+        return false;
+    }
+    index = container_index_of(object);
+
+    /* the last member knows the shape of the whole object */
+    last = object->child->prev;
+    if ((last == NULL) || !(last->type & BC_JSON_StringIsInterned) || (last->string == NULL))
+    {
+        return false;
+    }
+    shape = interned_key_header(last->string)->shape;
+    if ((shape == NULL) || (shape->slots == NULL) || (shape->key_count != index->count))
+    {
+        return false;
+    }
+    /* members linked in or out by hand without BC_JSON_MarkChanged */
+    if ((indexed_elements(index)[0] != object->child) || (indexed_elements(index)[index->count - 1] != last) || (last->next != NULL))
+    {
+        return false;
+    }
+
+    *found = NULL;
+    slot = hash_key((const unsigned char*)name, strlen(name)) & shape->slot_mask;
+    while (shape->slots[slot] != 0)
+    {
+        if (strcmp(shape->keys[shape->slots[slot] - 1], name) == 0)
+        {
+            *found = indexed_elements(index)[shape->slots[slot] - 1];
+            /* the member in the slot has to still have the key and be linked in */
+            return ((*found)->string == shape->keys[shape->slots[slot] - 1]) && ((*found == object->child) || (((*found)->prev != NULL) && ((*found)->prev->next == *found)));
+        }
+        slot = (slot + 1) & shape->slot_mask;
+    }
+
+    return true;
+}
+
+/* Look up a key in a frozen object with the table of its container_index. */
+static BC_JSON *get_frozen_object_item(const BC_JSON * const object, const char * const name, const BC_JSON_bool case_sensitive)
+{
+    container_index *index = container_index_of(object);
+    size_t *slots = indexed_slots(index);
+    BC_JSON *member = NULL;
+    size_t slot = hash_folded_key((const unsigned char*)name) & index->slot_mask;
+
+    for (; slots[slot] != 0; slot = (slot + 1) & index->slot_mask)
+    {
+        member = indexed_elements(index)[slots[slot] - 1];
+        if (case_sensitive ? (strcmp(name, member->string) == 0) : (case_insensitive_strcmp((const unsigned char*)name, (const unsigned char*)member->string) == 0))
+        {
+            return member;
+        }
+    }
+
+    return NULL;
+}
+
 static BC_JSON *get_object_item(const BC_JSON * const object, const char * const name, const BC_JSON_bool case_sensitive)
 {
     BC_JSON *current_element = NULL;
@@ -1910,6 +9598,16 @@ static BC_JSON *get_object_item(const BC_JSON * const object, const char * const
         return NULL;
     }
 
+    if (is_frozen_container(object) && (container_index_of(object)->slot_mask != 0))
+    {
+        return get_frozen_object_item(object, name, case_sensitive);
+    }
+
+    if (case_sensitive && get_shaped_object_item(object, name, &current_element))
+    {
+        return current_element;
+    }
+
     current_element = object->child;
     if (case_sensitive)
     {
@@ -1943,6 +9641,45 @@ CJSON_PUBLIC(BC_JSON *) BC_JSON_GetObjectItemCaseSensitive(const BC_JSON * const
     return get_object_item(object, string, true);
 }
 
+CJSON_PUBLIC(BC_JSON *) BC_JSON_GetObjectItemBySymbol(const BC_JSON * const object, const BC_JSON_Symbol symbol)
+{
+    const char *name = BC_JSON_SymbolName(symbol);
+    BC_JSON *current_element = NULL;
+
+    if ((object == NULL) || (name == NULL))
+    {
+        return NULL;
+    }
+
+    if (is_frozen_container(object) && (container_index_of(object)->slot_mask != 0))
+    {
+        return get_frozen_object_item(object, name, true);
+    }
+
+    for (current_element = object->child; current_element != NULL; current_element = current_element->next)
+    {
+        if (current_element->string == NULL)
+        {
+            return NULL;
+        }
+
+        if ((current_element->type & BC_JSON_StringIsInterned) && (interned_key_header(current_element->string)->symbol != 0))
+        {
+            /* keys interned while the symbol existed only need their ids compared */
+            if (interned_key_header(current_element->string)->symbol == symbol)
+            {
+                return current_element;
+            }
+        }
+        else if (strcmp(name, current_element->string) == 0)
+        {
+            return current_element;
+        }
+    }
+
+    return NULL;
+}
+
 CJSON_PUBLIC(BC_JSON_bool) BC_JSON_HasObjectItem(const BC_JSON *object, const char *string)
 {
     return BC_JSON_GetObjectItem(object, string) ? 1 : 0;
@@ -1955,6 +9692,13 @@ static void suffix_object(BC_JSON *prev, BC_JSON *item)
     item->prev = prev;
 }
 
+/* The elements of an array/object changed: its cached text and its index are out of date. */
+static void elements_changed(BC_JSON * const container)
+{
+    mark_changed(container);
+    drop_container_index(container);
+}
+
 /* Utility for handling references. */
 static BC_JSON *create_reference(const BC_JSON *item, const internal_hooks * const hooks)
 {
@@ -1971,8 +9715,10 @@ static BC_JSON *create_reference(const BC_JSON *item, const internal_hooks * con
     }
 
     memcpy(reference, item, sizeof(BC_JSON));
+    /* the index stays with the item */
+    reference->index = NULL;
     reference->string = NULL;
-    reference->type |= BC_JSON_IsReference;
+    reference->type = (reference->type | BC_JSON_IsReference) & ~(BC_JSON_OwnsFile | BC_JSON_IsFrozen | BC_JSON_IsPrinted);
     reference->next = reference->prev = NULL;
     return reference;
 }
@@ -1985,6 +9731,10 @@ static BC_JSON_bool add_item_to_array(BC_JSON *array, BC_JSON *item)
     {
         return false;
     }
+    if (reject_frozen(array) || reject_frozen(item))
+    {
+        return false;
+    }
 
     child = array->child;
     /*
@@ -2006,6 +9756,7 @@ static BC_JSON_bool add_item_to_array(BC_JSON *array, BC_JSON *item)
             array->child->prev = item;
         }
     }
+    elements_changed(array);
 
     return true;
 }
@@ -2041,11 +9792,19 @@ static BC_JSON_bool add_item_to_object(BC_JSON * const object, const char * cons
     {
         return false;
     }
+    if (reject_frozen(object) || reject_frozen(item))
+    {
+        return false;
+    }
 
     if (constant_key)
     {
         new_key = (char*)cast_away_const(string);
-        new_type = item->type | BC_JSON_StringIsConst;
+        new_type = (item->type | BC_JSON_StringIsConst) & ~BC_JSON_StringIsInterned;
+        if (is_symbol_name(string))
+        {
+            new_type |= BC_JSON_StringIsInterned;
+        }
     }
     else
     {
@@ -2055,7 +9814,7 @@ static BC_JSON_bool add_item_to_object(BC_JSON * const object, const char * cons
             return false;
         }
 
-        new_type = item->type & ~BC_JSON_StringIsConst;
+        new_type = item->type & ~(BC_JSON_StringIsConst | BC_JSON_StringIsInterned);
     }
 
     if (!(item->type & BC_JSON_StringIsConst) && (item->string != NULL))
@@ -2214,6 +9973,10 @@ CJSON_PUBLIC(BC_JSON *) BC_JSON_DetachItemViaPointer(BC_JSON *parent, BC_JSON *
     {
         return NULL;
     }
+    if (reject_frozen(parent))
+    {
+        return NULL;
+    }
 
     if (item != parent->child)
     {
@@ -2240,6 +10003,7 @@ CJSON_PUBLIC(BC_JSON *) BC_JSON_DetachItemViaPointer(BC_JSON *parent, BC_JSON *
     /* make sure the detached item doesn't point anywhere anymore */
     item->prev = NULL;
     item->next = NULL;
+    elements_changed(parent);
 
     return item;
 }
@@ -2292,6 +10056,10 @@ CJSON_PUBLIC(BC_JSON_bool) BC_JSON_InsertItemInArray(BC_JSON *array, int which,
     {
         return false;
     }
+    if (reject_frozen(array) || reject_frozen(newitem))
+    {
+        return false;
+    }
 
     after_inserted = get_array_item(array, (size_t)which);
     if (after_inserted == NULL)
@@ -2315,6 +10083,7 @@ CJSON_PUBLIC(BC_JSON_bool) BC_JSON_InsertItemInArray(BC_JSON *array, int which,
     {
         newitem->prev->next = newitem;
     }
+    elements_changed(array);
     return true;
 }
 
@@ -2325,6 +10094,11 @@ CJSON_PUBLIC(BC_JSON_bool) BC_JSON_ReplaceItemViaPointer(BC_JSON * const parent,
         return false;
     }
 
+    if (reject_frozen(parent) || reject_frozen(replacement))
+    {
+        return false;
+    }
+
     if (replacement == item)
     {
         return true;
@@ -2363,6 +10137,7 @@ CJSON_PUBLIC(BC_JSON_bool) BC_JSON_ReplaceItemViaPointer(BC_JSON * const parent,
     item->next = NULL;
     item->prev = NULL;
     BC_JSON_Delete(item);
+    elements_changed(parent);
 
     return true;
 }
@@ -2383,6 +10158,10 @@ static BC_JSON_bool replace_item_in_object(BC_JSON *object, const char *string,
     {
         return false;
     }
+    if (reject_frozen(object) || reject_frozen(replacement))
+    {
+        return false;
+    }
 
     /* replace the name in the replacement */
     if (!(replacement->type & BC_JSON_StringIsConst) && (replacement->string != NULL))
@@ -2395,7 +10174,7 @@ static BC_JSON_bool replace_item_in_object(BC_JSON *object, const char *string,
         return false;
     }
 
-    replacement->type &= ~BC_JSON_StringIsConst;
+    replacement->type &= ~(BC_JSON_StringIsConst | BC_JSON_StringIsInterned);
 
     return BC_JSON_ReplaceItemViaPointer(object, get_object_item(object, string, case_sensitive), replacement);
 }
@@ -2467,6 +10246,17 @@ CJSON_PUBLIC(BC_JSON *) BC_JSON_CreateNumber(double num)
     return item;
 }
 
+CJSON_PUBLIC(BC_JSON *) BC_JSON_CreateFloat(float num)
+{
+    BC_JSON *item = BC_JSON_CreateNumber((double)num);
+    if(item)
+    {
+        item->type |= BC_JSON_NumberIsFloat;
+    }
+
+    return item;
+}
+
 CJSON_PUBLIC(BC_JSON *) BC_JSON_CreateString(const char *string)
 {
     BC_JSON *item = BC_JSON_New_Item(&global_hooks);
@@ -2613,7 +10403,7 @@ CJSON_PUBLIC(BC_JSON *) BC_JSON_CreateFloatArray(const float *numbers, int count
 
     for(i = 0; a && (i < (size_t)count); i++)
     {
-        n = BC_JSON_CreateNumber((double)numbers[i]);
+        n = BC_JSON_CreateFloat(numbers[i]);
         if(!n)
         {
             BC_JSON_Delete(a);
@@ -2718,33 +10508,17 @@ CJSON_PUBLIC(BC_JSON *) BC_JSON_CreateStringArray(const char *const *strings, in
 }
 
 /* Duplication */
-BC_JSON * BC_JSON_Duplicate_rec(const BC_JSON *item, size_t depth, BC_JSON_bool recurse);
 
-CJSON_PUBLIC(BC_JSON *) BC_JSON_Duplicate(const BC_JSON *item, BC_JSON_bool recurse)
-{
-    return BC_JSON_Duplicate_rec(item, 0, recurse );
-}
-
-BC_JSON * BC_JSON_Duplicate_rec(const BC_JSON *item, size_t depth, BC_JSON_bool recurse)
+/* Copy a single item without its elements. */
+static BC_JSON *duplicate_item(const BC_JSON *item)
 {
-    BC_JSON *newitem = NULL;
-    BC_JSON *child = NULL;
-    BC_JSON *next = NULL;
-    BC_JSON *newchild = NULL;
-
-    /* Bail on bad ptr */
-    if (!item)
-    {
-        goto fail;
-    }
-    /* Create new item */
-    newitem = BC_JSON_New_Item(&global_hooks);
+    BC_JSON *newitem = BC_JSON_New_Item(&global_hooks);
     if (!newitem)
     {
         goto fail;
     }
     /* Copy over all vars */
-    newitem->type = item->type & (~BC_JSON_IsReference);
+    newitem->type = item->type & ~(BC_JSON_IsReference | BC_JSON_OwnsFile | BC_JSON_IsFrozen | BC_JSON_IsPrinted);
     newitem->value_number = item->value_number;
     if (item->value_string)
     {
@@ -2762,50 +10536,125 @@ BC_JSON * BC_JSON_Duplicate_rec(const BC_JSON *item, size_t depth, BC_JSON_bool
             goto fail;
         }
     }
+
+    return newitem;
+
+fail:
+    if (newitem != NULL)
+    {
+        BC_JSON_Delete(newitem);
+    }
+
+    return NULL;
+}
+
+/* an array/object of the source whose elements are being copied */
+typedef struct
+{
+    const BC_JSON *next_source; /* the element of the source to copy once the level is done */
+    BC_JSON *copy; /* the copy of the array/object */
+} duplicate_frame;
+
+CJSON_PUBLIC(BC_JSON *) BC_JSON_Duplicate(const BC_JSON *item, BC_JSON_bool recurse)
+{
+    duplicate_frame inline_frames[WALK_STACK_INLINE_FRAMES];
+    duplicate_frame *frames = inline_frames;
+    duplicate_frame *grown = NULL;
+    size_t capacity = WALK_STACK_INLINE_FRAMES;
+    size_t depth = 0;
+    BC_JSON *newitem = NULL;
+    BC_JSON *parent = NULL;
+    BC_JSON *newchild = NULL;
+    const BC_JSON *child = NULL;
+
+    /* Bail on bad ptr */
+    if (!item)
+    {
+        return NULL;
+    }
+    newitem = duplicate_item(item);
     /* If non-recursive, then we're done! */
-    if (!recurse)
+    if ((newitem == NULL) || !recurse)
     {
         return newitem;
     }
-    /* Walk the ->next chain for the child. */
+
+    /* Walk the tree depth first, the arrays/objects whose copy isn't complete yet are kept on
+     * an explicit stack, so deep nesting doesn't use up the call stack. */
+    parent = newitem;
     child = item->child;
-    while (child != NULL)
+    for (;;)
     {
-        if(depth >= CJSON_CIRCULAR_LIMIT) {
+        if (child == NULL)
+        {
+            /* all elements of this level are copied, continue in the level above */
+            if (depth == 0)
+            {
+                break;
+            }
+            depth--;
+            parent = frames[depth].copy;
+            child = frames[depth].next_source;
+            continue;
+        }
+
+        if (depth >= CJSON_CIRCULAR_LIMIT)
+        {
             goto fail;
         }
-        newchild = BC_JSON_Duplicate_rec(child, depth + 1, true); /* Duplicate (with recurse) each item in the ->next chain */
+        newchild = duplicate_item(child);
         if (!newchild)
         {
             goto fail;
         }
-        if (next != NULL)
+        if (parent->child != NULL)
         {
-            /* If newitem->child already set, then crosswire ->prev and ->next and move on */
-            next->next = newchild;
-            newchild->prev = next;
-            next = newchild;
+            /* crosswire ->prev and ->next with the last element */
+            parent->child->prev->next = newchild;
+            newchild->prev = parent->child->prev;
         }
         else
         {
-            /* Set newitem->child and move to it */
-            newitem->child = newchild;
-            next = newchild;
+            parent->child = newchild;
         }
-        child = child->next;
+        parent->child->prev = newchild;
+
+        if (child->child == NULL)
+        {
+            child = child->next;
+            continue;
+        }
+
+        /* descend into the elements of the child */
+        if (depth == capacity)
+        {
+            grown = (duplicate_frame*)grow_walk_stack(frames, &capacity, sizeof(duplicate_frame), inline_frames);
+            if (grown == NULL)
+            {
+                goto fail;
+            }
+            frames = grown;
+        }
+        frames[depth].next_source = child->next;
+        frames[depth].copy = parent;
+        depth++;
+        parent = newchild;
+        child = child->child;
     }
-    if (newitem && newitem->child)
+
+    if (frames != inline_frames)
     {
-        newitem->child->prev = newchild;
+        global_hooks.deallocate(frames);
     }
 
     return newitem;
 
 fail:
-    if (newitem != NULL)
+    if (frames != inline_frames)
     {
-        BC_JSON_Delete(newitem);
+        global_hooks.deallocate(frames);
     }
+    BC_JSON_Delete(newitem);
 
     return NULL;
 }
@@ -3007,7 +10856,8 @@ CJSON_PUBLIC(BC_JSON_bool) BC_JSON_IsRaw(const BC_JSON * const item)
     return (item->type & 0xFF) == BC_JSON_Raw;
 }
 
-CJSON_PUBLIC(BC_JSON_bool) BC_JSON_Compare(const BC_JSON * const a, const BC_JSON * const b, const BC_JSON_bool case_sensitive)
+/* Compare two items without looking at the elements of arrays/objects. */
+static BC_JSON_bool compare_item(const BC_JSON * const a, const BC_JSON * const b)
 {
     if ((a == NULL) || (b == NULL) || ((a->type & 0xFF) != (b->type & 0xFF)))
     {
@@ -3065,71 +10915,140 @@ CJSON_PUBLIC(BC_JSON_bool) BC_JSON_Compare(const BC_JSON * const a, const BC_JSO
 
             return false;
 
+        /* the elements are compared by the caller */
         case BC_JSON_Array:
+        case BC_JSON_Object:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+/* a pair of arrays/objects whose elements are being compared */
+typedef struct
+{
+    const BC_JSON *a_element; /* the next element of a_container to compare */
+    const BC_JSON *b_element; /* the next element of b_container (arrays only) */
+    const BC_JSON *a_container;
+    const BC_JSON *b_container;
+    BC_JSON_bool second_pass; /* objects: a and b have been swapped to check b's members against a */
+} compare_frame;
+
+CJSON_PUBLIC(BC_JSON_bool) BC_JSON_Compare(const BC_JSON * const a, const BC_JSON * const b, const BC_JSON_bool case_sensitive)
+{
+    compare_frame inline_frames[WALK_STACK_INLINE_FRAMES];
+    compare_frame *frames = inline_frames;
+    compare_frame *grown = NULL;
+    compare_frame *top = NULL;
+    size_t capacity = WALK_STACK_INLINE_FRAMES;
+    size_t depth = 0;
+    const BC_JSON *a_element = a;
+    const BC_JSON *b_element = b;
+    const BC_JSON *swap = NULL;
+    BC_JSON_bool equal = false;
+
+    /* Walk both trees depth first, the arrays/objects that are being compared are kept on an
+     * explicit stack, so deep nesting doesn't use up the call stack. */
+    for (;;)
+    {
+        if (!compare_item(a_element, b_element))
         {
-            BC_JSON *a_element = a->child;
-            BC_JSON *b_element = b->child;
+            goto end;
+        }
 
-            for (; (a_element != NULL) && (b_element != NULL);)
+        /* descend into the elements of arrays/objects, identical ones are equal */
+        if ((a_element != b_element) && (((a_element->type & 0xFF) == BC_JSON_Array) || ((a_element->type & 0xFF) == BC_JSON_Object)))
+        {
+            if (depth == capacity)
             {
-                if (!BC_JSON_Compare(a_element, b_element, case_sensitive))
+                grown = (compare_frame*)grow_walk_stack(frames, &capacity, sizeof(compare_frame), inline_frames);
+                if (grown == NULL)
                 {
-                    return false;
+                    goto end;
                 }
-
-                a_element = a_element->next;
-                b_element = b_element->next;
+                frames = grown;
             }
-
-            /* one of the arrays is longer than the other */
-            if (a_element != b_element) {
-                return false;
-            }
-
-            return true;
+            frames[depth].a_element = a_element->child;
+            frames[depth].b_element = b_element->child;
+            frames[depth].a_container = a_element;
+            frames[depth].b_container = b_element;
+            frames[depth].second_pass = false;
+            depth++;
         }
 
-        case BC_JSON_Object:
+        /* find the next pair of elements to compare */
+        for (;;)
         {
-            BC_JSON *a_element = NULL;
-            BC_JSON *b_element = NULL;
-            BC_JSON_ArrayForEach(a_element, a)
+            if (depth == 0)
             {
-                /* TODO This has O(n^2) runtime, which is horrible! */
-                b_element = get_object_item(b, a_element->string, case_sensitive);
-                if (b_element == NULL)
+                equal = true;
+                goto end;
+            }
+            top = &frames[depth - 1];
+
+            if ((top->a_container->type & 0xFF) == BC_JSON_Array)
+            {
+                a_element = top->a_element;
+                b_element = top->b_element;
+                if ((a_element != NULL) && (b_element != NULL))
                 {
-                    return false;
+                    top->a_element = a_element->next;
+                    top->b_element = b_element->next;
+                    break;
                 }
 
-                if (!BC_JSON_Compare(a_element, b_element, case_sensitive))
+                /* one of the arrays is longer than the other */
+                if (a_element != b_element)
                 {
-                    return false;
+                    goto end;
                 }
+                depth--;
+                continue;
             }
 
-            /* doing this twice, once on a and b to prevent true comparison if a subset of b
-             * TODO: Do this the proper way, this is just a fix for now */
-            BC_JSON_ArrayForEach(b_element, b)
+            a_element = top->a_element;
+            if (a_element != NULL)
             {
-                a_element = get_object_item(a, b_element->string, case_sensitive);
-                if (a_element == NULL)
+                top->a_element = a_element->next;
+                /* TODO This has O(n^2) runtime, which is horrible! */
+                b_element = get_object_item(top->b_container, a_element->string, case_sensitive);
+                if (b_element == NULL)
                 {
-                    return false;
+                    goto end;
                 }
-
-                if (!BC_JSON_Compare(b_element, a_element, case_sensitive))
+                /* the first pass compared this pair already, comparing arrays/objects again
+                 * would make the time this takes grow exponentially with the nesting of objects */
+                if (top->second_pass && ((a_element->type & (BC_JSON_Array | BC_JSON_Object)) != 0)
+                    && (get_object_item(top->a_container, b_element->string, case_sensitive) == a_element))
                 {
-                    return false;
+                    continue;
                 }
+                break;
             }
 
-            return true;
+            if (top->second_pass)
+            {
+                depth--;
+                continue;
+            }
+            /* doing this twice, once on a and b to prevent true comparison if a subset of b
+             * TODO: Do this the proper way, this is just a fix for now */
+            swap = top->a_container;
+            top->a_container = top->b_container;
+            top->b_container = swap;
+            top->a_element = top->a_container->child;
+            top->second_pass = true;
         }
+    }
 
-        default:
-            return false;
+end:
+    if (frames != inline_frames)
+    {
+        global_hooks.deallocate(frames);
     }
+
+    return equal;
 }
 
 CJSON_PUBLIC(void *) BC_JSON_malloc(size_t size)
@@ -103,6 +103,11 @@ extern "C" {
 
 #define BC_JSON_IsReference   256
 #define BC_JSON_StringIsConst 512
+#define BC_JSON_StringIsInterned 1024 /* string is a key owned by a BC_JSON_ShapeCache */
+#define BC_JSON_NumberIsFloat 2048 /* number came from a float, it is printed with float precision */
+#define BC_JSON_OwnsFile 4096 /* root of a zero_copy BC_JSON_ParseFile document, deleting it releases the file */
+#define BC_JSON_IsFrozen 8192 /* item of a document frozen with BC_JSON_Freeze, it can't be changed */
+#define BC_JSON_IsPrinted 16384 /* unchanged since BC_JSON_PrintCached printed it */
 
 	/* The BC_JSON structure: */
 	typedef struct BC_JSON {
@@ -126,6 +131,10 @@ extern "C" {
 		/* The item's name string, if this item is the child of, or is in the list of subitems of an
 		 * object. */
 		char*         name_string;
+
+		/* Belongs to the library: the index of a frozen array/object or of an object parsed with a
+		 * shape cache. Copies and references don't get it, and it mustn't be read or written. */
+		struct BC_JSON_Index* index;
 	} BC_JSON;
 
 	typedef struct BC_JSON_Hooks {
@@ -137,6 +146,98 @@ extern "C" {
 
 	typedef int BC_JSON_bool;
 
+	/* Id of a key registered with BC_JSON_Intern. */
+	typedef int BC_JSON_Symbol;
+
+	/* Storage needed to parse a document, as reported by BC_JSON_ParseMeasure. */
+	typedef struct BC_JSON_Measurement {
+		/* number of BC_JSON nodes in the tree */
+		size_t node_count;
+		/* bytes for keys, string values and unusually long number literals, including terminators */
+		size_t string_bytes;
+		/* size of a block that BC_JSON_ParseIntoBuffer can parse the document into: the nodes, the strings
+	 * and room to align the nodes in a block that isn't aligned */
+		size_t buffer_size;
+	} BC_JSON_Measurement;
+
+	/* What a BC_JSON_SaxHandlers callback returns: go on, skip the contents of the array/object it
+	 * started (its end is still reported) or, from key, the member's value, or stop parsing. */
+#define BC_JSON_SaxContinue 0
+#define BC_JSON_SaxSkip     1
+#define BC_JSON_SaxStop     2
+
+	/* Callbacks of BC_JSON_SaxParse, a NULL callback is skipped. Strings and keys are passed with
+	 * their length, they aren't null terminated and are only valid during the call. */
+	typedef struct BC_JSON_SaxHandlers {
+		int (*start_object)(void* context);
+		int (*end_object)(void* context);
+		int (*start_array)(void* context);
+		int (*end_array)(void* context);
+		int (*key)(void* context, const char* key, size_t length);
+		int (*string)(void* context, const char* string, size_t length);
+		int (*number)(void* context, double number);
+		int (*boolean)(void* context, BC_JSON_bool value);
+		int (*null)(void* context);
+	} BC_JSON_SaxHandlers;
+
+	/* Interns the keys of parsed objects and remembers their order, see BC_JSON_CreateShapeCache. */
+	typedef struct BC_JSON_ShapeCache BC_JSON_ShapeCache;
+
+	/* Options for BC_JSON_ParseWithOptions and BC_JSON_ParseFile. Zero means the default for every option. */
+	typedef struct BC_JSON_ParseOptions {
+		/* check that the JSON is followed by a null terminator, see BC_JSON_ParseWithOpts */
+		BC_JSON_bool require_null_terminated;
+		/* if not NULL, object keys are matched against and interned in this shape cache */
+		BC_JSON_ShapeCache* shape_cache;
+		/* how deeply arrays and objects may be nested, 0 for CJSON_NESTING_LIMIT. The parser doesn't
+		 * recurse, so this can be raised beyond CJSON_NESTING_LIMIT without risking the stack. */
+		size_t max_depth;
+		/* arrays and objects nested this deeply (1 for the members/elements of the root) are checked
+		 * (against max_depth too) but not parsed, they become BC_JSON_Raw items with a copy of their text, which printing
+		 * reproduces byte for byte. 0 parses everything. */
+		size_t raw_depth;
+		/* reject strings that aren't valid UTF-8 (overlong forms, surrogates, ...) */
+		BC_JSON_bool strict_utf8;
+		/* BC_JSON_ParseFile only: keep the file mapped and let strings and keys point into it
+		 * instead of copying them, see there */
+		BC_JSON_bool zero_copy;
+		/* skip // comments and block comments like whitespace, a block comment that isn't closed is an error */
+		BC_JSON_bool allow_comments;
+		/* accept a comma after the last element of an array or member of an object */
+		BC_JSON_bool allow_trailing_commas;
+	} BC_JSON_ParseOptions;
+
+	/* Spans: where the values of a document are in its text, so that BC_JSON_ParseEdit can re-parse
+	 * only the value an edit of the text is in. */
+	typedef struct BC_JSON_Spans BC_JSON_Spans;
+
+	/* An array in a text that is read one element at a time, see BC_JSON_ArrayStream_Open. */
+	typedef struct BC_JSON_ArrayStream BC_JSON_ArrayStream;
+
+	/* A JSON file with an index from BC_JSON_WriteIndex, see BC_JSON_IndexedFile_Open. */
+	typedef struct BC_JSON_IndexedFile BC_JSON_IndexedFile;
+
+	/* A buffer to print into again and again, see BC_JSON_PrintInto. */
+	typedef struct BC_JSON_PrintBuffer BC_JSON_PrintBuffer;
+
+	/* The text of the arrays/objects of a document, see BC_JSON_PrintCached. */
+	typedef struct BC_JSON_PrintCache BC_JSON_PrintCache;
+
+	/* Writes JSON text straight from values, without a tree, see BC_JSON_CreateWriter. */
+	typedef struct BC_JSON_Writer BC_JSON_Writer;
+
+	/* Receives the text of BC_JSON_PrintToWriter piece by piece. Returns how many of the length bytes
+	 * at data it took, it is called again with the rest. Returning 0 stops printing with an error.
+	 * Printing waits for the writer, so a writer that can't take more right now should block. */
+	typedef size_t (*BC_JSON_WriteFunction)(void* context, const char* data, size_t length);
+
+	/* A piece of the text of BC_JSON_PrintIoVec. It has the layout of struct iovec, so on POSIX
+	 * systems an array of them can be passed to writev as is. */
+	typedef struct BC_JSON_IoVec {
+		void* iov_base;
+		size_t iov_len;
+	} BC_JSON_IoVec;
+
 /* Limits how deeply nested arrays/objects can be before BC_JSON rejects to parse them.
  * This is to prevent stack overflows. */
 #ifndef CJSON_NESTING_LIMIT
@@ -149,6 +250,12 @@ extern "C" {
 	#define CJSON_CIRCULAR_LIMIT 10000
 #endif
 
+/* Limits how many shapes a BC_JSON_ShapeCache remembers, keys of new shapes aren't interned
+ * after that. This bounds the memory of a cache that sees objects with arbitrary keys. */
+#ifndef CJSON_SHAPE_CACHE_LIMIT
+	#define CJSON_SHAPE_CACHE_LIMIT 4096
+#endif
+
 	/* returns the version of BC_JSON as a string */
 	CJSON_PUBLIC(const char*) BC_JSON_Version(void);
 
@@ -177,6 +284,123 @@ extern "C" {
 		const char** return_parse_end,
 		BC_JSON_bool   require_null_terminated
 	);
+	/* Single allocation parsing: BC_JSON_ParseMeasure scans the input once without building a tree
+	 * and reports how much memory parsing it takes. BC_JSON_ParseIntoBuffer then builds the whole
+	 * tree inside the caller's block without calling the allocator, and returns NULL if the block is
+	 * too small. A block of the measured buffer_size is large enough at any alignment. Both behave like
+	 * BC_JSON_ParseWithLength. The tree lives as long as the block: don't BC_JSON_Delete it or
+	 * change it in ways that free or allocate memory, just release the block when done. */
+	CJSON_PUBLIC(BC_JSON_bool)
+	BC_JSON_ParseMeasure(const char* value, size_t buffer_length, BC_JSON_Measurement* measurement);
+	CJSON_PUBLIC(BC_JSON*)
+	BC_JSON_ParseIntoBuffer(const char* value, size_t buffer_length, void* block, size_t block_size);
+	/* Event parsing: walk the JSON like BC_JSON_ParseWithLength and call the handlers for what's in
+	 * it, without building a tree. Returns true if the JSON is valid or a handler stopped parsing
+	 * before the end, false on a syntax error, which BC_JSON_GetErrorPtr points at. */
+	CJSON_PUBLIC(BC_JSON_bool)
+	BC_JSON_SaxParse(
+		const char* value, size_t buffer_length, const BC_JSON_SaxHandlers* handlers, void* context
+	);
+	/* Check that the JSON is valid without building anything or allocating memory. This is stricter
+	 * than the parser: it follows the RFC 8259 grammar (no leading zeros, no control characters in
+	 * strings, only space, tab, CR and LF as whitespace), strings must be valid UTF-8, and nothing but
+	 * whitespace may follow the value, up to the end of the buffer or a terminating zero. Like the
+	 * parser, and unlike the grammar, it rejects \u escapes of unpaired surrogates ("\ud800") and
+	 * arrays/objects nested deeper than CJSON_NESTING_LIMIT. If error_position isn't NULL, it is set
+	 * to where the JSON is invalid, or NULL if it is valid. */
+	CJSON_PUBLIC(BC_JSON_bool)
+	BC_JSON_Validate(const char* value, size_t buffer_length, const char** error_position);
+	/* Parse only the parts of the JSON that the paths select. A path is a JSON pointer like
+	 * "/user/id", where a token that is a single asterisk matches every member of an object or
+	 * element of an array, or "" for the whole document. The result has the shape of the document, with only the
+	 * members and elements on the way to what the paths select (so array indices can shift) and all
+	 * of what they select. Everything else is checked like BC_JSON_ParseWithLength does, but no nodes
+	 * are built for it, and its strings and numbers aren't decoded. Returns NULL if the JSON or one
+	 * of the paths is invalid. */
+	CJSON_PUBLIC(BC_JSON*)
+	BC_JSON_ParseProjected(
+		const char* value, size_t buffer_length, const char* const* paths, size_t path_count
+	);
+	/* Parse like BC_JSON_ParseWithLength, but build the new document from the nodes and string
+	 * buffers of the document in *doc instead of deleting it and allocating a fresh one. Only what
+	 * the new document needs beyond the old one is allocated, and what's left over is freed.
+	 * *doc must be NULL or a root from one of the hook based parse/create functions. The old document
+	 * is consumed in any case: *doc is set to the new document, or NULL if parsing fails. */
+	CJSON_PUBLIC(BC_JSON*) BC_JSON_ParseReuse(BC_JSON** doc, const char* value, size_t buffer_length);
+	/* Find the array at pointer (a JSON pointer, "" or NULL for the root) without building anything
+	 * on the way, to read its elements one at a time with BC_JSON_ArrayStream_Next. Only one element
+	 * is in memory at a time, not the whole document. value must stay valid until the stream is
+	 * closed. Returns NULL if there is no array at pointer or the text up to it is invalid. */
+	CJSON_PUBLIC(BC_JSON_ArrayStream*) BC_JSON_ArrayStream_Open(const char* value, size_t buffer_length, const char* pointer);
+	/* Parse the next element of the array, which the caller owns. Pass the previous element as recycled
+	 * (or NULL) to have its nodes and strings reused like BC_JSON_ParseReuse does, it is consumed in any
+	 * case. Returns NULL at the end of the array, or if an element is invalid: BC_JSON_GetErrorPtr is
+	 * NULL at the end and points to the error otherwise. The text after the array isn't checked. */
+	CJSON_PUBLIC(BC_JSON*) BC_JSON_ArrayStream_Next(BC_JSON_ArrayStream* stream, BC_JSON* recycled);
+	CJSON_PUBLIC(void) BC_JSON_ArrayStream_Close(BC_JSON_ArrayStream* stream);
+	/* Scan the JSON file at path once and write an index of it to index_path: where the elements
+	 * of arrays and members of objects are, down to max_depth (1 for those of the root), and a
+	 * checksum of the file. Returns false if the file is invalid or the index can't be written. */
+	CJSON_PUBLIC(BC_JSON_bool) BC_JSON_WriteIndex(const char* path, const char* index_path, int max_depth);
+	/* Map the JSON file at path to look up values in it with the index at index_path. Fails if
+	 * the index isn't one for the file: its length has to match, and with verify its checksum,
+	 * which reads the whole file. */
+	CJSON_PUBLIC(BC_JSON_IndexedFile*) BC_JSON_IndexedFile_Open(const char* path, const char* index_path, BC_JSON_bool verify);
+	/* Parse only the value at pointer (a JSON pointer, "" or NULL for the root), which the caller
+	 * owns. The index leads to it or the indexed value it is in, so only that is parsed. Returns
+	 * NULL if there is no such value or it is invalid. */
+	CJSON_PUBLIC(BC_JSON*) BC_JSON_IndexedFile_Get(BC_JSON_IndexedFile* file, const char* pointer);
+	CJSON_PUBLIC(void) BC_JSON_IndexedFile_Close(BC_JSON_IndexedFile* file);
+	/* Parse like BC_JSON_ParseWithLength and remember where every value is in the text, in *spans.
+	 * The spans have to be deleted with BC_JSON_DeleteSpans, after or before the document. */
+	CJSON_PUBLIC(BC_JSON*) BC_JSON_ParseWithSpans(const char* value, size_t buffer_length, BC_JSON_Spans** spans);
+	/* Bring a document from BC_JSON_ParseWithSpans up to date with an edit of its text: removed_length
+	 * bytes at edit_offset of value (the text before the edit, that *doc and spans are for) are
+	 * replaced by inserted_length bytes at inserted. Only the innermost value the edit is in is parsed
+	 * again and replaces the old one, keeping its key. If the edit reaches beyond that value, the
+	 * values around it are tried, and at last the whole text. *doc changes if the root is replaced,
+	 * items outside the re-parsed value stay where they are. Returns false if the edited text can't be
+	 * parsed, *doc and spans still describe value then. The tree must not be changed other than by
+	 * BC_JSON_ParseEdit while spans are used for it. */
+	CJSON_PUBLIC(BC_JSON_bool)
+	BC_JSON_ParseEdit(
+		BC_JSON** doc, BC_JSON_Spans* spans, const char* value, size_t buffer_length,
+		size_t edit_offset, size_t removed_length, const char* inserted, size_t inserted_length
+	);
+	CJSON_PUBLIC(void) BC_JSON_DeleteSpans(BC_JSON_Spans* spans);
+	/* Parse like BC_JSON_ParseWithLengthOpts, with the options given in a BC_JSON_ParseOptions, which
+	 * can be NULL for the defaults. */
+	CJSON_PUBLIC(BC_JSON*) BC_JSON_ParseWithOptions(
+		const char*                 value,
+		size_t                      buffer_length,
+		const BC_JSON_ParseOptions* options,
+		const char**                return_parse_end
+	);
+	/* Parse the JSON file at path, with options that can be NULL for the defaults. The file is
+	 * memory mapped where the system supports it and parsed straight from the mapping instead of a
+	 * copy of the text, the mapping is released before returning. Where files can't be mapped they are
+	 * read into memory. require_null_terminated only allows whitespace after the JSON, up to the end
+	 * of the file. With options->zero_copy the mapping is kept: strings and keys are unescaped in
+	 * place (the mapping is private, the file doesn't change) and the items point to them instead of
+	 * owning copies. The mapping then belongs to the root and is released by BC_JSON_Delete, so the
+	 * keys and strings must not be used beyond the document. Keys are constant (BC_JSON_StringIsConst)
+	 * and strings are references (BC_JSON_IsReference), BC_JSON_SetValuestring can't change them.
+	 * The text is gone after a failure, so BC_JSON_GetErrorPtr returns NULL then. */
+	CJSON_PUBLIC(BC_JSON*) BC_JSON_ParseFile(const char* path, const BC_JSON_ParseOptions* options);
+
+	/* Shape cache: most objects of an API have the same keys in the same order. A parse with a shape
+	 * cache compares every key to the one that followed the previous key the last time with a single
+	 * memcmp, and shares the key strings stored in the cache instead of allocating them. Objects parsed
+	 * that way also get a table of their members, so BC_JSON_GetObjectItemCaseSensitive finds a key
+	 * by its slot instead of comparing it to every member. The keys belong to the cache: delete the
+	 * cache only after all documents parsed with it.
+	 * Threads: a parse changes the cache, so only one parse at a time may use it. Looking up keys
+	 * doesn't write to the cache, so documents parsed with it can be read by several threads at once
+	 * while no parse uses it. Changing an object through the functions that add, insert, replace,
+	 * detach and delete items drops its table, call BC_JSON_MarkChanged after changing its members
+	 * in any other way. */
+	CJSON_PUBLIC(BC_JSON_ShapeCache*) BC_JSON_CreateShapeCache(void);
+	CJSON_PUBLIC(void) BC_JSON_DeleteShapeCache(BC_JSON_ShapeCache* cache);
 
 	/* Render a BC_JSON entity to text for transfer/storage. */
 	CJSON_PUBLIC(char*) BC_JSON_Print(const BC_JSON* item);
@@ -185,12 +409,92 @@ extern "C" {
 	/* Render a BC_JSON entity to text using a buffered strategy. prebuffer is a guess at the final
 	 * size. guessing well reduces reallocation. fmt=0 gives unformatted, =1 gives formatted */
 	CJSON_PUBLIC(char*) BC_JSON_PrintBuffered(const BC_JSON* item, int prebuffer, BC_JSON_bool fmt);
+	/* Render a BC_JSON entity to the same text as BC_JSON_Print (format=1) or BC_JSON_PrintUnformatted
+	 * (format=0) on up to threads threads. The elements of the first array/object with more than one
+	 * element (going down through {"records":[...]} and the like) are split into runs of at least 256
+	 * that are printed at the same time, smaller items are printed on the calling thread. The hooks
+	 * must be safe to call from several threads. Define CJSON_NO_THREADS to always print on the
+	 * calling thread, otherwise link with the threads library (-pthread). */
+	CJSON_PUBLIC(char*) BC_JSON_PrintParallel(const BC_JSON* item, BC_JSON_bool format, int threads);
+	CJSON_PUBLIC(BC_JSON_PrintCache*) BC_JSON_CreatePrintCache(void);
+	/* Free a print cache and the text in it, the documents printed with it stay as they are. */
+	CJSON_PUBLIC(void) BC_JSON_DeletePrintCache(BC_JSON_PrintCache* cache);
+	/* Render a BC_JSON entity to text like BC_JSON_Print (format=1) or BC_JSON_PrintUnformatted
+	 * (format=0), and cache the text of every array/object in it in cache. Printing it again with the
+	 * cache only prints the arrays/objects again that changed since, and copies the text of the
+	 * others. Use a cache for one document, and on one thread at a time like the document; items that
+	 * are never printed with a cache don't touch one. Changes through BC_JSON_SetValuestring,
+	 * BC_JSON_SetNumberValue, BC_JSON_SetBoolValue and the functions that add, insert, replace,
+	 * detach and delete items are noticed, call BC_JSON_MarkChanged after changing an item in any
+	 * other way (setting its members). Returns NULL on failure. */
+	CJSON_PUBLIC(char*) BC_JSON_PrintCached(BC_JSON_PrintCache* cache, BC_JSON* item, BC_JSON_bool format);
+	CJSON_PUBLIC(void) BC_JSON_MarkChanged(BC_JSON* item);
+	/* The exact length of the text BC_JSON_Print (format=1) or BC_JSON_PrintUnformatted (format=0)
+	 * renders for item, without the terminating zero. Returns 0 if item can't be printed. */
+	CJSON_PUBLIC(size_t) BC_JSON_PrintedLength(const BC_JSON* item, BC_JSON_bool format);
+	/* Render a BC_JSON entity to text and hand it to write_fn in pieces of at most chunk_size bytes
+	 * (0 for a default of 4096), without holding the whole text in memory. Long strings are passed
+	 * to write_fn straight from the item. The text is the same that BC_JSON_Print (format=1) or
+	 * BC_JSON_PrintUnformatted (format=0) returns, without the terminating zero. Returns 1 on success
+	 * and 0 if the item can't be printed or write_fn fails. */
+	CJSON_PUBLIC(BC_JSON_bool)
+	BC_JSON_PrintToWriter(const BC_JSON* item, BC_JSON_bool format, BC_JSON_WriteFunction write_fn, void* context, size_t chunk_size);
+	/* Render a BC_JSON entity to text as a list of *count pieces for gather output (writev). Strings
+	 * without escapes and raw values of at least threshold bytes (0 for a default of 1024) aren't
+	 * copied, their pieces point into the item, which must not change until the pieces are written.
+	 * The rest of the text is in the same allocation as the list, free it with BC_JSON_free. The
+	 * pieces put together are the text of BC_JSON_Print (format=1) or BC_JSON_PrintUnformatted
+	 * (format=0) without the terminating zero. Returns NULL on failure. */
+	CJSON_PUBLIC(BC_JSON_IoVec*)
+	BC_JSON_PrintIoVec(const BC_JSON* item, BC_JSON_bool format, size_t threshold, size_t* count);
+	/* Render a BC_JSON entity to text in a buffer that is kept across prints, to avoid allocating for
+	 * every print. Each BC_JSON_PrintInto replaces the text of the previous one and grows the buffer
+	 * only when the text doesn't fit, the buffer never shrinks. BC_JSON_PrintBufferText returns the
+	 * text, it stays valid until the next BC_JSON_PrintInto or BC_JSON_DeletePrintBuffer, and
+	 * BC_JSON_PrintBufferLength its length without the terminating zero. BC_JSON_PrintInto returns
+	 * 1 on success and 0 on failure, the text is empty then. */
+	CJSON_PUBLIC(BC_JSON_PrintBuffer*) BC_JSON_CreatePrintBuffer(void);
+	CJSON_PUBLIC(void) BC_JSON_DeletePrintBuffer(BC_JSON_PrintBuffer* buffer);
+	CJSON_PUBLIC(BC_JSON_bool) BC_JSON_PrintInto(BC_JSON_PrintBuffer* buffer, const BC_JSON* item, BC_JSON_bool format);
+	CJSON_PUBLIC(const char*) BC_JSON_PrintBufferText(const BC_JSON_PrintBuffer* buffer);
+	CJSON_PUBLIC(size_t) BC_JSON_PrintBufferLength(const BC_JSON_PrintBuffer* buffer);
 	/* Render a BC_JSON entity to text using a buffer already allocated in memory with given length.
 	 * Returns 1 on success and 0 on failure. */
-	/* NOTE: BC_JSON is not always 100% accurate in estimating how much memory it will use, so to be
-	 * safe allocate 5 bytes more than you actually need */
+	/* NOTE: the buffer needs BC_JSON_PrintedLength(item, format) + 1 bytes, the text and its
+	 * terminating zero */
 	CJSON_PUBLIC(BC_JSON_bool)
 	BC_JSON_PrintPreallocated(BC_JSON* item, char* buffer, const int length, const BC_JSON_bool format);
+	/* Write JSON without building a tree: call the BC_JSON_Writer functions in the order the values
+	 * appear in the text, BC_JSON_WriterKey before every member of an object. The text is the same
+	 * BC_JSON_Print (format=1) or BC_JSON_PrintUnformatted (format=0) renders for the tree. A writer
+	 * from BC_JSON_CreateWriter collects the text in a buffer that grows as needed, see
+	 * BC_JSON_WriterText/BC_JSON_WriterLength. One from BC_JSON_CreateStreamWriter hands it to
+	 * write_fn in pieces of up to chunk_size bytes (0 for a default) like BC_JSON_PrintToWriter, the
+	 * last piece when BC_JSON_WriterFinish is called. A call that would produce invalid JSON (a
+	 * member without a key, closing the wrong array/object, a second top level value, ...) fails, and
+	 * so does every call after a failed one. BC_JSON_WriterFinish returns 1 if a complete value was
+	 * written, BC_JSON_ResetWriter starts over with the buffer of the writer. */
+	CJSON_PUBLIC(BC_JSON_Writer*) BC_JSON_CreateWriter(BC_JSON_bool format);
+	CJSON_PUBLIC(BC_JSON_Writer*) BC_JSON_CreateStreamWriter(
+		BC_JSON_bool format, BC_JSON_WriteFunction write_fn, void* context, size_t chunk_size
+	);
+	CJSON_PUBLIC(void) BC_JSON_DeleteWriter(BC_JSON_Writer* writer);
+	CJSON_PUBLIC(void) BC_JSON_ResetWriter(BC_JSON_Writer* writer);
+	CJSON_PUBLIC(BC_JSON_bool) BC_JSON_WriterBeginObject(BC_JSON_Writer* writer);
+	CJSON_PUBLIC(BC_JSON_bool) BC_JSON_WriterEndObject(BC_JSON_Writer* writer);
+	CJSON_PUBLIC(BC_JSON_bool) BC_JSON_WriterBeginArray(BC_JSON_Writer* writer);
+	CJSON_PUBLIC(BC_JSON_bool) BC_JSON_WriterEndArray(BC_JSON_Writer* writer);
+	CJSON_PUBLIC(BC_JSON_bool) BC_JSON_WriterKey(BC_JSON_Writer* writer, const char* key);
+	CJSON_PUBLIC(BC_JSON_bool) BC_JSON_WriterString(BC_JSON_Writer* writer, const char* string);
+	CJSON_PUBLIC(BC_JSON_bool) BC_JSON_WriterNumber(BC_JSON_Writer* writer, double number);
+	CJSON_PUBLIC(BC_JSON_bool) BC_JSON_WriterBool(BC_JSON_Writer* writer, BC_JSON_bool boolean);
+	CJSON_PUBLIC(BC_JSON_bool) BC_JSON_WriterNull(BC_JSON_Writer* writer);
+	/* write raw json as it is, like a BC_JSON_Raw item */
+	CJSON_PUBLIC(BC_JSON_bool) BC_JSON_WriterRaw(BC_JSON_Writer* writer, const char* raw);
+	CJSON_PUBLIC(BC_JSON_bool) BC_JSON_WriterFinish(BC_JSON_Writer* writer);
+	/* the text written so far, valid until the next call with the writer */
+	CJSON_PUBLIC(const char*) BC_JSON_WriterText(const BC_JSON_Writer* writer);
+	CJSON_PUBLIC(size_t) BC_JSON_WriterLength(const BC_JSON_Writer* writer);
 	/* Delete a BC_JSON entity and all subentities. */
 	CJSON_PUBLIC(void) BC_JSON_Delete(BC_JSON* item);
 
@@ -203,6 +507,29 @@ extern "C" {
 	CJSON_PUBLIC(BC_JSON*)
 	BC_JSON_GetObjectItemCaseSensitive(const BC_JSON* const object, const char* const string);
 	CJSON_PUBLIC(BC_JSON_bool) BC_JSON_HasObjectItem(const BC_JSON* object, const char* string);
+	/* Symbols: BC_JSON_Intern registers a key and returns its id, the same id for the same name,
+	 * or 0 if it fails. Keys that are registered symbols are parsed into the name of the symbol
+	 * instead of a copy, so BC_JSON_GetObjectItemBySymbol only compares ids for them. Passing
+	 * BC_JSON_SymbolName to BC_JSON_AddItemToObjectCS does the same for objects you build.
+	 * Symbols live until the program ends. Register them before parsing on several threads. */
+	CJSON_PUBLIC(BC_JSON_Symbol) BC_JSON_Intern(const char* name);
+	/* Returns NULL for ids that weren't returned by BC_JSON_Intern. */
+	CJSON_PUBLIC(const char*) BC_JSON_SymbolName(BC_JSON_Symbol symbol);
+	/* Get the item whose key is the name of the symbol. Case sensitive. */
+	CJSON_PUBLIC(BC_JSON*)
+	BC_JSON_GetObjectItemBySymbol(const BC_JSON* const object, const BC_JSON_Symbol symbol);
+	/* Make the document at item (a root) read-only and index every array and object in it, so that
+	 * BC_JSON_GetArraySize, BC_JSON_GetArrayItem and the BC_JSON_GetObjectItem functions take constant
+	 * time. Nothing of a frozen document is written by reading it, so any number of threads can read
+	 * and print it at once, with the Get functions, BC_JSONUtils_GetPointer and the Print functions
+	 * but BC_JSON_PrintCached, which doesn't cache for it. Symbols have to be registered before.
+	 * The functions that change items refuse to change a frozen document and fail an assert in
+	 * debug builds, BC_JSON_Delete only takes its root. Fails for documents with arrays/objects
+	 * added by reference or if memory runs out, the document can still be changed then. */
+	CJSON_PUBLIC(BC_JSON_bool) BC_JSON_Freeze(BC_JSON* item);
+	/* Drop the indexes of a document frozen with BC_JSON_Freeze so it can be changed again. Documents
+	 * parsed with BC_JSON_ParseIntoBuffer need this before their block is freed. */
+	CJSON_PUBLIC(void) BC_JSON_Unfreeze(BC_JSON* item);
 	/* For analysing failed parses. This returns a pointer to the parse error. You'll probably need
 	 * to look a few chars back to make sense of it. Defined when BC_JSON_Parse() returns 0. 0 when
 	 * BC_JSON_Parse() succeeds. */
@@ -230,6 +557,8 @@ extern "C" {
 	CJSON_PUBLIC(BC_JSON*) BC_JSON_CreateFalse(void);
 	CJSON_PUBLIC(BC_JSON*) BC_JSON_CreateBool(BC_JSON_bool boolean);
 	CJSON_PUBLIC(BC_JSON*) BC_JSON_CreateNumber(double num);
+	/* a number that is printed with the fewest digits that read back as the same float */
+	CJSON_PUBLIC(BC_JSON*) BC_JSON_CreateFloat(float num);
 	CJSON_PUBLIC(BC_JSON*) BC_JSON_CreateString(const char* string);
 	/* raw json */
 	CJSON_PUBLIC(BC_JSON*) BC_JSON_CreateRaw(const char* raw);
@@ -319,7 +648,7 @@ extern "C" {
 	CJSON_PUBLIC(BC_JSON*) BC_JSON_AddObjectToObject(BC_JSON* const object, const char* const name);
 	CJSON_PUBLIC(BC_JSON*) BC_JSON_AddArrayToObject(BC_JSON* const object, const char* const name);
 
-	/* helper for the BC_JSON_SetNumberValue macro */
+	/* helper for the BC_JSON_SetNumberValue macro, the number is printed with double precision afterwards */
 	CJSON_PUBLIC(double) BC_JSON_SetNumberHelper(BC_JSON* object, double number);
 #define BC_JSON_SetNumberValue(object, number)                                    \
 	((object != NULL) ? BC_JSON_SetNumberHelper(object, (double)number) : (number))
@@ -332,7 +661,7 @@ extern "C" {
  * the new type*/
 #define BC_JSON_SetBoolValue(object, boolValue)                            \
 	((object != NULL && ((object)->type & (BC_JSON_False | BC_JSON_True)))     \
-	   ? (object)->type = ((object)->type & (~(BC_JSON_False | BC_JSON_True))) \
+	   ? (object)->type = ((object)->type & (~(BC_JSON_False | BC_JSON_True | BC_JSON_IsPrinted))) \
 	                    | ((boolValue) ? BC_JSON_True : BC_JSON_False)         \
 	   : BC_JSON_Invalid)
 
@@ -41,6 +41,7 @@
 #include <limits.h>
 #include <math.h>
 #include <float.h>
+#include <assert.h>
 #include <math.h>
 
 #if defined(_MSC_VER)
@@ -261,7 +262,15 @@ CJSON_PUBLIC(char *) BC_JSONUtils_FindPointerFromObjectTo(const BC_JSON * const
 /* non broken version of BC_JSON_GetArrayItem */
 static BC_JSON *get_array_item(const BC_JSON *array, size_t item)
 {
-    BC_JSON *child = array ? array->child : NULL;
+    BC_JSON *child = NULL;
+
+    /* frozen arrays know where their elements are */
+    if ((array != NULL) && (array->type & BC_JSON_IsFrozen))
+    {
+        return (item <= (size_t)INT_MAX) ? BC_JSON_GetArrayItem(array, (int)item) : NULL;
+    }
+
+    child = array ? array->child : NULL;
     while ((child != NULL) && (item > 0))
     {
         item--;
@@ -403,27 +412,8 @@ static BC_JSON *detach_item_from_array(BC_JSON *array, size_t which)
         /* item doesn't exist */
         return NULL;
     }
-    if (c != array->child)
-    {
-        /* not the first element */
-        c->prev->next = c->next;
-    }
-    if (c->next)
-    {
-        c->next->prev = c->prev;
-    }
-    if (c == array->child)
-    {
-        array->child = c->next;
-    }
-    else if (c->next == NULL)
-    {
-        array->child->prev = c->prev;
-    }
-    /* make sure the detached item doesn't point anywhere anymore */
-    c->prev = c->next = NULL;
 
-    return c;
+    return BC_JSON_DetachItemViaPointer(array, c);
 }
 
 /* detach an item at the given path */
@@ -480,19 +470,17 @@ cleanup:
     return detached_item;
 }
 
-/* sort lists using mergesort */
-static BC_JSON *sort_list(BC_JSON *list, const BC_JSON_bool case_sensitive)
+/* Split a list in the middle for sorting it. Returns the second half,
+ * or NULL if the list is sorted already and needs no splitting. */
+static BC_JSON *split_list(BC_JSON *list, const BC_JSON_bool case_sensitive)
 {
-    BC_JSON *first = list;
     BC_JSON *second = list;
     BC_JSON *current_item = list;
-    BC_JSON *result = list;
-    BC_JSON *result_tail = NULL;
 
     if ((list == NULL) || (list->next == NULL))
     {
         /* One entry is sorted already. */
-        return result;
+        return NULL;
     }
 
     while ((current_item != NULL) && (current_item->next != NULL) && (compare_strings((unsigned char*)current_item->string, (unsigned char*)current_item->next->string, case_sensitive) < 0))
@@ -503,7 +491,7 @@ static BC_JSON *sort_list(BC_JSON *list, const BC_JSON_bool case_sensitive)
     if ((current_item == NULL) || (current_item->next == NULL))
     {
         /* Leave sorted lists unmodified. */
-        return result;
+        return NULL;
     }
 
     /* reset pointer to the beginning */
@@ -519,19 +507,24 @@ static BC_JSON *sort_list(BC_JSON *list, const BC_JSON_bool case_sensitive)
             current_item = current_item->next;
         }
     }
-    if ((second != NULL) && (second->prev != NULL))
+    if ((second == NULL) || (second->prev == NULL))
     {
-        /* Split the lists */
-        second->prev->next = NULL;
-        second->prev = NULL;
+        return NULL;
     }
 
-    /* Recursively sort the sub-lists. */
-    first = sort_list(first, case_sensitive);
-    second = sort_list(second, case_sensitive);
-    result = NULL;
+    /* Split the lists */
+    second->prev->next = NULL;
+    second->prev = NULL;
+
+    return second;
+}
+
+/* Merge two sorted lists. */
+static BC_JSON *merge_lists(BC_JSON *first, BC_JSON *second, const BC_JSON_bool case_sensitive)
+{
+    BC_JSON *result = NULL;
+    BC_JSON *result_tail = NULL;
 
-    /* Merge the sub-lists */
     while ((first != NULL) && (second != NULL))
     {
         BC_JSON *smaller = NULL;
@@ -592,101 +585,196 @@ static BC_JSON *sort_list(BC_JSON *list, const BC_JSON_bool case_sensitive)
     return result;
 }
 
+/* a list that has been split for sorting */
+typedef struct
+{
+    BC_JSON *second; /* the second half */
+    BC_JSON *first; /* the sorted first half, NULL while it is being sorted */
+} sort_frame;
+
+/* sort lists using mergesort, top down like the recursive version but with an explicit stack */
+static BC_JSON *sort_list(BC_JSON *list, const BC_JSON_bool case_sensitive)
+{
+    /* every level halves the list, so there can't be more levels than bits in a size_t */
+    sort_frame frames[sizeof(size_t) * CHAR_BIT];
+    size_t depth = 0;
+    BC_JSON *second = NULL;
+    BC_JSON *result = NULL;
+
+    for (;;)
+    {
+        /* split the first halves until they are sorted already */
+        for (second = split_list(list, case_sensitive); second != NULL; second = split_list(list, case_sensitive))
+        {
+            frames[depth].second = second;
+            frames[depth].first = NULL;
+            depth++;
+        }
+        result = list;
+
+        /* merge with the sorted first halves of the levels whose second half this completes */
+        while ((depth > 0) && (frames[depth - 1].first != NULL))
+        {
+            depth--;
+            result = merge_lists(frames[depth].first, result, case_sensitive);
+        }
+        if (depth == 0)
+        {
+            return result;
+        }
+
+        /* continue with the second half */
+        frames[depth - 1].first = result;
+        list = frames[depth - 1].second;
+    }
+}
+
 static void sort_object(BC_JSON * const object, const BC_JSON_bool case_sensitive)
 {
     if (object == NULL)
     {
         return;
     }
+    if (object->type & BC_JSON_IsFrozen)
+    {
+        /* frozen objects can't be changed, sorting one is a bug of the caller */
+        assert(!"a frozen BC_JSON document can't be sorted");
+        return;
+    }
     object->child = sort_list(object->child, case_sensitive);
+    BC_JSON_MarkChanged(object);
 }
 
+/* a pair of arrays/objects whose elements are being compared */
+typedef struct
+{
+    BC_JSON *a; /* the next element of either */
+    BC_JSON *b;
+    BC_JSON_bool object;
+} compare_frame;
+
+/* how many frames compare_json keeps on the call stack before it moves to the heap */
+#define COMPARE_INLINE_FRAMES 32
+
+/* Compare two items, objects are sorted on the way. The arrays/objects that are being
+ * compared are kept on an explicit stack, so deep nesting doesn't use up the call stack.
+ * Running out of memory for the stack counts as a mismatch. */
 static BC_JSON_bool compare_json(BC_JSON *a, BC_JSON *b, const BC_JSON_bool case_sensitive)
 {
-    if ((a == NULL) || (b == NULL) || ((a->type & 0xFF) != (b->type & 0xFF)))
-    {
-        /* mismatched type. */
-        return false;
-    }
-    switch (a->type & 0xFF)
+    compare_frame inline_frames[COMPARE_INLINE_FRAMES];
+    compare_frame *frames = inline_frames;
+    compare_frame *grown = NULL;
+    compare_frame *top = NULL;
+    size_t capacity = COMPARE_INLINE_FRAMES;
+    size_t depth = 0;
+    BC_JSON_bool identical = false;
+
+    for (;;)
     {
-        case JSON_TYPE.NUMBER:
-            /* numeric mismatch. */
-            if (!compare_double(a->value_number, b->value_number))
-            {
-                return false;
-            }
-            else
-            {
-                return true;
-            }
+        if ((a == NULL) || (b == NULL) || ((a->type & 0xFF) != (b->type & 0xFF)))
+        {
+            /* mismatched type. */
+            goto end;
+        }
+        switch (a->type & 0xFF)
+        {
+            case JSON_TYPE.NUMBER:
+                /* numeric mismatch. */
+                if (!compare_double(a->value_number, b->value_number))
+                {
+                    goto end;
+                }
+                break;
 
-        case BC_JSON_String:
-            /* string mismatch. */
-            if (strcmp(a->value_string, b->value_string) != 0)
-            {
-                return false;
-            }
-            else
-            {
-                return true;
-            }
+            case BC_JSON_String:
+                /* string mismatch. */
+                if (strcmp(a->value_string, b->value_string) != 0)
+                {
+                    goto end;
+                }
+                break;
 
-        case BC_JSON_Array:
-            for ((void)(a = a->child), b = b->child; (a != NULL) && (b != NULL); (void)(a = a->next), b = b->next)
-            {
-                BC_JSON_bool identical = compare_json(a, b, case_sensitive);
-                if (!identical)
+            case BC_JSON_Array:
+            case BC_JSON_Object:
+                if ((a->type & 0xFF) == BC_JSON_Object)
                 {
-                    return false;
+                    sort_object(a, case_sensitive);
+                    sort_object(b, case_sensitive);
                 }
-            }
 
-            /* array size mismatch? (one of both children is not NULL) */
-            if ((a != NULL) || (b != NULL))
-            {
-                return false;
-            }
-            else
+                /* compare the elements next */
+                if (depth == capacity)
+                {
+                    if (capacity > ((size_t)-1 / 2 / sizeof(compare_frame)))
+                    {
+                        goto end;
+                    }
+                    grown = (compare_frame*)BC_JSON_malloc(capacity * 2 * sizeof(compare_frame));
+                    if (grown == NULL)
+                    {
+                        goto end;
+                    }
+                    memcpy(grown, frames, capacity * sizeof(compare_frame));
+                    if (frames != inline_frames)
+                    {
+                        BC_JSON_free(frames);
+                    }
+                    frames = grown;
+                    capacity *= 2;
+                }
+                frames[depth].a = a->child;
+                frames[depth].b = b->child;
+                frames[depth].object = ((a->type & 0xFF) == BC_JSON_Object);
+                depth++;
+                break;
+
+            default:
+                /* null, true or false */
+                break;
+        }
+
+        /* find the next pair of elements to compare */
+        for (;;)
+        {
+            if (depth == 0)
             {
-                return true;
+                identical = true;
+                goto end;
             }
+            top = &frames[depth - 1];
 
-        case BC_JSON_Object:
-            sort_object(a, case_sensitive);
-            sort_object(b, case_sensitive);
-            for ((void)(a = a->child), b = b->child; (a != NULL) && (b != NULL); (void)(a = a->next), b = b->next)
+            if ((top->a == NULL) || (top->b == NULL))
             {
-                BC_JSON_bool identical = false;
-                /* compare object keys */
-                if (compare_strings((unsigned char*)a->string, (unsigned char*)b->string, case_sensitive))
-                {
-                    /* missing member */
-                    return false;
-                }
-                identical = compare_json(a, b, case_sensitive);
-                if (!identical)
+                /* array size or object length mismatch? (one of both children is not NULL) */
+                if (top->a != top->b)
                 {
-                    return false;
+                    goto end;
                 }
+                depth--;
+                continue;
             }
 
-            /* object length mismatch (one of both children is not null) */
-            if ((a != NULL) || (b != NULL))
+            a = top->a;
+            b = top->b;
+            top->a = a->next;
+            top->b = b->next;
+            /* compare object keys */
+            if (top->object && compare_strings((unsigned char*)a->string, (unsigned char*)b->string, case_sensitive))
             {
-                return false;
-            }
-            else
-            {
-                return true;
+                /* missing member */
+                goto end;
             }
-
-        default:
             break;
+        }
     }
 
-    /* null, true or false */
-    return true;
+end:
+    if (frames != inline_frames)
+    {
+        BC_JSON_free(frames);
+    }
+
+    return identical;
 }
 
 /* non broken version of BC_JSON_InsertItemInArray */
@@ -723,6 +811,7 @@ static BC_JSON_bool insert_item_in_array(BC_JSON *array, size_t which, BC_JSON *
     {
         newitem->prev->next = newitem;
     }
+    BC_JSON_MarkChanged(array);
 
     return 1;
 }
@@ -788,6 +877,9 @@ static void overwrite_item(BC_JSON * const root, const BC_JSON replacement)
         return;
     }
 
+    /* the text cached for the item and its index are out of date */
+    BC_JSON_MarkChanged(root);
+
     if (root->string != NULL)
     {
         BC_JSON_free(root->string);
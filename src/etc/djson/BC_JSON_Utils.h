@@ -35,7 +35,7 @@ CJSON_PUBLIC(BC_JSON *) BC_JSONUtils_GetPointer(BC_JSON * const object, const ch
 CJSON_PUBLIC(BC_JSON *) BC_JSONUtils_GetPointerCaseSensitive(BC_JSON * const object, const char *pointer);
 
 /* Implement RFC6902 (https://tools.ietf.org/html/rfc6902) JSON Patch spec. */
-/* NOTE: This modifies objects in 'from' and 'to' by sorting the elements by their key */
+/* NOTE: This modifies objects in 'from' and 'to' by sorting the elements by their key, so they can't be frozen (BC_JSON_Freeze) */
 CJSON_PUBLIC(BC_JSON *) BC_JSONUtils_GeneratePatches(BC_JSON * const from, BC_JSON * const to);
 CJSON_PUBLIC(BC_JSON *) BC_JSONUtils_GeneratePatchesCaseSensitive(BC_JSON * const from, BC_JSON * const to);
 /* Utility for generating patch array entries. */
@@ -70,7 +70,7 @@ CJSON_PUBLIC(int) BC_JSONUtils_ApplyPatchesCaseSensitive(BC_JSON * const object,
 CJSON_PUBLIC(BC_JSON *) BC_JSONUtils_MergePatch(BC_JSON *target, const BC_JSON * const patch);
 CJSON_PUBLIC(BC_JSON *) BC_JSONUtils_MergePatchCaseSensitive(BC_JSON *target, const BC_JSON * const patch);
 /* generates a patch to move from -> to */
-/* NOTE: This modifies objects in 'from' and 'to' by sorting the elements by their key */
+/* NOTE: This modifies objects in 'from' and 'to' by sorting the elements by their key, so they can't be frozen (BC_JSON_Freeze) */
 CJSON_PUBLIC(BC_JSON *) BC_JSONUtils_GenerateMergePatch(BC_JSON * const from, BC_JSON * const to);
 CJSON_PUBLIC(BC_JSON *) BC_JSONUtils_GenerateMergePatchCaseSensitive(BC_JSON * const from, BC_JSON * const to);
 
@@ -0,0 +1,204 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and BC_JSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+static void assert_same_value(const BC_JSON *expected, const BC_JSON *actual)
+{
+    char *expected_text = BC_JSON_PrintUnformatted(expected);
+    char *actual_text = BC_JSON_PrintUnformatted(actual);
+
+    TEST_ASSERT_NOT_NULL(expected_text);
+    TEST_ASSERT_NOT_NULL(actual_text);
+    TEST_ASSERT_EQUAL_STRING(expected_text, actual_text);
+
+    free(expected_text);
+    free(actual_text);
+}
+
+/* the value at a JSON pointer without escape sequences other than ~1 */
+static BC_JSON *get_pointer(BC_JSON *item, const char *pointer)
+{
+    char token[32];
+    size_t length = 0;
+
+    while ((item != NULL) && (pointer != NULL) && (*pointer == '/'))
+    {
+        for (pointer++, length = 0; (*pointer != '\0') && (*pointer != '/'); pointer++)
+        {
+            token[length++] = (char)((strncmp(pointer, "~1", 2) == 0) ? (pointer++, '/') : *pointer);
+        }
+        token[length] = '\0';
+        item = BC_JSON_IsArray(item) ? BC_JSON_GetArrayItem(item, atoi(token)) : BC_JSON_GetObjectItemCaseSensitive(item, token);
+    }
+
+    return item;
+}
+
+/* read the array at pointer one element at a time and compare it with the one from a full parse */
+static void assert_stream(const char *json, const char *pointer, const BC_JSON_bool recycle)
+{
+    BC_JSON *document = BC_JSON_Parse(json);
+    BC_JSON *expected = NULL;
+    BC_JSON *element = NULL;
+    BC_JSON_ArrayStream *stream = NULL;
+    int count = 0;
+
+    TEST_ASSERT_NOT_NULL(document);
+    expected = get_pointer(document, pointer);
+    TEST_ASSERT_TRUE(BC_JSON_IsArray(expected));
+
+    stream = BC_JSON_ArrayStream_Open(json, strlen(json), pointer);
+    TEST_ASSERT_NOT_NULL(stream);
+    for (expected = expected->child; expected != NULL; expected = expected->next)
+    {
+        element = BC_JSON_ArrayStream_Next(stream, recycle ? element : NULL);
+        TEST_ASSERT_NOT_NULL(element);
+        TEST_ASSERT_NULL(element->string);
+        assert_same_value(expected, element);
+        if (!recycle)
+        {
+            BC_JSON_Delete(element);
+        }
+        count++;
+    }
+    TEST_ASSERT_NULL(BC_JSON_ArrayStream_Next(stream, recycle ? element : NULL));
+    TEST_ASSERT_NULL(BC_JSON_GetErrorPtr());
+    TEST_ASSERT_NULL(BC_JSON_ArrayStream_Next(stream, NULL));
+    TEST_ASSERT_EQUAL_INT(BC_JSON_GetArraySize(get_pointer(document, pointer)), count);
+
+    BC_JSON_ArrayStream_Close(stream);
+    BC_JSON_Delete(document);
+}
+
+static void array_stream_should_read_the_elements_of_an_array(void)
+{
+    const char json[] = "{\"meta\": {\"records\": [0]}, \"a/b\": [[], {\"records\": \"no\"}],\n"
+                        " \"records\": [ {\"id\": 1, \"tags\": [\"x\", \"y\"]}, 2.5, \"three\", [[4]], null, true, {} ] , \"after\": 1}";
+
+    assert_stream(json, "/records", false);
+    assert_stream(json, "/records", true);
+    assert_stream(json, "/meta/records", false);
+    assert_stream(json, "/a~1b", true);
+    assert_stream(json, "/a~1b/0", false);
+    assert_stream(" [ ] ", "", false);
+    assert_stream("[1,2,3]", "", true);
+}
+
+static void array_stream_should_read_the_test_files(void)
+{
+    const char *files[] = { "inputs/test1", "inputs/test2", "inputs/test3", "inputs/test4", "inputs/test5", "inputs/test7", "inputs/test8", "inputs/test9", "inputs/test10", "inputs/test11" };
+    size_t i = 0;
+
+    for (i = 0; i < (sizeof(files) / sizeof(files[0])); i++)
+    {
+        char *json = read_file(files[i]);
+        BC_JSON *document = NULL;
+
+        TEST_ASSERT_NOT_NULL(json);
+        document = BC_JSON_Parse(json);
+        TEST_ASSERT_NOT_NULL(document);
+        if (BC_JSON_IsArray(document))
+        {
+            assert_stream(json, "", false);
+            assert_stream(json, NULL, true);
+        }
+        else
+        {
+            TEST_ASSERT_NULL(BC_JSON_ArrayStream_Open(json, strlen(json), ""));
+        }
+
+        BC_JSON_Delete(document);
+        free(json);
+    }
+}
+
+static void array_stream_should_not_open_without_an_array(void)
+{
+    const char json[] = "{\"a\": [1, 2], \"b\": 3, \"c\": {\"d\": []}}";
+
+    TEST_ASSERT_NULL(BC_JSON_ArrayStream_Open(json, strlen(json), ""));
+    TEST_ASSERT_NULL(BC_JSON_ArrayStream_Open(json, strlen(json), "/b"));
+    TEST_ASSERT_NULL(BC_JSON_ArrayStream_Open(json, strlen(json), "/a/0"));
+    TEST_ASSERT_NULL(BC_JSON_ArrayStream_Open(json, strlen(json), "/missing"));
+    TEST_ASSERT_NULL(BC_JSON_ArrayStream_Open(json, strlen(json), "/c/d/0"));
+    TEST_ASSERT_NULL(BC_JSON_ArrayStream_Open(json, strlen(json), "a"));
+    TEST_ASSERT_NULL(BC_JSON_ArrayStream_Open(json, strlen(json), "/~2"));
+    TEST_ASSERT_NULL(BC_JSON_ArrayStream_Open(NULL, 10, ""));
+    TEST_ASSERT_NULL(BC_JSON_ArrayStream_Open(json, 0, ""));
+
+    /* the text on the way is checked */
+    TEST_ASSERT_NULL(BC_JSON_ArrayStream_Open("{\"a\": [1,, 2], \"b\": []}", 23, "/b"));
+    TEST_ASSERT_NOT_NULL(BC_JSON_GetErrorPtr());
+
+    TEST_ASSERT_NULL(BC_JSON_ArrayStream_Next(NULL, BC_JSON_CreateArray()));
+    BC_JSON_ArrayStream_Close(NULL);
+}
+
+static void array_stream_should_stop_at_an_invalid_element(void)
+{
+    const char *invalid[] = { "[1 2]", "[1, ]", "[1,", "[1", "[1, {\"a\" 1}]", "[1, [}]" };
+    BC_JSON_ArrayStream *stream = NULL;
+    size_t i = 0;
+
+    for (i = 0; i < (sizeof(invalid) / sizeof(invalid[0])); i++)
+    {
+        BC_JSON *element = NULL;
+
+        stream = BC_JSON_ArrayStream_Open(invalid[i], strlen(invalid[i]), "");
+        TEST_ASSERT_NOT_NULL(stream);
+        element = BC_JSON_ArrayStream_Next(stream, NULL);
+        TEST_ASSERT_NOT_NULL(element);
+        TEST_ASSERT_EQUAL_DOUBLE(1, element->value_number);
+
+        TEST_ASSERT_NULL(BC_JSON_ArrayStream_Next(stream, element));
+        TEST_ASSERT_NOT_NULL(BC_JSON_GetErrorPtr());
+        TEST_ASSERT_NULL(BC_JSON_ArrayStream_Next(stream, NULL));
+
+        BC_JSON_ArrayStream_Close(stream);
+    }
+
+    /* the array is found before its elements are looked at */
+    stream = BC_JSON_ArrayStream_Open("[", 1, "");
+    TEST_ASSERT_NOT_NULL(stream);
+    TEST_ASSERT_NULL(BC_JSON_ArrayStream_Next(stream, NULL));
+    TEST_ASSERT_NOT_NULL(BC_JSON_GetErrorPtr());
+    BC_JSON_ArrayStream_Close(stream);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(array_stream_should_read_the_elements_of_an_array);
+    RUN_TEST(array_stream_should_read_the_test_files);
+    RUN_TEST(array_stream_should_not_open_without_an_array);
+    RUN_TEST(array_stream_should_stop_at_an_invalid_element);
+
+    return UNITY_END();
+}
@@ -0,0 +1,368 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and BC_JSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+/* changing a frozen document fails an assert in debug builds, the tests check that it is refused */
+#ifndef NDEBUG
+#define NDEBUG
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+/* look up a key by walking the members like an unfrozen object */
+static BC_JSON *find_member(const BC_JSON *object, const char *name, const BC_JSON_bool case_sensitive)
+{
+    BC_JSON *member = NULL;
+
+    for (member = object->child; member != NULL; member = member->next)
+    {
+        if (case_sensitive ? (strcmp(name, member->string) == 0) : (case_insensitive_strcmp((const unsigned char*)name, (const unsigned char*)member->string) == 0))
+        {
+            return member;
+        }
+    }
+
+    return NULL;
+}
+
+/* every lookup in a frozen array/object finds what walking its elements finds */
+static void assert_lookups_match(const BC_JSON *item)
+{
+    char upper[64];
+    BC_JSON *child = NULL;
+    int index = 0;
+    size_t i = 0;
+
+    if (!BC_JSON_IsArray(item) && !BC_JSON_IsObject(item))
+    {
+        return;
+    }
+
+    TEST_ASSERT_TRUE(item->type & BC_JSON_IsFrozen);
+    for (child = item->child; child != NULL; child = child->next, index++)
+    {
+        TEST_ASSERT_TRUE(child->type & BC_JSON_IsFrozen);
+        TEST_ASSERT_TRUE(BC_JSON_GetArrayItem(item, index) == child);
+        if (BC_JSON_IsObject(item))
+        {
+            TEST_ASSERT_TRUE(BC_JSON_GetObjectItemCaseSensitive(item, child->string) == find_member(item, child->string, true));
+            TEST_ASSERT_TRUE(BC_JSON_GetObjectItem(item, child->string) == find_member(item, child->string, false));
+
+            for (i = 0; (child->string[i] != '\0') && (i < (sizeof(upper) - 1)); i++)
+            {
+                upper[i] = (char)toupper((unsigned char)child->string[i]);
+            }
+            upper[i] = '\0';
+            TEST_ASSERT_TRUE(BC_JSON_GetObjectItemCaseSensitive(item, upper) == find_member(item, upper, true));
+            TEST_ASSERT_TRUE(BC_JSON_GetObjectItem(item, upper) == find_member(item, upper, false));
+        }
+        assert_lookups_match(child);
+    }
+    TEST_ASSERT_EQUAL_INT(index, BC_JSON_GetArraySize(item));
+    TEST_ASSERT_NULL(BC_JSON_GetArrayItem(item, index));
+    TEST_ASSERT_NULL(BC_JSON_GetObjectItem(item, "not a key of the inputs"));
+}
+
+static void freeze_should_index_arrays_and_objects(void)
+{
+    const char *files[] = { "inputs/test1", "inputs/test2", "inputs/test3", "inputs/test4", "inputs/test5", "inputs/test7", "inputs/test8", "inputs/test9", "inputs/test10", "inputs/test11" };
+    BC_JSON *document = NULL;
+    char *expected = NULL;
+    char *printed = NULL;
+    size_t i = 0;
+
+    for (i = 0; i < (sizeof(files) / sizeof(files[0])); i++)
+    {
+        char *content = read_file(files[i]);
+        TEST_ASSERT_NOT_NULL_MESSAGE(content, files[i]);
+        document = BC_JSON_Parse(content);
+        TEST_ASSERT_NOT_NULL_MESSAGE(document, files[i]);
+        expected = BC_JSON_Print(document);
+
+        TEST_ASSERT_TRUE_MESSAGE(BC_JSON_Freeze(document), files[i]);
+        assert_lookups_match(document);
+        printed = BC_JSON_Print(document);
+        TEST_ASSERT_EQUAL_STRING(expected, printed);
+
+        free(printed);
+        free(expected);
+        BC_JSON_Delete(document);
+        free(content);
+    }
+}
+
+static void freeze_should_leave_the_value_string_of_arrays_and_objects_alone(void)
+{
+    BC_JSON *document = BC_JSON_Parse("{\"list\": [1, 2, 3]}");
+    BC_JSON *list = NULL;
+
+    TEST_ASSERT_NOT_NULL(document);
+    list = BC_JSON_GetObjectItem(document, "list");
+    list->value_string = (char*)BC_JSON_strdup((const unsigned char*)"note", &global_hooks);
+    TEST_ASSERT_NOT_NULL(list->value_string);
+
+    TEST_ASSERT_TRUE(BC_JSON_Freeze(document));
+    TEST_ASSERT_NOT_NULL(list->index);
+    TEST_ASSERT_EQUAL_STRING("note", list->value_string);
+    TEST_ASSERT_EQUAL_INT(3, BC_JSON_GetArraySize(list));
+    TEST_ASSERT_EQUAL_DOUBLE(2, BC_JSON_GetArrayItem(list, 1)->value_number);
+
+    BC_JSON_Unfreeze(document);
+    TEST_ASSERT_NULL(list->index);
+    TEST_ASSERT_EQUAL_STRING("note", list->value_string);
+
+    BC_JSON_Delete(document);
+}
+
+static void freeze_should_find_the_first_of_duplicate_keys(void)
+{
+    BC_JSON *object = BC_JSON_Parse("{\"a\": 1, \"A\": 2, \"a\": 3, \"\": 4, \"b\": {}}");
+
+    TEST_ASSERT_NOT_NULL(object);
+    TEST_ASSERT_TRUE(BC_JSON_Freeze(object));
+
+    TEST_ASSERT_EQUAL_DOUBLE(1, BC_JSON_GetNumberValue(BC_JSON_GetObjectItem(object, "A")));
+    TEST_ASSERT_EQUAL_DOUBLE(1, BC_JSON_GetNumberValue(BC_JSON_GetObjectItemCaseSensitive(object, "a")));
+    TEST_ASSERT_EQUAL_DOUBLE(2, BC_JSON_GetNumberValue(BC_JSON_GetObjectItemCaseSensitive(object, "A")));
+    TEST_ASSERT_EQUAL_DOUBLE(4, BC_JSON_GetNumberValue(BC_JSON_GetObjectItem(object, "")));
+    TEST_ASSERT_NULL(BC_JSON_GetObjectItem(object, "c"));
+    TEST_ASSERT_NULL(BC_JSON_GetObjectItem(BC_JSON_GetObjectItem(object, "b"), "a"));
+    TEST_ASSERT_EQUAL_INT(0, BC_JSON_GetArraySize(BC_JSON_GetObjectItem(object, "b")));
+    TEST_ASSERT_EQUAL_DOUBLE(1, BC_JSON_GetNumberValue(BC_JSON_GetObjectItemBySymbol(object, BC_JSON_Intern("a"))));
+
+    BC_JSON_Delete(object);
+}
+
+static void freeze_should_refuse_changes(void)
+{
+    BC_JSON *document = BC_JSON_Parse("{\"list\": [1, 2, 3], \"name\": \"frozen\"}");
+    BC_JSON *list = NULL;
+    BC_JSON *name = NULL;
+    BC_JSON *item = BC_JSON_CreateNumber(4);
+    BC_JSON_PrintCache *cache = BC_JSON_CreatePrintCache();
+    char *expected = NULL;
+    char *printed = NULL;
+
+    TEST_ASSERT_NOT_NULL(document);
+    TEST_ASSERT_NOT_NULL(item);
+    TEST_ASSERT_NOT_NULL(cache);
+    expected = BC_JSON_PrintUnformatted(document);
+    TEST_ASSERT_TRUE(BC_JSON_Freeze(document));
+    TEST_ASSERT_TRUE(BC_JSON_Freeze(document));
+    list = BC_JSON_GetObjectItem(document, "list");
+    name = BC_JSON_GetObjectItem(document, "name");
+
+    TEST_ASSERT_FALSE(BC_JSON_Freeze(list));
+    TEST_ASSERT_FALSE(BC_JSON_AddItemToArray(list, item));
+    TEST_ASSERT_FALSE(BC_JSON_AddItemToObject(document, "item", item));
+    TEST_ASSERT_FALSE(BC_JSON_AddItemToArray(item, list));
+    TEST_ASSERT_NULL(BC_JSON_AddNullToObject(document, "null"));
+    TEST_ASSERT_FALSE(BC_JSON_InsertItemInArray(list, 0, item));
+    TEST_ASSERT_FALSE(BC_JSON_ReplaceItemInArray(list, 0, item));
+    TEST_ASSERT_FALSE(BC_JSON_ReplaceItemInObject(document, "name", item));
+    TEST_ASSERT_NULL(BC_JSON_DetachItemFromArray(list, 1));
+    TEST_ASSERT_NULL(BC_JSON_DetachItemFromObject(document, "list"));
+    BC_JSON_DeleteItemFromArray(list, 0);
+    BC_JSON_Delete(name);
+    TEST_ASSERT_NULL(BC_JSON_SetValuestring(name, "changed"));
+    TEST_ASSERT_EQUAL_DOUBLE(1, BC_JSON_SetNumberValue(list->child, 5));
+    TEST_ASSERT_NULL(item->string);
+
+    /* printing it with the cache doesn't cache */
+    printed = BC_JSON_PrintCached(cache, document, false);
+    TEST_ASSERT_EQUAL_STRING(expected, printed);
+    TEST_ASSERT_EQUAL_INT(0, cache->count);
+    TEST_ASSERT_FALSE(document->type & BC_JSON_IsPrinted);
+    free(printed);
+    printed = BC_JSON_PrintUnformatted(document);
+    TEST_ASSERT_EQUAL_STRING(expected, printed);
+    free(printed);
+
+    /* unfrozen it can be changed again */
+    BC_JSON_Unfreeze(list);
+    TEST_ASSERT_TRUE(list->type & BC_JSON_IsFrozen);
+    BC_JSON_Unfreeze(document);
+    TEST_ASSERT_FALSE(document->type & BC_JSON_IsFrozen);
+    TEST_ASSERT_NULL(list->index);
+    TEST_ASSERT_TRUE(BC_JSON_AddItemToArray(list, item));
+    TEST_ASSERT_EQUAL_INT(4, BC_JSON_GetArraySize(list));
+    TEST_ASSERT_EQUAL_DOUBLE(4, BC_JSON_GetNumberValue(BC_JSON_GetArrayItem(list, 3)));
+
+    free(expected);
+    BC_JSON_DeletePrintCache(cache);
+    BC_JSON_Delete(document);
+}
+
+static void freeze_should_work_with_duplicates_references_and_reuse(void)
+{
+    BC_JSON *document = BC_JSON_Parse("{\"list\": [1, {\"a\": true}], \"name\": \"frozen\"}");
+    BC_JSON *copy = NULL;
+    BC_JSON *other = BC_JSON_CreateArray();
+    const char *next = "[\"a longer string than the ones before\", [], {}]";
+    char *printed = NULL;
+
+    TEST_ASSERT_NOT_NULL(document);
+    TEST_ASSERT_NOT_NULL(other);
+    TEST_ASSERT_TRUE(BC_JSON_Freeze(document));
+
+    /* copies aren't frozen */
+    copy = BC_JSON_Duplicate(document, true);
+    TEST_ASSERT_NOT_NULL(copy);
+    TEST_ASSERT_FALSE(copy->type & BC_JSON_IsFrozen);
+    TEST_ASSERT_NULL(copy->index);
+    TEST_ASSERT_TRUE(BC_JSON_AddItemToObject(copy, "added", BC_JSON_CreateNull()));
+    BC_JSON_Delete(copy);
+
+    /* references to a frozen document can be put elsewhere, but documents with references to arrays/objects can't be frozen */
+    TEST_ASSERT_TRUE(BC_JSON_AddItemReferenceToArray(other, BC_JSON_GetObjectItem(document, "list")));
+    TEST_ASSERT_NULL(other->child->index);
+    TEST_ASSERT_TRUE(BC_JSON_AddItemReferenceToArray(other, BC_JSON_GetObjectItem(document, "name")));
+    printed = BC_JSON_PrintUnformatted(other);
+    TEST_ASSERT_EQUAL_STRING("[[1,{\"a\":true}],\"frozen\"]", printed);
+    free(printed);
+    TEST_ASSERT_FALSE(BC_JSON_Freeze(other));
+    TEST_ASSERT_FALSE(other->type & BC_JSON_IsFrozen);
+    TEST_ASSERT_NULL(other->index);
+    TEST_ASSERT_TRUE(BC_JSON_AddItemToArray(other, BC_JSON_CreateNull()));
+    BC_JSON_Delete(other);
+
+    /* a frozen document can be reused for the next parse */
+    TEST_ASSERT_NOT_NULL(BC_JSON_ParseReuse(&document, next, strlen(next)));
+    TEST_ASSERT_FALSE(document->type & BC_JSON_IsFrozen);
+    TEST_ASSERT_EQUAL_INT(3, BC_JSON_GetArraySize(document));
+    TEST_ASSERT_TRUE(BC_JSON_AddItemToArray(document, BC_JSON_CreateNull()));
+
+    BC_JSON_Delete(document);
+}
+
+#define READER_THREADS 4
+#define RECORD_COUNT 2000
+
+typedef struct
+{
+    const BC_JSON *document;
+    const char *expected;
+    int found;
+    BC_JSON_bool printed;
+#if defined(CJSON_THREADS_POSIX)
+    pthread_t thread;
+#endif
+} reader;
+
+static void read_document(reader * const context)
+{
+    const BC_JSON *records = BC_JSON_GetObjectItemCaseSensitive(context->document, "records");
+    char name[32];
+    char *printed = NULL;
+    int index = 0;
+
+    for (index = 0; index < BC_JSON_GetArraySize(records); index++)
+    {
+        const BC_JSON *record = BC_JSON_GetArrayItem(records, index);
+        sprintf(name, "record %d", index);
+        if ((BC_JSON_GetNumberValue(BC_JSON_GetObjectItemCaseSensitive(record, "id")) == index)
+            && (strcmp(BC_JSON_GetStringValue(BC_JSON_GetObjectItem(record, "NAME")), name) == 0)
+            && (BC_JSON_GetObjectItem(record, "missing") == NULL))
+        {
+            context->found++;
+        }
+    }
+
+    printed = BC_JSON_PrintUnformatted(context->document);
+    context->printed = (printed != NULL) && (strcmp(printed, context->expected) == 0);
+    free(printed);
+}
+
+#if defined(CJSON_THREADS_POSIX)
+static void *reader_thread(void *context)
+{
+    read_document((reader*)context);
+
+    return NULL;
+}
+#endif
+
+static void freeze_should_allow_concurrent_readers(void)
+{
+    reader readers[READER_THREADS];
+    BC_JSON *document = BC_JSON_CreateObject();
+    BC_JSON *records = BC_JSON_AddArrayToObject(document, "records");
+    char name[32];
+    char *expected = NULL;
+    int index = 0;
+
+    TEST_ASSERT_NOT_NULL(records);
+    for (index = 0; index < RECORD_COUNT; index++)
+    {
+        BC_JSON *record = BC_JSON_CreateObject();
+        sprintf(name, "record %d", index);
+        TEST_ASSERT_NOT_NULL(BC_JSON_AddNumberToObject(record, "id", index));
+        TEST_ASSERT_NOT_NULL(BC_JSON_AddStringToObject(record, "name", name));
+        TEST_ASSERT_TRUE(BC_JSON_AddItemToArray(records, record));
+    }
+    expected = BC_JSON_PrintUnformatted(document);
+    TEST_ASSERT_NOT_NULL(expected);
+    TEST_ASSERT_TRUE(BC_JSON_Freeze(document));
+
+    for (index = 0; index < READER_THREADS; index++)
+    {
+        readers[index].document = document;
+        readers[index].expected = expected;
+        readers[index].found = 0;
+        readers[index].printed = false;
+#if defined(CJSON_THREADS_POSIX)
+        TEST_ASSERT_EQUAL_INT(0, pthread_create(&readers[index].thread, NULL, reader_thread, (void*)&readers[index]));
+#else
+        read_document(&readers[index]);
+#endif
+    }
+    for (index = 0; index < READER_THREADS; index++)
+    {
+#if defined(CJSON_THREADS_POSIX)
+        pthread_join(readers[index].thread, NULL);
+#endif
+        TEST_ASSERT_EQUAL_INT(RECORD_COUNT, readers[index].found);
+        TEST_ASSERT_TRUE(readers[index].printed);
+    }
+
+    free(expected);
+    BC_JSON_Delete(document);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(freeze_should_index_arrays_and_objects);
+    RUN_TEST(freeze_should_leave_the_value_string_of_arrays_and_objects_alone);
+    RUN_TEST(freeze_should_find_the_first_of_duplicate_keys);
+    RUN_TEST(freeze_should_refuse_changes);
+    RUN_TEST(freeze_should_work_with_duplicates_references_and_reuse);
+    RUN_TEST(freeze_should_allow_concurrent_readers);
+
+    return UNITY_END();
+}
@@ -0,0 +1,326 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and BC_JSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+#define INDEXED_FILE_TEST_PATH "indexed_file_test.json"
+#define INDEXED_FILE_INDEX_PATH "indexed_file_test.index"
+
+static void write_test_file(const char *path, const char *content, size_t length)
+{
+    FILE *file = fopen(path, "wb");
+    TEST_ASSERT_NOT_NULL(file);
+    TEST_ASSERT_EQUAL_UINT((unsigned int)length, (unsigned int)fwrite(content, 1, length, file));
+    fclose(file);
+}
+
+/* the value at a JSON pointer */
+static BC_JSON *get_pointer(BC_JSON *item, const char *pointer)
+{
+    char token[64];
+    size_t length = 0;
+
+    while ((item != NULL) && (*pointer == '/'))
+    {
+        for (pointer++, length = 0; (*pointer != '\0') && (*pointer != '/'); pointer++)
+        {
+            if (*pointer == '~')
+            {
+                pointer++;
+                token[length++] = (*pointer == '0') ? '~' : '/';
+            }
+            else
+            {
+                token[length++] = *pointer;
+            }
+        }
+        token[length] = '\0';
+        if (BC_JSON_IsArray(item))
+        {
+            item = ((token[0] >= '0') && (token[0] <= '9') && ((token[0] != '0') || (length == 1))) ? BC_JSON_GetArrayItem(item, atoi(token)) : NULL;
+        }
+        else
+        {
+            item = BC_JSON_IsObject(item) ? BC_JSON_GetObjectItemCaseSensitive(item, token) : NULL;
+        }
+    }
+
+    return item;
+}
+
+static void assert_get(BC_JSON_IndexedFile *file, BC_JSON *document, const char *pointer)
+{
+    BC_JSON *expected = get_pointer(document, pointer);
+    BC_JSON *item = BC_JSON_IndexedFile_Get(file, pointer);
+    char *expected_text = NULL;
+    char *text = NULL;
+
+    if (expected == NULL)
+    {
+        TEST_ASSERT_NULL_MESSAGE(item, pointer);
+        return;
+    }
+    TEST_ASSERT_NOT_NULL_MESSAGE(item, pointer);
+    TEST_ASSERT_NULL(item->string);
+    TEST_ASSERT_NULL(item->next);
+    TEST_ASSERT_NULL(item->prev);
+
+    expected_text = BC_JSON_PrintUnformatted(expected);
+    text = BC_JSON_PrintUnformatted(item);
+    TEST_ASSERT_EQUAL_STRING_MESSAGE(expected_text, text, pointer);
+
+    BC_JSON_free(expected_text);
+    BC_JSON_free(text);
+    BC_JSON_Delete(item);
+}
+
+/* look up every value down to depth, and some that don't exist, with an index of max_depth */
+static void assert_lookups(BC_JSON_IndexedFile *file, BC_JSON *document, BC_JSON *item, char *pointer, const int depth)
+{
+    const size_t length = strlen(pointer);
+    BC_JSON *child = NULL;
+    int index = 0;
+
+    assert_get(file, document, pointer);
+    if (depth == 0)
+    {
+        return;
+    }
+
+    for (child = item->child; child != NULL; child = child->next, index++)
+    {
+        if (BC_JSON_IsArray(item))
+        {
+            sprintf(pointer + length, "/%d", index);
+        }
+        else if ((strlen(child->string) < 40) && (strchr(child->string, '~') == NULL) && (strchr(child->string, '/') == NULL))
+        {
+            sprintf(pointer + length, "/%s", child->string);
+        }
+        else
+        {
+            continue;
+        }
+        assert_lookups(file, document, child, pointer, depth - 1);
+    }
+
+    strcpy(pointer + length, BC_JSON_IsArray(item) ? "/99" : "/missing");
+    assert_get(file, document, pointer);
+    strcpy(pointer + length, "/-1");
+    assert_get(file, document, pointer);
+    pointer[length] = '\0';
+}
+
+static void assert_indexed_like_parsed(const char *path, const int max_depth)
+{
+    char *content = read_file(path);
+    char pointer[512] = "";
+    BC_JSON *document = NULL;
+    BC_JSON_IndexedFile *file = NULL;
+
+    TEST_ASSERT_NOT_NULL_MESSAGE(content, path);
+    document = BC_JSON_Parse(content);
+    TEST_ASSERT_NOT_NULL_MESSAGE(document, path);
+
+    TEST_ASSERT_TRUE_MESSAGE(BC_JSON_WriteIndex(path, INDEXED_FILE_INDEX_PATH, max_depth), path);
+    file = BC_JSON_IndexedFile_Open(path, INDEXED_FILE_INDEX_PATH, true);
+    TEST_ASSERT_NOT_NULL_MESSAGE(file, path);
+
+    assert_lookups(file, document, document, pointer, 4);
+    assert_get(file, document, "");
+    TEST_ASSERT_NULL(BC_JSON_IndexedFile_Get(file, "no/slash"));
+
+    BC_JSON_IndexedFile_Close(file);
+    BC_JSON_Delete(document);
+    free(content);
+}
+
+static void indexed_file_should_get_values(void)
+{
+    const char json[] = "\xEF\xBB\xBF {\"records\": [{\"id\": 0, \"tags\": [\"a\"]}, {\"id\": 1, \"tags\": []}, 2, [3, [4]]],\n"
+                        "  \"a/b~c\": {\"x\": {\"y\": {\"z\": true}}}, \"esc\\u0061ped\": \"yes\", \"\": 5, \"dup\": 1, \"dup\": 2 }  \n";
+    const char *files[] = { "inputs/test1", "inputs/test2", "inputs/test3", "inputs/test4", "inputs/test5", "inputs/test7", "inputs/test8", "inputs/test9", "inputs/test10", "inputs/test11" };
+    BC_JSON_IndexedFile *file = NULL;
+    BC_JSON *document = BC_JSON_Parse(json + 3);
+    BC_JSON *item = NULL;
+    int depth = 0;
+    size_t i = 0;
+
+    TEST_ASSERT_NOT_NULL(document);
+    write_test_file(INDEXED_FILE_TEST_PATH, json, sizeof(json) - 1);
+    for (depth = 0; depth < 5; depth++)
+    {
+        TEST_ASSERT_TRUE(BC_JSON_WriteIndex(INDEXED_FILE_TEST_PATH, INDEXED_FILE_INDEX_PATH, depth));
+        file = BC_JSON_IndexedFile_Open(INDEXED_FILE_TEST_PATH, INDEXED_FILE_INDEX_PATH, true);
+        TEST_ASSERT_NOT_NULL(file);
+
+        assert_get(file, document, "");
+        assert_get(file, document, "/records/1/id");
+        assert_get(file, document, "/records/3/1/0");
+        assert_get(file, document, "/records/4");
+        assert_get(file, document, "/records/01");
+        assert_get(file, document, "/a~1b~0c/x/y");
+        assert_get(file, document, "/a~1b~0c/x/y/z/0");
+        assert_get(file, document, "/escaped");
+        assert_get(file, document, "/");
+        assert_get(file, document, "/dup");
+        assert_get(file, document, "/records/0/tags/0");
+        assert_get(file, document, "/records/x");
+        item = BC_JSON_IndexedFile_Get(file, NULL);
+        TEST_ASSERT_NOT_NULL(item);
+        BC_JSON_Delete(item);
+
+        BC_JSON_IndexedFile_Close(file);
+    }
+    BC_JSON_Delete(document);
+
+    for (i = 0; i < (sizeof(files) / sizeof(files[0])); i++)
+    {
+        assert_indexed_like_parsed(files[i], 1);
+        assert_indexed_like_parsed(files[i], 3);
+    }
+
+    remove(INDEXED_FILE_TEST_PATH);
+    remove(INDEXED_FILE_INDEX_PATH);
+}
+
+static void indexed_file_should_index_deep_nesting(void)
+{
+    char json[(2 * 100) + sizeof("{\"a\": [true]}")];
+    char path[(2 * 100) + sizeof("/a/0")];
+    BC_JSON_IndexedFile *file = NULL;
+    BC_JSON *item = NULL;
+    size_t i = 0;
+
+    /* deeper than the walk keeps on the stack */
+    for (i = 0; i < 100; i++)
+    {
+        json[i] = '[';
+        json[i + 100 + sizeof("{\"a\": [true]}") - 1] = ']';
+        path[2 * i] = '/';
+        path[(2 * i) + 1] = '0';
+    }
+    memcpy(json + 100, "{\"a\": [true]}", sizeof("{\"a\": [true]}") - 1);
+    json[sizeof(json) - 1] = '\0';
+    memcpy(path + 200, "/a/0", sizeof("/a/0"));
+
+    write_test_file(INDEXED_FILE_TEST_PATH, json, strlen(json));
+    TEST_ASSERT_TRUE(BC_JSON_WriteIndex(INDEXED_FILE_TEST_PATH, INDEXED_FILE_INDEX_PATH, 200));
+    file = BC_JSON_IndexedFile_Open(INDEXED_FILE_TEST_PATH, INDEXED_FILE_INDEX_PATH, true);
+    TEST_ASSERT_NOT_NULL(file);
+    item = BC_JSON_IndexedFile_Get(file, path);
+    TEST_ASSERT_NOT_NULL(item);
+    TEST_ASSERT_TRUE(BC_JSON_IsTrue(item));
+    BC_JSON_Delete(item);
+    BC_JSON_IndexedFile_Close(file);
+
+    /* an unbalanced file fails however deep it is */
+    json[strlen(json) - 1] = ' ';
+    write_test_file(INDEXED_FILE_TEST_PATH, json, strlen(json));
+    TEST_ASSERT_FALSE(BC_JSON_WriteIndex(INDEXED_FILE_TEST_PATH, INDEXED_FILE_INDEX_PATH, 200));
+
+    remove(INDEXED_FILE_TEST_PATH);
+    remove(INDEXED_FILE_INDEX_PATH);
+}
+
+static void indexed_file_should_only_open_matching_indexes(void)
+{
+    const char json[] = "[{\"a\": 1}, {\"a\": 2}]";
+    const char changed[] = "[{\"a\": 1}, {\"a\": 3}]";
+    BC_JSON_IndexedFile *file = NULL;
+    BC_JSON *item = NULL;
+
+    write_test_file(INDEXED_FILE_TEST_PATH, json, sizeof(json) - 1);
+    TEST_ASSERT_TRUE(BC_JSON_WriteIndex(INDEXED_FILE_TEST_PATH, INDEXED_FILE_INDEX_PATH, 1));
+
+    /* same length, other content: only the checksum tells */
+    write_test_file(INDEXED_FILE_TEST_PATH, changed, sizeof(changed) - 1);
+    TEST_ASSERT_NULL(BC_JSON_IndexedFile_Open(INDEXED_FILE_TEST_PATH, INDEXED_FILE_INDEX_PATH, true));
+    file = BC_JSON_IndexedFile_Open(INDEXED_FILE_TEST_PATH, INDEXED_FILE_INDEX_PATH, false);
+    TEST_ASSERT_NOT_NULL(file);
+    item = BC_JSON_IndexedFile_Get(file, "/1/a");
+    TEST_ASSERT_NOT_NULL(item);
+    TEST_ASSERT_EQUAL_DOUBLE(3, item->value_number);
+    BC_JSON_Delete(item);
+    BC_JSON_IndexedFile_Close(file);
+
+    write_test_file(INDEXED_FILE_TEST_PATH, json, sizeof(json) - 2);
+    TEST_ASSERT_NULL(BC_JSON_IndexedFile_Open(INDEXED_FILE_TEST_PATH, INDEXED_FILE_INDEX_PATH, false));
+
+    /* not an index */
+    TEST_ASSERT_NULL(BC_JSON_IndexedFile_Open(INDEXED_FILE_TEST_PATH, INDEXED_FILE_TEST_PATH, false));
+    write_test_file(INDEXED_FILE_INDEX_PATH, "BCJSONIX", 8);
+    TEST_ASSERT_NULL(BC_JSON_IndexedFile_Open(INDEXED_FILE_TEST_PATH, INDEXED_FILE_INDEX_PATH, false));
+    TEST_ASSERT_NULL(BC_JSON_IndexedFile_Open(INDEXED_FILE_TEST_PATH, "does_not_exist.index", false));
+    TEST_ASSERT_NULL(BC_JSON_IndexedFile_Open(NULL, INDEXED_FILE_INDEX_PATH, false));
+    TEST_ASSERT_NULL(BC_JSON_IndexedFile_Open(INDEXED_FILE_TEST_PATH, NULL, false));
+    TEST_ASSERT_NULL(BC_JSON_IndexedFile_Get(NULL, ""));
+    BC_JSON_IndexedFile_Close(NULL);
+
+    remove(INDEXED_FILE_TEST_PATH);
+    remove(INDEXED_FILE_INDEX_PATH);
+}
+
+static void write_index_should_fail_on_invalid_files(void)
+{
+    const char *invalid[] = { "[1, 2", "{\"a\" 1}", "[1] x", "[[1], [2,]]", "" };
+    size_t i = 0;
+
+    for (i = 0; i < (sizeof(invalid) / sizeof(invalid[0])); i++)
+    {
+        FILE *index = NULL;
+
+        remove(INDEXED_FILE_INDEX_PATH);
+        write_test_file(INDEXED_FILE_TEST_PATH, invalid[i], strlen(invalid[i]));
+        TEST_ASSERT_FALSE(BC_JSON_WriteIndex(INDEXED_FILE_TEST_PATH, INDEXED_FILE_INDEX_PATH, 1));
+        TEST_ASSERT_FALSE(BC_JSON_WriteIndex(INDEXED_FILE_TEST_PATH, INDEXED_FILE_INDEX_PATH, 3));
+
+        index = fopen(INDEXED_FILE_INDEX_PATH, "rb");
+        TEST_ASSERT_NULL(index);
+    }
+
+    write_test_file(INDEXED_FILE_TEST_PATH, "[]", 2);
+    TEST_ASSERT_FALSE(BC_JSON_WriteIndex(INDEXED_FILE_TEST_PATH, INDEXED_FILE_INDEX_PATH, -1));
+    TEST_ASSERT_FALSE(BC_JSON_WriteIndex(NULL, INDEXED_FILE_INDEX_PATH, 1));
+    TEST_ASSERT_FALSE(BC_JSON_WriteIndex(INDEXED_FILE_TEST_PATH, NULL, 1));
+    TEST_ASSERT_FALSE(BC_JSON_WriteIndex("does_not_exist.json", INDEXED_FILE_INDEX_PATH, 1));
+
+    remove(INDEXED_FILE_TEST_PATH);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(indexed_file_should_get_values);
+    RUN_TEST(indexed_file_should_index_deep_nesting);
+    RUN_TEST(indexed_file_should_only_open_matching_indexes);
+    RUN_TEST(write_index_should_fail_on_invalid_files);
+
+    return UNITY_END();
+}
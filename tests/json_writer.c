@@ -0,0 +1,276 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and BC_JSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+/* write an item through the writer the way the printer walks it */
+static void write_item(BC_JSON_Writer *writer, const BC_JSON *item)
+{
+    const BC_JSON *child = NULL;
+
+    switch (item->type & 0xFF)
+    {
+        case BC_JSON_NULL:
+            TEST_ASSERT_TRUE(BC_JSON_WriterNull(writer));
+            break;
+        case BC_JSON_False:
+        case BC_JSON_True:
+            TEST_ASSERT_TRUE(BC_JSON_WriterBool(writer, BC_JSON_IsTrue(item)));
+            break;
+        case JSON_TYPE.NUMBER:
+            TEST_ASSERT_TRUE(BC_JSON_WriterNumber(writer, item->value_number));
+            break;
+        case BC_JSON_String:
+            TEST_ASSERT_TRUE(BC_JSON_WriterString(writer, item->value_string));
+            break;
+        case BC_JSON_Raw:
+            TEST_ASSERT_TRUE(BC_JSON_WriterRaw(writer, item->value_string));
+            break;
+        case BC_JSON_Array:
+            TEST_ASSERT_TRUE(BC_JSON_WriterBeginArray(writer));
+            for (child = item->child; child != NULL; child = child->next)
+            {
+                write_item(writer, child);
+            }
+            TEST_ASSERT_TRUE(BC_JSON_WriterEndArray(writer));
+            break;
+        case BC_JSON_Object:
+            TEST_ASSERT_TRUE(BC_JSON_WriterBeginObject(writer));
+            for (child = item->child; child != NULL; child = child->next)
+            {
+                TEST_ASSERT_TRUE(BC_JSON_WriterKey(writer, child->string));
+                write_item(writer, child);
+            }
+            TEST_ASSERT_TRUE(BC_JSON_WriterEndObject(writer));
+            break;
+        default:
+            TEST_FAIL_MESSAGE("Unexpected item type.");
+    }
+}
+
+typedef struct
+{
+    char *text;
+    size_t length;
+    size_t capacity;
+} collector;
+
+static size_t collect(void *context, const char *data, size_t length)
+{
+    collector *output = (collector*)context;
+
+    if ((output->length + length + 1) > output->capacity)
+    {
+        output->capacity = (output->length + length + 1) * 2;
+        output->text = (char*)realloc(output->text, output->capacity);
+        TEST_ASSERT_NOT_NULL(output->text);
+    }
+    memcpy(output->text + output->length, data, length);
+    output->length += length;
+    output->text[output->length] = '\0';
+
+    return length;
+}
+
+static void assert_writer_matches_print(const BC_JSON *item, BC_JSON_bool format)
+{
+    char *printed = format ? BC_JSON_Print(item) : BC_JSON_PrintUnformatted(item);
+    BC_JSON_Writer *writer = BC_JSON_CreateWriter(format);
+    collector output = { NULL, 0, 0 };
+
+    TEST_ASSERT_NOT_NULL(printed);
+    TEST_ASSERT_NOT_NULL(writer);
+
+    write_item(writer, item);
+    TEST_ASSERT_TRUE(BC_JSON_WriterFinish(writer));
+    TEST_ASSERT_EQUAL_STRING(printed, BC_JSON_WriterText(writer));
+    TEST_ASSERT_EQUAL_UINT((unsigned int)strlen(printed), (unsigned int)BC_JSON_WriterLength(writer));
+
+    /* again into the same buffer */
+    BC_JSON_ResetWriter(writer);
+    TEST_ASSERT_EQUAL_STRING("", BC_JSON_WriterText(writer));
+    write_item(writer, item);
+    TEST_ASSERT_TRUE(BC_JSON_WriterFinish(writer));
+    TEST_ASSERT_EQUAL_STRING(printed, BC_JSON_WriterText(writer));
+    BC_JSON_DeleteWriter(writer);
+
+    /* and in small chunks to a write function */
+    writer = BC_JSON_CreateStreamWriter(format, collect, &output, 1);
+    TEST_ASSERT_NOT_NULL(writer);
+    write_item(writer, item);
+    TEST_ASSERT_TRUE(BC_JSON_WriterFinish(writer));
+    TEST_ASSERT_NOT_NULL(output.text);
+    TEST_ASSERT_EQUAL_STRING(printed, output.text);
+    BC_JSON_DeleteWriter(writer);
+
+    free(output.text);
+    BC_JSON_free(printed);
+}
+
+static void writer_should_match_print(void)
+{
+    const char *files[] = { "inputs/test1", "inputs/test2", "inputs/test3", "inputs/test4", "inputs/test5", "inputs/test7", "inputs/test8", "inputs/test9", "inputs/test10", "inputs/test11" };
+    size_t i = 0;
+
+    for (i = 0; i < (sizeof(files) / sizeof(files[0])); i++)
+    {
+        char *content = read_file(files[i]);
+        BC_JSON *item = NULL;
+
+        TEST_ASSERT_NOT_NULL_MESSAGE(content, files[i]);
+        item = BC_JSON_Parse(content);
+        TEST_ASSERT_NOT_NULL_MESSAGE(item, files[i]);
+
+        assert_writer_matches_print(item, false);
+        assert_writer_matches_print(item, true);
+
+        BC_JSON_Delete(item);
+        free(content);
+    }
+}
+
+static void writer_should_match_print_for_edge_cases(void)
+{
+    const char *documents[] = { "{}", "[]", "[{}, [], {\"a\": {}}, [[]]]", "\"escaped \\\" \\\\ \\n \\u0001\"", "-0.5", "1e300", "null", "{\"nested\": {\"deeper\": [1, {\"deepest\": true}]}}" };
+    BC_JSON *raw = BC_JSON_CreateObject();
+    size_t i = 0;
+
+    for (i = 0; i < (sizeof(documents) / sizeof(documents[0])); i++)
+    {
+        BC_JSON *item = BC_JSON_Parse(documents[i]);
+        TEST_ASSERT_NOT_NULL_MESSAGE(item, documents[i]);
+
+        assert_writer_matches_print(item, false);
+        assert_writer_matches_print(item, true);
+
+        BC_JSON_Delete(item);
+    }
+
+    TEST_ASSERT_NOT_NULL(BC_JSON_AddRawToObject(raw, "raw", "[1,2]"));
+    TEST_ASSERT_NOT_NULL(BC_JSON_AddNumberToObject(raw, "not a number", 0.0 / 0.0));
+    assert_writer_matches_print(raw, false);
+    assert_writer_matches_print(raw, true);
+    BC_JSON_Delete(raw);
+}
+
+static void writer_should_reject_invalid_nesting(void)
+{
+    BC_JSON_Writer *writer = BC_JSON_CreateWriter(false);
+    TEST_ASSERT_NOT_NULL(writer);
+
+    /* a member without a key */
+    TEST_ASSERT_TRUE(BC_JSON_WriterBeginObject(writer));
+    TEST_ASSERT_FALSE(BC_JSON_WriterNumber(writer, 1));
+    /* everything fails after that */
+    TEST_ASSERT_FALSE(BC_JSON_WriterKey(writer, "a"));
+    TEST_ASSERT_FALSE(BC_JSON_WriterFinish(writer));
+
+    /* a key in an array */
+    BC_JSON_ResetWriter(writer);
+    TEST_ASSERT_TRUE(BC_JSON_WriterBeginArray(writer));
+    TEST_ASSERT_FALSE(BC_JSON_WriterKey(writer, "a"));
+
+    /* two keys in a row, and closing after a key */
+    BC_JSON_ResetWriter(writer);
+    TEST_ASSERT_TRUE(BC_JSON_WriterBeginObject(writer));
+    TEST_ASSERT_TRUE(BC_JSON_WriterKey(writer, "a"));
+    TEST_ASSERT_FALSE(BC_JSON_WriterKey(writer, "b"));
+    BC_JSON_ResetWriter(writer);
+    TEST_ASSERT_TRUE(BC_JSON_WriterBeginObject(writer));
+    TEST_ASSERT_TRUE(BC_JSON_WriterKey(writer, "a"));
+    TEST_ASSERT_FALSE(BC_JSON_WriterEndObject(writer));
+
+    /* closing the wrong kind, or nothing */
+    BC_JSON_ResetWriter(writer);
+    TEST_ASSERT_TRUE(BC_JSON_WriterBeginArray(writer));
+    TEST_ASSERT_FALSE(BC_JSON_WriterEndObject(writer));
+    BC_JSON_ResetWriter(writer);
+    TEST_ASSERT_FALSE(BC_JSON_WriterEndArray(writer));
+
+    /* a second top level value */
+    BC_JSON_ResetWriter(writer);
+    TEST_ASSERT_TRUE(BC_JSON_WriterNull(writer));
+    TEST_ASSERT_FALSE(BC_JSON_WriterNull(writer));
+
+    /* unfinished values */
+    BC_JSON_ResetWriter(writer);
+    TEST_ASSERT_FALSE(BC_JSON_WriterFinish(writer));
+    TEST_ASSERT_TRUE(BC_JSON_WriterBeginArray(writer));
+    TEST_ASSERT_FALSE(BC_JSON_WriterFinish(writer));
+
+    /* a reset writer works again */
+    BC_JSON_ResetWriter(writer);
+    TEST_ASSERT_TRUE(BC_JSON_WriterBeginArray(writer));
+    TEST_ASSERT_TRUE(BC_JSON_WriterString(writer, "ok"));
+    TEST_ASSERT_TRUE(BC_JSON_WriterEndArray(writer));
+    TEST_ASSERT_TRUE(BC_JSON_WriterFinish(writer));
+    TEST_ASSERT_EQUAL_STRING("[\"ok\"]", BC_JSON_WriterText(writer));
+
+    BC_JSON_DeleteWriter(writer);
+}
+
+static void writer_should_handle_null_arguments(void)
+{
+    BC_JSON_Writer *writer = BC_JSON_CreateWriter(false);
+    TEST_ASSERT_NOT_NULL(writer);
+
+    TEST_ASSERT_NULL(BC_JSON_CreateStreamWriter(false, NULL, NULL, 0));
+    TEST_ASSERT_FALSE(BC_JSON_WriterBeginObject(NULL));
+    TEST_ASSERT_FALSE(BC_JSON_WriterEndArray(NULL));
+    TEST_ASSERT_FALSE(BC_JSON_WriterKey(NULL, "a"));
+    TEST_ASSERT_FALSE(BC_JSON_WriterNumber(NULL, 1));
+    TEST_ASSERT_FALSE(BC_JSON_WriterFinish(NULL));
+    TEST_ASSERT_EQUAL_STRING("", BC_JSON_WriterText(NULL));
+    TEST_ASSERT_EQUAL_UINT(0, (unsigned int)BC_JSON_WriterLength(NULL));
+    BC_JSON_ResetWriter(NULL);
+    BC_JSON_DeleteWriter(NULL);
+
+    /* a NULL string is written as an empty one, like the printer does */
+    TEST_ASSERT_TRUE(BC_JSON_WriterString(writer, NULL));
+    TEST_ASSERT_EQUAL_STRING("\"\"", BC_JSON_WriterText(writer));
+
+    BC_JSON_ResetWriter(writer);
+    TEST_ASSERT_TRUE(BC_JSON_WriterBeginObject(writer));
+    TEST_ASSERT_FALSE(BC_JSON_WriterKey(writer, NULL));
+    BC_JSON_ResetWriter(writer);
+    TEST_ASSERT_FALSE(BC_JSON_WriterRaw(writer, NULL));
+
+    BC_JSON_DeleteWriter(writer);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(writer_should_match_print);
+    RUN_TEST(writer_should_match_print_for_edge_cases);
+    RUN_TEST(writer_should_reject_invalid_nesting);
+    RUN_TEST(writer_should_handle_null_arguments);
+
+    return UNITY_END();
+}
@@ -236,6 +236,86 @@ static void cjson_should_not_follow_too_deep_circular_references(void)
     BC_JSON_Delete(o);
 }
 
+/* builds arrays and objects nested in turn, depth levels deep */
+static BC_JSON *create_nested_items(size_t depth)
+{
+    BC_JSON *root = BC_JSON_CreateArray();
+    BC_JSON *current = root;
+    BC_JSON *child = NULL;
+    size_t i;
+
+    for (i = 1; i < depth; i++)
+    {
+        child = (i % 2) ? BC_JSON_CreateObject() : BC_JSON_CreateArray();
+        TEST_ASSERT_NOT_NULL(child);
+        if (BC_JSON_IsArray(current))
+        {
+            TEST_ASSERT_TRUE(BC_JSON_AddItemToArray(current, child));
+        }
+        else
+        {
+            TEST_ASSERT_TRUE(BC_JSON_AddItemToObject(current, "a", child));
+        }
+        current = child;
+    }
+
+    return root;
+}
+
+static void cjson_should_handle_deeply_nested_items(void)
+{
+    /* deep enough to overflow the call stack if these recursed */
+    const size_t depth = 200000;
+    BC_JSON_ParseOptions options = { 0, NULL, 0, 0, 0, 0, 0, 0 };
+    BC_JSON *nested = create_nested_items(depth);
+    BC_JSON *parsed = NULL;
+    char *printed = NULL;
+
+    printed = BC_JSON_PrintUnformatted(nested);
+    TEST_ASSERT_NOT_NULL(printed);
+    TEST_ASSERT_EQUAL_STRING_LEN("[{\"a\":[{\"a\":[", printed, 13);
+    TEST_ASSERT_EQUAL_STRING("]}]}]", printed + strlen(printed) - 5);
+
+    options.max_depth = depth;
+    parsed = BC_JSON_ParseWithOptions(printed, strlen(printed) + sizeof(""), &options, NULL);
+    TEST_ASSERT_NOT_NULL(parsed);
+    TEST_ASSERT_TRUE(BC_JSON_Compare(nested, parsed, true));
+    TEST_ASSERT_TRUE(BC_JSON_Compare(parsed, nested, false));
+    global_hooks.deallocate(printed);
+
+    BC_JSON_Delete(nested);
+    BC_JSON_Delete(parsed);
+}
+
+static void cjson_duplicate_should_copy_up_to_the_circular_limit(void)
+{
+    BC_JSON *nested = create_nested_items(CJSON_CIRCULAR_LIMIT);
+    BC_JSON *copy = NULL;
+    BC_JSON *deepest = nested;
+    BC_JSON *deeper = NULL;
+
+    copy = BC_JSON_Duplicate(nested, true);
+    TEST_ASSERT_NOT_NULL(copy);
+    TEST_ASSERT_TRUE(BC_JSON_Compare(nested, copy, true));
+
+    /* a difference at the deepest level is found */
+    while (deepest->child != NULL)
+    {
+        deepest = deepest->child;
+    }
+    deeper = BC_JSON_AddArrayToObject(deepest, "a");
+    TEST_ASSERT_NOT_NULL(deeper);
+    TEST_ASSERT_FALSE(BC_JSON_Compare(nested, copy, true));
+    TEST_ASSERT_FALSE(BC_JSON_Compare(copy, nested, true));
+
+    /* elements beyond the limit are taken for a circular reference */
+    TEST_ASSERT_TRUE(BC_JSON_AddItemToArray(deeper, BC_JSON_CreateNull()));
+    TEST_ASSERT_NULL(BC_JSON_Duplicate(nested, true));
+
+    BC_JSON_Delete(nested);
+    BC_JSON_Delete(copy);
+}
+
 static void cjson_set_number_value_should_set_numbers(void)
 {
     BC_JSON number[1] = {{NULL, NULL, NULL, JSON_TYPE.NUMBER, NULL, 0, 0, NULL}};
@@ -259,6 +339,7 @@ static void cjson_detach_item_via_pointer_should_detach_items(void)
     BC_JSON parent[1];
 
     memset(list, '\0', sizeof(list));
+    memset(parent, '\0', sizeof(parent));
 
     /* link the list */
     list[0].next = &(list[1]);
@@ -511,7 +592,7 @@ static void *CJSON_CDECL failing_realloc(void *pointer, size_t size)
 
 static void ensure_should_fail_on_failed_realloc(void)
 {
-    printbuffer buffer = {NULL, 10, 0, 0, false, false, {&malloc, &free, &failing_realloc}};
+    printbuffer buffer = {NULL, 10, 0, 0, false, false, {&malloc, &free, &failing_realloc}, NULL, NULL, NULL};
     buffer.buffer = (unsigned char *)malloc(100);
     TEST_ASSERT_NOT_NULL(buffer.buffer);
 
@@ -521,7 +602,7 @@ static void ensure_should_fail_on_failed_realloc(void)
 static void skip_utf8_bom_should_skip_bom(void)
 {
     const unsigned char string[] = "\xEF\xBB\xBF{}";
-    parse_buffer buffer = {0, 0, 0, 0, {0, 0, 0}};
+    parse_buffer buffer = {0, 0, 0, 0, {0, 0, 0}, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
     buffer.content = string;
     buffer.length = sizeof(string);
     buffer.hooks = global_hooks;
@@ -533,7 +614,7 @@ static void skip_utf8_bom_should_skip_bom(void)
 static void skip_utf8_bom_should_not_skip_bom_if_not_at_beginning(void)
 {
     const unsigned char string[] = " \xEF\xBB\xBF{}";
-    parse_buffer buffer = {0, 0, 0, 0, {0, 0, 0}};
+    parse_buffer buffer = {0, 0, 0, 0, {0, 0, 0}, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
     buffer.content = string;
     buffer.length = sizeof(string);
     buffer.hooks = global_hooks;
@@ -807,6 +888,8 @@ int CJSON_CDECL main(void)
     RUN_TEST(typecheck_functions_should_check_type);
     RUN_TEST(cjson_should_not_parse_to_deeply_nested_jsons);
     RUN_TEST(cjson_should_not_follow_too_deep_circular_references);
+    RUN_TEST(cjson_should_handle_deeply_nested_items);
+    RUN_TEST(cjson_duplicate_should_copy_up_to_the_circular_limit);
     RUN_TEST(cjson_set_number_value_should_set_numbers);
     RUN_TEST(cjson_detach_item_via_pointer_should_detach_items);
     RUN_TEST(cjson_detach_item_via_pointer_should_return_null_if_item_prev_is_null);
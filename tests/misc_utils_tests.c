@@ -70,11 +70,84 @@ static void cjson_utils_functions_shouldnt_crash_with_null_pointers(void)
     BC_JSON_Delete(item);
 }
 
+static void cjson_utils_should_compare_deeply_nested_items(void)
+{
+    /* deep enough to overflow the call stack if comparing recursed */
+    const size_t depth = 100000;
+    BC_JSON_ParseOptions options = { 0, NULL, 0, 0, 0, 0, 0, 0 };
+    BC_JSON *patches = NULL;
+    BC_JSON *patch = NULL;
+    BC_JSON *test = NULL;
+    BC_JSON *document = NULL;
+    char *json = NULL;
+    size_t i;
+
+    /* [{"b":0,"a":[{"b":0,"a":...[]...}]}] */
+    json = (char*)malloc(depth * 15 + sizeof("[]"));
+    TEST_ASSERT_NOT_NULL(json);
+    for (i = 0; i < depth; i++)
+    {
+        memcpy(json + i * 13, "[{\"b\":0,\"a\":", 13);
+        memcpy(json + depth * 13 + 2 + i * 2, "}]", 2);
+    }
+    memcpy(json + depth * 13, "[]", 2);
+    json[depth * 15 + 2] = '\0';
+
+    options.max_depth = depth * 2 + 1;
+    document = BC_JSON_ParseWithOptions(json, depth * 15 + sizeof("[]"), &options, NULL);
+    TEST_ASSERT_NOT_NULL(document);
+    test = BC_JSON_ParseWithOptions(json, depth * 15 + sizeof("[]"), &options, NULL);
+    TEST_ASSERT_NOT_NULL(test);
+    free(json);
+
+    /* too deep for BC_JSONUtils_AddPatchToArray, which duplicates the value */
+    patch = BC_JSON_CreateObject();
+    TEST_ASSERT_NOT_NULL(patch);
+    TEST_ASSERT_NOT_NULL(BC_JSON_AddStringToObject(patch, "op", "test"));
+    TEST_ASSERT_NOT_NULL(BC_JSON_AddStringToObject(patch, "path", ""));
+    TEST_ASSERT_TRUE(BC_JSON_AddItemToObject(patch, "value", test));
+    patches = BC_JSON_CreateArray();
+    TEST_ASSERT_NOT_NULL(patches);
+    TEST_ASSERT_TRUE(BC_JSON_AddItemToArray(patches, patch));
+    TEST_ASSERT_EQUAL_INT(0, BC_JSONUtils_ApplyPatchesCaseSensitive(document, patches));
+    TEST_ASSERT_EQUAL_INT(0, BC_JSONUtils_ApplyPatches(document, patches));
+
+    BC_JSON_Delete(patches);
+    BC_JSON_Delete(document);
+}
+
+static void cjson_utils_should_sort_large_objects(void)
+{
+    BC_JSON *object = BC_JSON_CreateObject();
+    BC_JSON *member = NULL;
+    char key[16];
+    int i;
+
+    for (i = 999; i >= 0; i--)
+    {
+        sprintf(key, "%03d", i);
+        TEST_ASSERT_NOT_NULL(BC_JSON_AddNumberToObject(object, key, i));
+    }
+
+    BC_JSONUtils_SortObjectCaseSensitive(object);
+    i = 0;
+    BC_JSON_ArrayForEach(member, object)
+    {
+        TEST_ASSERT_EQUAL_DOUBLE(i, member->value_number);
+        i++;
+    }
+    TEST_ASSERT_EQUAL_INT(1000, i);
+
+    BC_JSON_Delete(object);
+}
+
 int main(void)
 {
     UNITY_BEGIN();
 
     RUN_TEST(cjson_utils_functions_shouldnt_crash_with_null_pointers);
+    RUN_TEST(cjson_utils_should_compare_deeply_nested_items);
+    RUN_TEST(cjson_utils_should_sort_large_objects);
 
     return UNITY_END();
 }
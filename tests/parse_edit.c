@@ -0,0 +1,355 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and BC_JSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+/* compares the printed values, numbers out of range print as null but don't compare as equal */
+static void assert_same_value(const BC_JSON *expected, const BC_JSON *actual)
+{
+    char *expected_text = BC_JSON_PrintUnformatted(expected);
+    char *actual_text = BC_JSON_PrintUnformatted(actual);
+
+    TEST_ASSERT_NOT_NULL(expected_text);
+    TEST_ASSERT_NOT_NULL(actual_text);
+    TEST_ASSERT_EQUAL_STRING(expected_text, actual_text);
+
+    free(expected_text);
+    free(actual_text);
+}
+
+/* check that the span of every value is the text it was parsed from, returns the number of values */
+static size_t assert_spans(const BC_JSON_Spans *spans, const BC_JSON *item, const char *text, size_t start)
+{
+    const value_span *span = find_span(spans, item);
+    const BC_JSON *child = NULL;
+    BC_JSON *reparsed = NULL;
+    size_t cursor = 0;
+    size_t count = 1;
+
+    TEST_ASSERT_NOT_NULL(span);
+    reparsed = BC_JSON_ParseWithLength(text + start, span->length);
+    TEST_ASSERT_NOT_NULL(reparsed);
+    assert_same_value(reparsed, item);
+    BC_JSON_Delete(reparsed);
+
+    cursor = start;
+    for (child = item->child; child != NULL; child = child->next)
+    {
+        span = find_span(spans, child);
+        TEST_ASSERT_NOT_NULL(span);
+        count += assert_spans(spans, child, text, cursor + span->gap);
+        cursor += span->gap + span->length;
+    }
+
+    return count;
+}
+
+static void assert_document(const BC_JSON_Spans *spans, const BC_JSON *doc, const char *text)
+{
+    BC_JSON *expected = BC_JSON_Parse(text);
+
+    TEST_ASSERT_NOT_NULL(expected);
+    assert_same_value(expected, doc);
+    BC_JSON_Delete(expected);
+
+    TEST_ASSERT_EQUAL_UINT((unsigned int)spans->count, (unsigned int)assert_spans(spans, doc, text, find_span(spans, doc)->gap));
+}
+
+/* apply an edit to text, which has room for it */
+static void edit_text(char *text, size_t offset, size_t removed_length, const char *inserted)
+{
+    memmove(text + offset + strlen(inserted), text + offset + removed_length, strlen(text + offset + removed_length) + 1);
+    memcpy(text + offset, inserted, strlen(inserted));
+}
+
+/* edit doc, spans and text the same way */
+static BC_JSON_bool apply_edit(BC_JSON **doc, BC_JSON_Spans *spans, char *text, size_t offset, size_t removed_length, const char *inserted)
+{
+    if (!BC_JSON_ParseEdit(doc, spans, text, strlen(text), offset, removed_length, inserted, strlen(inserted)))
+    {
+        return false;
+    }
+    edit_text(text, offset, removed_length, inserted);
+
+    return true;
+}
+
+static void parse_with_spans_should_record_spans(void)
+{
+    const char json[] = " \n{\"a\" : [1, \"two\",{}, [ true ]], \"b\":{\"c\":null} }  ";
+    BC_JSON_Spans *spans = NULL;
+    BC_JSON *doc = BC_JSON_ParseWithSpans(json, sizeof(json) - 1, &spans);
+
+    TEST_ASSERT_NOT_NULL(doc);
+    TEST_ASSERT_NOT_NULL(spans);
+    TEST_ASSERT_EQUAL_UINT(2, (unsigned int)find_span(spans, doc)->gap);
+    TEST_ASSERT_EQUAL_UINT(sizeof(json) - 5, (unsigned int)find_span(spans, doc)->length);
+    assert_document(spans, doc, json);
+
+    BC_JSON_Delete(doc);
+    BC_JSON_DeleteSpans(spans);
+
+    TEST_ASSERT_NULL(BC_JSON_ParseWithSpans("[1, 2", 5, &spans));
+    TEST_ASSERT_NULL(spans);
+    TEST_ASSERT_NULL(BC_JSON_ParseWithSpans("[]", 2, NULL));
+}
+
+static void parse_edit_should_only_reparse_the_edited_value(void)
+{
+    char text[256] = "{\"name\": \"old\", \"list\": [1, 22, 3], \"nested\": {\"deep\": [true]}}";
+    BC_JSON_Spans *spans = NULL;
+    BC_JSON *doc = BC_JSON_ParseWithSpans(text, strlen(text), &spans);
+    BC_JSON *name = NULL;
+    BC_JSON *list = NULL;
+    BC_JSON *nested = NULL;
+    BC_JSON *first = NULL;
+
+    TEST_ASSERT_NOT_NULL(doc);
+    name = BC_JSON_GetObjectItem(doc, "name");
+    list = BC_JSON_GetObjectItem(doc, "list");
+    nested = BC_JSON_GetObjectItem(doc, "nested");
+    first = BC_JSON_GetArrayItem(list, 0);
+
+    /* inside a number: only that number is replaced */
+    TEST_ASSERT_TRUE(apply_edit(&doc, spans, text, (size_t)(strstr(text, "22") - text) + 1, 1, "56"));
+    TEST_ASSERT_EQUAL_DOUBLE(256, BC_JSON_GetArrayItem(list, 1)->value_number);
+    TEST_ASSERT_TRUE(BC_JSON_GetObjectItem(doc, "list") == list);
+    TEST_ASSERT_TRUE(BC_JSON_GetArrayItem(list, 0) == first);
+    assert_document(spans, doc, text);
+
+    /* inside a string, the member keeps its key */
+    TEST_ASSERT_TRUE(apply_edit(&doc, spans, text, (size_t)(strstr(text, "old") - text), 3, "new \\\"value\\\""));
+    TEST_ASSERT_EQUAL_STRING("new \"value\"", BC_JSON_GetObjectItem(doc, "name")->value_string);
+    TEST_ASSERT_TRUE(BC_JSON_GetObjectItem(doc, "list") == list);
+    TEST_ASSERT_TRUE(BC_JSON_GetObjectItem(doc, "nested") == nested);
+    assert_document(spans, doc, text);
+    (void)name;
+
+    /* a new element: the array is parsed again, the rest stays */
+    TEST_ASSERT_TRUE(apply_edit(&doc, spans, text, (size_t)(strstr(text, "3]") - text) + 1, 0, ", {\"x\": 4}"));
+    TEST_ASSERT_EQUAL_INT(4, BC_JSON_GetArraySize(BC_JSON_GetObjectItem(doc, "list")));
+    TEST_ASSERT_TRUE(BC_JSON_GetObjectItem(doc, "nested") == nested);
+    assert_document(spans, doc, text);
+
+    /* a key: the object around it is parsed again */
+    TEST_ASSERT_TRUE(apply_edit(&doc, spans, text, (size_t)(strstr(text, "deep") - text), 4, "shallow"));
+    TEST_ASSERT_NOT_NULL(BC_JSON_GetObjectItem(BC_JSON_GetObjectItem(doc, "nested"), "shallow"));
+    assert_document(spans, doc, text);
+
+    /* whitespace between values */
+    TEST_ASSERT_TRUE(apply_edit(&doc, spans, text, 1, 0, "\n    "));
+    assert_document(spans, doc, text);
+
+    /* an edit at the end of a value that changes what is around it */
+    TEST_ASSERT_TRUE(apply_edit(&doc, spans, text, (size_t)(strstr(text, "true") - text) + 4, 0, ", false"));
+    TEST_ASSERT_EQUAL_INT(2, BC_JSON_GetArraySize(BC_JSON_GetObjectItem(BC_JSON_GetObjectItem(doc, "nested"), "shallow")));
+    assert_document(spans, doc, text);
+
+    BC_JSON_Delete(doc);
+    BC_JSON_DeleteSpans(spans);
+}
+
+static void parse_edit_should_keep_the_document_if_the_edit_breaks_it(void)
+{
+    char text[64] = "[1, {\"a\": \"b\"}, 3]";
+    char before[64];
+    BC_JSON_Spans *spans = NULL;
+    BC_JSON *doc = BC_JSON_ParseWithSpans(text, strlen(text), &spans);
+    BC_JSON *original = doc;
+
+    TEST_ASSERT_NOT_NULL(doc);
+    strcpy(before, text);
+
+    TEST_ASSERT_FALSE(apply_edit(&doc, spans, text, 12, 1, ""));
+    TEST_ASSERT_FALSE(apply_edit(&doc, spans, text, 2, 1, ""));
+    TEST_ASSERT_FALSE(apply_edit(&doc, spans, text, 0, 1, "{"));
+    TEST_ASSERT_FALSE(apply_edit(&doc, spans, text, 6, 1, "x\""));
+    TEST_ASSERT_EQUAL_STRING(before, text);
+    TEST_ASSERT_TRUE(doc == original);
+    assert_document(spans, doc, text);
+
+    /* out of range */
+    TEST_ASSERT_FALSE(BC_JSON_ParseEdit(&doc, spans, text, strlen(text), strlen(text) + 1, 0, "", 0));
+    TEST_ASSERT_FALSE(BC_JSON_ParseEdit(&doc, spans, text, strlen(text), 2, strlen(text), "", 0));
+    TEST_ASSERT_FALSE(BC_JSON_ParseEdit(&doc, spans, text, strlen(text), 2, 0, NULL, 1));
+    TEST_ASSERT_FALSE(BC_JSON_ParseEdit(NULL, spans, text, strlen(text), 2, 0, "", 0));
+
+    /* replacing the root */
+    TEST_ASSERT_TRUE(apply_edit(&doc, spans, text, 0, strlen(text), " \"just a string\" "));
+    TEST_ASSERT_TRUE(BC_JSON_IsString(doc));
+    assert_document(spans, doc, text);
+    TEST_ASSERT_TRUE(apply_edit(&doc, spans, text, 3, 0, "o"));
+    TEST_ASSERT_EQUAL_STRING("joust a string", doc->value_string);
+    assert_document(spans, doc, text);
+
+    BC_JSON_Delete(doc);
+    BC_JSON_DeleteSpans(spans);
+}
+
+static void parse_edit_should_join_the_root_with_text_after_it(void)
+{
+    char text[32] = "\"x\"1";
+    BC_JSON_Spans *spans = NULL;
+    BC_JSON *doc = BC_JSON_ParseWithSpans(text, strlen(text), &spans);
+
+    /* the text after the root is ignored, until an edit makes it part of the root */
+    TEST_ASSERT_NOT_NULL(doc);
+    TEST_ASSERT_TRUE(apply_edit(&doc, spans, text, 0, 3, "2e3"));
+    TEST_ASSERT_EQUAL_STRING("2e31", text);
+    TEST_ASSERT_TRUE(BC_JSON_IsNumber(doc));
+    TEST_ASSERT_EQUAL_DOUBLE(2e31, doc->value_number);
+    assert_document(spans, doc, text);
+
+    /* also by an edit inside the root */
+    strcpy(text, "35e45e5");
+    BC_JSON_Delete(doc);
+    BC_JSON_DeleteSpans(spans);
+    doc = BC_JSON_ParseWithSpans(text, strlen(text), &spans);
+    TEST_ASSERT_NOT_NULL(doc);
+    TEST_ASSERT_EQUAL_DOUBLE(35e45, doc->value_number);
+    TEST_ASSERT_TRUE(apply_edit(&doc, spans, text, 2, 2, "1"));
+    TEST_ASSERT_EQUAL_STRING("3515e5", text);
+    TEST_ASSERT_EQUAL_DOUBLE(3515e5, doc->value_number);
+    assert_document(spans, doc, text);
+
+    /* whitespace keeps them apart */
+    strcpy(text, "\"x\" 1");
+    BC_JSON_Delete(doc);
+    BC_JSON_DeleteSpans(spans);
+    doc = BC_JSON_ParseWithSpans(text, strlen(text), &spans);
+    TEST_ASSERT_NOT_NULL(doc);
+    TEST_ASSERT_TRUE(apply_edit(&doc, spans, text, 0, 3, "2e3"));
+    TEST_ASSERT_EQUAL_DOUBLE(2e3, doc->value_number);
+    assert_document(spans, doc, text);
+
+    BC_JSON_Delete(doc);
+    BC_JSON_DeleteSpans(spans);
+}
+
+static void parse_edit_should_keep_to_the_nesting_limit(void)
+{
+    char text[(2 * CJSON_NESTING_LIMIT) + 8];
+    BC_JSON_Spans *spans = NULL;
+    BC_JSON *doc = NULL;
+    size_t i = 0;
+
+    /* as deeply nested as the limit allows */
+    for (i = 0; i < CJSON_NESTING_LIMIT; i++)
+    {
+        text[i] = '[';
+        text[CJSON_NESTING_LIMIT + 1 + i] = ']';
+    }
+    text[CJSON_NESTING_LIMIT] = '1';
+    text[(2 * CJSON_NESTING_LIMIT) + 1] = '\0';
+    doc = BC_JSON_ParseWithSpans(text, strlen(text), &spans);
+    TEST_ASSERT_NOT_NULL(doc);
+
+    /* the innermost value is nested in all of them, one level more is too deep like in a full parse */
+    TEST_ASSERT_FALSE(apply_edit(&doc, spans, text, CJSON_NESTING_LIMIT, 1, "[1]"));
+    TEST_ASSERT_TRUE(apply_edit(&doc, spans, text, CJSON_NESTING_LIMIT, 1, "2"));
+    assert_document(spans, doc, text);
+
+    BC_JSON_Delete(doc);
+    BC_JSON_DeleteSpans(spans);
+}
+
+static void parse_edit_should_match_a_full_parse(void)
+{
+    const char *files[] = { "inputs/test1", "inputs/test2", "inputs/test3", "inputs/test4", "inputs/test5", "inputs/test7", "inputs/test8", "inputs/test9", "inputs/test10", "inputs/test11" };
+    const char *insertions[] = { "", "1", "-", ".", "e", "\"", ",", ":", "[", "]", "{", "}", " ", "x", "\\", ", 0", "[]", "\"k\": 1, " };
+    unsigned long random = 12345;
+    size_t i = 0;
+    size_t round = 0;
+
+    for (i = 0; i < (sizeof(files) / sizeof(files[0])); i++)
+    {
+        char *content = read_file(files[i]);
+        char *text = NULL;
+        BC_JSON_Spans *spans = NULL;
+        BC_JSON *doc = NULL;
+
+        TEST_ASSERT_NOT_NULL(content);
+        text = (char*)malloc(strlen(content) + 1000);
+        TEST_ASSERT_NOT_NULL(text);
+        strcpy(text, content);
+        doc = BC_JSON_ParseWithSpans(text, strlen(text), &spans);
+        TEST_ASSERT_NOT_NULL(doc);
+
+        for (round = 0; round < 200; round++)
+        {
+            size_t length = strlen(text);
+            size_t offset = 0;
+            size_t removed_length = 0;
+            const char *inserted = NULL;
+            char *edited = NULL;
+            BC_JSON *expected = NULL;
+
+            random = (random * 1103515245 + 12345) & 0x7FFFFFFF;
+            offset = (random >> 4) % (length + 1);
+            random = (random * 1103515245 + 12345) & 0x7FFFFFFF;
+            removed_length = ((random >> 4) % 3) % (length - offset + 1);
+            random = (random * 1103515245 + 12345) & 0x7FFFFFFF;
+            inserted = insertions[(random >> 4) % (sizeof(insertions) / sizeof(insertions[0]))];
+
+            edited = (char*)malloc(length + strlen(inserted) + 1);
+            TEST_ASSERT_NOT_NULL(edited);
+            strcpy(edited, text);
+            edit_text(edited, offset, removed_length, inserted);
+            expected = BC_JSON_Parse(edited);
+
+            TEST_ASSERT_EQUAL_INT(expected != NULL, BC_JSON_ParseEdit(&doc, spans, text, length, offset, removed_length, inserted, strlen(inserted)));
+            if (expected != NULL)
+            {
+                strcpy(text, edited);
+            }
+            assert_document(spans, doc, text);
+
+            BC_JSON_Delete(expected);
+            free(edited);
+        }
+
+        BC_JSON_Delete(doc);
+        BC_JSON_DeleteSpans(spans);
+        free(text);
+        free(content);
+    }
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(parse_with_spans_should_record_spans);
+    RUN_TEST(parse_edit_should_only_reparse_the_edited_value);
+    RUN_TEST(parse_edit_should_keep_the_document_if_the_edit_breaks_it);
+    RUN_TEST(parse_edit_should_join_the_root_with_text_after_it);
+    RUN_TEST(parse_edit_should_keep_to_the_nesting_limit);
+    RUN_TEST(parse_edit_should_match_a_full_parse);
+
+    return UNITY_END();
+}
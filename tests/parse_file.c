@@ -0,0 +1,265 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and BC_JSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+/* like BC_JSON.c, but in front of the first system header so that mapped files get posix_madvise */
+#if defined(__STRICT_ANSI__) && !defined(_POSIX_C_SOURCE) && (defined(__unix__) || defined(__APPLE__))
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+#define PARSE_FILE_TEST_PATH "parse_file_test.json"
+
+static void write_test_file(const char *content, size_t length)
+{
+    FILE *file = fopen(PARSE_FILE_TEST_PATH, "wb");
+    TEST_ASSERT_NOT_NULL(file);
+    TEST_ASSERT_EQUAL_UINT((unsigned int)length, (unsigned int)fwrite(content, 1, length, file));
+    fclose(file);
+}
+
+static void assert_parses_like_text(const char *path, const BC_JSON_ParseOptions *options)
+{
+    char *content = read_file(path);
+    BC_JSON *expected = NULL;
+    BC_JSON *item = NULL;
+    char *expected_text = NULL;
+    char *text = NULL;
+
+    TEST_ASSERT_NOT_NULL_MESSAGE(content, path);
+    expected = BC_JSON_Parse(content);
+    TEST_ASSERT_NOT_NULL_MESSAGE(expected, path);
+    item = BC_JSON_ParseFile(path, options);
+    TEST_ASSERT_NOT_NULL_MESSAGE(item, path);
+
+    expected_text = BC_JSON_Print(expected);
+    text = BC_JSON_Print(item);
+    TEST_ASSERT_EQUAL_STRING_MESSAGE(expected_text, text, path);
+    TEST_ASSERT_TRUE(BC_JSON_Compare(expected, item, true));
+
+    BC_JSON_free(text);
+    BC_JSON_free(expected_text);
+    BC_JSON_Delete(item);
+    BC_JSON_Delete(expected);
+    free(content);
+}
+
+static void parse_file_should_parse_files(void)
+{
+    const char *files[] = { "inputs/test1", "inputs/test2", "inputs/test3", "inputs/test4", "inputs/test5", "inputs/test7", "inputs/test8", "inputs/test9", "inputs/test10", "inputs/test11" };
+    BC_JSON_ParseOptions options;
+    size_t i = 0;
+
+    memset(&options, '\0', sizeof(options));
+    for (i = 0; i < (sizeof(files) / sizeof(files[0])); i++)
+    {
+        assert_parses_like_text(files[i], NULL);
+
+        options.zero_copy = false;
+        assert_parses_like_text(files[i], &options);
+
+        options.zero_copy = true;
+        assert_parses_like_text(files[i], &options);
+    }
+}
+
+static void parse_file_should_point_into_the_file_with_zero_copy(void)
+{
+    const char json[] = "{\"plain\": \"text\", \"esc\\\"aped\": \"a\\tb\\u00fc\\ud83d\\ude00\", \"list\": [\"x\", 1, \"\"]}";
+    BC_JSON_ParseOptions options;
+    BC_JSON *item = NULL;
+    BC_JSON *copy = NULL;
+    BC_JSON *array = NULL;
+    BC_JSON *member = NULL;
+    char *content = NULL;
+
+    write_test_file(json, sizeof(json) - 1);
+    memset(&options, '\0', sizeof(options));
+    options.zero_copy = true;
+
+    item = BC_JSON_ParseFile(PARSE_FILE_TEST_PATH, &options);
+    TEST_ASSERT_NOT_NULL(item);
+    TEST_ASSERT_TRUE(item->type & BC_JSON_OwnsFile);
+    TEST_ASSERT_TRUE(BC_JSON_IsObject(item));
+
+    member = BC_JSON_GetObjectItem(item, "plain");
+    TEST_ASSERT_EQUAL_STRING("text", BC_JSON_GetStringValue(member));
+    TEST_ASSERT_TRUE(member->type & BC_JSON_IsReference);
+    TEST_ASSERT_TRUE(member->type & BC_JSON_StringIsConst);
+    /* references can't be changed */
+    TEST_ASSERT_NULL(BC_JSON_SetValuestring(member, "other"));
+
+    member = BC_JSON_GetObjectItem(item, "esc\"aped");
+    TEST_ASSERT_NOT_NULL(member);
+    TEST_ASSERT_EQUAL_STRING("a\tb\xC3\xBC\xF0\x9F\x98\x80", BC_JSON_GetStringValue(member));
+
+    member = BC_JSON_GetObjectItem(item, "list");
+    TEST_ASSERT_EQUAL_STRING("x", BC_JSON_GetStringValue(BC_JSON_GetArrayItem(member, 0)));
+    TEST_ASSERT_EQUAL_STRING("", BC_JSON_GetStringValue(BC_JSON_GetArrayItem(member, 2)));
+
+    /* a copy owns its strings and doesn't own the file */
+    copy = BC_JSON_Duplicate(BC_JSON_GetObjectItem(item, "list"), true);
+    TEST_ASSERT_NOT_NULL(copy);
+    TEST_ASSERT_FALSE(copy->type & (BC_JSON_OwnsFile | BC_JSON_IsReference));
+
+    /* neither does a reference to the root, deleting it leaves the file to the root */
+    array = BC_JSON_CreateArray();
+    TEST_ASSERT_NOT_NULL(array);
+    TEST_ASSERT_TRUE(BC_JSON_AddItemReferenceToArray(array, item));
+    TEST_ASSERT_FALSE(array->child->type & BC_JSON_OwnsFile);
+    BC_JSON_Delete(array);
+    TEST_ASSERT_TRUE(item->type & BC_JSON_OwnsFile);
+    TEST_ASSERT_EQUAL_STRING("text", BC_JSON_GetStringValue(BC_JSON_GetObjectItem(item, "plain")));
+    TEST_ASSERT_EQUAL_STRING("x", BC_JSON_GetStringValue(BC_JSON_GetArrayItem(BC_JSON_GetObjectItem(item, "list"), 0)));
+
+    BC_JSON_Delete(item);
+    TEST_ASSERT_EQUAL_STRING("x", BC_JSON_GetStringValue(BC_JSON_GetArrayItem(copy, 0)));
+    BC_JSON_Delete(copy);
+
+    /* the file didn't change */
+    content = read_file(PARSE_FILE_TEST_PATH);
+    TEST_ASSERT_EQUAL_STRING(json, content);
+    free(content);
+
+    /* a root that is a string */
+    write_test_file("\"only\\nstring\"", 14);
+    item = BC_JSON_ParseFile(PARSE_FILE_TEST_PATH, &options);
+    TEST_ASSERT_NOT_NULL(item);
+    TEST_ASSERT_EQUAL_STRING("only\nstring", BC_JSON_GetStringValue(item));
+    BC_JSON_Delete(item);
+
+    remove(PARSE_FILE_TEST_PATH);
+}
+
+static void parse_file_should_reuse_zero_copy_documents(void)
+{
+    BC_JSON_ParseOptions options;
+    BC_JSON *item = NULL;
+
+    write_test_file("[\"a\", {\"b\": \"c\"}]", 17);
+    memset(&options, '\0', sizeof(options));
+    options.zero_copy = true;
+
+    item = BC_JSON_ParseFile(PARSE_FILE_TEST_PATH, &options);
+    TEST_ASSERT_NOT_NULL(item);
+    TEST_ASSERT_NOT_NULL(BC_JSON_ParseReuse(&item, "{\"key\": [\"value\", 1, 2]}", 24));
+    TEST_ASSERT_FALSE(item->type & BC_JSON_OwnsFile);
+    TEST_ASSERT_EQUAL_STRING("value", BC_JSON_GetStringValue(BC_JSON_GetArrayItem(BC_JSON_GetObjectItem(item, "key"), 0)));
+    BC_JSON_Delete(item);
+
+    remove(PARSE_FILE_TEST_PATH);
+}
+
+static void parse_file_should_only_allow_whitespace_after_the_json_if_requested(void)
+{
+    BC_JSON_ParseOptions options;
+    BC_JSON *item = NULL;
+
+    memset(&options, '\0', sizeof(options));
+    write_test_file("[1] x", 5);
+    item = BC_JSON_ParseFile(PARSE_FILE_TEST_PATH, &options);
+    TEST_ASSERT_NOT_NULL(item);
+    BC_JSON_Delete(item);
+
+    options.require_null_terminated = true;
+    TEST_ASSERT_NULL(BC_JSON_ParseFile(PARSE_FILE_TEST_PATH, &options));
+    options.zero_copy = true;
+    TEST_ASSERT_NULL(BC_JSON_ParseFile(PARSE_FILE_TEST_PATH, &options));
+
+    write_test_file("[1] \n\t", 6);
+    item = BC_JSON_ParseFile(PARSE_FILE_TEST_PATH, &options);
+    TEST_ASSERT_NOT_NULL(item);
+    BC_JSON_Delete(item);
+
+    write_test_file("[1]", 3);
+    item = BC_JSON_ParseFile(PARSE_FILE_TEST_PATH, &options);
+    TEST_ASSERT_NOT_NULL(item);
+    BC_JSON_Delete(item);
+
+    remove(PARSE_FILE_TEST_PATH);
+}
+
+static void parse_file_should_fail_gracefully(void)
+{
+    BC_JSON_ParseOptions options;
+
+    memset(&options, '\0', sizeof(options));
+    options.zero_copy = true;
+
+    TEST_ASSERT_NULL(BC_JSON_ParseFile(NULL, NULL));
+    TEST_ASSERT_NULL(BC_JSON_ParseFile("inputs/does-not-exist", NULL));
+    TEST_ASSERT_NULL(BC_JSON_ParseFile("inputs", NULL));
+
+    write_test_file("", 0);
+    TEST_ASSERT_NULL(BC_JSON_ParseFile(PARSE_FILE_TEST_PATH, NULL));
+
+    write_test_file("{\"a\": [1, 2,]}", 14);
+    TEST_ASSERT_NULL(BC_JSON_ParseFile(PARSE_FILE_TEST_PATH, NULL));
+    /* the text is gone, so there is no error position */
+    TEST_ASSERT_NULL(BC_JSON_GetErrorPtr());
+    TEST_ASSERT_NULL(BC_JSON_ParseFile(PARSE_FILE_TEST_PATH, &options));
+    TEST_ASSERT_NULL(BC_JSON_GetErrorPtr());
+
+    /* a string that runs into the end of the file */
+    write_test_file("[\"abc", 5);
+    TEST_ASSERT_NULL(BC_JSON_ParseFile(PARSE_FILE_TEST_PATH, &options));
+
+    remove(PARSE_FILE_TEST_PATH);
+}
+
+static void read_file_text_should_read_whole_files(void)
+{
+    file_text text = { NULL, 0, false };
+    char *content = read_file("inputs/test7");
+
+    TEST_ASSERT_NOT_NULL(content);
+    TEST_ASSERT_TRUE(read_file_text("inputs/test7", &text));
+    TEST_ASSERT_FALSE(text.mapped);
+    TEST_ASSERT_EQUAL_UINT((unsigned int)strlen(content), (unsigned int)text.length);
+    TEST_ASSERT_EQUAL_MEMORY(content, text.content, text.length);
+    release_file_text(&text);
+    TEST_ASSERT_NULL(text.content);
+
+    TEST_ASSERT_FALSE(read_file_text("inputs/does-not-exist", &text));
+
+    free(content);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(parse_file_should_parse_files);
+    RUN_TEST(parse_file_should_point_into_the_file_with_zero_copy);
+    RUN_TEST(parse_file_should_reuse_zero_copy_documents);
+    RUN_TEST(parse_file_should_only_allow_whitespace_after_the_json_if_requested);
+    RUN_TEST(parse_file_should_fail_gracefully);
+    RUN_TEST(read_file_text_should_read_whole_files);
+
+    return UNITY_END();
+}
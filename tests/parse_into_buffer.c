@@ -0,0 +1,171 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and BC_JSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+static size_t allocations = 0;
+
+static void * CJSON_CDECL counting_malloc(size_t size)
+{
+    allocations++;
+    return malloc(size);
+}
+
+static void assert_parses_into_exact_buffer(const char *json)
+{
+    BC_JSON_Measurement measurement;
+    BC_JSON_Hooks hooks = { counting_malloc, free };
+    BC_JSON *expected = NULL;
+    BC_JSON *parsed = NULL;
+    unsigned char *block = NULL;
+    size_t content_size = 0;
+    size_t shift = 0;
+
+    TEST_ASSERT_TRUE_MESSAGE(BC_JSON_ParseMeasure(json, strlen(json) + sizeof(""), &measurement), "Failed to measure.");
+    content_size = measurement.node_count * sizeof(BC_JSON) + measurement.string_bytes;
+    TEST_ASSERT_EQUAL_UINT((unsigned int)(content_size + sizeof(node_alignment) - 1), (unsigned int)measurement.buffer_size);
+
+    expected = BC_JSON_Parse(json);
+    TEST_ASSERT_NOT_NULL(expected);
+
+    block = (unsigned char*)malloc(measurement.buffer_size + sizeof(node_alignment));
+    TEST_ASSERT_NOT_NULL(block);
+
+    /* one byte less than the nodes and strings take has to fail, even in an aligned block */
+    TEST_ASSERT_NULL_MESSAGE(BC_JSON_ParseIntoBuffer(json, strlen(json) + sizeof(""), block, content_size - 1), "Parsed into a block that is too small.");
+
+    /* the measured size is enough wherever the block starts */
+    for (shift = 0; shift < sizeof(node_alignment); shift++)
+    {
+        BC_JSON_InitHooks(&hooks);
+        allocations = 0;
+        parsed = BC_JSON_ParseIntoBuffer(json, strlen(json) + sizeof(""), block + shift, measurement.buffer_size);
+        BC_JSON_InitHooks(NULL);
+
+        TEST_ASSERT_NOT_NULL_MESSAGE(parsed, "Failed to parse into the measured block.");
+        TEST_ASSERT_EQUAL_UINT_MESSAGE(0, (unsigned int)allocations, "Parsing into a block called the allocator.");
+        TEST_ASSERT_TRUE(BC_JSON_Compare(expected, parsed, true));
+    }
+
+    BC_JSON_Delete(expected);
+    free(block);
+}
+
+static void parse_into_buffer_should_parse_scalars(void)
+{
+    assert_parses_into_exact_buffer("null");
+    assert_parses_into_exact_buffer("true");
+    assert_parses_into_exact_buffer("-12.5e3");
+    assert_parses_into_exact_buffer("\"hello\"");
+    assert_parses_into_exact_buffer("\"\"");
+}
+
+static void parse_into_buffer_should_parse_nested_documents(void)
+{
+    assert_parses_into_exact_buffer("{\"a\": [1, 2, {\"b\": null}], \"c\": {}, \"d\": []}");
+    assert_parses_into_exact_buffer("[[[[[[\"deep\"]]]]], {\"\": \"\"}]");
+}
+
+static void parse_into_buffer_should_measure_escapes_exactly(void)
+{
+    assert_parses_into_exact_buffer("[\"tab\\there\", \"\\u00e4\\u732b\\ud83d\\ude00\", \"\\\\\\/\\\"\"]");
+    assert_parses_into_exact_buffer("{\"\\u0041\\n\": \"\\u007f\"}");
+}
+
+static void parse_into_buffer_should_measure_long_numbers(void)
+{
+    assert_parses_into_exact_buffer("[0.0000000000000000000000000000000000000000000000000000000000000000000000000001, 1]");
+}
+
+static void parse_measure_should_fail_on_invalid_json(void)
+{
+    BC_JSON_Measurement measurement;
+
+    TEST_ASSERT_FALSE(BC_JSON_ParseMeasure("[1, 2", 6, &measurement));
+    TEST_ASSERT_FALSE(BC_JSON_ParseMeasure("{\"a\" 1}", 8, &measurement));
+    TEST_ASSERT_FALSE(BC_JSON_ParseMeasure("[\"\\x\"]", 7, &measurement));
+    TEST_ASSERT_FALSE(BC_JSON_ParseMeasure("[1,]", 5, &measurement));
+    TEST_ASSERT_FALSE(BC_JSON_ParseMeasure(NULL, 5, &measurement));
+    TEST_ASSERT_FALSE(BC_JSON_ParseMeasure("[]", 3, NULL));
+}
+
+static void parse_measure_should_respect_the_nesting_limit(void)
+{
+    BC_JSON_Measurement measurement;
+    char deep[CJSON_NESTING_LIMIT + 2];
+
+    memset(deep, '[', sizeof(deep) - 1);
+    deep[sizeof(deep) - 1] = '\0';
+
+    TEST_ASSERT_FALSE(BC_JSON_ParseMeasure(deep, sizeof(deep), &measurement));
+}
+
+static void measure_value_should_take_the_nesting_limit_of_the_parse(void)
+{
+    BC_JSON_Measurement measurement;
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+    const size_t depth = 3 * CJSON_NESTING_LIMIT;
+    char *deep = (char*)malloc(2 * depth + 1);
+
+    TEST_ASSERT_NOT_NULL(deep);
+    memset(deep, '[', depth);
+    memset(deep + depth, ']', depth);
+    deep[2 * depth] = '\0';
+
+    buffer.content = (const unsigned char*)deep;
+    buffer.length = 2 * depth + 1;
+    buffer.hooks = global_hooks;
+
+    /* deeper than the default, measured like BC_JSON_ParseWithOptions parses it */
+    buffer.depth_limit = depth;
+    memset(&measurement, '\0', sizeof(measurement));
+    TEST_ASSERT_TRUE(measure_value(&buffer, &measurement));
+    TEST_ASSERT_EQUAL_UINT((unsigned int)depth, (unsigned int)measurement.node_count);
+
+    buffer.offset = 0;
+    buffer.depth = 0;
+    buffer.depth_limit = depth - 1;
+    TEST_ASSERT_FALSE(measure_value(&buffer, &measurement));
+
+    free(deep);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(parse_into_buffer_should_parse_scalars);
+    RUN_TEST(parse_into_buffer_should_parse_nested_documents);
+    RUN_TEST(parse_into_buffer_should_measure_escapes_exactly);
+    RUN_TEST(parse_into_buffer_should_measure_long_numbers);
+    RUN_TEST(parse_measure_should_fail_on_invalid_json);
+    RUN_TEST(parse_measure_should_respect_the_nesting_limit);
+    RUN_TEST(measure_value_should_take_the_nesting_limit_of_the_parse);
+
+    return UNITY_END();
+}
@@ -0,0 +1,151 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and BC_JSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+static size_t allocations = 0;
+
+static void * CJSON_CDECL counting_malloc(size_t size)
+{
+    allocations++;
+    return malloc(size);
+}
+
+static void assert_projection(const char *expected, const char *json, const char * const *paths, size_t path_count)
+{
+    BC_JSON *projected = BC_JSON_ParseProjected(json, strlen(json) + sizeof(""), paths, path_count);
+    char *printed = NULL;
+
+    TEST_ASSERT_NOT_NULL_MESSAGE(projected, json);
+    printed = BC_JSON_PrintUnformatted(projected);
+    TEST_ASSERT_NOT_NULL(printed);
+    TEST_ASSERT_EQUAL_STRING(expected, printed);
+
+    BC_JSON_free(printed);
+    BC_JSON_Delete(projected);
+}
+
+static const char document[] = "{\"user\": {\"id\": 42, \"name\": \"Ada\", \"tags\": [\"a\", \"b\"]}, \"event\": {\"type\": \"click\", \"at\": 1.5e3}, \"payload\": {\"items\": [{\"sku\": \"x1\", \"qty\": 1}, {\"qty\": 2}, {\"sku\": \"x3\", \"price\": {\"amount\": 9}}]}}";
+
+static void parse_projected_should_select_paths(void)
+{
+    const char *paths[] = { "/user/id", "/event/type", "/payload/items/*/sku" };
+
+    assert_projection("{\"user\":{\"id\":42},\"event\":{\"type\":\"click\"},\"payload\":{\"items\":[{\"sku\":\"x1\"},{},{\"sku\":\"x3\"}]}}", document, paths, 3);
+}
+
+static void parse_projected_should_select_whole_subtrees(void)
+{
+    const char *user[] = { "/user" };
+    const char *indices[] = { "/payload/items/2/price", "/user/tags/1" };
+    const char *everything[] = { "" };
+    const char *nothing[] = { "/missing/path" };
+    BC_JSON *parsed = BC_JSON_Parse(document);
+    BC_JSON *projected = NULL;
+
+    assert_projection("{\"user\":{\"id\":42,\"name\":\"Ada\",\"tags\":[\"a\",\"b\"]}}", document, user, 1);
+    /* left out elements shift the indices */
+    assert_projection("{\"user\":{\"tags\":[\"b\"]},\"payload\":{\"items\":[{\"price\":{\"amount\":9}}]}}", document, indices, 2);
+    assert_projection("{}", document, nothing, 1);
+    assert_projection("{}", document, NULL, 0);
+
+    projected = BC_JSON_ParseProjected(document, sizeof(document), everything, 1);
+    TEST_ASSERT_NOT_NULL(parsed);
+    TEST_ASSERT_NOT_NULL(projected);
+    TEST_ASSERT_TRUE(BC_JSON_Compare(parsed, projected, true));
+    BC_JSON_Delete(projected);
+    BC_JSON_Delete(parsed);
+
+    /* the root is always there */
+    assert_projection("17", "17", nothing, 1);
+    assert_projection("[]", "[1, 2]", nothing, 1);
+}
+
+static void parse_projected_should_match_keys(void)
+{
+    const char json[] = "{\"a/b\": 1, \"c~d\": 2, \"e\\u0066\": 3, \"\": 4, \"01\": 5, \"f\": [10, 11]}";
+    const char *escaped[] = { "/a~1b", "/c~0d", "/ef" };
+    const char *empty[] = { "/" };
+    const char *not_indices[] = { "/f/01", "/f/1x", "/01" };
+
+    assert_projection("{\"a/b\":1,\"c~d\":2,\"ef\":3}", json, escaped, 3);
+    assert_projection("{\"\":4}", json, empty, 1);
+    assert_projection("{\"01\":5,\"f\":[]}", json, not_indices, 3);
+}
+
+static void parse_projected_should_check_skipped_values(void)
+{
+    const char *paths[] = { "/a" };
+    const char *invalid[] = { "{\"a\": 1, \"b\": [1, 2,]}", "{\"b\": {\"c\" 1}, \"a\": 1}", "{\"b\": \"\\x\", \"a\": 1}", "{\"b\": -, \"a\": 1}", "{\"b\": [[[[", "{\"a\": [1 2]}", "{\"a\": 1,}", "[\"a\"" };
+    const char *bad_paths[] = { "a/b" };
+    const char *bad_escape[] = { "/a~2" };
+    size_t i = 0;
+
+    for (i = 0; i < (sizeof(invalid) / sizeof(invalid[0])); i++)
+    {
+        TEST_ASSERT_NULL_MESSAGE(BC_JSON_Parse(invalid[i]), invalid[i]);
+        TEST_ASSERT_NULL_MESSAGE(BC_JSON_ParseProjected(invalid[i], strlen(invalid[i]) + sizeof(""), paths, 1), invalid[i]);
+        TEST_ASSERT_NOT_NULL(BC_JSON_GetErrorPtr());
+    }
+
+    TEST_ASSERT_NULL(BC_JSON_ParseProjected(document, sizeof(document), bad_paths, 1));
+    TEST_ASSERT_NULL(BC_JSON_ParseProjected(document, sizeof(document), bad_escape, 1));
+    TEST_ASSERT_NULL(BC_JSON_ParseProjected(document, sizeof(document), NULL, 1));
+    TEST_ASSERT_NULL(BC_JSON_ParseProjected(NULL, 1, paths, 1));
+}
+
+static void parse_projected_should_allocate_only_for_the_selection(void)
+{
+    const char *paths[] = { "/user/id" };
+    BC_JSON_Hooks hooks = { counting_malloc, free };
+    BC_JSON *projected = NULL;
+
+    BC_JSON_InitHooks(&hooks);
+    allocations = 0;
+    projected = BC_JSON_ParseProjected(document, sizeof(document), paths, 1);
+    BC_JSON_InitHooks(NULL);
+
+    TEST_ASSERT_NOT_NULL(projected);
+    /* 4 for the paths, 3 nodes and 2 keys */
+    TEST_ASSERT_EQUAL_UINT(9, (unsigned int)allocations);
+
+    BC_JSON_Delete(projected);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(parse_projected_should_select_paths);
+    RUN_TEST(parse_projected_should_select_whole_subtrees);
+    RUN_TEST(parse_projected_should_match_keys);
+    RUN_TEST(parse_projected_should_check_skipped_values);
+    RUN_TEST(parse_projected_should_allocate_only_for_the_selection);
+
+    return UNITY_END();
+}
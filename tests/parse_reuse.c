@@ -0,0 +1,146 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and BC_JSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+static size_t allocations = 0;
+
+static void * CJSON_CDECL counting_malloc(size_t size)
+{
+    allocations++;
+    return malloc(size);
+}
+
+static void assert_reuse_matches_parse(BC_JSON **doc, const char *json)
+{
+    BC_JSON *expected = BC_JSON_Parse(json);
+    BC_JSON *parsed = NULL;
+
+    TEST_ASSERT_NOT_NULL(expected);
+
+    parsed = BC_JSON_ParseReuse(doc, json, strlen(json) + sizeof(""));
+    TEST_ASSERT_NOT_NULL(parsed);
+    TEST_ASSERT_TRUE(parsed == *doc);
+    TEST_ASSERT_TRUE_MESSAGE(BC_JSON_Compare(expected, parsed, true), "Reused document differs from a fresh parse.");
+
+    BC_JSON_Delete(expected);
+}
+
+static void parse_reuse_should_parse_without_a_previous_document(void)
+{
+    BC_JSON *doc = NULL;
+
+    assert_reuse_matches_parse(&doc, "{\"a\": [1, 2, {\"b\": \"c\"}], \"d\": null}");
+
+    BC_JSON_Delete(doc);
+}
+
+static void parse_reuse_should_not_allocate_for_the_same_shape(void)
+{
+    const char first[] = "{\"id\": 1, \"name\": \"first\", \"tags\": [\"x\", \"y\"], \"nested\": {\"ok\": true}}";
+    const char second[] = "{\"id\": 2, \"name\": \"other\", \"tags\": [\"z\", \"w\"], \"nested\": {\"ok\": false}}";
+    BC_JSON_Hooks hooks = { counting_malloc, free };
+    BC_JSON *doc = NULL;
+
+    assert_reuse_matches_parse(&doc, first);
+
+    BC_JSON_InitHooks(&hooks);
+    allocations = 0;
+    TEST_ASSERT_NOT_NULL(BC_JSON_ParseReuse(&doc, second, sizeof(second)));
+    TEST_ASSERT_EQUAL_UINT_MESSAGE(0, (unsigned int)allocations, "Reusing a document of the same shape allocated memory.");
+    BC_JSON_InitHooks(NULL);
+
+    assert_reuse_matches_parse(&doc, second);
+
+    BC_JSON_Delete(doc);
+}
+
+static void parse_reuse_should_grow_and_shrink(void)
+{
+    BC_JSON *doc = NULL;
+
+    assert_reuse_matches_parse(&doc, "[\"a\"]");
+    assert_reuse_matches_parse(&doc, "[\"a much longer string than before\", {\"key\": [1, 2, 3, 4, 5]}, \"more\"]");
+    assert_reuse_matches_parse(&doc, "{\"k\": 0}");
+    assert_reuse_matches_parse(&doc, "\"\"");
+    assert_reuse_matches_parse(&doc, "[1.23456789012345678901234567890123456789012345678901234567890123456789]");
+
+    BC_JSON_Delete(doc);
+}
+
+static void parse_reuse_should_not_free_memory_the_document_does_not_own(void)
+{
+    static const char constant_key[] = "constant";
+    static char referenced_string[] = "referenced";
+    BC_JSON *referenced = BC_JSON_CreateArray();
+    BC_JSON *doc = BC_JSON_CreateObject();
+
+    TEST_ASSERT_NOT_NULL(referenced);
+    TEST_ASSERT_NOT_NULL(doc);
+    TEST_ASSERT_TRUE(BC_JSON_AddItemToArray(referenced, BC_JSON_CreateString("owned elsewhere")));
+    TEST_ASSERT_TRUE(BC_JSON_AddItemToObjectCS(doc, constant_key, BC_JSON_CreateNumber(1)));
+    TEST_ASSERT_TRUE(BC_JSON_AddItemToObject(doc, "string", BC_JSON_CreateStringReference(referenced_string)));
+    TEST_ASSERT_TRUE(BC_JSON_AddItemReferenceToObject(doc, "array", referenced));
+
+    assert_reuse_matches_parse(&doc, "{\"constant\": 2, \"string\": \"copied\", \"array\": [3]}");
+
+    TEST_ASSERT_EQUAL_STRING("referenced", referenced_string);
+    TEST_ASSERT_EQUAL_STRING("owned elsewhere", BC_JSON_GetArrayItem(referenced, 0)->value_string);
+
+    BC_JSON_Delete(doc);
+    BC_JSON_Delete(referenced);
+}
+
+static void parse_reuse_should_release_the_old_document_on_failure(void)
+{
+    const char invalid[] = "{\"a\": [1, 2,]}";
+    BC_JSON *doc = NULL;
+
+    assert_reuse_matches_parse(&doc, "{\"a\": [1, 2, 3]}");
+
+    TEST_ASSERT_NULL(BC_JSON_ParseReuse(&doc, invalid, sizeof(invalid)));
+    TEST_ASSERT_NULL(doc);
+    TEST_ASSERT_NOT_NULL(BC_JSON_GetErrorPtr());
+
+    assert_reuse_matches_parse(&doc, "[true]");
+
+    BC_JSON_Delete(doc);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(parse_reuse_should_parse_without_a_previous_document);
+    RUN_TEST(parse_reuse_should_not_allocate_for_the_same_shape);
+    RUN_TEST(parse_reuse_should_grow_and_shrink);
+    RUN_TEST(parse_reuse_should_not_free_memory_the_document_does_not_own);
+    RUN_TEST(parse_reuse_should_release_the_old_document_on_failure);
+
+    return UNITY_END();
+}
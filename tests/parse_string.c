@@ -45,7 +45,7 @@ static void assert_is_string(BC_JSON *string_item)
 
 static void assert_parse_string(const char *string, const char *expected)
 {
-    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 } };
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
     buffer.content = (const unsigned char*)string;
     buffer.length = strlen(string) + sizeof("");
     buffer.hooks = global_hooks;
@@ -59,7 +59,7 @@ static void assert_parse_string(const char *string, const char *expected)
 
 static void assert_not_parse_string(const char * const string)
 {
-    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 } };
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
     buffer.content = (const unsigned char*)string;
     buffer.length = strlen(string) + sizeof("");
     buffer.hooks = global_hooks;
@@ -112,6 +112,19 @@ static void parse_string_should_not_overflow_with_closing_backslash(void)
     reset(item);
 }
 
+static void parse_string_should_point_at_invalid_utf16_literals(void)
+{
+    const char *invalid[] = { "\"\\u00e95u4e2d\\ud83d\\ue00\"", "\"ab\\udc00\"", "\"ab\\ud800x\"", "\"ab\\ud800\\u0041\"", "\"ab\\u12\"", "\"\\u0041\\x\"" };
+    const size_t positions[] = { 13, 3, 3, 3, 3, 7 };
+    size_t i = 0;
+
+    for (i = 0; i < (sizeof(invalid) / sizeof(invalid[0])); i++)
+    {
+        TEST_ASSERT_NULL_MESSAGE(BC_JSON_Parse(invalid[i]), invalid[i]);
+        TEST_ASSERT_EQUAL_UINT_MESSAGE(positions[i], BC_JSON_GetErrorPtr() - invalid[i], invalid[i]);
+    }
+}
+
 static void parse_string_should_parse_bug_94(void)
 {
     const char string[] = "\"~!@\\\\#$%^&*()\\\\\\\\-\\\\+{}[]:\\\\;\\\\\\\"\\\\<\\\\>?/.,DC=ad,DC=com\"";
@@ -131,5 +144,6 @@ int CJSON_CDECL main(void)
     RUN_TEST(parse_string_should_not_parse_invalid_backslash);
     RUN_TEST(parse_string_should_parse_bug_94);
     RUN_TEST(parse_string_should_not_overflow_with_closing_backslash);
+    RUN_TEST(parse_string_should_point_at_invalid_utf16_literals);
     return UNITY_END();
 }
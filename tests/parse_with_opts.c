@@ -97,6 +97,290 @@ static void parse_with_opts_should_parse_utf8_bom(void)
     BC_JSON_Delete(without_bom);
 }
 
+static void parse_with_options_should_limit_nesting(void)
+{
+    BC_JSON_ParseOptions options;
+    BC_JSON *item = NULL;
+
+    memset(&options, '\0', sizeof(options));
+    options.max_depth = 3;
+
+    item = BC_JSON_ParseWithOptions("[{\"a\": [1]}, []]", 18, &options, NULL);
+    TEST_ASSERT_NOT_NULL(item);
+    BC_JSON_Delete(item);
+
+    TEST_ASSERT_NULL(BC_JSON_ParseWithOptions("[{\"a\": [[1]]}, []]", 20, &options, NULL));
+}
+
+static void parse_with_options_should_parse_beyond_the_default_nesting_limit(void)
+{
+    const size_t depth = CJSON_NESTING_LIMIT * 10;
+    const size_t length = 6 * depth + 1;
+    BC_JSON_ParseOptions options;
+    BC_JSON *item = NULL;
+    BC_JSON *current = NULL;
+    char *json = (char*)malloc(length + 1);
+    char *end = NULL;
+    size_t i = 0;
+
+    TEST_ASSERT_NOT_NULL(json);
+
+    /* alternate arrays and objects: [{"k":[{"k":...1...}]}] */
+    end = json;
+    for (i = 0; i < depth; i++)
+    {
+        strcpy(end, (i % 2) ? "{\"k\":" : "[");
+        end += strlen(end);
+    }
+    *end++ = '1';
+    for (i = depth; i > 0; i--)
+    {
+        *end++ = ((i - 1) % 2) ? '}' : ']';
+    }
+    *end = '\0';
+
+    TEST_ASSERT_NULL(BC_JSON_Parse(json));
+
+    memset(&options, '\0', sizeof(options));
+    options.max_depth = depth;
+    item = BC_JSON_ParseWithOptions(json, strlen(json) + 1, &options, NULL);
+    TEST_ASSERT_NOT_NULL(item);
+
+    current = item;
+    for (i = 0; i < depth; i++)
+    {
+        TEST_ASSERT_TRUE(BC_JSON_IsArray(current) || BC_JSON_IsObject(current));
+        TEST_ASSERT_TRUE(current->child == current->child->prev);
+        TEST_ASSERT_NULL(current->next);
+        current = current->child;
+    }
+    TEST_ASSERT_TRUE(BC_JSON_IsNumber(current));
+    BC_JSON_Delete(item);
+
+    /* a failure at the deepest level has to release everything */
+    json[strlen(json) - 1] = ',';
+    TEST_ASSERT_NULL(BC_JSON_ParseWithOptions(json, strlen(json) + 1, &options, NULL));
+
+    free(json);
+}
+
+static void parse_with_options_should_keep_deep_values_raw(void)
+{
+    const char json[] = "{\"id\": 1, \"payload\": {\"n\": 1.50, \"s\": \"\\u00fc\",  \"a\": [ 1e2 ]}, \"list\": [[], {\"x\" : 0}]}";
+    BC_JSON_ParseOptions options;
+    BC_JSON *item = NULL;
+    BC_JSON *payload = NULL;
+    BC_JSON *list = NULL;
+    char *printed = NULL;
+
+    memset(&options, '\0', sizeof(options));
+    options.raw_depth = 1;
+
+    item = BC_JSON_ParseWithOptions(json, sizeof(json), &options, NULL);
+    TEST_ASSERT_NOT_NULL(item);
+
+    /* the root is parsed, the arrays/objects in it are kept as they are in the text */
+    TEST_ASSERT_TRUE(BC_JSON_IsNumber(BC_JSON_GetObjectItem(item, "id")));
+    payload = BC_JSON_GetObjectItem(item, "payload");
+    TEST_ASSERT_TRUE(BC_JSON_IsRaw(payload));
+    TEST_ASSERT_EQUAL_STRING("{\"n\": 1.50, \"s\": \"\\u00fc\",  \"a\": [ 1e2 ]}", payload->value_string);
+    printed = BC_JSON_PrintUnformatted(item);
+    TEST_ASSERT_EQUAL_STRING("{\"id\":1,\"payload\":{\"n\": 1.50, \"s\": \"\\u00fc\",  \"a\": [ 1e2 ]},\"list\":[[], {\"x\" : 0}]}", printed);
+    BC_JSON_free(printed);
+    BC_JSON_Delete(item);
+
+    /* one level deeper */
+    options.raw_depth = 2;
+    item = BC_JSON_ParseWithOptions(json, sizeof(json), &options, NULL);
+    TEST_ASSERT_NOT_NULL(item);
+    TEST_ASSERT_TRUE(BC_JSON_IsObject(BC_JSON_GetObjectItem(item, "payload")));
+    TEST_ASSERT_TRUE(BC_JSON_IsRaw(BC_JSON_GetObjectItem(BC_JSON_GetObjectItem(item, "payload"), "a")));
+    list = BC_JSON_GetObjectItem(item, "list");
+    TEST_ASSERT_TRUE(BC_JSON_IsArray(list));
+    TEST_ASSERT_EQUAL_STRING("[]", BC_JSON_GetArrayItem(list, 0)->value_string);
+    TEST_ASSERT_EQUAL_STRING("{\"x\" : 0}", BC_JSON_GetArrayItem(list, 1)->value_string);
+    BC_JSON_Delete(item);
+
+    /* raw values are still checked */
+    options.raw_depth = 1;
+    TEST_ASSERT_NULL(BC_JSON_ParseWithOptions("[1, [2,]]", 10, &options, NULL));
+    TEST_ASSERT_NULL(BC_JSON_ParseWithOptions("[1, {\"a\" 2}]", 14, &options, NULL));
+    TEST_ASSERT_NULL(BC_JSON_ParseWithOptions("[1, [2]", 8, &options, NULL));
+}
+
+static void parse_with_options_should_limit_the_nesting_of_raw_values(void)
+{
+    const size_t depth = 1501;
+    char *json = (char*)malloc(2 * depth + 2);
+    BC_JSON_ParseOptions options;
+    BC_JSON *item = NULL;
+
+    TEST_ASSERT_NOT_NULL(json);
+    memset(json, '[', depth);
+    json[depth] = '1';
+    memset(json + depth + 1, ']', depth);
+    json[2 * depth + 1] = '\0';
+
+    /* deeper than the default limit, but not than max_depth */
+    memset(&options, '\0', sizeof(options));
+    options.max_depth = 2000;
+    item = BC_JSON_ParseWithOptions(json, 2 * depth + 2, &options, NULL);
+    TEST_ASSERT_NOT_NULL(item);
+    BC_JSON_Delete(item);
+    options.raw_depth = 1;
+    item = BC_JSON_ParseWithOptions(json, 2 * depth + 2, &options, NULL);
+    TEST_ASSERT_NOT_NULL(item);
+    TEST_ASSERT_TRUE(BC_JSON_IsRaw(item->child));
+    BC_JSON_Delete(item);
+
+    /* the levels above a raw value count as well */
+    memset(&options, '\0', sizeof(options));
+    options.max_depth = 5;
+    TEST_ASSERT_NULL(BC_JSON_ParseWithOptions(json + depth - 51, 2 * 51 + 1, &options, NULL));
+    options.raw_depth = 1;
+    TEST_ASSERT_NULL(BC_JSON_ParseWithOptions(json + depth - 51, 2 * 51 + 1, &options, NULL));
+    options.raw_depth = 3;
+    TEST_ASSERT_NULL(BC_JSON_ParseWithOptions(json + depth - 6, 2 * 6 + 1, &options, NULL));
+    item = BC_JSON_ParseWithOptions(json + depth - 5, 2 * 5 + 1, &options, NULL);
+    TEST_ASSERT_NOT_NULL(item);
+    BC_JSON_Delete(item);
+
+    free(json);
+}
+
+static void parse_with_options_should_check_utf8_if_requested(void)
+{
+    const char json[] = "{\"k\xC3\xBC\": \"0123456789012345678901234567890123456789\xED\xA0\x80\"}";
+    BC_JSON_ParseOptions options;
+    BC_JSON *item = NULL;
+
+    memset(&options, '\0', sizeof(options));
+
+    /* by default the bytes are taken as they are */
+    item = BC_JSON_ParseWithOptions(json, sizeof(json), &options, NULL);
+    TEST_ASSERT_NOT_NULL(item);
+    BC_JSON_Delete(item);
+
+    options.strict_utf8 = true;
+    TEST_ASSERT_NULL(BC_JSON_ParseWithOptions(json, sizeof(json), &options, NULL));
+    TEST_ASSERT_NULL(BC_JSON_ParseWithOptions("[\"\xC0\xAF\"]", 7, &options, NULL));
+    TEST_ASSERT_NULL(BC_JSON_ParseWithOptions("{\"\xFF\": 1}", 10, &options, NULL));
+
+    item = BC_JSON_ParseWithOptions("{\"k\xC3\xBC\": \"\xF0\x9F\x98\x80\"}", 15, &options, NULL);
+    TEST_ASSERT_NOT_NULL(item);
+    TEST_ASSERT_EQUAL_STRING("\xF0\x9F\x98\x80", BC_JSON_GetObjectItem(item, "k\xC3\xBC")->value_string);
+    BC_JSON_Delete(item);
+}
+
+static BC_JSON *parse_exact(const char *json, const BC_JSON_ParseOptions *options)
+{
+    /* without a terminator, so reading beyond the text is caught */
+    size_t length = strlen(json);
+    char *copy = (char*)malloc(length);
+    BC_JSON *item = NULL;
+
+    TEST_ASSERT_NOT_NULL(copy);
+    memcpy(copy, json, length);
+    item = BC_JSON_ParseWithOptions(copy, length, options, NULL);
+    free(copy);
+
+    return item;
+}
+
+static void parse_with_options_should_skip_comments_if_allowed(void)
+{
+    const char json[] = "// settings\n{ /* first */ \"a\" /* b */ : /**/ 1, // one\n \"b\": [1 /* * / */, 2]/***/ } // done";
+    BC_JSON_ParseOptions options;
+    BC_JSON *item = NULL;
+    char *printed = NULL;
+
+    memset(&options, '\0', sizeof(options));
+    TEST_ASSERT_NULL(BC_JSON_ParseWithOptions(json, sizeof(json), &options, NULL));
+
+    options.allow_comments = true;
+    options.require_null_terminated = true;
+    item = BC_JSON_ParseWithOptions(json, sizeof(json), &options, NULL);
+    TEST_ASSERT_NOT_NULL(item);
+    printed = BC_JSON_PrintUnformatted(item);
+    TEST_ASSERT_EQUAL_STRING("{\"a\":1,\"b\":[1,2]}", printed);
+    BC_JSON_free(printed);
+    BC_JSON_Delete(item);
+
+    /* comments aren't looked for in strings */
+    item = BC_JSON_ParseWithOptions("[\"/* x */ // y\"]", 17, &options, NULL);
+    TEST_ASSERT_NOT_NULL(item);
+    TEST_ASSERT_EQUAL_STRING("/* x */ // y", BC_JSON_GetArrayItem(item, 0)->value_string);
+    BC_JSON_Delete(item);
+
+    /* a comment up to the end of the text, with and without a terminator */
+    options.require_null_terminated = false;
+    item = parse_exact("[1] // end", &options);
+    TEST_ASSERT_NOT_NULL(item);
+    BC_JSON_Delete(item);
+    item = parse_exact("[1] /* end */", &options);
+    TEST_ASSERT_NOT_NULL(item);
+    BC_JSON_Delete(item);
+
+    /* what isn't a comment or a closed one */
+    TEST_ASSERT_NULL(parse_exact("[1 / 2]", &options));
+    TEST_ASSERT_NULL(parse_exact("[1 /* ]", &options));
+    TEST_ASSERT_NULL(parse_exact("[1 /* ]*", &options));
+    TEST_ASSERT_NULL(parse_exact("[1 // ]", &options));
+    TEST_ASSERT_NULL(parse_exact("[1 /", &options));
+    TEST_ASSERT_NULL(parse_exact("{\"a\": 1 /*/}", &options));
+    /* a comment ends at a terminator like the text does */
+    TEST_ASSERT_NULL(BC_JSON_ParseWithOptions("[1 /* \0 */]", 12, &options, NULL));
+
+    /* raw values keep their comments */
+    options.raw_depth = 1;
+    item = BC_JSON_ParseWithOptions("[[1, /* x */ 2]]", 17, &options, NULL);
+    TEST_ASSERT_NOT_NULL(item);
+    TEST_ASSERT_EQUAL_STRING("[1, /* x */ 2]", BC_JSON_GetArrayItem(item, 0)->value_string);
+    BC_JSON_Delete(item);
+}
+
+static void parse_with_options_should_accept_trailing_commas_if_allowed(void)
+{
+    BC_JSON_ParseOptions options;
+    BC_JSON *item = NULL;
+    char *printed = NULL;
+
+    memset(&options, '\0', sizeof(options));
+    TEST_ASSERT_NULL(parse_exact("[1, 2,]", &options));
+    TEST_ASSERT_NULL(parse_exact("{\"a\": 1,}", &options));
+
+    options.allow_trailing_commas = true;
+    item = parse_exact("{\"a\": [1, 2, ], \"b\": {\"c\": [[],], }, }", &options);
+    TEST_ASSERT_NOT_NULL(item);
+    printed = BC_JSON_PrintUnformatted(item);
+    TEST_ASSERT_EQUAL_STRING("{\"a\":[1,2],\"b\":{\"c\":[[]]}}", printed);
+    BC_JSON_free(printed);
+    BC_JSON_Delete(item);
+
+    /* only one, and only after an element */
+    TEST_ASSERT_NULL(parse_exact("[,]", &options));
+    TEST_ASSERT_NULL(parse_exact("{,}", &options));
+    TEST_ASSERT_NULL(parse_exact("[1,,]", &options));
+    TEST_ASSERT_NULL(parse_exact("{\"a\": 1,,}", &options));
+    TEST_ASSERT_NULL(parse_exact("[1,", &options));
+    TEST_ASSERT_NULL(parse_exact("[1, }", &options));
+
+    /* with comments in between */
+    TEST_ASSERT_NULL(parse_exact("[1, /* x */ ]", &options));
+    options.allow_comments = true;
+    item = parse_exact("[1, /* x */ // y\n ]", &options);
+    TEST_ASSERT_NOT_NULL(item);
+    TEST_ASSERT_EQUAL_INT(1, BC_JSON_GetArraySize(item));
+    BC_JSON_Delete(item);
+
+    /* in raw values too */
+    options.raw_depth = 1;
+    item = parse_exact("{\"a\": {\"b\": [1,],},}", &options);
+    TEST_ASSERT_NOT_NULL(item);
+    TEST_ASSERT_EQUAL_STRING("{\"b\": [1,],}", BC_JSON_GetObjectItem(item, "a")->value_string);
+    BC_JSON_Delete(item);
+}
+
 int CJSON_CDECL main(void)
 {
     UNITY_BEGIN();
@@ -107,6 +391,13 @@ int CJSON_CDECL main(void)
     RUN_TEST(parse_with_opts_should_require_null_if_requested);
     RUN_TEST(parse_with_opts_should_return_parse_end);
     RUN_TEST(parse_with_opts_should_parse_utf8_bom);
+    RUN_TEST(parse_with_options_should_limit_nesting);
+    RUN_TEST(parse_with_options_should_parse_beyond_the_default_nesting_limit);
+    RUN_TEST(parse_with_options_should_keep_deep_values_raw);
+    RUN_TEST(parse_with_options_should_limit_the_nesting_of_raw_values);
+    RUN_TEST(parse_with_options_should_check_utf8_if_requested);
+    RUN_TEST(parse_with_options_should_skip_comments_if_allowed);
+    RUN_TEST(parse_with_options_should_accept_trailing_commas_if_allowed);
 
     return UNITY_END();
 }
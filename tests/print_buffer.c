@@ -0,0 +1,177 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and BC_JSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+static size_t allocations = 0;
+
+static void * CJSON_CDECL counting_malloc(size_t size)
+{
+    allocations++;
+    return malloc(size);
+}
+
+static void assert_print_into_matches_print(BC_JSON_PrintBuffer *buffer, BC_JSON *item, BC_JSON_bool format)
+{
+    char *printed = format ? BC_JSON_Print(item) : BC_JSON_PrintUnformatted(item);
+
+    TEST_ASSERT_NOT_NULL(printed);
+    TEST_ASSERT_TRUE(BC_JSON_PrintInto(buffer, item, format));
+    TEST_ASSERT_EQUAL_UINT(strlen(printed), BC_JSON_PrintBufferLength(buffer));
+    TEST_ASSERT_EQUAL_STRING(printed, BC_JSON_PrintBufferText(buffer));
+
+    BC_JSON_free(printed);
+}
+
+static void print_buffer_should_match_print(void)
+{
+    const char *files[] = { "inputs/test1", "inputs/test2", "inputs/test3", "inputs/test4", "inputs/test5", "inputs/test7", "inputs/test8", "inputs/test9", "inputs/test10", "inputs/test11" };
+    BC_JSON_PrintBuffer *buffer = BC_JSON_CreatePrintBuffer();
+    size_t i = 0;
+
+    TEST_ASSERT_NOT_NULL(buffer);
+
+    /* one buffer for all of them, the texts get longer and shorter */
+    for (i = 0; i < (sizeof(files) / sizeof(files[0])); i++)
+    {
+        char *content = read_file(files[i]);
+        BC_JSON *item = NULL;
+
+        TEST_ASSERT_NOT_NULL_MESSAGE(content, files[i]);
+        item = BC_JSON_Parse(content);
+        TEST_ASSERT_NOT_NULL_MESSAGE(item, files[i]);
+
+        assert_print_into_matches_print(buffer, item, true);
+        assert_print_into_matches_print(buffer, item, false);
+
+        BC_JSON_Delete(item);
+        free(content);
+    }
+
+    BC_JSON_DeletePrintBuffer(buffer);
+}
+
+static void print_buffer_should_reuse_its_memory(void)
+{
+    BC_JSON_Hooks hooks = { counting_malloc, free };
+    BC_JSON_PrintBuffer *buffer = NULL;
+    BC_JSON *item = NULL;
+    const char *first_text = NULL;
+    size_t first_allocations = 0;
+    int i = 0;
+
+    BC_JSON_InitHooks(&hooks);
+    item = BC_JSON_CreateArray();
+    for (i = 0; i < 1000; i++)
+    {
+        TEST_ASSERT_TRUE(BC_JSON_AddItemToArray(item, BC_JSON_CreateNumber(i / 3.0)));
+    }
+    buffer = BC_JSON_CreatePrintBuffer();
+    TEST_ASSERT_NOT_NULL(buffer);
+
+    allocations = 0;
+    TEST_ASSERT_TRUE(BC_JSON_PrintInto(buffer, item, false));
+    first_allocations = allocations;
+    first_text = BC_JSON_PrintBufferText(buffer);
+    /* the buffer grows geometrically, not once per value */
+    TEST_ASSERT_TRUE(first_allocations > 1);
+    TEST_ASSERT_TRUE(first_allocations < 20);
+
+    /* the same text and a shorter one fit the buffer */
+    allocations = 0;
+    TEST_ASSERT_TRUE(BC_JSON_PrintInto(buffer, item, false));
+    BC_JSON_DeleteItemFromArray(item, 0);
+    TEST_ASSERT_TRUE(BC_JSON_PrintInto(buffer, item, false));
+    TEST_ASSERT_TRUE(BC_JSON_PrintInto(buffer, item->child, false));
+    TEST_ASSERT_EQUAL_UINT(0, allocations);
+    TEST_ASSERT_EQUAL_PTR(first_text, BC_JSON_PrintBufferText(buffer));
+    TEST_ASSERT_EQUAL_STRING("0.3333333333333333", BC_JSON_PrintBufferText(buffer));
+    TEST_ASSERT_EQUAL_UINT(18, BC_JSON_PrintBufferLength(buffer));
+
+    BC_JSON_DeletePrintBuffer(buffer);
+    BC_JSON_Delete(item);
+    BC_JSON_InitHooks(NULL);
+}
+
+static void print_buffer_should_be_empty_after_a_failure(void)
+{
+    BC_JSON_PrintBuffer *buffer = BC_JSON_CreatePrintBuffer();
+    BC_JSON *item = BC_JSON_CreateArray();
+    BC_JSON invalid[1];
+
+    memset(invalid, 0, sizeof(invalid));
+    TEST_ASSERT_NOT_NULL(buffer);
+    TEST_ASSERT_TRUE(BC_JSON_AddItemToArray(item, BC_JSON_CreateString("text")));
+
+    /* a new buffer is empty */
+    TEST_ASSERT_EQUAL_STRING("", BC_JSON_PrintBufferText(buffer));
+    TEST_ASSERT_EQUAL_UINT(0, BC_JSON_PrintBufferLength(buffer));
+
+    TEST_ASSERT_TRUE(BC_JSON_PrintInto(buffer, item, false));
+    TEST_ASSERT_EQUAL_STRING("[\"text\"]", BC_JSON_PrintBufferText(buffer));
+
+    TEST_ASSERT_TRUE(BC_JSON_AddItemToArray(item, invalid));
+    TEST_ASSERT_FALSE(BC_JSON_PrintInto(buffer, item, false));
+    TEST_ASSERT_EQUAL_STRING("", BC_JSON_PrintBufferText(buffer));
+    TEST_ASSERT_EQUAL_UINT(0, BC_JSON_PrintBufferLength(buffer));
+    TEST_ASSERT_NOT_NULL(BC_JSON_DetachItemViaPointer(item, invalid));
+
+    /* and it can be printed into again */
+    TEST_ASSERT_TRUE(BC_JSON_PrintInto(buffer, item, true));
+    TEST_ASSERT_EQUAL_STRING("[\"text\"]", BC_JSON_PrintBufferText(buffer));
+
+    BC_JSON_DeletePrintBuffer(buffer);
+    BC_JSON_Delete(item);
+}
+
+static void print_buffer_should_handle_null(void)
+{
+    BC_JSON_PrintBuffer *buffer = BC_JSON_CreatePrintBuffer();
+    BC_JSON *item = BC_JSON_CreateNull();
+
+    TEST_ASSERT_FALSE(BC_JSON_PrintInto(NULL, item, false));
+    TEST_ASSERT_FALSE(BC_JSON_PrintInto(buffer, NULL, false));
+    TEST_ASSERT_EQUAL_STRING("", BC_JSON_PrintBufferText(NULL));
+    TEST_ASSERT_EQUAL_UINT(0, BC_JSON_PrintBufferLength(NULL));
+    BC_JSON_DeletePrintBuffer(NULL);
+
+    BC_JSON_DeletePrintBuffer(buffer);
+    BC_JSON_Delete(item);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(print_buffer_should_match_print);
+    RUN_TEST(print_buffer_should_reuse_its_memory);
+    RUN_TEST(print_buffer_should_be_empty_after_a_failure);
+    RUN_TEST(print_buffer_should_handle_null);
+
+    return UNITY_END();
+}
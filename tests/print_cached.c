@@ -0,0 +1,267 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and BC_JSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+static void assert_cached_matches_print(BC_JSON_PrintCache *cache, BC_JSON *item)
+{
+    char *printed = NULL;
+    char *cached = NULL;
+
+    printed = BC_JSON_Print(item);
+    cached = BC_JSON_PrintCached(cache, item, true);
+    TEST_ASSERT_NOT_NULL(printed);
+    TEST_ASSERT_NOT_NULL(cached);
+    TEST_ASSERT_EQUAL_STRING(printed, cached);
+    BC_JSON_free(printed);
+    BC_JSON_free(cached);
+
+    printed = BC_JSON_PrintUnformatted(item);
+    cached = BC_JSON_PrintCached(cache, item, false);
+    TEST_ASSERT_NOT_NULL(printed);
+    TEST_ASSERT_NOT_NULL(cached);
+    TEST_ASSERT_EQUAL_STRING(printed, cached);
+    BC_JSON_free(printed);
+    BC_JSON_free(cached);
+}
+
+static void print_cached_should_match_print(void)
+{
+    const char *files[] = { "inputs/test1", "inputs/test2", "inputs/test3", "inputs/test4", "inputs/test5", "inputs/test7", "inputs/test8", "inputs/test9", "inputs/test10", "inputs/test11" };
+    size_t i = 0;
+
+    for (i = 0; i < (sizeof(files) / sizeof(files[0])); i++)
+    {
+        char *content = read_file(files[i]);
+        BC_JSON_PrintCache *cache = BC_JSON_CreatePrintCache();
+        BC_JSON *item = NULL;
+
+        TEST_ASSERT_NOT_NULL_MESSAGE(content, files[i]);
+        TEST_ASSERT_NOT_NULL(cache);
+        item = BC_JSON_Parse(content);
+        TEST_ASSERT_NOT_NULL_MESSAGE(item, files[i]);
+
+        /* the second time around from the cache */
+        assert_cached_matches_print(cache, item);
+        assert_cached_matches_print(cache, item);
+
+        BC_JSON_DeletePrintCache(cache);
+        BC_JSON_Delete(item);
+        free(content);
+    }
+}
+
+static void print_cached_should_copy_unchanged_text(void)
+{
+    BC_JSON *item = BC_JSON_Parse("{\"a\":{\"b\":[1,2,{\"c\":\"d\"}]},\"e\":[true]}");
+    BC_JSON_PrintCache *cache = BC_JSON_CreatePrintCache();
+    BC_JSON *b = NULL;
+    char *cached = NULL;
+
+    TEST_ASSERT_NOT_NULL(item);
+    TEST_ASSERT_NOT_NULL(cache);
+    cached = BC_JSON_PrintCached(cache, item, false);
+    TEST_ASSERT_EQUAL_STRING("{\"a\":{\"b\":[1,2,{\"c\":\"d\"}]},\"e\":[true]}", cached);
+    BC_JSON_free(cached);
+
+    /* a change the cache doesn't know about isn't printed */
+    b = BC_JSON_GetObjectItem(BC_JSON_GetObjectItem(item, "a"), "b");
+    b->child->value_number = 3;
+    cached = BC_JSON_PrintCached(cache, item, false);
+    TEST_ASSERT_EQUAL_STRING("{\"a\":{\"b\":[1,2,{\"c\":\"d\"}]},\"e\":[true]}", cached);
+    BC_JSON_free(cached);
+
+    /* until it is told */
+    BC_JSON_MarkChanged(b->child);
+    cached = BC_JSON_PrintCached(cache, item, false);
+    TEST_ASSERT_EQUAL_STRING("{\"a\":{\"b\":[3,2,{\"c\":\"d\"}]},\"e\":[true]}", cached);
+    BC_JSON_free(cached);
+
+    /* a new cache has to print everything */
+    BC_JSON_DeletePrintCache(cache);
+    cache = BC_JSON_CreatePrintCache();
+    TEST_ASSERT_NOT_NULL(cache);
+    b->child->value_number = 4;
+    assert_cached_matches_print(cache, item);
+
+    BC_JSON_DeletePrintCache(cache);
+    BC_JSON_Delete(item);
+}
+
+static void print_cached_should_notice_changes(void)
+{
+    BC_JSON *item = BC_JSON_Parse("{\"config\":{\"name\":\"x\",\"limits\":[1,2,3],\"nested\":{\"deep\":[[{\"v\":1}]]}},\"state\":[{\"id\":1},{\"id\":2}]}");
+    BC_JSON *config = NULL;
+    BC_JSON *state = NULL;
+    BC_JSON *limits = NULL;
+    BC_JSON *deep = NULL;
+    BC_JSON *moved = NULL;
+    BC_JSON_PrintCache *cache = BC_JSON_CreatePrintCache();
+
+    TEST_ASSERT_NOT_NULL(item);
+    TEST_ASSERT_NOT_NULL(cache);
+    config = BC_JSON_GetObjectItem(item, "config");
+    state = BC_JSON_GetObjectItem(item, "state");
+    limits = BC_JSON_GetObjectItem(config, "limits");
+    deep = BC_JSON_GetObjectItem(BC_JSON_GetObjectItem(config, "nested"), "deep");
+    assert_cached_matches_print(cache, item);
+
+    TEST_ASSERT_NOT_NULL(BC_JSON_SetValuestring(BC_JSON_GetObjectItem(config, "name"), "a longer name"));
+    assert_cached_matches_print(cache, item);
+    TEST_ASSERT_NOT_NULL(BC_JSON_SetValuestring(BC_JSON_GetObjectItem(config, "name"), "y"));
+    assert_cached_matches_print(cache, item);
+
+    BC_JSON_SetNumberValue(deep->child->child->child, 42);
+    assert_cached_matches_print(cache, item);
+
+    TEST_ASSERT_TRUE(BC_JSON_AddItemToArray(limits, BC_JSON_CreateNumber(4)));
+    assert_cached_matches_print(cache, item);
+    TEST_ASSERT_NOT_NULL(BC_JSON_AddStringToObject(state->child, "added", "value"));
+    assert_cached_matches_print(cache, item);
+    TEST_ASSERT_TRUE(BC_JSON_InsertItemInArray(limits, 0, BC_JSON_CreateNumber(0)));
+    assert_cached_matches_print(cache, item);
+
+    TEST_ASSERT_TRUE(BC_JSON_ReplaceItemInArray(limits, 1, BC_JSON_CreateString("one")));
+    assert_cached_matches_print(cache, item);
+    TEST_ASSERT_TRUE(BC_JSON_ReplaceItemInObject(config, "name", BC_JSON_CreateObject()));
+    assert_cached_matches_print(cache, item);
+
+    BC_JSON_DeleteItemFromArray(limits, 2);
+    assert_cached_matches_print(cache, item);
+
+    /* a cached array moves somewhere deeper, where it is indented differently */
+    moved = BC_JSON_DetachItemFromObject(config, "nested");
+    TEST_ASSERT_NOT_NULL(moved);
+    assert_cached_matches_print(cache, item);
+    TEST_ASSERT_TRUE(BC_JSON_AddItemToObject(deep->child->child, "moved", BC_JSON_CreateArray()));
+    TEST_ASSERT_TRUE(BC_JSON_AddItemToArray(state->child->next, moved));
+    assert_cached_matches_print(cache, item);
+    BC_JSON_SetNumberValue(deep->child->child->child, 7);
+    assert_cached_matches_print(cache, item);
+
+    TEST_ASSERT_NOT_NULL(BC_JSON_AddFalseToObject(moved->child->child, "flag"));
+    assert_cached_matches_print(cache, item);
+    BC_JSON_SetBoolValue(BC_JSON_GetObjectItem(moved->child->child, "flag"), true);
+    assert_cached_matches_print(cache, item);
+
+    BC_JSON_DeletePrintCache(cache);
+    BC_JSON_Delete(item);
+}
+
+static void print_cached_should_print_references_every_time(void)
+{
+    BC_JSON *shared = BC_JSON_Parse("[1,{\"a\":[2]}]");
+    BC_JSON *item = BC_JSON_CreateObject();
+    BC_JSON *inner = NULL;
+    BC_JSON_PrintCache *cache = BC_JSON_CreatePrintCache();
+    BC_JSON_PrintCache *shared_cache = BC_JSON_CreatePrintCache();
+
+    TEST_ASSERT_NOT_NULL(shared);
+    TEST_ASSERT_NOT_NULL(cache);
+    TEST_ASSERT_NOT_NULL(shared_cache);
+    TEST_ASSERT_TRUE(BC_JSON_AddItemReferenceToObject(item, "shared", shared));
+    TEST_ASSERT_NOT_NULL(BC_JSON_AddObjectToObject(item, "own"));
+    assert_cached_matches_print(cache, item);
+    assert_cached_matches_print(shared_cache, shared);
+
+    /* printing the original marks the change as printed */
+    inner = BC_JSON_GetObjectItem(shared->child->next, "a");
+    BC_JSON_SetNumberValue(inner->child, 3);
+    assert_cached_matches_print(cache, item);
+    assert_cached_matches_print(shared_cache, shared);
+
+    BC_JSON_DeletePrintCache(cache);
+    BC_JSON_DeletePrintCache(shared_cache);
+    BC_JSON_Delete(item);
+    BC_JSON_Delete(shared);
+}
+
+/* Items parsed into the same block are at the addresses of the ones before them. */
+static void print_cached_should_not_use_text_of_freed_items(void)
+{
+    const char *first = "[[1,2],{\"a\":[3]}]";
+    const char *second = "[[4,5],{\"b\":[6]}]";
+    BC_JSON_Measurement measurement;
+    BC_JSON_PrintCache *cache = BC_JSON_CreatePrintCache();
+    BC_JSON *item = NULL;
+    void *block = NULL;
+    char *cached = NULL;
+
+    TEST_ASSERT_NOT_NULL(cache);
+    TEST_ASSERT_TRUE(BC_JSON_ParseMeasure(first, strlen(first) + sizeof(""), &measurement));
+    block = malloc(measurement.buffer_size);
+    TEST_ASSERT_NOT_NULL(block);
+
+    item = BC_JSON_ParseIntoBuffer(first, strlen(first) + sizeof(""), block, measurement.buffer_size);
+    TEST_ASSERT_NOT_NULL(item);
+    cached = BC_JSON_PrintCached(cache, item, false);
+    TEST_ASSERT_EQUAL_STRING(first, cached);
+    BC_JSON_free(cached);
+
+    item = BC_JSON_ParseIntoBuffer(second, strlen(second) + sizeof(""), block, measurement.buffer_size);
+    TEST_ASSERT_NOT_NULL(item);
+    cached = BC_JSON_PrintCached(cache, item, false);
+    TEST_ASSERT_EQUAL_STRING(second, cached);
+    BC_JSON_free(cached);
+
+    BC_JSON_DeletePrintCache(cache);
+    free(block);
+}
+
+static void print_cached_should_print_values(void)
+{
+    BC_JSON *number = BC_JSON_CreateNumber(1.5);
+    BC_JSON *empty = BC_JSON_CreateArray();
+    BC_JSON_PrintCache *cache = BC_JSON_CreatePrintCache();
+
+    TEST_ASSERT_NOT_NULL(cache);
+    assert_cached_matches_print(cache, number);
+    assert_cached_matches_print(cache, empty);
+    TEST_ASSERT_NULL(BC_JSON_PrintCached(cache, NULL, false));
+    TEST_ASSERT_NULL(BC_JSON_PrintCached(NULL, empty, false));
+    BC_JSON_MarkChanged(NULL);
+    BC_JSON_DeletePrintCache(NULL);
+
+    BC_JSON_DeletePrintCache(cache);
+    BC_JSON_Delete(number);
+    BC_JSON_Delete(empty);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(print_cached_should_match_print);
+    RUN_TEST(print_cached_should_copy_unchanged_text);
+    RUN_TEST(print_cached_should_notice_changes);
+    RUN_TEST(print_cached_should_print_references_every_time);
+    RUN_TEST(print_cached_should_not_use_text_of_freed_items);
+    RUN_TEST(print_cached_should_print_values);
+
+    return UNITY_END();
+}
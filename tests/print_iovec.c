@@ -0,0 +1,187 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and BC_JSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+/* put the pieces together and check that they are the printed text */
+static BC_JSON_IoVec *assert_iovec_matches_print(BC_JSON *item, BC_JSON_bool format, size_t threshold, size_t *count)
+{
+    char *printed = format ? BC_JSON_Print(item) : BC_JSON_PrintUnformatted(item);
+    BC_JSON_IoVec *vectors = BC_JSON_PrintIoVec(item, format, threshold, count);
+    size_t offset = 0;
+    size_t i = 0;
+
+    TEST_ASSERT_NOT_NULL(printed);
+    TEST_ASSERT_NOT_NULL(vectors);
+    TEST_ASSERT_TRUE(*count > 0);
+
+    for (i = 0; i < *count; i++)
+    {
+        TEST_ASSERT_NOT_NULL(vectors[i].iov_base);
+        TEST_ASSERT_TRUE(vectors[i].iov_len > 0);
+        TEST_ASSERT_TRUE((offset + vectors[i].iov_len) <= strlen(printed));
+        TEST_ASSERT_EQUAL_MEMORY(printed + offset, vectors[i].iov_base, vectors[i].iov_len);
+        offset += vectors[i].iov_len;
+    }
+    TEST_ASSERT_EQUAL_UINT(strlen(printed), offset);
+
+    BC_JSON_free(printed);
+
+    return vectors;
+}
+
+static void print_iovec_should_match_print(void)
+{
+    const char *files[] = { "inputs/test1", "inputs/test2", "inputs/test3", "inputs/test4", "inputs/test5", "inputs/test7", "inputs/test8", "inputs/test9", "inputs/test10", "inputs/test11" };
+    const size_t thresholds[] = { 0, 1, 5, 20 };
+    size_t count = 0;
+    size_t i = 0;
+    size_t j = 0;
+
+    for (i = 0; i < (sizeof(files) / sizeof(files[0])); i++)
+    {
+        char *content = read_file(files[i]);
+        BC_JSON *item = NULL;
+
+        TEST_ASSERT_NOT_NULL_MESSAGE(content, files[i]);
+        item = BC_JSON_Parse(content);
+        TEST_ASSERT_NOT_NULL_MESSAGE(item, files[i]);
+
+        for (j = 0; j < (sizeof(thresholds) / sizeof(thresholds[0])); j++)
+        {
+            BC_JSON_free(assert_iovec_matches_print(item, false, thresholds[j], &count));
+            BC_JSON_free(assert_iovec_matches_print(item, true, thresholds[j], &count));
+        }
+
+        BC_JSON_Delete(item);
+        free(content);
+    }
+}
+
+static void print_iovec_should_reference_long_strings_in_place(void)
+{
+    char blob[2000];
+    BC_JSON *item = BC_JSON_CreateObject();
+    BC_JSON *first = NULL;
+    BC_JSON *raw = NULL;
+    BC_JSON_IoVec *vectors = NULL;
+    size_t count = 0;
+
+    memset(blob, 'b', sizeof(blob) - 1);
+    blob[sizeof(blob) - 1] = '\0';
+    first = BC_JSON_AddStringToObject(item, "first", blob);
+    raw = BC_JSON_AddRawToObject(item, "raw", "[\"a raw value that is long enough\"]");
+    TEST_ASSERT_NOT_NULL(BC_JSON_AddStringToObject(item, "short", "short"));
+    blob[10] = '\n';
+    TEST_ASSERT_NOT_NULL(BC_JSON_AddStringToObject(item, "escaped", blob));
+
+    vectors = assert_iovec_matches_print(item, false, 32, &count);
+    /* {"first":" blob ","raw": raw ,"short":"short","escaped":"...\n..."} */
+    TEST_ASSERT_EQUAL_UINT(5, count);
+    TEST_ASSERT_TRUE(vectors[1].iov_base == first->value_string);
+    TEST_ASSERT_EQUAL_UINT(sizeof(blob) - 1, vectors[1].iov_len);
+    TEST_ASSERT_TRUE(vectors[3].iov_base == raw->value_string);
+    BC_JSON_free(vectors);
+
+    /* the default threshold only references the blob */
+    vectors = assert_iovec_matches_print(item, true, 0, &count);
+    TEST_ASSERT_EQUAL_UINT(3, count);
+    TEST_ASSERT_TRUE(vectors[1].iov_base == first->value_string);
+    BC_JSON_free(vectors);
+
+    BC_JSON_Delete(item);
+}
+
+static void print_iovec_should_reference_a_long_string_at_the_top(void)
+{
+    char blob[2000];
+    BC_JSON *item = NULL;
+    BC_JSON_IoVec *vectors = NULL;
+    size_t count = 0;
+
+    memset(blob, 'b', sizeof(blob) - 1);
+    blob[sizeof(blob) - 1] = '\0';
+    item = BC_JSON_CreateString(blob);
+
+    vectors = assert_iovec_matches_print(item, false, 0, &count);
+    TEST_ASSERT_EQUAL_UINT(3, count);
+    TEST_ASSERT_TRUE(vectors[1].iov_base == item->value_string);
+    BC_JSON_free(vectors);
+
+    BC_JSON_Delete(item);
+}
+
+static void print_iovec_should_handle_many_segments(void)
+{
+    char blob[100];
+    BC_JSON *item = BC_JSON_CreateArray();
+    BC_JSON_IoVec *vectors = NULL;
+    size_t count = 0;
+    int i = 0;
+
+    memset(blob, 'b', sizeof(blob) - 1);
+    blob[sizeof(blob) - 1] = '\0';
+    for (i = 0; i < 1000; i++)
+    {
+        TEST_ASSERT_TRUE(BC_JSON_AddItemToArray(item, BC_JSON_CreateString(blob)));
+    }
+
+    vectors = assert_iovec_matches_print(item, true, 64, &count);
+    TEST_ASSERT_EQUAL_UINT(2001, count);
+    BC_JSON_free(vectors);
+
+    BC_JSON_Delete(item);
+}
+
+static void print_iovec_should_fail_on_invalid_arguments(void)
+{
+    BC_JSON invalid[1];
+    BC_JSON *item = BC_JSON_CreateTrue();
+    size_t count = 0;
+
+    memset(invalid, 0, sizeof(invalid));
+
+    TEST_ASSERT_NULL(BC_JSON_PrintIoVec(NULL, false, 0, &count));
+    TEST_ASSERT_NULL(BC_JSON_PrintIoVec(item, false, 0, NULL));
+    TEST_ASSERT_NULL(BC_JSON_PrintIoVec(invalid, false, 0, &count));
+
+    BC_JSON_Delete(item);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(print_iovec_should_match_print);
+    RUN_TEST(print_iovec_should_reference_long_strings_in_place);
+    RUN_TEST(print_iovec_should_reference_a_long_string_at_the_top);
+    RUN_TEST(print_iovec_should_handle_many_segments);
+    RUN_TEST(print_iovec_should_fail_on_invalid_arguments);
+
+    return UNITY_END();
+}
@@ -0,0 +1,197 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and BC_JSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+static size_t allocations = 0;
+
+static void * CJSON_CDECL counting_malloc(size_t size)
+{
+    allocations++;
+    return malloc(size);
+}
+
+static void assert_length_is_exact(BC_JSON *item, BC_JSON_bool format)
+{
+    char *printed = format ? BC_JSON_Print(item) : BC_JSON_PrintUnformatted(item);
+    size_t length = BC_JSON_PrintedLength(item, format);
+    char *buffer = NULL;
+
+    TEST_ASSERT_NOT_NULL(printed);
+    TEST_ASSERT_EQUAL_UINT_MESSAGE(strlen(printed), length, "Printed length is not exact.");
+
+    /* the exact length is enough for printing into a preallocated buffer, one less isn't */
+    buffer = (char*)malloc(length + 1);
+    TEST_ASSERT_NOT_NULL(buffer);
+    TEST_ASSERT_TRUE(BC_JSON_PrintPreallocated(item, buffer, (int)length + 1, format));
+    TEST_ASSERT_EQUAL_STRING(printed, buffer);
+    TEST_ASSERT_FALSE(BC_JSON_PrintPreallocated(item, buffer, (int)length, format));
+
+    free(buffer);
+    BC_JSON_free(printed);
+}
+
+static void assert_json_length_is_exact(const char *json)
+{
+    BC_JSON *item = BC_JSON_Parse(json);
+
+    TEST_ASSERT_NOT_NULL_MESSAGE(item, json);
+    assert_length_is_exact(item, false);
+    assert_length_is_exact(item, true);
+
+    BC_JSON_Delete(item);
+}
+
+static void printed_length_should_measure_scalars(void)
+{
+    assert_json_length_is_exact("null");
+    assert_json_length_is_exact("true");
+    assert_json_length_is_exact("false");
+    assert_json_length_is_exact("0");
+    assert_json_length_is_exact("-1.7976931348623157e+308");
+    assert_json_length_is_exact("0.1");
+    assert_json_length_is_exact("\"\"");
+    assert_json_length_is_exact("\"quotes \\\" and \\\\ backslashes\\b\\f\\n\\r\\t\\u0001\\u001f\"");
+}
+
+static void printed_length_should_measure_containers(void)
+{
+    assert_json_length_is_exact("[]");
+    assert_json_length_is_exact("{}");
+    assert_json_length_is_exact("[[], {}, [[]], {\"a\": {}}]");
+    assert_json_length_is_exact("{\"a\": {\"b\": {\"c\": [1, 2, {\"d\": {}}]}}, \"e\\n\": \"f\"}");
+    assert_json_length_is_exact("[1, \"two\", 3.5, true, false, null, {\"x\": [1e-09, -0]}]");
+}
+
+static void printed_length_should_measure_the_test_inputs(void)
+{
+    const char *files[] = { "inputs/test1", "inputs/test2", "inputs/test3", "inputs/test4", "inputs/test5", "inputs/test7", "inputs/test8", "inputs/test9", "inputs/test10", "inputs/test11" };
+    size_t i = 0;
+
+    for (i = 0; i < (sizeof(files) / sizeof(files[0])); i++)
+    {
+        char *content = read_file(files[i]);
+        TEST_ASSERT_NOT_NULL_MESSAGE(content, files[i]);
+        assert_json_length_is_exact(content);
+        free(content);
+    }
+}
+
+static void printed_length_should_measure_created_items(void)
+{
+    const float floats[] = { 0.1f, 3.40282347e+38f };
+    BC_JSON *object = BC_JSON_CreateObject();
+    BC_JSON *nulls = BC_JSON_CreateObject();
+    BC_JSON *nested = NULL;
+
+    TEST_ASSERT_NOT_NULL(object);
+    TEST_ASSERT_NOT_NULL(BC_JSON_AddRawToObject(object, "raw", "[1,2, 3]"));
+    TEST_ASSERT_NOT_NULL(BC_JSON_AddRawToObject(object, "empty raw", ""));
+    TEST_ASSERT_TRUE(BC_JSON_AddItemToObject(object, "floats", BC_JSON_CreateFloatArray(floats, 2)));
+    TEST_ASSERT_NOT_NULL(BC_JSON_AddNumberToObject(object, "infinity", HUGE_VAL));
+    nested = BC_JSON_AddArrayToObject(object, "nested");
+    TEST_ASSERT_TRUE(BC_JSON_AddItemReferenceToArray(nested, object->child));
+    TEST_ASSERT_TRUE(BC_JSON_AddItemToArray(nested, nulls));
+    /* a string without value and a key without name print as "" */
+    TEST_ASSERT_TRUE(BC_JSON_AddItemToArray(nested, BC_JSON_CreateString("x")));
+    BC_JSON_free(nested->child->next->next->value_string);
+    nested->child->next->next->value_string = NULL;
+    TEST_ASSERT_TRUE(BC_JSON_AddItemToObject(nulls, "key", BC_JSON_CreateNull()));
+    BC_JSON_free(nulls->child->string);
+    nulls->child->string = NULL;
+
+    assert_length_is_exact(object, false);
+    assert_length_is_exact(object, true);
+
+    BC_JSON_Delete(object);
+}
+
+static void printed_length_should_fail_on_invalid_items(void)
+{
+    BC_JSON invalid[1];
+    BC_JSON *array = BC_JSON_CreateArray();
+
+    memset(invalid, 0, sizeof(invalid));
+    TEST_ASSERT_EQUAL_UINT(0, BC_JSON_PrintedLength(NULL, false));
+    TEST_ASSERT_EQUAL_UINT(0, BC_JSON_PrintedLength(invalid, false));
+
+    invalid->type = BC_JSON_Raw;
+    TEST_ASSERT_EQUAL_UINT(0, BC_JSON_PrintedLength(invalid, true));
+
+    /* an invalid element anywhere fails the whole array */
+    TEST_ASSERT_TRUE(BC_JSON_AddItemToArray(array, BC_JSON_CreateNumber(1)));
+    TEST_ASSERT_TRUE(BC_JSON_AddItemToArray(array, BC_JSON_CreateRaw("2")));
+    array->child->next->type = BC_JSON_Invalid;
+    TEST_ASSERT_EQUAL_UINT(0, BC_JSON_PrintedLength(array, false));
+    TEST_ASSERT_NULL(BC_JSON_PrintUnformatted(array));
+
+    BC_JSON_Delete(array);
+}
+
+static void print_should_allocate_once(void)
+{
+    BC_JSON_Hooks hooks = { counting_malloc, free };
+    char *content = read_file("inputs/test7");
+    BC_JSON *item = NULL;
+    char *printed = NULL;
+
+    TEST_ASSERT_NOT_NULL(content);
+    item = BC_JSON_Parse(content);
+    TEST_ASSERT_NOT_NULL(item);
+
+    BC_JSON_InitHooks(&hooks);
+    allocations = 0;
+    printed = BC_JSON_Print(item);
+    TEST_ASSERT_NOT_NULL(printed);
+    TEST_ASSERT_EQUAL_UINT(1, allocations);
+    BC_JSON_free(printed);
+
+    allocations = 0;
+    printed = BC_JSON_PrintUnformatted(item);
+    TEST_ASSERT_NOT_NULL(printed);
+    TEST_ASSERT_EQUAL_UINT(1, allocations);
+    BC_JSON_free(printed);
+    BC_JSON_InitHooks(NULL);
+
+    BC_JSON_Delete(item);
+    free(content);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(printed_length_should_measure_scalars);
+    RUN_TEST(printed_length_should_measure_containers);
+    RUN_TEST(printed_length_should_measure_the_test_inputs);
+    RUN_TEST(printed_length_should_measure_created_items);
+    RUN_TEST(printed_length_should_fail_on_invalid_items);
+    RUN_TEST(print_should_allocate_once);
+
+    return UNITY_END();
+}
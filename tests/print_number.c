@@ -30,7 +30,7 @@ static void assert_print_number(const char *expected, double input)
     unsigned char new_buffer[26];
     unsigned int i = 0;
     BC_JSON item[1];
-    printbuffer buffer = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 } };
+    printbuffer buffer = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0 };
     buffer.buffer = printed;
     buffer.length = sizeof(printed);
     buffer.offset = 0;
@@ -88,7 +88,7 @@ static void print_number_should_print_positive_reals(void)
     assert_print_number("1000000000000", 10e11);
     assert_print_number("1.23e+129", 123e+127);
     assert_print_number("1.23e-126", 123e-128);
-    assert_print_number("3.1415926535897931", 3.1415926535897931);
+    assert_print_number("3.141592653589793", 3.1415926535897931);
 }
 
 static void print_number_should_print_negative_reals(void)
@@ -100,6 +100,38 @@ static void print_number_should_print_negative_reals(void)
     assert_print_number("-1.23e-126", -123e-128);
 }
 
+static void print_number_should_print_shortest_round_trip(void)
+{
+    assert_print_number("0.1", 0.1);
+    assert_print_number("0.30000000000000004", 0.1 + 0.2);
+    assert_print_number("1.2345678901234568e+17", 123456789012345678.0);
+    assert_print_number("1.7976931348623157e+308", 1.7976931348623157e+308);
+    assert_print_number("5e-324", 4.9406564584124654e-324);
+    assert_print_number("1e-323", 9.8813129168249309e-324);
+}
+
+static void print_number_should_print_floats_with_float_precision(void)
+{
+    const float numbers[] = { 0.1f, 3.14159f, 16777216.0f, 3.40282347e+38f, 1.40129846e-45f };
+    BC_JSON *array = BC_JSON_CreateFloatArray(numbers, 5);
+    char *printed = NULL;
+
+    TEST_ASSERT_NOT_NULL(array);
+    TEST_ASSERT_TRUE(array->child->type & BC_JSON_NumberIsFloat);
+    printed = BC_JSON_PrintUnformatted(array);
+    TEST_ASSERT_EQUAL_STRING("[0.1,3.14159,16777216,3.4028235e+38,1e-45]", printed);
+    global_hooks.deallocate(printed);
+
+    /* setting a double clears the float flag */
+    BC_JSON_SetNumberValue(array->child, 0.1);
+    TEST_ASSERT_FALSE(array->child->type & BC_JSON_NumberIsFloat);
+    printed = BC_JSON_PrintUnformatted(array->child);
+    TEST_ASSERT_EQUAL_STRING("0.1", printed);
+    global_hooks.deallocate(printed);
+
+    BC_JSON_Delete(array);
+}
+
 static void print_number_should_print_non_number(void)
 {
     TEST_IGNORE();
@@ -119,6 +151,8 @@ int CJSON_CDECL main(void)
     RUN_TEST(print_number_should_print_positive_integers);
     RUN_TEST(print_number_should_print_positive_reals);
     RUN_TEST(print_number_should_print_negative_reals);
+    RUN_TEST(print_number_should_print_shortest_round_trip);
+    RUN_TEST(print_number_should_print_floats_with_float_precision);
     RUN_TEST(print_number_should_print_non_number);
 
     return UNITY_END();
@@ -0,0 +1,177 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and BC_JSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+static void assert_parallel_matches_print(BC_JSON *item, int threads)
+{
+    char *printed = NULL;
+    char *parallel = NULL;
+
+    printed = BC_JSON_Print(item);
+    parallel = BC_JSON_PrintParallel(item, true, threads);
+    TEST_ASSERT_NOT_NULL(printed);
+    TEST_ASSERT_NOT_NULL(parallel);
+    TEST_ASSERT_EQUAL_STRING(printed, parallel);
+    BC_JSON_free(printed);
+    BC_JSON_free(parallel);
+
+    printed = BC_JSON_PrintUnformatted(item);
+    parallel = BC_JSON_PrintParallel(item, false, threads);
+    TEST_ASSERT_NOT_NULL(printed);
+    TEST_ASSERT_NOT_NULL(parallel);
+    TEST_ASSERT_EQUAL_STRING(printed, parallel);
+    BC_JSON_free(printed);
+    BC_JSON_free(parallel);
+}
+
+static BC_JSON *create_records(int count)
+{
+    BC_JSON *records = BC_JSON_CreateArray();
+    int i = 0;
+
+    TEST_ASSERT_NOT_NULL(records);
+    for (i = 0; i < count; i++)
+    {
+        BC_JSON *record = BC_JSON_CreateObject();
+        BC_JSON *tags = BC_JSON_CreateArray();
+
+        TEST_ASSERT_NOT_NULL(BC_JSON_AddNumberToObject(record, "id", i));
+        TEST_ASSERT_NOT_NULL(BC_JSON_AddStringToObject(record, "name", "escaped\t\"name\""));
+        TEST_ASSERT_TRUE(BC_JSON_AddItemToArray(tags, BC_JSON_CreateNumber(i / 7.0)));
+        TEST_ASSERT_TRUE(BC_JSON_AddItemToArray(tags, BC_JSON_CreateObject()));
+        TEST_ASSERT_TRUE(BC_JSON_AddItemToObject(record, "tags", tags));
+        TEST_ASSERT_TRUE(BC_JSON_AddItemToArray(records, record));
+    }
+
+    return records;
+}
+
+static void print_parallel_should_match_print_for_arrays(void)
+{
+    BC_JSON *records = create_records(3001);
+
+    assert_parallel_matches_print(records, 2);
+    assert_parallel_matches_print(records, 3);
+    assert_parallel_matches_print(records, 8);
+    assert_parallel_matches_print(records, 64);
+
+    BC_JSON_Delete(records);
+}
+
+static void print_parallel_should_match_print_for_objects(void)
+{
+    BC_JSON *object = BC_JSON_CreateObject();
+    char key[32];
+    int i = 0;
+
+    for (i = 0; i < 2000; i++)
+    {
+        sprintf(key, "key %d", i);
+        TEST_ASSERT_TRUE(BC_JSON_AddItemToObject(object, key, create_records(i % 3)));
+    }
+
+    assert_parallel_matches_print(object, 4);
+
+    BC_JSON_Delete(object);
+}
+
+static void print_parallel_should_split_nested_records(void)
+{
+    BC_JSON *document = BC_JSON_CreateObject();
+    BC_JSON *wrapper = BC_JSON_CreateArray();
+
+    /* {"data":[{"records":[...]}]} is split at the records */
+    TEST_ASSERT_TRUE(BC_JSON_AddItemToObject(document, "data", wrapper));
+    TEST_ASSERT_TRUE(BC_JSON_AddItemToArray(wrapper, BC_JSON_CreateObject()));
+    TEST_ASSERT_TRUE(BC_JSON_AddItemToObject(wrapper->child, "records", create_records(1000)));
+
+    assert_parallel_matches_print(document, 4);
+
+    BC_JSON_Delete(document);
+}
+
+static void print_parallel_should_print_small_items(void)
+{
+    const char *files[] = { "inputs/test1", "inputs/test2", "inputs/test3", "inputs/test4", "inputs/test5", "inputs/test7", "inputs/test8", "inputs/test9", "inputs/test10", "inputs/test11" };
+    BC_JSON *records = create_records(10);
+    BC_JSON *number = BC_JSON_CreateNumber(42);
+    size_t i = 0;
+
+    for (i = 0; i < (sizeof(files) / sizeof(files[0])); i++)
+    {
+        char *content = read_file(files[i]);
+        BC_JSON *item = NULL;
+
+        TEST_ASSERT_NOT_NULL_MESSAGE(content, files[i]);
+        item = BC_JSON_Parse(content);
+        TEST_ASSERT_NOT_NULL_MESSAGE(item, files[i]);
+
+        assert_parallel_matches_print(item, 4);
+
+        BC_JSON_Delete(item);
+        free(content);
+    }
+
+    assert_parallel_matches_print(records, 4);
+    assert_parallel_matches_print(number, 4);
+
+    BC_JSON_Delete(records);
+    BC_JSON_Delete(number);
+}
+
+static void print_parallel_should_fail_on_invalid_items(void)
+{
+    BC_JSON *records = create_records(2000);
+    BC_JSON invalid[1];
+    BC_JSON *element = NULL;
+
+    memset(invalid, 0, sizeof(invalid));
+    TEST_ASSERT_NULL(BC_JSON_PrintParallel(NULL, false, 4));
+
+    /* an element that can't be printed in the last run */
+    TEST_ASSERT_TRUE(BC_JSON_AddItemToArray(records, invalid));
+    TEST_ASSERT_NULL(BC_JSON_PrintParallel(records, true, 4));
+    element = BC_JSON_DetachItemViaPointer(records, invalid);
+    TEST_ASSERT_TRUE(element == invalid);
+
+    BC_JSON_Delete(records);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(print_parallel_should_match_print_for_arrays);
+    RUN_TEST(print_parallel_should_match_print_for_objects);
+    RUN_TEST(print_parallel_should_split_nested_records);
+    RUN_TEST(print_parallel_should_print_small_items);
+    RUN_TEST(print_parallel_should_fail_on_invalid_items);
+
+    return UNITY_END();
+}
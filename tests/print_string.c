@@ -27,7 +27,7 @@
 static void assert_print_string(const char *expected, const char *input)
 {
     unsigned char printed[1024];
-    printbuffer buffer = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 } };
+    printbuffer buffer = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0 };
     buffer.buffer = printed;
     buffer.length = sizeof(printed);
     buffer.offset = 0;
@@ -65,6 +65,39 @@ static void print_string_should_print_utf8(void)
     assert_print_string("\"ü猫慕\"", "ü猫慕");
 }
 
+static void print_string_should_escape_at_every_position(void)
+{
+    /* the characters to escape land at the start, in the middle and at the end of the blocks
+     * that strings are scanned in, and in the tail after the last block */
+    const char *escaped[] = { "\"", "\\", "\n", "\x01", "\x1f" };
+    const char *sequences[] = { "\\\"", "\\\\", "\\n", "\\u0001", "\\u001f" };
+    char input[80];
+    char expected[100];
+    size_t position = 0;
+    size_t i = 0;
+
+    for (i = 0; i < (sizeof(escaped) / sizeof(escaped[0])); i++)
+    {
+        for (position = 0; position < 70; position++)
+        {
+            memset(input, 'x', 70);
+            input[70] = '\0';
+            input[position] = escaped[i][0];
+
+            expected[0] = '\"';
+            memset(expected + 1, 'x', position);
+            strcpy(expected + 1 + position, sequences[i]);
+            memset(expected + strlen(expected), 'x', 69 - position);
+            strcpy(expected + 1 + position + strlen(sequences[i]) + 69 - position, "\"");
+
+            assert_print_string(expected, input);
+        }
+    }
+
+    /* high bytes and DEL are printed as they are */
+    assert_print_string("\"\x7f\x80\xff\x7f\x80\xff\x7f\x80\xff\x7f\x80\xff\x7f\x80\xff\x7f\x80\xff\"", "\x7f\x80\xff\x7f\x80\xff\x7f\x80\xff\x7f\x80\xff\x7f\x80\xff\x7f\x80\xff");
+}
+
 int CJSON_CDECL main(void)
 {
     /* initialize BC_JSON item */
@@ -73,6 +106,7 @@ int CJSON_CDECL main(void)
     RUN_TEST(print_string_should_print_empty_strings);
     RUN_TEST(print_string_should_print_ascii);
     RUN_TEST(print_string_should_print_utf8);
+    RUN_TEST(print_string_should_escape_at_every_position);
 
     return UNITY_END();
 }
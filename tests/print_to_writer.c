@@ -0,0 +1,256 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and BC_JSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+typedef struct
+{
+    char *text;
+    size_t length;
+    size_t capacity;
+    size_t calls;
+    size_t largest_write;
+    /* how many bytes are taken per call, 0 for all of them */
+    size_t take_at_most;
+    /* the writer fails once this many bytes are written, 0 to never fail */
+    size_t fail_after;
+    BC_JSON_bool failed;
+} collector;
+
+static size_t collect(void *context, const char *data, size_t length)
+{
+    collector *output = (collector*)context;
+
+    TEST_ASSERT_NOT_NULL(data);
+    TEST_ASSERT_TRUE(length > 0);
+    TEST_ASSERT_FALSE_MESSAGE(output->failed, "Written to after a failed write.");
+
+    output->calls++;
+    if (length > output->largest_write)
+    {
+        output->largest_write = length;
+    }
+    if ((output->fail_after != 0) && ((output->length + length) > output->fail_after))
+    {
+        output->failed = true;
+        return 0;
+    }
+    if ((output->take_at_most != 0) && (length > output->take_at_most))
+    {
+        length = output->take_at_most;
+    }
+
+    if ((output->length + length + 1) > output->capacity)
+    {
+        output->capacity = (output->length + length + 1) * 2;
+        output->text = (char*)realloc(output->text, output->capacity);
+        TEST_ASSERT_NOT_NULL(output->text);
+    }
+    memcpy(output->text + output->length, data, length);
+    output->length += length;
+    output->text[output->length] = '\0';
+
+    return length;
+}
+
+static void assert_writer_matches_print(BC_JSON *item, BC_JSON_bool format, size_t chunk_size, size_t take_at_most)
+{
+    collector output;
+    char *printed = format ? BC_JSON_Print(item) : BC_JSON_PrintUnformatted(item);
+
+    memset(&output, 0, sizeof(output));
+    output.take_at_most = take_at_most;
+
+    TEST_ASSERT_NOT_NULL(printed);
+    TEST_ASSERT_TRUE(BC_JSON_PrintToWriter(item, format, collect, &output, chunk_size));
+    TEST_ASSERT_EQUAL_UINT(strlen(printed), output.length);
+    TEST_ASSERT_EQUAL_STRING(printed, output.text);
+
+    free(output.text);
+    BC_JSON_free(printed);
+}
+
+static void print_to_writer_should_match_print(void)
+{
+    const char *files[] = { "inputs/test1", "inputs/test2", "inputs/test3", "inputs/test4", "inputs/test5", "inputs/test7", "inputs/test8", "inputs/test9", "inputs/test10", "inputs/test11" };
+    const size_t chunk_sizes[] = { 0, 1, 7, 26, 64, 4096 };
+    size_t i = 0;
+    size_t j = 0;
+
+    for (i = 0; i < (sizeof(files) / sizeof(files[0])); i++)
+    {
+        char *content = read_file(files[i]);
+        BC_JSON *item = NULL;
+
+        TEST_ASSERT_NOT_NULL_MESSAGE(content, files[i]);
+        item = BC_JSON_Parse(content);
+        TEST_ASSERT_NOT_NULL_MESSAGE(item, files[i]);
+
+        for (j = 0; j < (sizeof(chunk_sizes) / sizeof(chunk_sizes[0])); j++)
+        {
+            assert_writer_matches_print(item, false, chunk_sizes[j], 0);
+            assert_writer_matches_print(item, true, chunk_sizes[j], 0);
+        }
+
+        BC_JSON_Delete(item);
+        free(content);
+    }
+}
+
+static void print_to_writer_should_pass_long_strings_through(void)
+{
+    char long_string[1000];
+    BC_JSON *item = BC_JSON_CreateArray();
+    collector output;
+
+    memset(long_string, 'x', sizeof(long_string) - 1);
+    long_string[sizeof(long_string) - 1] = '\0';
+    long_string[500] = '\n';
+    long_string[700] = '\1';
+    TEST_ASSERT_TRUE(BC_JSON_AddItemToArray(item, BC_JSON_CreateString(long_string)));
+    TEST_ASSERT_TRUE(BC_JSON_AddItemToArray(item, BC_JSON_CreateRaw(long_string + 710)));
+    TEST_ASSERT_TRUE(BC_JSON_AddItemToArray(item, BC_JSON_CreateString("short")));
+
+    assert_writer_matches_print(item, false, 64, 0);
+    assert_writer_matches_print(item, true, 64, 0);
+
+    /* only the runs without escapes are written straight from the string, everything else fits the chunk */
+    memset(&output, 0, sizeof(output));
+    TEST_ASSERT_TRUE(BC_JSON_PrintToWriter(item, false, collect, &output, 64));
+    TEST_ASSERT_EQUAL_UINT(500, output.largest_write);
+
+    free(output.text);
+    BC_JSON_Delete(item);
+}
+
+static void print_to_writer_should_write_what_the_writer_takes_again(void)
+{
+    char *content = read_file("inputs/test7");
+    BC_JSON *item = NULL;
+
+    TEST_ASSERT_NOT_NULL(content);
+    item = BC_JSON_Parse(content);
+    TEST_ASSERT_NOT_NULL(item);
+
+    assert_writer_matches_print(item, true, 64, 1);
+    assert_writer_matches_print(item, false, 0, 3);
+
+    BC_JSON_Delete(item);
+    free(content);
+}
+
+static void print_to_writer_should_fail_when_the_writer_fails(void)
+{
+    char *content = read_file("inputs/test7");
+    BC_JSON *item = NULL;
+    collector output;
+
+    TEST_ASSERT_NOT_NULL(content);
+    item = BC_JSON_Parse(content);
+    TEST_ASSERT_NOT_NULL(item);
+
+    memset(&output, 0, sizeof(output));
+    output.fail_after = 100;
+    TEST_ASSERT_FALSE(BC_JSON_PrintToWriter(item, true, collect, &output, 32));
+    /* printing stops at the first failed write */
+    TEST_ASSERT_TRUE(output.failed);
+    TEST_ASSERT_TRUE(output.length <= 100);
+
+    free(output.text);
+    BC_JSON_Delete(item);
+    free(content);
+}
+
+static void print_to_writer_should_fail_on_invalid_arguments(void)
+{
+    BC_JSON invalid[1];
+    BC_JSON *item = BC_JSON_CreateTrue();
+    collector output;
+
+    memset(invalid, 0, sizeof(invalid));
+    memset(&output, 0, sizeof(output));
+
+    TEST_ASSERT_FALSE(BC_JSON_PrintToWriter(NULL, false, collect, &output, 0));
+    TEST_ASSERT_FALSE(BC_JSON_PrintToWriter(item, false, NULL, &output, 0));
+    TEST_ASSERT_FALSE(BC_JSON_PrintToWriter(invalid, false, collect, &output, 0));
+    TEST_ASSERT_EQUAL_UINT(0, output.calls);
+
+    BC_JSON_Delete(item);
+}
+
+static size_t allocated = 0;
+static size_t allocations = 0;
+
+static void * CJSON_CDECL counting_malloc(size_t size)
+{
+    allocations++;
+    allocated += size;
+    return malloc(size);
+}
+
+static void print_to_writer_should_only_allocate_the_chunk(void)
+{
+    BC_JSON_Hooks hooks = { counting_malloc, free };
+    BC_JSON *item = BC_JSON_CreateArray();
+    collector output;
+    int i = 0;
+
+    for (i = 0; i < 10000; i++)
+    {
+        BC_JSON *element = BC_JSON_CreateObject();
+        TEST_ASSERT_NOT_NULL(BC_JSON_AddNumberToObject(element, "number", i / 7.0));
+        TEST_ASSERT_NOT_NULL(BC_JSON_AddStringToObject(element, "string", "escaped\t\"text\""));
+        TEST_ASSERT_TRUE(BC_JSON_AddItemToArray(item, element));
+    }
+
+    memset(&output, 0, sizeof(output));
+    BC_JSON_InitHooks(&hooks);
+    TEST_ASSERT_TRUE(BC_JSON_PrintToWriter(item, true, collect, &output, 256));
+    BC_JSON_InitHooks(NULL);
+    TEST_ASSERT_EQUAL_UINT(1, allocations);
+    TEST_ASSERT_EQUAL_UINT(256, allocated);
+    TEST_ASSERT_TRUE(output.largest_write < 256);
+
+    free(output.text);
+    assert_writer_matches_print(item, true, 256, 0);
+    BC_JSON_Delete(item);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(print_to_writer_should_match_print);
+    RUN_TEST(print_to_writer_should_pass_long_strings_through);
+    RUN_TEST(print_to_writer_should_write_what_the_writer_takes_again);
+    RUN_TEST(print_to_writer_should_fail_when_the_writer_fails);
+    RUN_TEST(print_to_writer_should_fail_on_invalid_arguments);
+    RUN_TEST(print_to_writer_should_only_allocate_the_chunk);
+
+    return UNITY_END();
+}
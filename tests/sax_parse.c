@@ -0,0 +1,396 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and BC_JSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+/* builds a tree from the events, to compare it with the one BC_JSON_Parse builds */
+typedef struct
+{
+    BC_JSON *root;
+    BC_JSON *containers[64];
+    size_t depth;
+    char key[256];
+} tree_builder;
+
+static int add_value(tree_builder *builder, BC_JSON *value)
+{
+    TEST_ASSERT_NOT_NULL(value);
+    if (builder->depth == 0)
+    {
+        TEST_ASSERT_NULL(builder->root);
+        builder->root = value;
+    }
+    else if (BC_JSON_IsObject(builder->containers[builder->depth - 1]))
+    {
+        TEST_ASSERT_TRUE(BC_JSON_AddItemToObject(builder->containers[builder->depth - 1], builder->key, value));
+    }
+    else
+    {
+        TEST_ASSERT_TRUE(BC_JSON_AddItemToArray(builder->containers[builder->depth - 1], value));
+    }
+
+    return BC_JSON_SaxContinue;
+}
+
+static int start_container(tree_builder *builder, BC_JSON *container)
+{
+    add_value(builder, container);
+    TEST_ASSERT_TRUE(builder->depth < (sizeof(builder->containers) / sizeof(builder->containers[0])));
+    builder->containers[builder->depth++] = container;
+
+    return BC_JSON_SaxContinue;
+}
+
+static int build_start_object(void *context)
+{
+    return start_container((tree_builder*)context, BC_JSON_CreateObject());
+}
+
+static int build_start_array(void *context)
+{
+    return start_container((tree_builder*)context, BC_JSON_CreateArray());
+}
+
+static int build_end(void *context)
+{
+    tree_builder *builder = (tree_builder*)context;
+
+    TEST_ASSERT_TRUE(builder->depth > 0);
+    builder->depth--;
+
+    return BC_JSON_SaxContinue;
+}
+
+static int build_key(void *context, const char *key, size_t length)
+{
+    tree_builder *builder = (tree_builder*)context;
+
+    TEST_ASSERT_TRUE(length < sizeof(builder->key));
+    memcpy(builder->key, key, length);
+    builder->key[length] = '\0';
+
+    return BC_JSON_SaxContinue;
+}
+
+static int build_string(void *context, const char *string, size_t length)
+{
+    char copy[1024];
+
+    TEST_ASSERT_TRUE(length < sizeof(copy));
+    memcpy(copy, string, length);
+    copy[length] = '\0';
+
+    return add_value((tree_builder*)context, BC_JSON_CreateString(copy));
+}
+
+static int build_number(void *context, double number)
+{
+    return add_value((tree_builder*)context, BC_JSON_CreateNumber(number));
+}
+
+static int build_boolean(void *context, BC_JSON_bool value)
+{
+    return add_value((tree_builder*)context, BC_JSON_CreateBool(value));
+}
+
+static int build_null(void *context)
+{
+    return add_value((tree_builder*)context, BC_JSON_CreateNull());
+}
+
+static const BC_JSON_SaxHandlers builder_handlers = {
+    build_start_object,
+    build_end,
+    build_start_array,
+    build_end,
+    build_key,
+    build_string,
+    build_number,
+    build_boolean,
+    build_null
+};
+
+/* writes the events into a string, one character (and the text of strings/keys) per event */
+typedef struct
+{
+    char events[256];
+    /* what the handler for a key/object/array with this text or character returns */
+    const char *action_on;
+    int action;
+} event_log;
+
+static int log_event(event_log *log, const char *text, size_t length)
+{
+    int action = BC_JSON_SaxContinue;
+    size_t used = strlen(log->events);
+
+    TEST_ASSERT_TRUE(used + length < sizeof(log->events));
+    memcpy(log->events + used, text, length);
+    log->events[used + length] = '\0';
+
+    if ((log->action_on != NULL) && (strlen(log->action_on) == length) && (memcmp(log->action_on, text, length) == 0))
+    {
+        action = log->action;
+    }
+
+    return action;
+}
+
+static int log_start_object(void *context)
+{
+    return log_event((event_log*)context, "{", 1);
+}
+
+static int log_end_object(void *context)
+{
+    return log_event((event_log*)context, "}", 1);
+}
+
+static int log_start_array(void *context)
+{
+    return log_event((event_log*)context, "[", 1);
+}
+
+static int log_end_array(void *context)
+{
+    return log_event((event_log*)context, "]", 1);
+}
+
+static int log_string(void *context, const char *string, size_t length)
+{
+    return log_event((event_log*)context, string, length);
+}
+
+static int log_number(void *context, double number)
+{
+    char printed[32];
+
+    sprintf(printed, "%g", number);
+
+    return log_event((event_log*)context, printed, strlen(printed));
+}
+
+static int log_boolean(void *context, BC_JSON_bool value)
+{
+    return log_event((event_log*)context, value ? "t" : "f", 1);
+}
+
+static int log_null(void *context)
+{
+    return log_event((event_log*)context, "n", 1);
+}
+
+static const BC_JSON_SaxHandlers log_handlers = {
+    log_start_object,
+    log_end_object,
+    log_start_array,
+    log_end_array,
+    log_string,
+    log_string,
+    log_number,
+    log_boolean,
+    log_null
+};
+
+static void assert_events(const char *expected, const char *json, const char *action_on, int action)
+{
+    event_log log;
+
+    log.events[0] = '\0';
+    log.action_on = action_on;
+    log.action = action;
+
+    TEST_ASSERT_TRUE(BC_JSON_SaxParse(json, strlen(json), &log_handlers, &log));
+    TEST_ASSERT_EQUAL_STRING(expected, log.events);
+}
+
+static void assert_sax_matches_parse(const char *json)
+{
+    tree_builder builder;
+    BC_JSON *expected = BC_JSON_Parse(json);
+
+    memset(&builder, 0, sizeof(builder));
+    TEST_ASSERT_NOT_NULL_MESSAGE(expected, json);
+
+    TEST_ASSERT_TRUE_MESSAGE(BC_JSON_SaxParse(json, strlen(json) + sizeof(""), &builder_handlers, &builder), json);
+    TEST_ASSERT_EQUAL_UINT(0, (unsigned int)builder.depth);
+    TEST_ASSERT_TRUE_MESSAGE(BC_JSON_Compare(expected, builder.root, true), "The events don't describe the parsed tree.");
+
+    BC_JSON_Delete(builder.root);
+    BC_JSON_Delete(expected);
+}
+
+static void sax_parse_should_report_the_parsed_tree(void)
+{
+    const char *files[] = { "inputs/test1", "inputs/test2", "inputs/test3", "inputs/test4", "inputs/test5", "inputs/test7", "inputs/test8", "inputs/test9", "inputs/test10", "inputs/test11" };
+    size_t i = 0;
+
+    for (i = 0; i < (sizeof(files) / sizeof(files[0])); i++)
+    {
+        char *content = read_file(files[i]);
+
+        TEST_ASSERT_NOT_NULL_MESSAGE(content, files[i]);
+        assert_sax_matches_parse(content);
+        free(content);
+    }
+
+    assert_sax_matches_parse("\"string\"");
+    assert_sax_matches_parse("-1.5e3");
+    assert_sax_matches_parse("[[], {}, [[]], {\"a\": {}}]");
+    assert_sax_matches_parse("\xEF\xBB\xBF {\"bom\": true} trailing text");
+}
+
+static void sax_parse_should_unescape_only_strings_with_escapes(void)
+{
+    const char json[] = "[\"plain\", \"tab\\there\", \"\\u00fc\\ud83d\\ude00\"]";
+    assert_events("[plaintab\there\xC3\xBC\xF0\x9F\x98\x80]", json, NULL, BC_JSON_SaxContinue);
+}
+
+static const char *first_string = NULL;
+
+static int remember_string(void *context, const char *string, size_t length)
+{
+    (void)context;
+    (void)length;
+    if (first_string == NULL)
+    {
+        first_string = string;
+    }
+
+    return BC_JSON_SaxContinue;
+}
+
+static void sax_parse_should_point_into_the_input(void)
+{
+    const char json[] = "[\"plain\"]";
+    BC_JSON_SaxHandlers handlers;
+
+    memset(&handlers, 0, sizeof(handlers));
+    handlers.string = remember_string;
+    first_string = NULL;
+
+    TEST_ASSERT_TRUE(BC_JSON_SaxParse(json, sizeof(json), &handlers, NULL));
+    TEST_ASSERT_TRUE(first_string == json + 2);
+}
+
+static void sax_parse_should_skip(void)
+{
+    const char json[] = "{\"a\": [1, {\"b\": 2}], \"c\": {\"d\": [3]}, \"e\": 4}";
+
+    assert_events("{a[1{b2}]c{d[3]}e4}", json, NULL, BC_JSON_SaxContinue);
+    /* the contents of an array/object, its end is still reported */
+    assert_events("{a[]c{d[]}e4}", json, "[", BC_JSON_SaxSkip);
+    assert_events("[1{}2]", "[1, {\"b\": [2]}, 2]", "{", BC_JSON_SaxSkip);
+    /* the value of a member */
+    assert_events("{a[1{b2}]ce4}", json, "c", BC_JSON_SaxSkip);
+    assert_events("{a[1{b2}]c{d[3]}e}", json, "e", BC_JSON_SaxSkip);
+    /* skipping from other handlers does nothing */
+    assert_events("{a[1{b2}]c{d[3]}e4}", json, "2", BC_JSON_SaxSkip);
+}
+
+static void sax_parse_should_stop(void)
+{
+    const char json[] = "{\"a\": [1, {\"b\": 2}], \"c\": {\"d\": [3]}, \"e\": 4}";
+
+    assert_events("{a[1{b", json, "b", BC_JSON_SaxStop);
+    assert_events("{a[1{b2}]", json, "]", BC_JSON_SaxStop);
+    assert_events("{", json, "{", BC_JSON_SaxStop);
+
+    /* what follows the stop isn't checked */
+    assert_events("[1", "[1, }", "1", BC_JSON_SaxStop);
+}
+
+static void sax_parse_should_fail_like_parse(void)
+{
+    const char empty[] = "[]";
+    const char *invalid[] = { "", "[", "{", "[1,]", "{\"a\":}", "{\"a\" 1}", "{1: 2}", "[\"\\x\"]", "[\"unterminated]", "nul", "[1 2]", "{\"a\": 1,}", "-", "]" };
+    BC_JSON_SaxHandlers handlers;
+    size_t i = 0;
+
+    memset(&handlers, 0, sizeof(handlers));
+
+    for (i = 0; i < (sizeof(invalid) / sizeof(invalid[0])); i++)
+    {
+        TEST_ASSERT_NULL_MESSAGE(BC_JSON_ParseWithLength(invalid[i], strlen(invalid[i]) + sizeof("")), invalid[i]);
+        TEST_ASSERT_FALSE_MESSAGE(BC_JSON_SaxParse(invalid[i], strlen(invalid[i]) + sizeof(""), &handlers, NULL), invalid[i]);
+        TEST_ASSERT_NOT_NULL(BC_JSON_GetErrorPtr());
+    }
+
+    TEST_ASSERT_FALSE(BC_JSON_SaxParse(NULL, 1, &handlers, NULL));
+    TEST_ASSERT_FALSE(BC_JSON_SaxParse("[]", 2, NULL, NULL));
+    TEST_ASSERT_NULL(BC_JSON_ParseWithLength(empty, 0));
+    TEST_ASSERT_EQUAL_PTR(empty, BC_JSON_GetErrorPtr());
+    TEST_ASSERT_FALSE(BC_JSON_SaxParse(empty, 0, &handlers, NULL));
+    TEST_ASSERT_EQUAL_PTR(empty, BC_JSON_GetErrorPtr());
+}
+
+static void sax_parse_should_report_errors_where_parse_does(void)
+{
+    const char *invalid[] = { "[\"abc", "\"abc", "{\"abc", "{\"a\": \"b", "[\"a\\", "[\"a\\x\"]", "[\"ab\\n\\q\"]", "{\"a\\x\": 1}", "[\"\\u12\"]", "[\"\\ud800\\x\"]", "{1: 2}", "{\"a\": 1, 2}" };
+    BC_JSON_SaxHandlers handlers;
+    const char *parse_error = NULL;
+    size_t i = 0;
+
+    memset(&handlers, 0, sizeof(handlers));
+
+    for (i = 0; i < (sizeof(invalid) / sizeof(invalid[0])); i++)
+    {
+        TEST_ASSERT_NULL_MESSAGE(BC_JSON_ParseWithLength(invalid[i], strlen(invalid[i]) + sizeof("")), invalid[i]);
+        parse_error = BC_JSON_GetErrorPtr();
+        TEST_ASSERT_FALSE_MESSAGE(BC_JSON_SaxParse(invalid[i], strlen(invalid[i]) + sizeof(""), &handlers, NULL), invalid[i]);
+        TEST_ASSERT_EQUAL_UINT_MESSAGE(parse_error - invalid[i], BC_JSON_GetErrorPtr() - invalid[i], invalid[i]);
+    }
+}
+
+static void sax_parse_should_also_check_skipped_values(void)
+{
+    event_log log;
+
+    log.events[0] = '\0';
+    log.action_on = "[";
+    log.action = BC_JSON_SaxSkip;
+
+    TEST_ASSERT_FALSE(BC_JSON_SaxParse("[1, {\"a\" 2}]", 13, &log_handlers, &log));
+    TEST_ASSERT_FALSE(BC_JSON_SaxParse("[1, \"\\q\"]", 10, &log_handlers, &log));
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(sax_parse_should_report_the_parsed_tree);
+    RUN_TEST(sax_parse_should_unescape_only_strings_with_escapes);
+    RUN_TEST(sax_parse_should_point_into_the_input);
+    RUN_TEST(sax_parse_should_skip);
+    RUN_TEST(sax_parse_should_stop);
+    RUN_TEST(sax_parse_should_fail_like_parse);
+    RUN_TEST(sax_parse_should_report_errors_where_parse_does);
+    RUN_TEST(sax_parse_should_also_check_skipped_values);
+
+    return UNITY_END();
+}
@@ -0,0 +1,318 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and BC_JSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+static BC_JSON *parse_with_cache(const char *json, BC_JSON_ShapeCache *cache)
+{
+    BC_JSON_ParseOptions options;
+    BC_JSON *expected = NULL;
+    BC_JSON *parsed = NULL;
+
+    memset(&options, '\0', sizeof(options));
+    options.shape_cache = cache;
+
+    parsed = BC_JSON_ParseWithOptions(json, strlen(json) + sizeof(""), &options, NULL);
+    TEST_ASSERT_NOT_NULL(parsed);
+
+    expected = BC_JSON_Parse(json);
+    TEST_ASSERT_NOT_NULL(expected);
+    TEST_ASSERT_TRUE_MESSAGE(BC_JSON_Compare(expected, parsed, true), "Parsing with a shape cache changed the result.");
+    BC_JSON_Delete(expected);
+
+    return parsed;
+}
+
+static void shape_cache_should_share_keys_between_objects(void)
+{
+    BC_JSON_ShapeCache *cache = BC_JSON_CreateShapeCache();
+    BC_JSON *first = NULL;
+    BC_JSON *second = NULL;
+    BC_JSON *first_member = NULL;
+    BC_JSON *second_member = NULL;
+
+    TEST_ASSERT_NOT_NULL(cache);
+
+    first = parse_with_cache("[{\"id\": 1, \"name\": \"a\"}, {\"id\": 2, \"name\": \"b\"}]", cache);
+    second = parse_with_cache("{\"id\": 3, \"name\": \"c\"}", cache);
+
+    first_member = BC_JSON_GetArrayItem(first, 1)->child;
+    second_member = second->child;
+    TEST_ASSERT_TRUE(first_member->type & BC_JSON_StringIsConst);
+    TEST_ASSERT_TRUE(first_member->type & BC_JSON_StringIsInterned);
+    TEST_ASSERT_TRUE(BC_JSON_IsNumber(first_member));
+    TEST_ASSERT_TRUE(first_member->string == second_member->string);
+    TEST_ASSERT_TRUE(first_member->next->string == second_member->next->string);
+    TEST_ASSERT_TRUE(BC_JSON_GetArrayItem(first, 0)->child->string == first_member->string);
+
+    BC_JSON_Delete(first);
+    BC_JSON_Delete(second);
+    BC_JSON_DeleteShapeCache(cache);
+}
+
+static void shape_cache_should_find_members_by_slot(void)
+{
+    const char duplicates[] = "{\"a\": 1, \"b\": 2, \"c\": 3, \"b\": 4, \"d\": 5}";
+    BC_JSON_ShapeCache *cache = BC_JSON_CreateShapeCache();
+    BC_JSON_ParseOptions options;
+    BC_JSON *object = NULL;
+    BC_JSON *prefix = NULL;
+
+    TEST_ASSERT_NOT_NULL(cache);
+    memset(&options, '\0', sizeof(options));
+    options.shape_cache = cache;
+
+    /* an object whose keys are a prefix of another object's keys has a shape of its own */
+    prefix = parse_with_cache("{\"a\": 0, \"b\": 0}", cache);
+    object = parse_with_cache("{\"a\": 1, \"b\": 2, \"c\": 3, \"d\": 5}", cache);
+
+    TEST_ASSERT_EQUAL_DOUBLE(1, BC_JSON_GetObjectItemCaseSensitive(object, "a")->value_number);
+    TEST_ASSERT_EQUAL_DOUBLE(2, BC_JSON_GetObjectItemCaseSensitive(object, "b")->value_number);
+    TEST_ASSERT_EQUAL_DOUBLE(3, BC_JSON_GetObjectItemCaseSensitive(object, "c")->value_number);
+    TEST_ASSERT_EQUAL_DOUBLE(5, BC_JSON_GetObjectItemCaseSensitive(object, "d")->value_number);
+    TEST_ASSERT_NULL(BC_JSON_GetObjectItemCaseSensitive(object, "e"));
+    TEST_ASSERT_NULL(BC_JSON_GetObjectItemCaseSensitive(object, "A"));
+    TEST_ASSERT_EQUAL_DOUBLE(1, BC_JSON_GetObjectItem(object, "A")->value_number);
+
+    TEST_ASSERT_NOT_NULL(BC_JSON_GetObjectItemCaseSensitive(prefix, "b"));
+    TEST_ASSERT_NULL(BC_JSON_GetObjectItemCaseSensitive(prefix, "c"));
+
+    /* the first of duplicate keys is found */
+    BC_JSON_Delete(object);
+    object = BC_JSON_ParseWithOptions(duplicates, sizeof(duplicates), &options, NULL);
+    TEST_ASSERT_NOT_NULL(object);
+    TEST_ASSERT_EQUAL_DOUBLE(2, BC_JSON_GetObjectItemCaseSensitive(object, "b")->value_number);
+    TEST_ASSERT_EQUAL_DOUBLE(5, BC_JSON_GetObjectItemCaseSensitive(object, "d")->value_number);
+
+    BC_JSON_Delete(prefix);
+    BC_JSON_Delete(object);
+    BC_JSON_DeleteShapeCache(cache);
+}
+
+static void shape_cache_should_handle_changed_objects(void)
+{
+    BC_JSON_ShapeCache *cache = BC_JSON_CreateShapeCache();
+    BC_JSON *object = NULL;
+
+    TEST_ASSERT_NOT_NULL(cache);
+
+    object = parse_with_cache("{\"a\": 1, \"b\": 2, \"c\": 3}", cache);
+
+    BC_JSON_DeleteItemFromObjectCaseSensitive(object, "a");
+    TEST_ASSERT_NULL(BC_JSON_GetObjectItemCaseSensitive(object, "a"));
+    TEST_ASSERT_EQUAL_DOUBLE(3, BC_JSON_GetObjectItemCaseSensitive(object, "c")->value_number);
+
+    TEST_ASSERT_NOT_NULL(BC_JSON_AddNumberToObject(object, "a", 4));
+    TEST_ASSERT_EQUAL_DOUBLE(4, BC_JSON_GetObjectItemCaseSensitive(object, "a")->value_number);
+
+    TEST_ASSERT_TRUE(BC_JSON_ReplaceItemInObjectCaseSensitive(object, "b", BC_JSON_CreateNumber(5)));
+    TEST_ASSERT_FALSE(BC_JSON_GetObjectItemCaseSensitive(object, "b")->type & BC_JSON_StringIsInterned);
+    TEST_ASSERT_EQUAL_DOUBLE(5, BC_JSON_GetObjectItemCaseSensitive(object, "b")->value_number);
+
+    /* moving a member into an object with another shape */
+    BC_JSON_Delete(object);
+    object = parse_with_cache("{\"x\": 1, \"y\": 2}", cache);
+    TEST_ASSERT_TRUE(BC_JSON_AddItemToArray(object, BC_JSON_DetachItemFromObjectCaseSensitive(object, "x")));
+    TEST_ASSERT_EQUAL_DOUBLE(1, BC_JSON_GetObjectItemCaseSensitive(object, "x")->value_number);
+    TEST_ASSERT_EQUAL_DOUBLE(2, BC_JSON_GetObjectItemCaseSensitive(object, "y")->value_number);
+
+    BC_JSON_Delete(object);
+    BC_JSON_DeleteShapeCache(cache);
+}
+
+static void shape_cache_should_index_objects_while_parsing(void)
+{
+    BC_JSON_ShapeCache *cache = BC_JSON_CreateShapeCache();
+    BC_JSON *object = NULL;
+    BC_JSON *copy = NULL;
+    BC_JSON *reference = NULL;
+    object_shape *shape = NULL;
+    size_t *slots = NULL;
+
+    TEST_ASSERT_NOT_NULL(cache);
+
+    object = parse_with_cache("{\"a\": 1, \"b\": 2, \"c\": 3}", cache);
+
+    /* the slot table and the member table exist before the first lookup, a lookup writes neither */
+    shape = interned_key_header(object->child->prev->string)->shape;
+    TEST_ASSERT_NOT_NULL(shape);
+    TEST_ASSERT_NOT_NULL(shape->slots);
+    TEST_ASSERT_TRUE(has_container_index(object));
+    TEST_ASSERT_EQUAL_UINT(3, container_index_of(object)->count);
+    slots = shape->slots;
+    TEST_ASSERT_EQUAL_DOUBLE(2, BC_JSON_GetObjectItemCaseSensitive(object, "b")->value_number);
+    TEST_ASSERT_TRUE(slots == shape->slots);
+
+    /* copies and references don't share the table */
+    copy = BC_JSON_Duplicate(object, true);
+    TEST_ASSERT_NOT_NULL(copy);
+    TEST_ASSERT_FALSE(has_container_index(copy));
+    TEST_ASSERT_EQUAL_DOUBLE(3, BC_JSON_GetObjectItemCaseSensitive(copy, "c")->value_number);
+    reference = BC_JSON_CreateObjectReference(object->child);
+    TEST_ASSERT_NOT_NULL(reference);
+    BC_JSON_Delete(reference);
+
+    /* changing the members drops the table */
+    BC_JSON_Delete(BC_JSON_DetachItemViaPointer(object, object->child->next));
+    TEST_ASSERT_FALSE(has_container_index(object));
+    TEST_ASSERT_NULL(BC_JSON_GetObjectItemCaseSensitive(object, "b"));
+    BC_JSON_Delete(object);
+
+    /* swapping keys directly needs BC_JSON_MarkChanged */
+    object = parse_with_cache("{\"a\": 1, \"b\": 2, \"c\": 3}", cache);
+    TEST_ASSERT_TRUE(has_container_index(object));
+    object->child->next->string = object->child->prev->string;
+    object->child->prev->string = shape_key(shape->parent);
+    BC_JSON_MarkChanged(object);
+    TEST_ASSERT_FALSE(has_container_index(object));
+    TEST_ASSERT_EQUAL_DOUBLE(2, BC_JSON_GetObjectItemCaseSensitive(object, "c")->value_number);
+    TEST_ASSERT_EQUAL_DOUBLE(3, BC_JSON_GetObjectItemCaseSensitive(object, "b")->value_number);
+
+    BC_JSON_Delete(copy);
+    BC_JSON_Delete(object);
+    BC_JSON_DeleteShapeCache(cache);
+}
+
+static void shape_cache_should_keep_the_index_apart_from_the_members(void)
+{
+    BC_JSON_ShapeCache *cache = BC_JSON_CreateShapeCache();
+    BC_JSON *object = NULL;
+    BC_JSON *added = NULL;
+    BC_JSON *replaced = NULL;
+    BC_JSON *replacement = NULL;
+
+    TEST_ASSERT_NOT_NULL(cache);
+
+    /* the value_string of an object belongs to the caller, not to the index */
+    object = parse_with_cache("{\"a\": 1, \"b\": 2, \"c\": 3}", cache);
+    TEST_ASSERT_TRUE(has_container_index(object));
+    TEST_ASSERT_NULL(object->value_string);
+    object->value_string = (char*)BC_JSON_strdup((const unsigned char*)"note", &global_hooks);
+    TEST_ASSERT_EQUAL_DOUBLE(2, BC_JSON_GetObjectItemCaseSensitive(object, "b")->value_number);
+    BC_JSON_MarkChanged(object);
+    TEST_ASSERT_FALSE(has_container_index(object));
+    TEST_ASSERT_EQUAL_STRING("note", object->value_string);
+    BC_JSON_Delete(object);
+
+    /* members linked in by hand are found without BC_JSON_MarkChanged */
+    object = parse_with_cache("{\"a\": 1, \"b\": 2, \"c\": 3}", cache);
+    TEST_ASSERT_TRUE(has_container_index(object));
+    added = BC_JSON_CreateNumber(4);
+    TEST_ASSERT_NOT_NULL(added);
+    added->string = (char*)BC_JSON_strdup((const unsigned char*)"d", &global_hooks);
+    added->prev = object->child->prev;
+    object->child->prev->next = added;
+    object->child->prev = added;
+    TEST_ASSERT_EQUAL_INT(4, BC_JSON_GetArraySize(object));
+    TEST_ASSERT_TRUE(BC_JSON_GetArrayItem(object, 3) == added);
+    TEST_ASSERT_TRUE(BC_JSON_GetObjectItemCaseSensitive(object, "d") == added);
+    TEST_ASSERT_EQUAL_DOUBLE(3, BC_JSON_GetObjectItemCaseSensitive(object, "c")->value_number);
+    BC_JSON_Delete(object);
+
+    /* and so is a member replaced by hand */
+    object = parse_with_cache("{\"a\": 1, \"b\": 2, \"c\": 3}", cache);
+    TEST_ASSERT_TRUE(has_container_index(object));
+    replaced = object->child->next;
+    replacement = BC_JSON_CreateNumber(5);
+    TEST_ASSERT_NOT_NULL(replacement);
+    replacement->string = (char*)BC_JSON_strdup((const unsigned char*)"b", &global_hooks);
+    replacement->prev = replaced->prev;
+    replacement->next = replaced->next;
+    replaced->prev->next = replacement;
+    replaced->next->prev = replacement;
+    replaced->next = replaced->prev = NULL;
+    TEST_ASSERT_TRUE(BC_JSON_GetObjectItemCaseSensitive(object, "b") == replacement);
+    TEST_ASSERT_TRUE(BC_JSON_GetArrayItem(object, 1) == replacement);
+    BC_JSON_Delete(replaced);
+    BC_JSON_Delete(object);
+
+    BC_JSON_DeleteShapeCache(cache);
+}
+
+static void shape_cache_should_not_intern_escaped_keys(void)
+{
+    BC_JSON_ShapeCache *cache = BC_JSON_CreateShapeCache();
+    BC_JSON *object = NULL;
+    BC_JSON *copy = NULL;
+
+    TEST_ASSERT_NOT_NULL(cache);
+
+    object = parse_with_cache("{\"a\\\\b\": 1, \"c\": 2}", cache);
+    TEST_ASSERT_FALSE(object->child->type & BC_JSON_StringIsConst);
+    TEST_ASSERT_FALSE(object->child->next->type & BC_JSON_StringIsInterned);
+    BC_JSON_Delete(object);
+
+    /* the same characters without the escape sequence are a different key */
+    object = parse_with_cache("{\"a\\b\": 1}", cache);
+    TEST_ASSERT_EQUAL_STRING("a\b", object->child->string);
+
+    copy = BC_JSON_Duplicate(object, true);
+    TEST_ASSERT_TRUE(BC_JSON_Compare(object, copy, true));
+
+    BC_JSON_Delete(copy);
+    BC_JSON_Delete(object);
+    BC_JSON_DeleteShapeCache(cache);
+}
+
+static void shape_cache_should_fail_like_a_normal_parse(void)
+{
+    BC_JSON_ShapeCache *cache = BC_JSON_CreateShapeCache();
+    BC_JSON_ParseOptions options;
+    BC_JSON *object = NULL;
+
+    TEST_ASSERT_NOT_NULL(cache);
+    memset(&options, '\0', sizeof(options));
+    options.shape_cache = cache;
+
+    object = parse_with_cache("{\"a\": 1, \"b\": 2}", cache);
+    BC_JSON_Delete(object);
+
+    TEST_ASSERT_NULL(BC_JSON_ParseWithOptions("{\"a\": 1, \"b\"", 12, &options, NULL));
+    TEST_ASSERT_NULL(BC_JSON_ParseWithOptions("{\"a\": 1, \"b\": }", 16, &options, NULL));
+    TEST_ASSERT_NULL(BC_JSON_ParseWithOptions("{\"a", 3, &options, NULL));
+
+    options.require_null_terminated = true;
+    TEST_ASSERT_NULL(BC_JSON_ParseWithOptions("{\"a\": 1} x", 11, &options, NULL));
+
+    BC_JSON_DeleteShapeCache(cache);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(shape_cache_should_share_keys_between_objects);
+    RUN_TEST(shape_cache_should_find_members_by_slot);
+    RUN_TEST(shape_cache_should_handle_changed_objects);
+    RUN_TEST(shape_cache_should_index_objects_while_parsing);
+    RUN_TEST(shape_cache_should_keep_the_index_apart_from_the_members);
+    RUN_TEST(shape_cache_should_not_intern_escaped_keys);
+    RUN_TEST(shape_cache_should_fail_like_a_normal_parse);
+
+    return UNITY_END();
+}
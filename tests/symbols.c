@@ -0,0 +1,158 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and BC_JSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+static void intern_should_return_the_same_symbol_for_the_same_name(void)
+{
+    BC_JSON_Symbol user_id = BC_JSON_Intern("user_id");
+    BC_JSON_Symbol name = BC_JSON_Intern("name");
+    char copy[] = "user_id";
+
+    TEST_ASSERT_TRUE(user_id > 0);
+    TEST_ASSERT_TRUE(name > 0);
+    TEST_ASSERT_TRUE(user_id != name);
+    TEST_ASSERT_EQUAL_INT(user_id, BC_JSON_Intern(copy));
+    TEST_ASSERT_EQUAL_STRING("user_id", BC_JSON_SymbolName(user_id));
+    TEST_ASSERT_TRUE(BC_JSON_SymbolName(user_id) != copy);
+
+    TEST_ASSERT_EQUAL_INT(0, BC_JSON_Intern(NULL));
+    TEST_ASSERT_NULL(BC_JSON_SymbolName(0));
+    TEST_ASSERT_NULL(BC_JSON_SymbolName(-1));
+    TEST_ASSERT_NULL(BC_JSON_SymbolName(100000));
+}
+
+static void intern_should_grow_the_table(void)
+{
+    char name[32];
+    BC_JSON_Symbol symbols[500];
+    int i = 0;
+
+    for (i = 0; i < 500; i++)
+    {
+        sprintf(name, "field_%d", i);
+        symbols[i] = BC_JSON_Intern(name);
+        TEST_ASSERT_TRUE(symbols[i] > 0);
+    }
+    for (i = 0; i < 500; i++)
+    {
+        sprintf(name, "field_%d", i);
+        TEST_ASSERT_EQUAL_INT(symbols[i], BC_JSON_Intern(name));
+        TEST_ASSERT_EQUAL_STRING(name, BC_JSON_SymbolName(symbols[i]));
+    }
+}
+
+static void parse_should_attach_symbols_to_keys(void)
+{
+    BC_JSON_Symbol user_id = BC_JSON_Intern("user_id");
+    BC_JSON_Symbol missing = BC_JSON_Intern("missing");
+    BC_JSON *object = BC_JSON_Parse("{\"other\": 1, \"user_id\": 2, \"us\\u0065r_id\": 3}");
+    BC_JSON *member = NULL;
+
+    TEST_ASSERT_NOT_NULL(object);
+
+    member = BC_JSON_GetObjectItemBySymbol(object, user_id);
+    TEST_ASSERT_NOT_NULL(member);
+    TEST_ASSERT_EQUAL_DOUBLE(2, member->value_number);
+    TEST_ASSERT_TRUE(member->string == BC_JSON_SymbolName(user_id));
+    TEST_ASSERT_TRUE(member->type & BC_JSON_StringIsConst);
+    TEST_ASSERT_TRUE(member->type & BC_JSON_StringIsInterned);
+
+    /* escaped keys are still found, by comparing strings */
+    TEST_ASSERT_FALSE(member->next->type & BC_JSON_StringIsInterned);
+    TEST_ASSERT_EQUAL_STRING("user_id", member->next->string);
+    TEST_ASSERT_FALSE(object->child->type & BC_JSON_StringIsConst);
+
+    TEST_ASSERT_NULL(BC_JSON_GetObjectItemBySymbol(object, missing));
+    TEST_ASSERT_NULL(BC_JSON_GetObjectItemBySymbol(object, 0));
+    TEST_ASSERT_NULL(BC_JSON_GetObjectItemBySymbol(NULL, user_id));
+
+    BC_JSON_Delete(object);
+}
+
+static void add_item_to_object_cs_should_accept_symbols(void)
+{
+    BC_JSON_Symbol user_id = BC_JSON_Intern("user_id");
+    BC_JSON *object = BC_JSON_CreateObject();
+    BC_JSON *number = BC_JSON_CreateNumber(42);
+    char same_characters[] = "user_id";
+
+    TEST_ASSERT_NOT_NULL(object);
+    TEST_ASSERT_TRUE(BC_JSON_AddItemToObjectCS(object, same_characters, BC_JSON_CreateNull()));
+    TEST_ASSERT_FALSE(object->child->type & BC_JSON_StringIsInterned);
+
+    TEST_ASSERT_TRUE(BC_JSON_AddItemToObjectCS(object, BC_JSON_SymbolName(user_id), number));
+    TEST_ASSERT_TRUE(number->type & BC_JSON_StringIsInterned);
+
+    /* the first member with that name is found, even though only the second is a symbol */
+    TEST_ASSERT_TRUE(BC_JSON_GetObjectItemBySymbol(object, user_id) == object->child);
+    BC_JSON_DeleteItemFromObjectCaseSensitive(object, "user_id");
+    TEST_ASSERT_TRUE(BC_JSON_GetObjectItemBySymbol(object, user_id) == number);
+
+    /* a key that isn't constant anymore isn't a symbol either */
+    TEST_ASSERT_TRUE(BC_JSON_AddItemToObject(object, "user_id", BC_JSON_DetachItemViaPointer(object, number)));
+    TEST_ASSERT_FALSE(number->type & (BC_JSON_StringIsInterned | BC_JSON_StringIsConst));
+    TEST_ASSERT_TRUE(BC_JSON_GetObjectItemBySymbol(object, user_id) == number);
+
+    BC_JSON_Delete(object);
+}
+
+static void shape_cache_should_attach_symbols_to_keys(void)
+{
+    BC_JSON_Symbol name = BC_JSON_Intern("name");
+    BC_JSON_ShapeCache *cache = BC_JSON_CreateShapeCache();
+    BC_JSON_ParseOptions options;
+    const char json[] = "{\"id\": 1, \"name\": \"x\"}";
+    BC_JSON *object = NULL;
+
+    TEST_ASSERT_NOT_NULL(cache);
+    memset(&options, '\0', sizeof(options));
+    options.shape_cache = cache;
+
+    object = BC_JSON_ParseWithOptions(json, sizeof(json), &options, NULL);
+    TEST_ASSERT_NOT_NULL(object);
+    TEST_ASSERT_EQUAL_STRING("x", BC_JSON_GetObjectItemBySymbol(object, name)->value_string);
+    /* the key belongs to the shape cache */
+    TEST_ASSERT_TRUE(BC_JSON_GetObjectItemBySymbol(object, name)->string != BC_JSON_SymbolName(name));
+
+    BC_JSON_Delete(object);
+    BC_JSON_DeleteShapeCache(cache);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(intern_should_return_the_same_symbol_for_the_same_name);
+    RUN_TEST(intern_should_grow_the_table);
+    RUN_TEST(parse_should_attach_symbols_to_keys);
+    RUN_TEST(add_item_to_object_cs_should_accept_symbols);
+    RUN_TEST(shape_cache_should_attach_symbols_to_keys);
+
+    return UNITY_END();
+}
@@ -0,0 +1,170 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and BC_JSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+static size_t allocations = 0;
+
+static void * CJSON_CDECL counting_malloc(size_t size)
+{
+    allocations++;
+    return malloc(size);
+}
+
+static void assert_valid(const char *json)
+{
+    const char *error_position = json;
+
+    TEST_ASSERT_TRUE_MESSAGE(BC_JSON_Validate(json, strlen(json), &error_position), json);
+    TEST_ASSERT_NULL(error_position);
+    /* with the terminating zero */
+    TEST_ASSERT_TRUE_MESSAGE(BC_JSON_Validate(json, strlen(json) + sizeof(""), NULL), json);
+}
+
+static void assert_invalid_at(const char *json, size_t length, size_t position)
+{
+    const char *error_position = NULL;
+
+    TEST_ASSERT_FALSE_MESSAGE(BC_JSON_Validate(json, length, &error_position), json);
+    TEST_ASSERT_TRUE_MESSAGE(error_position == (json + position), json);
+    TEST_ASSERT_TRUE(BC_JSON_GetErrorPtr() == (json + position));
+}
+
+#define assert_invalid(json, position) assert_invalid_at((json), strlen(json) + sizeof(""), (position))
+
+static void validate_should_accept_valid_json(void)
+{
+    const char *files[] = { "inputs/test1", "inputs/test2", "inputs/test3", "inputs/test4", "inputs/test5", "inputs/test7", "inputs/test8", "inputs/test9", "inputs/test10", "inputs/test11" };
+    size_t i = 0;
+
+    for (i = 0; i < (sizeof(files) / sizeof(files[0])); i++)
+    {
+        char *content = read_file(files[i]);
+        TEST_ASSERT_NOT_NULL_MESSAGE(content, files[i]);
+        assert_valid(content);
+        free(content);
+    }
+
+    assert_valid("0");
+    assert_valid("-0.5e-3");
+    assert_valid("1E+10");
+    assert_valid(" \t\r\n[1, \"two\", {\"three\": [true, false, null]}] \n");
+    assert_valid("\"\\u00fc\\ud83d\\ude00 \\\" \\\\ \\/ \\b\\f\\n\\r\\t\"");
+    assert_valid("\xEF\xBB\xBF{}");
+}
+
+static void validate_should_reject_what_rfc_8259_does_not_allow(void)
+{
+    assert_invalid("01", 1);
+    assert_invalid("[1.]", 1);
+    assert_invalid("[.5]", 1);
+    assert_invalid("-", 0);
+    assert_invalid("[1e]", 1);
+    assert_invalid("+1", 0);
+    assert_invalid("[1,]", 3);
+    assert_invalid("{\"a\":1,}", 7);
+    assert_invalid("[\"tab\there\"]", 1);
+    assert_invalid("[\v1]", 1);
+    assert_invalid("[1] x", 4);
+    assert_invalid("[1] [2]", 4);
+    assert_invalid("[\"\\x\"]", 1);
+    assert_invalid("[\"\\udc00\"]", 1);
+    /* \u takes exactly four hex digits */
+    assert_invalid("\"\\u+d800\"", 0);
+    assert_invalid("\"\\u0+0x\"", 0);
+    assert_invalid("\"\\ud3d\\ude00\"", 0);
+    assert_invalid("\"\\u-123\"", 0);
+    assert_invalid("\"\\u 123\"", 0);
+    assert_invalid("[\"\\u12", 1);
+    assert_invalid("", 0);
+}
+
+static void validate_should_check_utf8(void)
+{
+    /* valid sequences of every length, at the limits of the ranges */
+    assert_valid("\"\xC2\x80 \xDF\xBF \xE0\xA0\x80 \xED\x9F\xBF \xEE\x80\x80 \xEF\xBF\xBF \xF0\x90\x80\x80 \xF4\x8F\xBF\xBF\"");
+    /* and in long strings that are scanned in blocks */
+    assert_valid("\"0123456789012345678901234567890123456789\xC3\xBC" "0123456789012345678901234567890123456789\xE2\x82\xAC\"");
+
+    /* continuation byte without a lead byte */
+    assert_invalid("\"\x80\"", 0);
+    /* overlong forms */
+    assert_invalid("\"\xC0\xAF\"", 0);
+    assert_invalid("\"\xE0\x80\xAF\"", 0);
+    assert_invalid("\"\xF0\x80\x80\xAF\"", 0);
+    /* surrogates */
+    assert_invalid("\"\xED\xA0\x80\"", 0);
+    /* beyond U+10FFFF */
+    assert_invalid("\"\xF4\x90\x80\x80\"", 0);
+    assert_invalid("\"\xF5\x80\x80\x80\"", 0);
+    /* incomplete sequences */
+    assert_invalid("\"\xE2\x82\"", 0);
+    assert_invalid("\"0123456789012345678901234567890123456789\xE2\x82\"", 0);
+    /* in keys too */
+    assert_invalid("{\"\xFF\": 1}", 1);
+}
+
+static void validate_should_not_allocate(void)
+{
+    char *content = read_file("inputs/test7");
+    BC_JSON_Hooks hooks = { counting_malloc, free };
+
+    TEST_ASSERT_NOT_NULL(content);
+
+    BC_JSON_InitHooks(&hooks);
+    allocations = 0;
+    TEST_ASSERT_TRUE(BC_JSON_Validate(content, strlen(content), NULL));
+    TEST_ASSERT_FALSE(BC_JSON_Validate("{\"a\": [1, 2, \"\\u00fc\"] x", 24, NULL));
+    BC_JSON_InitHooks(NULL);
+
+    TEST_ASSERT_EQUAL_UINT(0, (unsigned int)allocations);
+
+    free(content);
+}
+
+static void validate_should_handle_null(void)
+{
+    const char *error_position = "not changed";
+
+    TEST_ASSERT_FALSE(BC_JSON_Validate(NULL, 10, &error_position));
+    TEST_ASSERT_NULL(error_position);
+    TEST_ASSERT_FALSE(BC_JSON_Validate("[]", 0, NULL));
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(validate_should_accept_valid_json);
+    RUN_TEST(validate_should_reject_what_rfc_8259_does_not_allow);
+    RUN_TEST(validate_should_check_utf8);
+    RUN_TEST(validate_should_not_allocate);
+    RUN_TEST(validate_should_handle_null);
+
+    return UNITY_END();
+}